@@ -0,0 +1,243 @@
+// ==============================================================================
+// @file   disksim.cpp
+// @brief  libdisksim.so C 接口的实现：把不透明句柄上的调用转发给 FileSystem
+// ==============================================================================
+
+#include "disksim.h"
+
+#include <climits>
+#include <cstring>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "../core/filesystem.h"
+#include "../utils/common.h"
+#include "../utils/error_codes.h"
+#include "../utils/error_handler.h"
+
+// 头文件中的常量必须与引擎内部定义保持一致
+static_assert(DISKSIM_E_NOT_FOUND == ERROR_FILE_NOT_FOUND, "error code drift");
+static_assert(DISKSIM_E_PERMISSION == ERROR_PERMISSION_DENIED,
+              "error code drift");
+static_assert(DISKSIM_E_CHECKSUM == ERROR_CHECKSUM_MISMATCH,
+              "error code drift");
+static_assert(DISKSIM_O_READ == OPEN_MODE_READ &&
+                  DISKSIM_O_WRITE == OPEN_MODE_WRITE &&
+                  DISKSIM_O_CREATE == OPEN_MODE_CREATE &&
+                  DISKSIM_O_APPEND == OPEN_MODE_APPEND,
+              "open flag drift");
+static_assert(DISKSIM_S_IFDIR == FILE_TYPE_DIRECTORY &&
+                  DISKSIM_S_IFREG == FILE_TYPE_REGULAR,
+              "file type drift");
+static_assert(DISKSIM_NAME_MAX == MAX_FILENAME_LENGTH, "name length drift");
+
+/**
+ * @brief 不透明句柄的实际定义。
+ */
+struct disksim_fs {
+  FileSystem fs;  ///< 已挂载的文件系统
+};
+
+namespace {
+
+/**
+ * @brief 把失败转换为负错误码：优先使用本次调用中引擎记录的第一个错误码，
+ *        引擎未记录时使用调用方给出的默认值。
+ */
+int failure(ErrorCode fallback) {
+  ErrorCode code = ErrorHandler::last_error();
+  return code != SUCCESS ? code : fallback;
+}
+
+/**
+ * @brief 在 C 边界执行一次调用：清除线程错误码，并把逃逸的 C++ 异常
+ *        （主要是分配失败）转换为错误码，保证不会跨越 C 调用约定抛出。
+ */
+template <typename Fn>
+int guarded(Fn&& fn) {
+  ErrorHandler::clear_last_error();
+  try {
+    return fn();
+  } catch (const std::bad_alloc&) {
+    return ERROR_OUT_OF_MEMORY;
+  } catch (...) {
+    return ERROR_IO_ERROR;
+  }
+}
+
+}  // namespace
+
+// ==============================================================================
+// 版本与错误
+// ==============================================================================
+
+int disksim_api_version(void) { return DISKSIM_API_VERSION; }
+
+const char* disksim_strerror(int error) {
+  return get_error_message(static_cast<ErrorCode>(error));
+}
+
+void disksim_set_logging(int enabled) {
+  ErrorHandler::set_logging_enabled(enabled != 0);
+}
+
+// ==============================================================================
+// 挂载与卸载
+// ==============================================================================
+
+int disksim_mount(const char* image, int flags, disksim_fs** out) {
+  if (image == nullptr || out == nullptr ||
+      (flags & ~DISKSIM_MOUNT_READ_ONLY) != 0) {
+    return ERROR_INVALID_ARGUMENT;
+  }
+  *out = nullptr;
+
+  return guarded([&] {
+    disksim_fs* handle = new disksim_fs();
+    if (!handle->fs.mount(image, (flags & DISKSIM_MOUNT_READ_ONLY) != 0)) {
+      int code = failure(ERROR_MOUNT_FAILED);
+      delete handle;
+      return code;
+    }
+    *out = handle;
+    return static_cast<int>(SUCCESS);
+  });
+}
+
+int disksim_unmount(disksim_fs* fs) {
+  if (fs == nullptr) {
+    return SUCCESS;
+  }
+  return guarded([&] {
+    bool ok = fs->fs.unmount();
+    int code = ok ? static_cast<int>(SUCCESS) : failure(ERROR_UNMOUNT_FAILED);
+    delete fs;
+    return code;
+  });
+}
+
+// ==============================================================================
+// 文件
+// ==============================================================================
+
+int disksim_open(disksim_fs* fs, const char* path, int flags) {
+  const int known = DISKSIM_O_READ | DISKSIM_O_WRITE | DISKSIM_O_CREATE |
+                    DISKSIM_O_APPEND;
+  if (fs == nullptr || path == nullptr || flags == 0 ||
+      (flags & ~known) != 0) {
+    return ERROR_INVALID_ARGUMENT;
+  }
+  return guarded([&] {
+    int fd = fs->fs.open_file(path, flags);
+    return fd >= 0 ? fd : failure(ERROR_FILE_NOT_FOUND);
+  });
+}
+
+int disksim_read(disksim_fs* fs, int fd, void* buffer, size_t size) {
+  if (fs == nullptr || (buffer == nullptr && size > 0)) {
+    return ERROR_INVALID_ARGUMENT;
+  }
+  // 单次调用的传输长度受返回值类型限制
+  int length = size > static_cast<size_t>(INT_MAX) ? INT_MAX
+                                                   : static_cast<int>(size);
+  return guarded([&] {
+    int n = fs->fs.read_file(fd, static_cast<char*>(buffer), length);
+    return n >= 0 ? n : failure(ERROR_IO_ERROR);
+  });
+}
+
+int disksim_write(disksim_fs* fs, int fd, const void* buffer, size_t size) {
+  if (fs == nullptr || (buffer == nullptr && size > 0)) {
+    return ERROR_INVALID_ARGUMENT;
+  }
+  int length = size > static_cast<size_t>(INT_MAX) ? INT_MAX
+                                                   : static_cast<int>(size);
+  return guarded([&] {
+    int n = fs->fs.write_file(fd, static_cast<const char*>(buffer), length);
+    return n >= 0 ? n : failure(ERROR_IO_ERROR);
+  });
+}
+
+int disksim_seek(disksim_fs* fs, int fd, int64_t offset) {
+  if (fs == nullptr || offset < 0 || offset > INT_MAX) {
+    return ERROR_INVALID_ARGUMENT;
+  }
+  return guarded([&] {
+    return fs->fs.seek_file(fd, static_cast<int>(offset))
+               ? static_cast<int>(SUCCESS)
+               : failure(ERROR_INVALID_FILE_DESCRIPTOR);
+  });
+}
+
+int disksim_close(disksim_fs* fs, int fd) {
+  if (fs == nullptr) {
+    return ERROR_INVALID_ARGUMENT;
+  }
+  return guarded([&] {
+    return fs->fs.close_file(fd) ? static_cast<int>(SUCCESS)
+                                 : failure(ERROR_INVALID_FILE_DESCRIPTOR);
+  });
+}
+
+// ==============================================================================
+// 目录与元数据
+// ==============================================================================
+
+int disksim_mkdir(disksim_fs* fs, const char* path) {
+  if (fs == nullptr || path == nullptr) {
+    return ERROR_INVALID_ARGUMENT;
+  }
+  return guarded([&] {
+    return fs->fs.create_directory(path) ? static_cast<int>(SUCCESS)
+                                         : failure(ERROR_IO_ERROR);
+  });
+}
+
+int disksim_readdir(disksim_fs* fs, const char* path,
+                    disksim_dirent_t* entries, size_t capacity,
+                    size_t* total) {
+  if (fs == nullptr || path == nullptr ||
+      (entries == nullptr && capacity > 0)) {
+    return ERROR_INVALID_ARGUMENT;
+  }
+  return guarded([&] {
+    std::vector<DirectoryEntry> listing;
+    if (!fs->fs.list_directory(path, listing)) {
+      return failure(ERROR_FILE_NOT_FOUND);
+    }
+    if (total != nullptr) {
+      *total = listing.size();
+    }
+
+    size_t count = listing.size() < capacity ? listing.size() : capacity;
+    if (count > static_cast<size_t>(INT_MAX)) {
+      count = INT_MAX;
+    }
+    for (size_t i = 0; i < count; ++i) {
+      entries[i].inode = static_cast<uint32_t>(listing[i].inode_number);
+      std::strncpy(entries[i].name, listing[i].name, DISKSIM_NAME_MAX - 1);
+      entries[i].name[DISKSIM_NAME_MAX - 1] = '\0';
+    }
+    return static_cast<int>(count);
+  });
+}
+
+int disksim_stat(disksim_fs* fs, const char* path, disksim_stat_t* out) {
+  if (fs == nullptr || path == nullptr || out == nullptr) {
+    return ERROR_INVALID_ARGUMENT;
+  }
+  return guarded([&] {
+    Inode inode;
+    if (!fs->fs.stat(path, inode)) {
+      return failure(ERROR_FILE_NOT_FOUND);
+    }
+    out->mode = static_cast<uint32_t>(inode.mode);
+    out->links = static_cast<uint32_t>(inode.link_count);
+    out->size = static_cast<uint64_t>(inode.size);
+    out->atime = static_cast<int64_t>(inode.access_time);
+    out->mtime = static_cast<int64_t>(inode.modification_time);
+    out->ctime = static_cast<int64_t>(inode.creation_time);
+    return static_cast<int>(SUCCESS);
+  });
+}
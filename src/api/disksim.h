@@ -0,0 +1,154 @@
+/* ==============================================================================
+ * @file   disksim.h
+ * @brief  libdisksim.so 的 C 接口：在进程内挂载镜像并直接调用文件系统
+ * ==============================================================================
+ *
+ * 所有对象都是不透明句柄，所有数据都由调用方提供缓冲区，接口中不出现任何
+ * C++ 类型，因此可以从 C 以及任何支持 C 调用约定的语言中使用。
+ *
+ * 返回值约定：成功时返回 DISKSIM_OK（或文件描述符、字节数、条目数等非负值），
+ * 失败时返回负的错误码（DISKSIM_E_*），可用 disksim_strerror 转为文字。
+ *
+ * 同一个 disksim_fs 句柄可以被多个线程同时使用，文件系统内部自行加锁；
+ * 一个镜像同一时间只能被一个读写句柄（或任意多个只读句柄）挂载，
+ * 与命令行程序之间同样遵守该规则。
+ *
+ * 接口版本：新增函数只会追加，已有函数的签名与结构体布局不会改变；
+ * 不兼容的修改会提升 DISKSIM_API_VERSION。
+ */
+
+#ifndef DISKSIM_H
+#define DISKSIM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if defined(__GNUC__)
+#define DISKSIM_API __attribute__((visibility("default")))
+#else
+#define DISKSIM_API
+#endif
+
+#define DISKSIM_API_VERSION 1
+
+/* ==================== 错误码（与引擎内部 ErrorCode 取值一致） ==================== */
+
+#define DISKSIM_OK 0
+#define DISKSIM_E_DISK_NOT_FOUND (-1)
+#define DISKSIM_E_NO_SPACE (-4)
+#define DISKSIM_E_NOT_FOUND (-6)
+#define DISKSIM_E_EXISTS (-7)
+#define DISKSIM_E_INVALID_PATH (-8)
+#define DISKSIM_E_PERMISSION (-9)
+#define DISKSIM_E_IO (-11)
+#define DISKSIM_E_NOT_EMPTY (-13)
+#define DISKSIM_E_NOT_DIRECTORY (-14)
+#define DISKSIM_E_IS_DIRECTORY (-15)
+#define DISKSIM_E_BAD_FD (-16)
+#define DISKSIM_E_INVALID_ARGUMENT (-19)
+#define DISKSIM_E_NO_MEMORY (-20)
+#define DISKSIM_E_MOUNT_FAILED (-24)
+#define DISKSIM_E_NOT_MOUNTED (-28)
+#define DISKSIM_E_CHECKSUM (-29)
+
+/* ==================== 标志与常量 ==================== */
+
+#define DISKSIM_MOUNT_READ_ONLY 0x01 /* 以共享锁只读挂载 */
+
+#define DISKSIM_O_READ 0x01   /* 读 */
+#define DISKSIM_O_WRITE 0x02  /* 写 */
+#define DISKSIM_O_CREATE 0x04 /* 不存在时创建 */
+#define DISKSIM_O_APPEND 0x08 /* 追加 */
+
+#define DISKSIM_S_IFDIR 0x4000 /* disksim_stat_t.mode 中的目录类型位 */
+#define DISKSIM_S_IFREG 0x8000 /* disksim_stat_t.mode 中的普通文件类型位 */
+
+#define DISKSIM_NAME_MAX 256 /* 目录项名称缓冲区长度（含结尾的 '\0'） */
+
+/* ==================== 类型 ==================== */
+
+/** 已挂载的文件系统（不透明句柄）。 */
+typedef struct disksim_fs disksim_fs;
+
+/** 文件或目录的元数据。 */
+typedef struct disksim_stat_t {
+  uint32_t mode;  /* 类型位（DISKSIM_S_IF*）与权限位 */
+  uint32_t links; /* 硬链接计数 */
+  uint64_t size;  /* 大小（字节） */
+  int64_t atime;  /* 最后访问时间（Unix 秒） */
+  int64_t mtime;  /* 最后修改时间（Unix 秒） */
+  int64_t ctime;  /* 创建时间（Unix 秒） */
+} disksim_stat_t;
+
+/** 一个目录项。 */
+typedef struct disksim_dirent_t {
+  uint32_t inode;               /* inode 号 */
+  char name[DISKSIM_NAME_MAX];  /* 以 '\0' 结尾的名称 */
+} disksim_dirent_t;
+
+/* ==================== 函数 ==================== */
+
+/** 库实现的接口版本（DISKSIM_API_VERSION）。 */
+DISKSIM_API int disksim_api_version(void);
+
+/** 错误码的文字描述（静态字符串，无需释放）。 */
+DISKSIM_API const char* disksim_strerror(int error);
+
+/** 开启（非0）或关闭（0）引擎向标准错误流输出的错误日志，默认开启。 */
+DISKSIM_API void disksim_set_logging(int enabled);
+
+/**
+ * 挂载镜像（普通、条带、镜像、分片集合均可）。
+ * @param image 镜像路径。
+ * @param flags 0 或 DISKSIM_MOUNT_READ_ONLY。
+ * @param out 成功时写入新句柄。
+ */
+DISKSIM_API int disksim_mount(const char* image, int flags, disksim_fs** out);
+
+/** 卸载并释放句柄（仍打开的文件会被关闭）。fs 为 NULL 时直接返回。 */
+DISKSIM_API int disksim_unmount(disksim_fs* fs);
+
+/** 打开文件，flags 为 DISKSIM_O_* 的组合；成功返回文件描述符。 */
+DISKSIM_API int disksim_open(disksim_fs* fs, const char* path, int flags);
+
+/** 从当前位置读取最多 size 字节到 buffer；成功返回读到的字节数（0 表示文件末尾）。 */
+DISKSIM_API int disksim_read(disksim_fs* fs, int fd, void* buffer, size_t size);
+
+/** 从当前位置写入 size 字节；成功返回写入的字节数。 */
+DISKSIM_API int disksim_write(disksim_fs* fs, int fd, const void* buffer,
+                              size_t size);
+
+/** 把读写位置移到距文件开头 offset 字节处。 */
+DISKSIM_API int disksim_seek(disksim_fs* fs, int fd, int64_t offset);
+
+/** 关闭文件描述符。 */
+DISKSIM_API int disksim_close(disksim_fs* fs, int fd);
+
+/** 创建目录（父目录必须已存在）。 */
+DISKSIM_API int disksim_mkdir(disksim_fs* fs, const char* path);
+
+/**
+ * 读取目录内容到调用方提供的数组。
+ * @param entries 目录项数组，capacity 为 0 时可以为 NULL。
+ * @param capacity 数组容量。
+ * @param total 非 NULL 时写入目录中的条目总数；大于 capacity 时结果被截断，
+ *              调用方可按该值分配数组后重试。
+ * @return 成功返回写入 entries 的条目数。
+ */
+DISKSIM_API int disksim_readdir(disksim_fs* fs, const char* path,
+                                disksim_dirent_t* entries, size_t capacity,
+                                size_t* total);
+
+/** 获取文件或目录的元数据。 */
+DISKSIM_API int disksim_stat(disksim_fs* fs, const char* path,
+                             disksim_stat_t* out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DISKSIM_H */
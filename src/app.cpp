@@ -9,6 +9,7 @@
 #include "utils/error_codes.h"
 #include "utils/path_utils_extended.h"
 #include "utils/app_utils.h"
+#include "core/image_archive.h"
 #include "threading/stress_tester.h"
 #include "threading/task_dispatcher.h"
 
@@ -39,6 +40,20 @@ int App::run() {
 
   _disk_path = PathUtils::normalize_path(_argv[1]);
 
+  // 磁盘路径后的 --read-only 表示以共享锁只读挂载，可与其他只读进程并发
+  if (_argc >= 3 && _argv[2] == "--read-only") {
+    _read_only = true;
+    _argv.erase(_argv.begin() + 2);
+    --_argc;
+  }
+
+  if (_read_only && _argc >= 3 &&
+      (_argv[2] == "create" || _argv[2] == "format" || _argv[2] == "import-image")) {
+    ErrorHandler::log_error(ERROR_PERMISSION_DENIED,
+                            _argv[2] + " cannot be used with --read-only");
+    return 1;
+  }
+
   // 根据命令分发到不同的处理函数
   if (_argc >= 4 && _argv[2] == "create") {
     return handle_create_command();
@@ -47,6 +62,14 @@ int App::run() {
   if (_argc >= 3 && _argv[2] == "format") {
     return handle_format_command();
   }
+
+  if (_argc >= 4 && _argv[2] == "export-image") {
+    return handle_export_command();
+  }
+
+  if (_argc >= 4 && _argv[2] == "import-image") {
+    return handle_import_command();
+  }
   
   // 检查是否是多线程模式
   if (_argc >= 3 && _argv[2] == "stress") {
@@ -64,22 +87,37 @@ int App::run() {
  * @brief 打印程序的使用说明。
  */
 void App::print_usage() {
-  std::cout << "Usage: " << _program_name << " <disk_file> [command]" << std::endl;
+  std::cout << "Usage: " << _program_name << " <disk_file> [--read-only] [command]" << std::endl;
   std::cout << std::endl;
   std::cout << "Commands:" << std::endl;
-  std::cout << "  create <size_mb>     - Create a new disk file" << std::endl;
+  std::cout << "  create <size_mb> [--log-structured [--segment-blocks N]]" << std::endl;
+  std::cout << "                   [--stripe K [--stripe-unit N] | --mirror K] [--shards N]" << std::endl;
+  std::cout << "                   [--checksums [--verify strict|warn|off]]" << std::endl;
+  std::cout << "                   [--tiered FAST_MB [--fast-path P]]" << std::endl;
+  std::cout << "                       - Create a new disk file" << std::endl;
   std::cout << "  format               - Format the disk" << std::endl;
+  std::cout << "  export-image <out> [--compress]" << std::endl;
+  std::cout << "                       - Write allocated blocks to a compact archive (- for stdout)" << std::endl;
+  std::cout << "  import-image <in> [device options]" << std::endl;
+  std::cout << "                       - Create the disk from an archive (- for stdin)" << std::endl;
   std::cout << "  run                  - Run interactive shell" << std::endl;
   std::cout << "  stress [options]     - Run storage stress test" << std::endl;
   std::cout << "  multithreaded <cmd>  - Execute a command using multithreaded dispatcher" << std::endl;
   std::cout << "  <command>            - Execute a single command" << std::endl;
   std::cout << std::endl;
+  std::cout << "Options:" << std::endl;
+  std::cout << "  --read-only          - Mount with a shared lock; any number of read-only" << std::endl;
+  std::cout << "                         processes may read the image at the same time" << std::endl;
+  std::cout << std::endl;
   std::cout << "Examples:" << std::endl;
   std::cout << "  " << _program_name << " disk.img create 100" << std::endl;
+  std::cout << "  " << _program_name << " disk.img create 100 --log-structured" << std::endl;
   std::cout << "  " << _program_name << " disk.img format" << std::endl;
+  std::cout << "  " << _program_name << " disk.img export-image disk.dsia --compress" << std::endl;
   std::cout << "  " << _program_name << " disk.img run" << std::endl;
   std::cout << "  " << _program_name << " disk.img ls /" << std::endl;
   std::cout << "  " << _program_name << " disk.img multithreaded ls /" << std::endl;
+  std::cout << "  " << _program_name << " disk.img --read-only cat /data.txt" << std::endl;
 }
 
 /**
@@ -92,16 +130,58 @@ int App::handle_create_command() {
     return 1;
   }
 
+  std::vector<std::string> option_args(_argv.begin() + 4, _argv.end());
+  DeviceOptions options;
+  std::string error_message;
+  if (!parse_device_options(option_args, options, error_message)) {
+    ErrorHandler::log_error(ERROR_INVALID_ARGUMENT, error_message);
+    return 1;
+  }
+
+  if (options.shards > 1) {
+    if (!ErrorHandler::check_and_log(
+        ShardRouter::create(_disk_path, size_mb, options),
+        ERROR_IO_ERROR,
+        "Failed to create shard set: " + _disk_path
+    )) {
+      return 1;
+    }
+    std::cout << "Disk created successfully: " << _disk_path << " ("
+              << options.shards << " shards x " << size_mb << "MB)" << std::endl;
+    return 0;
+  }
+
   DiskSimulator disk;
   if (!ErrorHandler::check_and_log(
-      disk.create_disk(_disk_path, size_mb),
+      disk.create_disk(_disk_path, size_mb, options),
       ERROR_IO_ERROR,
       "Failed to create disk: " + _disk_path
   )) {
     return 1;
   }
 
-  std::cout << "Disk created successfully: " << _disk_path << " (" << size_mb << "MB)" << std::endl;
+  // 新镜像不应沿用旧镜像遗留的文件名索引、挂载表和缓存热点集合
+  NameIndex::remove_index_file(_disk_path);
+  MountTable::remove_table_file(_disk_path);
+  CacheWarmer::remove_warm_file(_disk_path);
+
+  std::cout << "Disk created successfully: " << _disk_path << " (" << size_mb << "MB";
+  if (options.stripe_members > 1) {
+    std::cout << ", striped x" << options.stripe_members;
+  }
+  if (options.mirror_members > 1) {
+    std::cout << ", mirrored x" << options.mirror_members;
+  }
+  if (options.mode == DeviceMode::LogStructured) {
+    std::cout << ", log-structured";
+  }
+  if (options.checksums) {
+    std::cout << ", checksummed";
+  }
+  if (options.tier_fast_mb > 0) {
+    std::cout << ", tiered (" << options.tier_fast_mb << "MB fast)";
+  }
+  std::cout << ")" << std::endl;
   return 0;
 }
 
@@ -110,26 +190,116 @@ int App::handle_create_command() {
  * @return int 成功返回0，失败返回1。
  */
 int App::handle_format_command() {
+  // 分片集合逐个格式化其中的分片镜像
+  std::vector<std::string> images = {_disk_path};
+  if (ShardRouter::is_manifest(_disk_path) &&
+      !ShardRouter::read_manifest(_disk_path, images)) {
+    return 1;
+  }
+
+  for (const std::string& image : images) {
+    if (!format_image(image)) {
+      return 1;
+    }
+  }
+
+  std::cout << "Disk formatted successfully" << std::endl;
+  return 0;
+}
+
+/**
+ * @brief 格式化单个磁盘镜像并清理其附属文件。
+ * @param image 镜像路径。
+ * @return bool 成功返回true。
+ */
+bool App::format_image(const std::string& image) {
   DiskSimulator disk;
   if (!ErrorHandler::check_and_log(
-      disk.open_disk(_disk_path),
+      disk.open_disk(image),
       ERROR_IO_ERROR,
-      "Cannot open disk file for formatting: " + _disk_path
+      "Cannot open disk file for formatting: " + image
   )) {
-    return 1;
+    return false;
   }
 
   if (!ErrorHandler::check_and_log(
       disk.format_disk(),
       ERROR_FORMAT_FAILED,
-      "Failed to format disk: " + _disk_path
+      "Failed to format disk: " + image
   )) {
     disk.close_disk();
-    return 1;
+    return false;
   }
 
-  std::cout << "Disk formatted successfully" << std::endl;
+  // 格式化后清空文件名索引（若已启用）
+  NameIndex name_index;
+  if (name_index.open(image)) {
+    name_index.reset();
+  }
+  name_index.close();
+
+  // 挂载点目录已随格式化消失，记录的热点也不再存在
+  MountTable::remove_table_file(image);
+  CacheWarmer::remove_warm_file(image);
+
   disk.close_disk();
+  return true;
+}
+
+/**
+ * @brief 处理 'export-image' 命令，把镜像导出为紧凑归档。
+ * @return int 成功返回0，失败返回1。
+ */
+int App::handle_export_command() {
+  const std::string& archive = _argv[3];
+  bool compress = false;
+  for (int i = 4; i < _argc; ++i) {
+    if (_argv[i] != "--compress") {
+      ErrorHandler::log_error(ERROR_INVALID_ARGUMENT,
+                              "Unknown export-image option: " + _argv[i]);
+      return 1;
+    }
+    compress = true;
+  }
+  if (ShardRouter::is_manifest(_disk_path)) {
+    ErrorHandler::log_error(ERROR_INVALID_ARGUMENT,
+                            "export-image works on a single image; export each shard separately");
+    return 1;
+  }
+
+  ArchiveStats stats;
+  if (!ImageArchive::export_image(_disk_path, archive, compress, stats)) {
+    return 1;
+  }
+  // 归档写往标准输出时，摘要改写到标准错误，避免混入数据流
+  (archive == "-" ? std::cerr : std::cout) << stats.summary("Exported") << std::endl;
+  return 0;
+}
+
+/**
+ * @brief 处理 'import-image' 命令，由归档新建镜像。
+ * @return int 成功返回0，失败返回1。
+ */
+int App::handle_import_command() {
+  std::vector<std::string> option_args(_argv.begin() + 4, _argv.end());
+  DeviceOptions options;
+  std::string error_message;
+  if (!parse_device_options(option_args, options, error_message)) {
+    ErrorHandler::log_error(ERROR_INVALID_ARGUMENT, error_message);
+    return 1;
+  }
+
+  ArchiveStats stats;
+  if (!ImageArchive::import_image(_argv[3], _disk_path, options, stats)) {
+    return 1;
+  }
+
+  // 与 create 相同：新镜像不沿用旧镜像遗留的附属文件
+  NameIndex::remove_index_file(_disk_path);
+  MountTable::remove_table_file(_disk_path);
+  CacheWarmer::remove_warm_file(_disk_path);
+
+  std::cout << stats.summary("Imported") << std::endl;
   return 0;
 }
 
@@ -139,7 +309,7 @@ int App::handle_format_command() {
  */
 int App::handle_run_command() {
   if (!ErrorHandler::check_and_log(
-      _fs.mount(_disk_path),
+      _fs.mount(_disk_path, _read_only),
       ERROR_NOT_MOUNTED,
       "Cannot mount disk file: " + _disk_path + " (Make sure the disk file exists and is formatted.)"
   )) {
@@ -175,7 +345,7 @@ int App::handle_run_command() {
 
 int App::handle_multithreaded_mode() {
   if (!ErrorHandler::check_and_log(
-      _fs.mount(_disk_path),
+      _fs.mount(_disk_path, _read_only),
       ERROR_NOT_MOUNTED,
       "Cannot mount disk file: " + _disk_path + " (Make sure the disk file exists and is formatted.)"
   )) {
@@ -284,7 +454,7 @@ int App::handle_stress_command() {
   }
 
   if (!ErrorHandler::check_and_log(
-          _fs.mount(_disk_path), ERROR_NOT_MOUNTED,
+          _fs.mount(_disk_path, _read_only), ERROR_NOT_MOUNTED,
           "Cannot mount disk file: " + _disk_path +
               " (Make sure the disk file exists and is formatted.)")) {
     return 1;
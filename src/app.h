@@ -57,6 +57,25 @@ class App {
    */
   int handle_format_command();
 
+  /**
+   * @brief 处理 'export-image' 命令，把已分配的块导出为紧凑归档。
+   * @return int 成功返回0，失败返回1。
+   */
+  int handle_export_command();
+
+  /**
+   * @brief 处理 'import-image' 命令，由归档新建镜像。
+   * @return int 成功返回0，失败返回1。
+   */
+  int handle_import_command();
+
+  /**
+   * @brief 格式化单个磁盘镜像（分片集合中的每个分片各调用一次）。
+   * @param image 镜像路径。
+   * @return bool 成功返回true。
+   */
+  bool format_image(const std::string& image);
+
   /**
    * @brief 处理 'run' 命令（交互模式）或单个文件系统命令。
    * @return int 成功返回0，失败返回1。
@@ -79,6 +98,7 @@ class App {
   std::vector<std::string> _argv;  // 命令行参数列表
   std::string _program_name;       // 程序名称
   std::string _disk_path;          // 磁盘文件路径
+  bool _read_only = false;         // 是否以 --read-only 共享只读挂载
   FileSystem _fs;                  // 文件系统实例
   std::unique_ptr<TaskDispatcher>
       _task_dispatcher;  // 任务分发器实例（在多线程模式下使用）
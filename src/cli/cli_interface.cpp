@@ -5,11 +5,17 @@
 
 #include "cli_interface.h"
 
+#include <cstdlib>
 #include <cstring>
 #include <iostream>
 #include <vector>
 
+#include "../threading/parallel_search.h"
 #include "../threading/stress_tester.h"
+#include "../threading/tree_copier.h"
+#include "../utils/memory_accounting.h"
+#include "../utils/monitoring.h"
+#include "../utils/slow_op_watchdog.h"
 
 /**
  * @brief CLIInterface 构造函数。
@@ -62,6 +68,16 @@ bool CLIInterface::execute_command(const Command& cmd) {
     return cmd_exit(cmd);
   } else if (cmd.name == "info") {
     return cmd_info(cmd);
+  } else if (cmd.name == "stats") {
+    return cmd_stats(cmd);
+  } else if (cmd.name == "scrub") {
+    return cmd_scrub(cmd);
+  } else if (cmd.name == "slowlog") {
+    return cmd_slowlog(cmd);
+  } else if (cmd.name == "defrag") {
+    return cmd_defrag(cmd);
+  } else if (cmd.name == "heatmap") {
+    return cmd_heatmap(cmd);
   } else if (cmd.name == "format") {
     return cmd_format(cmd);
   } else if (cmd.name == "ls") {
@@ -80,6 +96,16 @@ bool CLIInterface::execute_command(const Command& cmd) {
     return cmd_copy(cmd);
   } else if (cmd.name == "stress") {
     return cmd_stress(cmd);
+  } else if (cmd.name == "find") {
+    return cmd_find(cmd);
+  } else if (cmd.name == "grep") {
+    return cmd_grep(cmd);
+  } else if (cmd.name == "locate") {
+    return cmd_locate(cmd);
+  } else if (cmd.name == "mount") {
+    return cmd_mount(cmd);
+  } else if (cmd.name == "umount") {
+    return cmd_umount(cmd);
   } else {
     ErrorHandler::log_error(ERROR_UNKNOWN_COMMAND,
                             "Unknown command: " + cmd.name);
@@ -127,6 +153,162 @@ bool CLIInterface::cmd_info(const Command& cmd) {
   }
 }
 
+/** @brief 处理 'stats' 命令。*/
+bool CLIInterface::cmd_stats(const Command& cmd) {
+  (void)cmd;
+  std::string report;
+  if (!filesystem.get_device_stats(report)) {
+    ErrorHandler::log_error(ERROR_IO_ERROR, "Failed to get device statistics");
+    return false;
+  }
+  std::cout << report;
+  std::string warm_status;
+  if (filesystem.get_warm_set_status(warm_status)) {
+    std::cout << warm_status;
+  }
+  std::string defrag_status;
+  if (filesystem.get_defrag_status(defrag_status)) {
+    std::cout << defrag_status;
+  }
+  std::cout << MemoryAccounting::report();
+  std::cout << "  Process " << Monitoring::get_process_memory() << std::endl;
+  return true;
+}
+
+/** @brief 处理 'scrub' 命令：巡检全部块校验和，或修改读取校验策略。*/
+bool CLIInterface::cmd_scrub(const Command& cmd) {
+  if (!cmd.args.empty()) {
+    ChecksumPolicy policy;
+    if (!parse_checksum_policy(cmd.args[1], policy)) {
+      ErrorHandler::log_error(ERROR_INVALID_ARGUMENT,
+                              "Invalid verify policy: " + cmd.args[1] +
+                                  " (expected strict, warn or off)");
+      return false;
+    }
+    if (!filesystem.set_verify_policy(policy)) {
+      return false;
+    }
+    std::cout << "Verify policy set to " << cmd.args[1] << std::endl;
+    return true;
+  }
+
+  std::string report;
+  bool corrupted = false;
+  if (!filesystem.scrub(report, corrupted)) {
+    return false;
+  }
+  std::cout << report;
+  return !corrupted;
+}
+
+/** @brief 处理 'slowlog' 命令：显示阈值与最近的慢操作，或修改阈值。*/
+bool CLIInterface::cmd_slowlog(const Command& cmd) {
+  if (!cmd.args.empty()) {
+    const std::string& value = cmd.args[0];
+    double ms = 0;
+    if (value != "off") {
+      char* end = nullptr;
+      ms = std::strtod(value.c_str(), &end);
+      if (end == value.c_str() || *end != '\0' || ms < 0) {
+        ErrorHandler::log_error(ERROR_INVALID_ARGUMENT,
+                                "Invalid threshold: " + value +
+                                    " (expected milliseconds or off)");
+        return false;
+      }
+    }
+    SlowOpWatchdog::set_threshold_ms(ms);
+    if (SlowOpWatchdog::threshold_ms() > 0) {
+      std::cout << "Slow operation threshold set to " << value << " ms"
+                << std::endl;
+    } else {
+      std::cout << "Slow operation watchdog disabled" << std::endl;
+    }
+    return true;
+  }
+
+  double threshold = SlowOpWatchdog::threshold_ms();
+  if (threshold > 0) {
+    std::cout << "Slow operation threshold: " << threshold << " ms"
+              << std::endl;
+  } else {
+    std::cout << "Slow operation watchdog: off" << std::endl;
+  }
+  std::vector<std::string> reports = SlowOpWatchdog::recent_reports();
+  if (reports.empty()) {
+    std::cout << "No slow operations recorded" << std::endl;
+  }
+  for (const std::string& line : reports) {
+    std::cout << line << std::endl;
+  }
+  return true;
+}
+
+/** @brief 处理 'defrag' 命令：整理路径下的碎片文件，或控制后台整理线程。*/
+bool CLIInterface::cmd_defrag(const Command& cmd) {
+  std::string argument = cmd.args.empty() ? "/" : cmd.args[0];
+  if (argument == "--background") {
+    if (!filesystem.start_background_defrag()) {
+      return false;
+    }
+    std::cout << "Background defrag started" << std::endl;
+    return true;
+  }
+  if (argument == "--stop") {
+    if (!filesystem.stop_background_defrag()) {
+      return false;
+    }
+    std::cout << "Background defrag stopped" << std::endl;
+    return true;
+  }
+  if (argument == "--status") {
+    std::string status;
+    if (!filesystem.get_defrag_status(status)) {
+      return false;
+    }
+    std::cout << status;
+    return true;
+  }
+  if (argument.rfind("--", 0) == 0) {
+    ErrorHandler::log_error(ERROR_INVALID_ARGUMENT,
+                            "Unknown defrag option: " + argument);
+    return false;
+  }
+
+  std::string report;
+  if (!filesystem.defragment(PathUtils::normalize_path(argument), report)) {
+    return false;
+  }
+  std::cout << report;
+  return true;
+}
+
+/** @brief 处理 'heatmap' 命令：显示块访问热度，或开始、停止、清空统计。*/
+bool CLIInterface::cmd_heatmap(const Command& cmd) {
+  std::string action = cmd.args.empty() ? "" : cmd.args[0];
+  if (action == "on" || action == "off") {
+    if (!filesystem.set_heatmap_enabled(action == "on")) {
+      return false;
+    }
+    std::cout << "Heat map tracking " << (action == "on" ? "started" : "stopped")
+              << std::endl;
+    return true;
+  }
+  if (action == "reset") {
+    if (!filesystem.reset_heatmap()) {
+      return false;
+    }
+    std::cout << "Heat map counters cleared" << std::endl;
+    return true;
+  }
+
+  std::string report;
+  if (!filesystem.get_heatmap_report(report)) {
+    return false;
+  }
+  std::cout << report;
+  return true;
+}
+
 /** @brief 处理 'format' 命令。*/
 bool CLIInterface::cmd_format(const Command& cmd) {
   (void)cmd;
@@ -273,6 +455,9 @@ bool CLIInterface::cmd_echo(const Command& cmd) {
  * @brief 处理 'copy' 命令。
  */
 bool CLIInterface::cmd_copy(const Command& cmd) {
+  if (!cmd.args.empty() && cmd.args[0] == "-r") {
+    return cmd_copy_tree(cmd);
+  }
   if (cmd.args.size() != 2) {
     ErrorHandler::log_error(
         ERROR_INVALID_ARGUMENT,
@@ -361,6 +546,36 @@ bool CLIInterface::cmd_copy(const Command& cmd) {
   return success;
 }
 
+/**
+ * @brief 处理 'cp -r' 命令：并行递归复制目录树。
+ */
+bool CLIInterface::cmd_copy_tree(const Command& cmd) {
+  std::size_t jobs = 0;
+  if (cmd.args.size() == 5) {
+    const std::string& value = cmd.args[4];
+    char* end = nullptr;
+    unsigned long parsed = std::strtoul(value.c_str(), &end, 10);
+    if (end == value.c_str() || *end != '\0' || parsed == 0 ||
+        parsed > TreeCopier::kMaxParallelism) {
+      ErrorHandler::log_error(
+          ERROR_INVALID_ARGUMENT,
+          "Invalid --jobs value: " + value + " (expected 1-" +
+              std::to_string(TreeCopier::kMaxParallelism) + ")");
+      return false;
+    }
+    jobs = parsed;
+  }
+
+  TreeCopier copier(filesystem, jobs);
+  CopyStats stats;
+  if (!copier.copy(cmd.args[1], cmd.args[2], stats)) {
+    return false;
+  }
+  std::cout << stats.summary() << " (" << copier.parallelism() << " jobs)"
+            << std::endl;
+  return true;
+}
+
 /** @brief 处理 'stress' 命令。*/
 bool CLIInterface::cmd_stress(const Command& cmd) {
   StressTestConfig config;
@@ -380,6 +595,113 @@ bool CLIInterface::cmd_stress(const Command& cmd) {
   return success;
 }
 
+/** @brief 处理 'find' 命令。*/
+bool CLIInterface::cmd_find(const Command& cmd) {
+  FindOptions options;
+  std::string error_message;
+  if (!parse_find_arguments(cmd.args, options, error_message)) {
+    ErrorHandler::log_error(ERROR_INVALID_ARGUMENT, error_message);
+    return false;
+  }
+
+  ParallelSearcher searcher(filesystem);
+  std::vector<std::string> results;
+  if (!searcher.find(options, results)) {
+    return false;
+  }
+
+  for (const std::string& path : results) {
+    std::cout << path << std::endl;
+  }
+  return true;
+}
+
+/** @brief 处理 'grep' 命令。*/
+bool CLIInterface::cmd_grep(const Command& cmd) {
+  const std::string& pattern = cmd.args[0];
+  std::string root_path = PathUtils::normalize_path(cmd.args[1]);
+
+  ParallelSearcher searcher(filesystem);
+  std::vector<GrepMatch> matches;
+  if (!searcher.grep(pattern, root_path, matches)) {
+    return false;
+  }
+
+  for (const GrepMatch& match : matches) {
+    std::cout << match.path << ":" << match.line_number << ":" << match.line
+              << std::endl;
+  }
+  return true;
+}
+
+/** @brief 处理 'locate' 命令。*/
+bool CLIInterface::cmd_locate(const Command& cmd) {
+  const std::string& argument = cmd.args[0];
+
+  if (argument == "--build") {
+    if (!filesystem.build_name_index()) {
+      ErrorHandler::log_error(ERROR_IO_ERROR, "Failed to build name index");
+      return false;
+    }
+    std::cout << "Name index built" << std::endl;
+    return true;
+  }
+
+  if (argument == "--drop") {
+    if (!filesystem.drop_name_index()) {
+      return false;
+    }
+    std::cout << "Name index dropped" << std::endl;
+    return true;
+  }
+
+  std::vector<std::string> paths;
+  if (!filesystem.locate(argument, paths)) {
+    return false;
+  }
+  if (paths.empty()) {
+    ErrorHandler::log_error(ERROR_FILE_NOT_FOUND,
+                            "No entries named: " + argument);
+    return false;
+  }
+
+  for (const std::string& path : paths) {
+    std::cout << path << std::endl;
+  }
+  return true;
+}
+
+/** @brief 处理 'mount' 命令：无参数时列出挂载点。*/
+bool CLIInterface::cmd_mount(const Command& cmd) {
+  if (cmd.args.empty()) {
+    std::vector<MountInfo> mounts;
+    if (!filesystem.list_mounts(mounts)) {
+      return false;
+    }
+    for (const MountInfo& info : mounts) {
+      std::cout << info.image_path << " on " << info.mount_point << std::endl;
+    }
+    return true;
+  }
+
+  const std::string& image_path = cmd.args[0];
+  const std::string& mount_point = cmd.args[1];
+  if (!filesystem.attach_mount(mount_point, image_path)) {
+    return false;
+  }
+  std::cout << "Mounted " << image_path << " on " << mount_point << std::endl;
+  return true;
+}
+
+/** @brief 处理 'umount' 命令。*/
+bool CLIInterface::cmd_umount(const Command& cmd) {
+  if (!filesystem.detach_mount(cmd.args[0])) {
+    return false;
+  }
+  std::cout << "Unmounted " << cmd.args[0] << std::endl;
+  return true;
+}
+
 // =============================================================================
 // Private Helper Methods
 // =============================================================================
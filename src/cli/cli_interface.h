@@ -55,6 +55,11 @@ class CLIInterface {
   bool cmd_help(const Command& cmd);
   bool cmd_exit(const Command& cmd);
   bool cmd_info(const Command& cmd);
+  bool cmd_stats(const Command& cmd);
+  bool cmd_scrub(const Command& cmd);
+  bool cmd_slowlog(const Command& cmd);
+  bool cmd_defrag(const Command& cmd);
+  bool cmd_heatmap(const Command& cmd);
   bool cmd_format(const Command& cmd);
   bool cmd_ls(const Command& cmd);
   bool cmd_mkdir(const Command& cmd);
@@ -63,7 +68,13 @@ class CLIInterface {
   bool cmd_cat(const Command& cmd);
   bool cmd_echo(const Command& cmd);
   bool cmd_copy(const Command& cmd);
+  bool cmd_copy_tree(const Command& cmd);
   bool cmd_stress(const Command& cmd);
+  bool cmd_find(const Command& cmd);
+  bool cmd_grep(const Command& cmd);
+  bool cmd_locate(const Command& cmd);
+  bool cmd_mount(const Command& cmd);
+  bool cmd_umount(const Command& cmd);
 
   // UI 辅助函数
   std::string get_prompt() const;
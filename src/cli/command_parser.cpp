@@ -16,7 +16,10 @@ CommandParser::CommandParser() {
   // 初始化支持的命令列表
   supported_commands = {"help",  "exit",    "quit",   "info",  "format",
                         "ls",    "mkdir",   "touch",  "rm",    "cat",
-                        "echo",  "copy",    "stress"};
+                        "echo",  "copy",    "stress", "find",  "grep",
+                        "locate", "stats",   "mount",  "umount",
+                        "scrub", "slowlog", "defrag", "cp",
+                        "heatmap"};
 }
 
 /**
@@ -61,6 +64,24 @@ void CommandParser::show_help() const {
   std::cout << "  help              - Show this help message" << std::endl;
   std::cout << "  exit, quit        - Exit the program" << std::endl;
   std::cout << "  info              - Show disk information" << std::endl;
+  std::cout << "  stats             - Show block device mode and I/O statistics"
+            << std::endl;
+  std::cout << "  scrub [--verify strict|warn|off]"
+            << std::endl;
+  std::cout << "                    - Verify all block checksums, or set the read verify policy"
+            << std::endl;
+  std::cout << "  slowlog [ms|off]  - Show recent slow operations, or set the threshold"
+            << std::endl;
+  std::cout << "  defrag [path]     - Move fragmented files into contiguous runs"
+            << std::endl;
+  std::cout << "  defrag --background|--stop|--status"
+            << std::endl;
+  std::cout << "                    - Control the background defragmenter"
+            << std::endl;
+  std::cout << "  heatmap [on|off|reset]"
+            << std::endl;
+  std::cout << "                    - Show block access heat, or control tracking"
+            << std::endl;
   std::cout << "  format            - Format the disk" << std::endl;
   std::cout << "  ls [path]         - List directory contents" << std::endl;
   std::cout << "  mkdir <path>      - Create a directory" << std::endl;
@@ -70,7 +91,24 @@ void CommandParser::show_help() const {
   std::cout << "  echo <text> > <path> - Write text to a file" << std::endl;
   std::cout << "  copy <src> <dst>  - Copy a file from source to destination"
             << std::endl;
+  std::cout << "  cp -r <src_dir> <dst_dir> [--jobs N]" << std::endl;
+  std::cout << "                    - Copy a directory tree in parallel"
+            << std::endl;
   std::cout << "  stress [options] - Run storage stress workload" << std::endl;
+  std::cout << "  find <dir> [-name <glob>] [-size [+|-]N[c|k|M|G]]"
+            << std::endl;
+  std::cout << "                    - Find entries by name and size in parallel"
+            << std::endl;
+  std::cout << "  grep <pattern> <dir> - Search file contents under a directory"
+            << std::endl;
+  std::cout << "  locate <name>     - Look up paths by name via the name index"
+            << std::endl;
+  std::cout << "  locate --build|--drop - Build or remove the name index"
+            << std::endl;
+  std::cout << "  mount [<image> <dir>] - Mount an image on a directory, or list mounts"
+            << std::endl;
+  std::cout << "  umount <dir>      - Unmount the image mounted on a directory"
+            << std::endl;
   std::cout << std::endl;
 }
 
@@ -110,7 +148,7 @@ bool CommandParser::validate_command(const Command& cmd) const {
 
   // 检查特定命令的参数数量
   if (cmd.name == "mkdir" || cmd.name == "touch" || cmd.name == "rm" ||
-      cmd.name == "cat") {
+      cmd.name == "cat" || cmd.name == "locate" || cmd.name == "umount") {
     if (cmd.args.size() != 1) {
       ErrorHandler::log_error(ERROR_INVALID_ARGUMENT,
                               cmd.name + " requires exactly one argument");
@@ -123,12 +161,66 @@ bool CommandParser::validate_command(const Command& cmd) const {
       return false;
     }
   } else if (cmd.name == "copy" || cmd.name == "cp") {
-    if (cmd.args.size() != 2) {
+    if (!cmd.args.empty() && cmd.args[0] == "-r") {
+      if (cmd.args.size() != 3 &&
+          !(cmd.args.size() == 5 && cmd.args[3] == "--jobs")) {
+        ErrorHandler::log_error(ERROR_INVALID_ARGUMENT,
+                                "Usage: cp -r <src_dir> <dst_dir> [--jobs N]");
+        return false;
+      }
+    } else if (cmd.args.size() != 2) {
       ErrorHandler::log_error(
           ERROR_INVALID_ARGUMENT,
           "copy requires exactly two arguments: source and destination");
       return false;
     }
+  } else if (cmd.name == "find") {
+    if (cmd.args.empty()) {
+      ErrorHandler::log_error(
+          ERROR_INVALID_ARGUMENT,
+          "Usage: find <dir> [-name <glob>] [-size [+|-]N[c|k|M|G]]");
+      return false;
+    }
+  } else if (cmd.name == "grep") {
+    if (cmd.args.size() != 2) {
+      ErrorHandler::log_error(ERROR_INVALID_ARGUMENT,
+                              "Usage: grep <pattern> <dir>");
+      return false;
+    }
+  } else if (cmd.name == "scrub") {
+    if (!cmd.args.empty() &&
+        (cmd.args.size() != 2 || cmd.args[0] != "--verify")) {
+      ErrorHandler::log_error(ERROR_INVALID_ARGUMENT,
+                              "Usage: scrub [--verify strict|warn|off]");
+      return false;
+    }
+  } else if (cmd.name == "slowlog") {
+    if (cmd.args.size() > 1) {
+      ErrorHandler::log_error(ERROR_INVALID_ARGUMENT,
+                              "Usage: slowlog [ms|off]");
+      return false;
+    }
+  } else if (cmd.name == "defrag") {
+    if (cmd.args.size() > 1) {
+      ErrorHandler::log_error(
+          ERROR_INVALID_ARGUMENT,
+          "Usage: defrag [path] | defrag --background|--stop|--status");
+      return false;
+    }
+  } else if (cmd.name == "heatmap") {
+    if (cmd.args.size() > 1 ||
+        (cmd.args.size() == 1 && cmd.args[0] != "on" && cmd.args[0] != "off" &&
+         cmd.args[0] != "reset")) {
+      ErrorHandler::log_error(ERROR_INVALID_ARGUMENT,
+                              "Usage: heatmap [on|off|reset]");
+      return false;
+    }
+  } else if (cmd.name == "mount") {
+    if (!cmd.args.empty() && cmd.args.size() != 2) {
+      ErrorHandler::log_error(ERROR_INVALID_ARGUMENT,
+                              "Usage: mount [<image> <dir>]");
+      return false;
+    }
   }
 
   return true;
@@ -5,6 +5,7 @@
 
 #include "bitmap_manager.h"
 #include "disk_simulator.h"
+#include "../utils/memory_accounting.h"
 #include <cstring>
 #include <iostream>
 #include <algorithm> // for std::min
@@ -29,6 +30,7 @@ BitmapManager::BitmapManager(int size)
     bitmap_size = (total_bits + 7) / 8;
     try {
       bitmap_data = new char[bitmap_size];
+      MemoryAccounting::on_allocate(MemSubsystem::Bitmaps, bitmap_size);
       // 初始化所有位为0（空闲）
       BlockUtils::clear_buffer(bitmap_data, bitmap_size);
     } catch (const std::bad_alloc& e) {
@@ -45,6 +47,9 @@ BitmapManager::BitmapManager(int size)
  * @brief 析构函数，释放位图数据所占用的内存。
  */
 BitmapManager::~BitmapManager() {
+  if (bitmap_data != nullptr) {
+    MemoryAccounting::on_deallocate(MemSubsystem::Bitmaps, bitmap_size);
+  }
   delete[] bitmap_data;
   bitmap_data = nullptr;
 }
@@ -73,6 +78,28 @@ bool BitmapManager::allocate_bit(int& bit_num) {
   return true;
 }
 
+/**
+ * @brief 分配一段连续的空闲位，并将其全部标记为已使用。
+ * @param count 需要的位数。
+ * @param[out] first_bit 分配到的第一个位号。
+ * @return bool 成功分配返回true；没有足够长的连续空闲区间时返回false（不记录错误）。
+ */
+bool BitmapManager::allocate_run(int count, int& first_bit) {
+  if (!check_initialized("allocate_run") || count <= 0) return false;
+
+  std::lock_guard<std::mutex> lock(bitmap_mutex_);
+  first_bit = find_free_run(count);
+  if (first_bit == -1) {
+    return false;
+  }
+
+  for (int bit = first_bit; bit < first_bit + count; ++bit) {
+    set_bit(bit);
+  }
+  free_bits_count -= count;
+  return true;
+}
+
 /**
  * @brief 释放一个指定的位，将其标记为空闲。
  * @param bit_num 要释放的位号。
@@ -305,6 +332,36 @@ int BitmapManager::find_free_bit() const {
   return -1;
 }
 
+/**
+ * @brief 查找第一段长度不小于 count 的连续空闲位。
+ * @param count 需要的位数。
+ * @return int 区间的起始位号。如果找不到则返回-1。
+ */
+int BitmapManager::find_free_run(int count) const {
+  if (free_bits_count < count || !bitmap_data) {
+    return -1;
+  }
+
+  int run_start = 0;
+  int run_length = 0;
+  for (int bit = 0; bit < total_bits; ++bit) {
+    int byte_index = bit / 8;
+    int bit_offset = bit % 8;
+    if ((bitmap_data[byte_index] & (1 << bit_offset)) != 0) {
+      run_length = 0;
+      continue;
+    }
+    if (run_length == 0) {
+      run_start = bit;
+    }
+    if (++run_length == count) {
+      return run_start;
+    }
+  }
+
+  return -1;
+}
+
 /**
  * @brief 遍历整个位图，重新计算空闲位的数量。
  * @note 这是一个耗时操作，仅在从磁盘加载或数据不一致时调用。
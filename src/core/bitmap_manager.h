@@ -31,6 +31,14 @@ class BitmapManager {
    */
   bool allocate_bit(int& bit_num);
 
+  /**
+   * @brief 分配一段连续的空闲位（首次适配）。
+   * @param count 需要的位数。
+   * @param[out] first_bit 分配到的第一个位号。
+   * @return bool 操作成功返回true，没有足够长的连续空闲区间返回false。
+   */
+  bool allocate_run(int count, int& first_bit);
+
   /**
    * @brief 释放一个指定的位。
    * @param bit_num 要释放的位号。
@@ -104,5 +112,6 @@ class BitmapManager {
   void set_bit(int bit_num);
   void clear_bit(int bit_num);
   int find_free_bit() const;
+  int find_free_run(int count) const;
   void recalculate_free_bits();
 };
\ No newline at end of file
@@ -0,0 +1,150 @@
+// ==============================================================================
+// @file   block_device.cpp
+// @brief  设备创建选项的解析
+// ==============================================================================
+
+#include "block_device.h"
+
+#include <cstdlib>
+
+/**
+ * @brief 解析 create 命令中磁盘大小之后的设备选项。
+ */
+bool parse_device_options(const std::vector<std::string>& args,
+                          DeviceOptions& options, std::string& error_message) {
+  options = DeviceOptions();
+  bool verify_given = false;
+  for (size_t i = 0; i < args.size(); ++i) {
+    const std::string& arg = args[i];
+    if (arg == "--log-structured") {
+      options.mode = DeviceMode::LogStructured;
+    } else if (arg == "--segment-blocks") {
+      if (i + 1 >= args.size()) {
+        error_message = "--segment-blocks requires a value";
+        return false;
+      }
+      char* end = nullptr;
+      long value = std::strtol(args[++i].c_str(), &end, 10);
+      if (*end != '\0' || value < 8 || value > 65536) {
+        error_message = "Invalid segment size: " + args[i] +
+                        " (expected 8-65536 blocks)";
+        return false;
+      }
+      options.segment_blocks = static_cast<int>(value);
+    } else if (arg == "--shards") {
+      if (i + 1 >= args.size()) {
+        error_message = "--shards requires a value";
+        return false;
+      }
+      char* end = nullptr;
+      long value = std::strtol(args[++i].c_str(), &end, 10);
+      if (*end != '\0' || value < 2 || value > 64) {
+        error_message = "Invalid shard count: " + args[i] +
+                        " (expected 2-64)";
+        return false;
+      }
+      options.shards = static_cast<int>(value);
+    } else if (arg == "--checksums") {
+      options.checksums = true;
+    } else if (arg == "--verify") {
+      if (i + 1 >= args.size()) {
+        error_message = "--verify requires a value";
+        return false;
+      }
+      if (!parse_checksum_policy(args[++i], options.verify)) {
+        error_message = "Invalid verify policy: " + args[i] +
+                        " (expected strict, warn or off)";
+        return false;
+      }
+      verify_given = true;
+    } else if (arg == "--mirror") {
+      if (i + 1 >= args.size()) {
+        error_message = "--mirror requires a value";
+        return false;
+      }
+      char* end = nullptr;
+      long value = std::strtol(args[++i].c_str(), &end, 10);
+      if (*end != '\0' || value < 2 || value > 8) {
+        error_message = "Invalid mirror width: " + args[i] + " (expected 2-8)";
+        return false;
+      }
+      options.mirror_members = static_cast<int>(value);
+    } else if (arg == "--stripe" || arg == "--stripe-unit") {
+      if (i + 1 >= args.size()) {
+        error_message = arg + " requires a value";
+        return false;
+      }
+      char* end = nullptr;
+      long value = std::strtol(args[++i].c_str(), &end, 10);
+      bool members = arg == "--stripe";
+      long low = members ? 2 : 1;
+      long high = members ? 16 : 4096;
+      if (*end != '\0' || value < low || value > high) {
+        error_message = "Invalid " + std::string(members ? "stripe width" : "stripe unit") +
+                        ": " + args[i] + " (expected " + std::to_string(low) +
+                        "-" + std::to_string(high) + ")";
+        return false;
+      }
+      if (members) {
+        options.stripe_members = static_cast<int>(value);
+      } else {
+        options.stripe_blocks = static_cast<int>(value);
+      }
+    } else if (arg == "--tiered") {
+      if (i + 1 >= args.size()) {
+        error_message = "--tiered requires a value";
+        return false;
+      }
+      char* end = nullptr;
+      long value = std::strtol(args[++i].c_str(), &end, 10);
+      if (*end != '\0' || value < 1 || value > 65536) {
+        error_message = "Invalid fast tier size: " + args[i] +
+                        " (expected 1-65536 MB)";
+        return false;
+      }
+      options.tier_fast_mb = static_cast<int>(value);
+    } else if (arg == "--fast-path") {
+      if (i + 1 >= args.size() || args[i + 1].empty()) {
+        error_message = "--fast-path requires a value";
+        return false;
+      }
+      options.tier_fast_path = args[++i];
+    } else {
+      error_message = "Unknown create option: " + arg;
+      return false;
+    }
+  }
+  if (options.stripe_members > 1 && options.mirror_members > 1) {
+    error_message = "--stripe and --mirror cannot be combined";
+    return false;
+  }
+  if (verify_given && !options.checksums) {
+    error_message = "--verify requires --checksums";
+    return false;
+  }
+  if (!options.tier_fast_path.empty() && options.tier_fast_mb == 0) {
+    error_message = "--fast-path requires --tiered";
+    return false;
+  }
+  if (!options.tier_fast_path.empty() && options.shards > 1) {
+    error_message = "--fast-path cannot be combined with --shards";
+    return false;
+  }
+  return true;
+}
+
+/**
+ * @brief 解析校验策略名称。
+ */
+bool parse_checksum_policy(const std::string& name, ChecksumPolicy& policy) {
+  if (name == "strict") {
+    policy = ChecksumPolicy::Strict;
+  } else if (name == "warn") {
+    policy = ChecksumPolicy::Warn;
+  } else if (name == "off") {
+    policy = ChecksumPolicy::Off;
+  } else {
+    return false;
+  }
+  return true;
+}
@@ -0,0 +1,193 @@
+// ==============================================================================
+// @file   block_device.h
+// @brief  块设备抽象接口、设备统计与设备创建选项
+// ==============================================================================
+
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "../utils/common.h"
+
+// ==============================================================================
+// 设备统计与延迟模型
+// ==============================================================================
+
+/**
+ * @struct DeviceLatencyModel
+ * @brief 简化的机械磁盘延迟模型，用于量化不同布局策略的访问代价。
+ *
+ * 顺序访问（块号紧接上一次访问）只计传输时间；非顺序访问额外计入
+ * 固定寻道开销与按距离线性增长的寻道时间。模型只做统计，不会真正休眠。
+ */
+struct DeviceLatencyModel {
+  double seek_base_ms{4.0};         ///< 每次非顺序访问的固定寻道开销（毫秒）
+  double full_stroke_ms{8.0};       ///< 跨越整个设备的额外寻道时间（毫秒）
+  double transfer_ms_per_block{0.04};  ///< 每块传输时间（毫秒）
+};
+
+/**
+ * @struct DeviceStats
+ * @brief 单个物理后端文件的I/O统计。
+ */
+struct DeviceStats {
+  std::string name;                ///< 后端名称（通常为文件路径）
+  std::uint64_t reads{0};          ///< 读块次数
+  std::uint64_t writes{0};         ///< 写块次数
+  std::uint64_t sequential{0};     ///< 顺序访问次数
+  std::uint64_t seeks{0};          ///< 非顺序访问（寻道）次数
+  std::uint64_t seek_distance{0};  ///< 累计寻道距离（块）
+  double simulated_ms{0.0};        ///< 按延迟模型估算的设备时间（毫秒）
+  std::string access_hint{"normal"};  ///< 当前向宿主机声明的访问模式
+  std::uint64_t hints{0};          ///< 已发出的 fadvise/madvise 提示次数
+};
+
+// ==============================================================================
+// 设备创建选项
+// ==============================================================================
+
+/**
+ * @enum DeviceMode
+ * @brief 磁盘镜像的块放置模式。
+ */
+enum class DeviceMode {
+  Plain,          ///< 逻辑块与物理块一一对应（原地更新）
+  LogStructured,  ///< 所有写入追加到当前段，由块映射表定位
+};
+
+/**
+ * @enum ChecksumPolicy
+ * @brief 启用块校验和时，读取遇到校验和不匹配的处理方式。
+ */
+enum class ChecksumPolicy {
+  Off = 0,     ///< 不在读取时校验（写入仍更新校验和，供巡检使用）
+  Warn = 1,    ///< 记录错误但照常返回数据
+  Strict = 2,  ///< 读取失败，返回 I/O 错误
+};
+
+/**
+ * @struct DeviceOptions
+ * @brief 创建磁盘镜像时的设备选项。
+ */
+struct DeviceOptions {
+  DeviceMode mode{DeviceMode::Plain};  ///< 块放置模式
+  int segment_blocks{128};             ///< 日志结构模式下每段的块数
+  int shards{1};                       ///< 分片数（大于1时创建分片集合）
+  int stripe_members{1};               ///< 条带成员文件数（大于1时启用RAID-0条带）
+  int stripe_blocks{16};               ///< 条带单元大小（块）
+  int mirror_members{1};               ///< 镜像成员文件数（大于1时启用RAID-1镜像）
+  bool checksums{false};               ///< 是否为每个块保存 CRC32C 校验和
+  ChecksumPolicy verify{ChecksumPolicy::Strict};  ///< 读取时的校验策略
+  int tier_fast_mb{0};                 ///< 快速层大小（MB，大于0时启用冷热分层）
+  std::string tier_fast_path;          ///< 快速层文件路径（为空时使用 <disk_file>.fast）
+};
+
+/**
+ * @brief 解析校验策略名称（"strict" / "warn" / "off"）。
+ * @return bool 名称有效返回true。
+ */
+bool parse_checksum_policy(const std::string& name, ChecksumPolicy& policy);
+
+/**
+ * @brief 解析 create 命令中磁盘大小之后的设备选项。
+ * @param args 选项列表，例如 {"--log-structured", "--segment-blocks", "64"}、
+ *             {"--shards", "4"} 或 {"--stripe", "4", "--stripe-unit", "32"} 或 {"--mirror", "2"}
+ *             或 {"--checksums", "--verify", "warn"}。
+ * @param[out] options 输出的设备选项。
+ * @param[out] error_message 错误信息。
+ * @return bool 成功返回true。
+ */
+bool parse_device_options(const std::vector<std::string>& args,
+                          DeviceOptions& options, std::string& error_message);
+
+// ==============================================================================
+// 块设备接口
+// ==============================================================================
+
+/**
+ * @class BlockDevice
+ * @brief 以 BLOCK_SIZE 为单位读写的块设备抽象。
+ *
+ * DiskSimulator 通过该接口访问底层存储。具体实现可以是单个镜像文件，
+ * 也可以在物理设备之上做地址重映射（例如日志结构模式）。
+ * 所有实现都必须支持多线程并发调用。
+ */
+class BlockDevice {
+ public:
+  virtual ~BlockDevice() = default;
+
+  /**
+   * @brief 读取一个逻辑块。
+   */
+  virtual bool read_block(int block_num, char* buffer) = 0;
+
+  /**
+   * @brief 写入一个逻辑块。
+   */
+  virtual bool write_block(int block_num, const char* buffer) = 0;
+
+  /**
+   * @brief 读取连续的多个逻辑块（默认逐块读取）。
+   * @param start_block 起始块号。
+   * @param count 块数。
+   * @param buffer 输出缓冲区，大小至少为 count * BLOCK_SIZE。
+   */
+  virtual bool read_blocks(int start_block, int count, char* buffer) {
+    for (int i = 0; i < count; ++i) {
+      if (!read_block(start_block + i, buffer + static_cast<size_t>(i) * BLOCK_SIZE)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  /**
+   * @brief 写入连续的多个逻辑块（默认逐块写入）。
+   * @param start_block 起始块号。
+   * @param count 块数。
+   * @param buffer 输入缓冲区，大小至少为 count * BLOCK_SIZE。
+   */
+  virtual bool write_blocks(int start_block, int count, const char* buffer) {
+    for (int i = 0; i < count; ++i) {
+      if (!write_block(start_block + i, buffer + static_cast<size_t>(i) * BLOCK_SIZE)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  /**
+   * @brief 通知设备某个逻辑块的内容已不再需要（默认忽略）。
+   */
+  virtual bool discard_block(int block_num) {
+    (void)block_num;
+    return true;
+  }
+
+  /**
+   * @brief 将设备的内部状态持久化（默认无操作）。
+   */
+  virtual bool flush() { return true; }
+
+  /**
+   * @brief 丢弃宿主机页缓存中属于本设备的页面（默认无操作）。
+   * @details 用于冷缓存基准测试；调用前应先 flush，脏页写回后才能被丢弃。
+   */
+  virtual bool drop_host_cache() { return true; }
+
+  /**
+   * @brief 逻辑块总数。
+   */
+  virtual int get_total_blocks() const = 0;
+
+  /**
+   * @brief 设备模式的简短描述。
+   */
+  virtual std::string describe() const = 0;
+
+  /**
+   * @brief 收集各物理后端的I/O统计。
+   */
+  virtual void collect_stats(std::vector<DeviceStats>& stats) const = 0;
+};
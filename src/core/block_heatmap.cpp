@@ -0,0 +1,319 @@
+// ==============================================================================
+// @file   block_heatmap.cpp
+// @brief  逻辑块访问热度统计的实现
+// ==============================================================================
+
+#include "block_heatmap.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+#include <utility>
+#include <vector>
+
+namespace {
+
+const char kHeatLevels[] = " .:-=+*#%@";  ///< 热度条字符，由冷到热
+constexpr int kHeatLevelCount = sizeof(kHeatLevels) - 1;
+
+/**
+ * @brief 磁盘布局中的一个区域。
+ */
+struct Region {
+  const char* name;
+  int start;
+  int count;
+};
+
+double percent(std::uint64_t part, std::uint64_t total) {
+  return total ? 100.0 * static_cast<double>(part) / static_cast<double>(total)
+               : 0.0;
+}
+
+}  // namespace
+
+// ==============================================================================
+// 构造与状态控制
+// ==============================================================================
+
+BlockHeatMap::BlockHeatMap()
+    : total_blocks_(0),
+      enabled_(false),
+      next_block_(-1),
+      sequential_reads_(0),
+      random_reads_(0),
+      sequential_writes_(0),
+      random_writes_(0),
+      decays_(0) {}
+
+/**
+ * @brief 绑定到新打开的磁盘（此时尚无并发I/O）。
+ */
+void BlockHeatMap::attach(int total_blocks, bool enabled) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  enabled_.store(false);
+  if (total_blocks != total_blocks_) {
+    reads_.reset();
+    writes_.reset();
+    total_blocks_ = total_blocks;
+  }
+  if (reads_) {
+    for (int i = 0; i < total_blocks_; ++i) {
+      reads_[i].store(0, std::memory_order_relaxed);
+      writes_[i].store(0, std::memory_order_relaxed);
+    }
+  }
+  next_block_.store(-1);
+  sequential_reads_.store(0);
+  random_reads_.store(0);
+  sequential_writes_.store(0);
+  random_writes_.store(0);
+  decays_.store(0);
+  if (enabled) {
+    set_enabled_locked();
+  }
+}
+
+/**
+ * @brief 开始或停止记录；第一次开始时分配计数数组。
+ */
+void BlockHeatMap::set_enabled(bool enabled) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (enabled) {
+    set_enabled_locked();
+  } else {
+    enabled_.store(false, std::memory_order_release);
+  }
+}
+
+bool BlockHeatMap::is_enabled() const {
+  return enabled_.load(std::memory_order_acquire);
+}
+
+/**
+ * @brief 清空所有计数（记录状态不变）。
+ */
+void BlockHeatMap::reset() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (reads_) {
+    for (int i = 0; i < total_blocks_; ++i) {
+      reads_[i].store(0, std::memory_order_relaxed);
+      writes_[i].store(0, std::memory_order_relaxed);
+    }
+  }
+  sequential_reads_.store(0);
+  random_reads_.store(0);
+  sequential_writes_.store(0);
+  random_writes_.store(0);
+  decays_.store(0);
+}
+
+// ==============================================================================
+// 记录
+// ==============================================================================
+
+/**
+ * @brief 记录一次访问：逐块递增计数，并按起始块判断是否顺序。
+ */
+void BlockHeatMap::record(int start_block, int count, bool write) {
+  if (!enabled_.load(std::memory_order_acquire)) {
+    return;
+  }
+
+  bool sequential = next_block_.exchange(start_block + count,
+                                         std::memory_order_relaxed) == start_block;
+  if (write) {
+    (sequential ? sequential_writes_ : random_writes_)
+        .fetch_add(1, std::memory_order_relaxed);
+  } else {
+    (sequential ? sequential_reads_ : random_reads_)
+        .fetch_add(1, std::memory_order_relaxed);
+  }
+
+  Counter* counters = write ? writes_.get() : reads_.get();
+  bool saturated = false;
+  int end = std::min(start_block + count, total_blocks_);
+  for (int block = std::max(start_block, 0); block < end; ++block) {
+    if (counters[block].fetch_add(1, std::memory_order_relaxed) + 1 >=
+        kDecayThreshold) {
+      saturated = true;
+    }
+  }
+  if (saturated) {
+    decay();
+  }
+}
+
+// ==============================================================================
+// 报告
+// ==============================================================================
+
+/**
+ * @brief 生成热度报告。
+ */
+std::string BlockHeatMap::report(const DiskLayout& layout) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::ostringstream oss;
+  if (!reads_) {
+    oss << "Block Heat Map: off (enable with 'heatmap on' or DISKSIM_HEATMAP=1)"
+        << std::endl;
+    return oss.str();
+  }
+
+  std::vector<std::uint32_t> reads(total_blocks_);
+  std::vector<std::uint32_t> writes(total_blocks_);
+  std::uint64_t total_accesses = 0;
+  for (int i = 0; i < total_blocks_; ++i) {
+    reads[i] = reads_[i].load(std::memory_order_relaxed);
+    writes[i] = writes_[i].load(std::memory_order_relaxed);
+    total_accesses += reads[i] + writes[i];
+  }
+
+  std::uint64_t seq_reads = sequential_reads_.load();
+  std::uint64_t rand_reads = random_reads_.load();
+  std::uint64_t seq_writes = sequential_writes_.load();
+  std::uint64_t rand_writes = random_writes_.load();
+  std::uint64_t operations = seq_reads + rand_reads + seq_writes + rand_writes;
+
+  oss << std::fixed << std::setprecision(1);
+  oss << "Block Heat Map:" << std::endl;
+  oss << "  Tracking: " << (is_enabled() ? "on" : "off") << " ("
+      << total_blocks_ << " blocks, decayed " << decays_.load() << " times)"
+      << std::endl;
+  oss << "  Operations: " << seq_reads + rand_reads << " reads ("
+      << percent(seq_reads, seq_reads + rand_reads) << "% sequential), "
+      << seq_writes + rand_writes << " writes ("
+      << percent(seq_writes, seq_writes + rand_writes) << "% sequential)"
+      << std::endl;
+  oss << "  Access pattern: " << percent(seq_reads + seq_writes, operations)
+      << "% sequential, " << percent(rand_reads + rand_writes, operations)
+      << "% random" << std::endl;
+
+  // 各区域的访问强度
+  const Region regions[] = {
+      {"Superblock", layout.superblock_start, layout.superblock_blocks},
+      {"Inode table", layout.inode_table_start, layout.inode_table_blocks},
+      {"Inode bitmap", layout.inode_bitmap_start, layout.inode_bitmap_blocks},
+      {"Data bitmap", layout.data_bitmap_start, layout.data_bitmap_blocks},
+      {"Data", layout.data_blocks_start, layout.data_blocks_count},
+  };
+  oss << "  Regions:" << std::endl;
+  oss << "    " << std::left << std::setw(14) << "Region" << std::right
+      << std::setw(8) << "Blocks" << std::setw(10) << "Reads" << std::setw(10)
+      << "Writes" << std::setw(8) << "Share" << std::setw(12) << "Per block"
+      << std::endl;
+  for (const Region& region : regions) {
+    std::uint64_t region_reads = 0;
+    std::uint64_t region_writes = 0;
+    int end = std::min(region.start + region.count, total_blocks_);
+    for (int block = region.start; block < end; ++block) {
+      region_reads += reads[block];
+      region_writes += writes[block];
+    }
+    std::uint64_t accesses = region_reads + region_writes;
+    oss << "    " << std::left << std::setw(14) << region.name << std::right
+        << std::setw(8) << region.count << std::setw(10) << region_reads
+        << std::setw(10) << region_writes << std::setw(7)
+        << percent(accesses, total_accesses) << "%" << std::setw(12)
+        << std::setprecision(2)
+        << (region.count ? static_cast<double>(accesses) / region.count : 0.0)
+        << std::setprecision(1) << std::endl;
+  }
+
+  // 数据区热度条：按块号等分为 kHeatBands 格，按最热一格归一化
+  int data_end = std::min(layout.data_blocks_start + layout.data_blocks_count,
+                          total_blocks_);
+  int data_blocks = data_end - layout.data_blocks_start;
+  if (data_blocks > 0) {
+    int bands = std::min(kHeatBands, data_blocks);
+    std::vector<std::uint64_t> band_heat(bands, 0);
+    for (int block = layout.data_blocks_start; block < data_end; ++block) {
+      int band = static_cast<int>(
+          static_cast<long long>(block - layout.data_blocks_start) * bands /
+          data_blocks);
+      band_heat[band] += reads[block] + writes[block];
+    }
+    std::uint64_t hottest = *std::max_element(band_heat.begin(), band_heat.end());
+    std::string strip;
+    for (std::uint64_t heat : band_heat) {
+      int level = 0;
+      if (heat > 0) {
+        level = 1 + static_cast<int>(heat * (kHeatLevelCount - 2) / hottest);
+      }
+      strip += kHeatLevels[level];
+    }
+    oss << "  Data heat: [" << strip << "]" << std::endl;
+  }
+
+  // 最热的元数据块
+  std::vector<std::pair<std::uint64_t, int>> metadata;
+  int metadata_end = std::min(layout.data_blocks_start, total_blocks_);
+  for (int block = 0; block < metadata_end; ++block) {
+    std::uint64_t accesses = reads[block] + writes[block];
+    if (accesses > 0) {
+      metadata.emplace_back(accesses, block);
+    }
+  }
+  std::size_t shown = std::min(metadata.size(), kHottestBlocks);
+  std::partial_sort(metadata.begin(), metadata.begin() + shown, metadata.end(),
+                    [](const std::pair<std::uint64_t, int>& a,
+                       const std::pair<std::uint64_t, int>& b) {
+                      return a.first > b.first ||
+                             (a.first == b.first && a.second < b.second);
+                    });
+  oss << "  Hottest metadata blocks:" << std::endl;
+  if (shown == 0) {
+    oss << "    (none)" << std::endl;
+  }
+  for (std::size_t i = 0; i < shown; ++i) {
+    int block = metadata[i].second;
+    const Region* owner = &regions[0];
+    for (const Region& region : regions) {
+      if (block >= region.start && block < region.start + region.count) {
+        owner = &region;
+      }
+    }
+    oss << "    " << owner->name << " block " << block - owner->start
+        << " (block " << block << "): "
+        << percent(metadata[i].first, total_accesses) << "% of I/O ("
+        << reads[block] << " reads, " << writes[block] << " writes)"
+        << std::endl;
+  }
+  return oss.str();
+}
+
+// ==============================================================================
+// 私有辅助方法
+// ==============================================================================
+
+/**
+ * @brief 分配计数数组（如尚未分配）并开始记录；调用者持有 mutex_。
+ */
+void BlockHeatMap::set_enabled_locked() {
+  if (!reads_ && total_blocks_ > 0) {
+    reads_.reset(new Counter[total_blocks_]);
+    writes_.reset(new Counter[total_blocks_]);
+    for (int i = 0; i < total_blocks_; ++i) {
+      reads_[i].store(0, std::memory_order_relaxed);
+      writes_[i].store(0, std::memory_order_relaxed);
+    }
+  }
+  enabled_.store(reads_ != nullptr, std::memory_order_release);
+}
+
+/**
+ * @brief 把所有计数减半；已有线程在衰减时直接返回。
+ */
+void BlockHeatMap::decay() {
+  std::unique_lock<std::mutex> lock(mutex_, std::try_to_lock);
+  if (!lock.owns_lock()) {
+    return;
+  }
+  for (int i = 0; i < total_blocks_; ++i) {
+    reads_[i].store(reads_[i].load(std::memory_order_relaxed) / 2,
+                    std::memory_order_relaxed);
+    writes_[i].store(writes_[i].load(std::memory_order_relaxed) / 2,
+                     std::memory_order_relaxed);
+  }
+  decays_.fetch_add(1, std::memory_order_relaxed);
+}
@@ -0,0 +1,85 @@
+// ==============================================================================
+// @file   block_heatmap.h
+// @brief  逻辑块访问热度统计（heatmap）
+// ==============================================================================
+
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "../utils/common.h"
+
+/**
+ * @class BlockHeatMap
+ * @brief 按逻辑块记录读写次数，并汇总顺序/随机访问比例。
+ *
+ * 每个块各有一个16位的读计数和写计数（每块4字节），数组在第一次启用时
+ * 才分配，关闭时记录路径上只剩一次原子加载。任一计数接近上限时把所有
+ * 计数减半（指数衰减），热度因此偏向近期访问，而各块之间的相对比例不变。
+ * 计数使用 relaxed 原子操作，衰减与并发递增之间可能丢失个别计数，结果
+ * 是近似值。顺序访问按“本次起始块等于上次结束块”判断，与 FileBlockDevice
+ * 的判定一致，多线程交错时同样只是近似。
+ */
+class BlockHeatMap {
+ public:
+  BlockHeatMap();
+
+  /**
+   * @brief 绑定到一个新打开的磁盘，清空此前的统计。
+   * @param total_blocks 逻辑总块数。
+   * @param enabled 是否立即开始记录。
+   */
+  void attach(int total_blocks, bool enabled);
+
+  /**
+   * @brief 开始或停止记录（停止后保留已有统计）。
+   */
+  void set_enabled(bool enabled);
+
+  /** @brief 是否正在记录。 */
+  bool is_enabled() const;
+
+  /** @brief 清空所有计数。 */
+  void reset();
+
+  /**
+   * @brief 记录一次对连续块的访问。
+   * @param start_block 起始块号。
+   * @param count 块数。
+   * @param write 是否为写入。
+   */
+  void record(int start_block, int count, bool write);
+
+  /**
+   * @brief 生成热度报告：各区域的访问强度、数据区热度条、最热的元数据块。
+   * @param layout 磁盘布局，用于划分区域。
+   * @return std::string 格式化的报告文本。
+   */
+  std::string report(const DiskLayout& layout) const;
+
+ private:
+  using Counter = std::atomic<std::uint16_t>;
+
+  static constexpr std::uint16_t kDecayThreshold = 0xF000;  ///< 触发衰减的计数
+  static constexpr int kHeatBands = 64;        ///< 数据区热度条的格数
+  static constexpr std::size_t kHottestBlocks = 5;  ///< 报告的最热元数据块数
+
+  void set_enabled_locked();
+  void decay();
+
+  int total_blocks_;
+  std::atomic<bool> enabled_;
+  std::unique_ptr<Counter[]> reads_;   ///< 每块读计数
+  std::unique_ptr<Counter[]> writes_;  ///< 每块写计数
+  std::atomic<int> next_block_;        ///< 上一次访问结束后的块号
+  std::atomic<std::uint64_t> sequential_reads_;
+  std::atomic<std::uint64_t> random_reads_;
+  std::atomic<std::uint64_t> sequential_writes_;
+  std::atomic<std::uint64_t> random_writes_;
+  std::atomic<std::uint64_t> decays_;  ///< 衰减次数
+  mutable std::mutex mutex_;           ///< 保护数组分配、清空与衰减
+};
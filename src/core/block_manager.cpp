@@ -33,7 +33,7 @@ BlockManager::BlockManager(DiskSimulator& disk, InodeManager& inode_manager)
  * @param size 要读取的大小。
  * @return bool 读取成功返回true，否则返回false。
  */
-bool BlockManager::read_data_from_blocks(const std::vector<int>& blocks,
+bool BlockManager::read_data_from_blocks(const BlockList& blocks,
                                          int offset, char* buffer, int size) {
   return FileOperationsUtils::read_data_from_blocks(disk, blocks, offset, buffer, size);
 }
@@ -46,7 +46,7 @@ bool BlockManager::read_data_from_blocks(const std::vector<int>& blocks,
  * @param size 要写入的大小。
  * @return bool 写入成功返回true，否则返回false。
  */
-bool BlockManager::write_data_to_blocks(const std::vector<int>& blocks,
+bool BlockManager::write_data_to_blocks(const BlockList& blocks,
                                         int offset, const char* buffer,
                                         int size) {
   return FileOperationsUtils::write_data_to_blocks(disk, blocks, offset, buffer, size);
@@ -66,7 +66,7 @@ bool BlockManager::allocate_file_data_blocks(
     return true;
   }
 
-  std::vector<int> allocated_blocks;
+  BlockList allocated_blocks;
   if (!inode_manager.allocate_data_blocks(-1, blocks_needed,
                                           allocated_blocks)) {
     ErrorHandler::log_error(ERROR_NO_FREE_BLOCKS,
@@ -35,7 +35,7 @@ class BlockManager {
    * @param size 要读取的大小。
    * @return bool 读取成功返回true，否则返回false。
    */
-  bool read_data_from_blocks(const std::vector<int>& blocks, int offset,
+  bool read_data_from_blocks(const BlockList& blocks, int offset,
                              char* buffer, int size);
 
   /**
@@ -46,7 +46,7 @@ class BlockManager {
    * @param size 要写入的大小。
    * @return bool 写入成功返回true，否则返回false。
    */
-  bool write_data_to_blocks(const std::vector<int>& blocks, int offset,
+  bool write_data_to_blocks(const BlockList& blocks, int offset,
                             const char* buffer, int size);
 
   /**
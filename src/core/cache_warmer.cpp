@@ -0,0 +1,445 @@
+// ==============================================================================
+// @file   cache_warmer.cpp
+// @brief  缓存热点集合的持久化与后台预热实现
+// ==============================================================================
+
+#include "cache_warmer.h"
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+
+#include "filesystem.h"
+
+namespace {
+
+const char kWarmMagic[4] = {'D', 'S', 'W', 'S'};  ///< 热点集合文件魔数
+const std::uint32_t kWarmVersion = 1;             ///< 热点集合文件版本
+constexpr std::size_t kMaxEntries = 16384;        ///< 每类条目的记录上限
+constexpr std::size_t kMaxBlocks = 8192;          ///< 记录的数据块上限（32MB）
+constexpr int kMaxRunBlocks = 32;                 ///< 预取时合并的连续区间上限
+constexpr std::size_t kBatchSize = 64;            ///< 每次持锁预热的条目数
+
+/**
+ * @brief 环境变量 DISKSIM_WARM_SET=0 时关闭热点集合。
+ */
+bool warm_set_enabled() {
+  const char* value = std::getenv("DISKSIM_WARM_SET");
+  return value == nullptr || std::strcmp(value, "0") != 0;
+}
+
+/**
+ * @brief 定期写回间隔，取自 DISKSIM_WARM_SAVE_S（默认300秒，0表示关闭）。
+ */
+std::chrono::seconds save_interval() {
+  const char* value = std::getenv("DISKSIM_WARM_SAVE_S");
+  if (value == nullptr) {
+    return std::chrono::seconds(300);
+  }
+  long seconds = std::atol(value);
+  return std::chrono::seconds(seconds > 0 ? seconds : 0);
+}
+
+bool write_ints(FILE* file, const std::vector<int>& values) {
+  std::uint32_t count = static_cast<std::uint32_t>(values.size());
+  return fwrite(&count, sizeof(count), 1, file) == 1 &&
+         fwrite(values.data(), sizeof(int), values.size(), file) == values.size();
+}
+
+bool read_ints(FILE* file, std::vector<int>& values, std::size_t limit) {
+  std::uint32_t count = 0;
+  if (fread(&count, sizeof(count), 1, file) != 1 || count > limit) {
+    return false;
+  }
+  values.resize(count);
+  return fread(values.data(), sizeof(int), count, file) == count;
+}
+
+/**
+ * @brief 丢弃不在 [0, limit) 内的编号。
+ */
+template <typename List>
+void drop_out_of_range(List& values, int limit) {
+  values.erase(std::remove_if(values.begin(), values.end(),
+                              [limit](int v) { return v < 0 || v >= limit; }),
+               values.end());
+}
+
+}  // namespace
+
+std::size_t WarmSet::size() const {
+  return inodes.size() + directories.size() + dentries.size() + blocks.size();
+}
+
+// ==============================================================================
+// 构造与析构
+// ==============================================================================
+
+CacheWarmer::CacheWarmer(FileSystem& fs)
+    : fs_(fs), read_only_(false), running_(false), stop_(false), loaded_(0),
+      prefetched_(0), prefetch_done_(false), saves_(0), saved_(0) {}
+
+CacheWarmer::~CacheWarmer() {
+  // 文件系统卸载时已经停止；这里只兜底回收线程，不再写回
+  stop_.store(true);
+  wakeup_.notify_all();
+  if (worker_.joinable()) {
+    worker_.join();
+  }
+}
+
+// ==============================================================================
+// 生命周期
+// ==============================================================================
+
+/**
+ * @brief 读取热点集合（文件不存在或不匹配时视为空集合）并启动后台线程。
+ */
+void CacheWarmer::start(const std::string& image_path, bool read_only) {
+  if (running_ || !warm_set_enabled()) {
+    return;
+  }
+  warm_path_ = warm_path_for(image_path);
+  read_only_ = read_only;
+  stop_.store(false);
+  loaded_.store(0);
+  prefetched_.store(0);
+  prefetch_done_.store(false);
+  saves_.store(0);
+  saved_.store(0);
+
+  WarmSet set;
+  if (access(warm_path_.c_str(), F_OK) == 0 && !read_file(set)) {
+    set = WarmSet();  // 损坏或属于旧镜像的集合直接忽略，卸载时会被覆盖
+  }
+  loaded_.store(set.size());
+
+  running_ = true;
+  worker_ = std::thread(&CacheWarmer::worker_loop, this, std::move(set));
+}
+
+/**
+ * @brief 停止后台线程，可写挂载时写回最终集合。
+ */
+void CacheWarmer::stop() {
+  if (!running_) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_.store(true);
+  }
+  wakeup_.notify_all();
+  if (worker_.joinable()) {
+    worker_.join();
+  }
+  save();
+  running_ = false;
+}
+
+/**
+ * @brief 记录当前缓存中的热点并原子替换热点集合文件。
+ */
+bool CacheWarmer::save() {
+  if (!running_ || read_only_) {
+    return false;
+  }
+  WarmSet set;
+  if (!capture(set)) {
+    return false;
+  }
+  if (!write_file(set)) {
+    ErrorHandler::log_error(ERROR_IO_ERROR,
+                            "Failed to write warm set: " + warm_path_);
+    return false;
+  }
+  saves_.fetch_add(1);
+  saved_.store(set.size());
+  return true;
+}
+
+std::string CacheWarmer::status() const {
+  std::ostringstream oss;
+  oss << "Warm set: ";
+  if (!running_) {
+    oss << (warm_set_enabled() ? "inactive" : "disabled (DISKSIM_WARM_SET=0)");
+    return oss.str();
+  }
+  oss << warm_path_ << " | loaded " << loaded_.load() << " entries | prefetched "
+      << prefetched_.load() << (prefetch_done_.load() ? " (done)" : " (in progress)")
+      << " | saves " << saves_.load();
+  if (saves_.load() > 0) {
+    oss << " (last " << saved_.load() << " entries)";
+  }
+  return oss.str();
+}
+
+std::string CacheWarmer::warm_path_for(const std::string& image_path) {
+  return image_path + ".warm";
+}
+
+void CacheWarmer::remove_warm_file(const std::string& image_path) {
+  unlink(warm_path_for(image_path).c_str());
+}
+
+// ==============================================================================
+// 记录与持久化
+// ==============================================================================
+
+/**
+ * @brief 在共享锁下枚举三类缓存，并展开热点目录与文件引用的数据块。
+ * @details 目录的数据块优先，其次是普通文件，总数不超过 kMaxBlocks。
+ */
+bool CacheWarmer::capture(WarmSet& set) {
+  auto guard = fs_.acquire_shared_lock();
+  if (!fs_.mounted) {
+    return false;
+  }
+
+  fs_.inode_manager.cached_inodes(set.inodes);
+  set.directories = fs_.directory_manager.cached_directories();
+  fs_.path_manager.cached_dentries(set.dentries);
+
+  std::sort(set.inodes.begin(), set.inodes.end());
+  std::sort(set.directories.begin(), set.directories.end());
+  std::sort(set.dentries.begin(), set.dentries.end(),
+            [](const DentryKey& a, const DentryKey& b) {
+              return a.parent != b.parent ? a.parent < b.parent : a.name < b.name;
+            });
+  set.inodes.resize(std::min(set.inodes.size(), kMaxEntries));
+  set.directories.resize(std::min(set.directories.size(), kMaxEntries));
+  set.dentries.resize(std::min(set.dentries.size(), kMaxEntries));
+
+  auto append_blocks = [&](int inode_num) {
+    BlockList blocks;
+    if (!fs_.inode_manager.get_data_blocks(inode_num, blocks)) {
+      return;
+    }
+    for (int block : blocks) {
+      if (set.blocks.size() >= kMaxBlocks) {
+        return;
+      }
+      set.blocks.push_back(block);
+    }
+  };
+  for (int inode_num : set.directories) {
+    append_blocks(inode_num);
+  }
+  for (int inode_num : set.inodes) {
+    if (set.blocks.size() >= kMaxBlocks) {
+      break;
+    }
+    Inode inode;
+    if (fs_.inode_manager.read_inode(inode_num, inode) &&
+        !(inode.mode & FILE_TYPE_DIRECTORY)) {
+      append_blocks(inode_num);
+    }
+  }
+  std::sort(set.blocks.begin(), set.blocks.end());
+  set.blocks.erase(std::unique(set.blocks.begin(), set.blocks.end()),
+                   set.blocks.end());
+  return true;
+}
+
+/**
+ * @brief 写临时文件后原子替换：头部记录镜像的块数与 inode 数，用于识别过期集合。
+ */
+bool CacheWarmer::write_file(const WarmSet& set) const {
+  std::string temp_path = warm_path_ + ".tmp";
+  FILE* file = fopen(temp_path.c_str(), "wb");
+  if (!file) {
+    return false;
+  }
+
+  std::int32_t total_blocks = fs_.disk.get_total_blocks();
+  std::int32_t total_inodes = fs_.inode_manager.get_total_inodes();
+  std::vector<int> blocks(set.blocks.begin(), set.blocks.end());
+  bool ok = fwrite(kWarmMagic, 1, sizeof(kWarmMagic), file) == sizeof(kWarmMagic) &&
+            fwrite(&kWarmVersion, sizeof(kWarmVersion), 1, file) == 1 &&
+            fwrite(&total_blocks, sizeof(total_blocks), 1, file) == 1 &&
+            fwrite(&total_inodes, sizeof(total_inodes), 1, file) == 1 &&
+            write_ints(file, set.inodes) && write_ints(file, set.directories) &&
+            write_ints(file, blocks);
+
+  std::uint32_t dentry_count = static_cast<std::uint32_t>(set.dentries.size());
+  ok = ok && fwrite(&dentry_count, sizeof(dentry_count), 1, file) == 1;
+  for (const DentryKey& key : set.dentries) {
+    if (!ok) {
+      break;
+    }
+    std::int32_t parent32 = key.parent;
+    std::uint16_t length = static_cast<std::uint16_t>(
+        std::min<std::size_t>(key.name.size(), MAX_FILENAME_LENGTH));
+    ok = fwrite(&parent32, sizeof(parent32), 1, file) == 1 &&
+         fwrite(&length, sizeof(length), 1, file) == 1 &&
+         fwrite(key.name.data(), 1, length, file) == length;
+  }
+
+  ok = fclose(file) == 0 && ok;
+  if (!ok || rename(temp_path.c_str(), warm_path_.c_str()) != 0) {
+    unlink(temp_path.c_str());
+    return false;
+  }
+  return true;
+}
+
+/**
+ * @brief 读取热点集合；镜像尺寸不符或文件不完整时返回false。
+ */
+bool CacheWarmer::read_file(WarmSet& set) const {
+  FILE* file = fopen(warm_path_.c_str(), "rb");
+  if (!file) {
+    return false;
+  }
+
+  char magic[4];
+  std::uint32_t version = 0;
+  std::int32_t total_blocks = 0;
+  std::int32_t total_inodes = 0;
+  std::vector<int> blocks;
+  bool ok = fread(magic, 1, sizeof(magic), file) == sizeof(magic) &&
+            memcmp(magic, kWarmMagic, sizeof(magic)) == 0 &&
+            fread(&version, sizeof(version), 1, file) == 1 &&
+            version == kWarmVersion &&
+            fread(&total_blocks, sizeof(total_blocks), 1, file) == 1 &&
+            fread(&total_inodes, sizeof(total_inodes), 1, file) == 1 &&
+            total_blocks == fs_.disk.get_total_blocks() &&
+            total_inodes == fs_.inode_manager.get_total_inodes() &&
+            read_ints(file, set.inodes, kMaxEntries) &&
+            read_ints(file, set.directories, kMaxEntries) &&
+            read_ints(file, blocks, kMaxBlocks);
+
+  std::uint32_t dentry_count = 0;
+  ok = ok && fread(&dentry_count, sizeof(dentry_count), 1, file) == 1 &&
+       dentry_count <= kMaxEntries;
+  char name_buffer[MAX_FILENAME_LENGTH];
+  for (std::uint32_t i = 0; ok && i < dentry_count; ++i) {
+    std::int32_t parent32;
+    std::uint16_t length;
+    ok = fread(&parent32, sizeof(parent32), 1, file) == 1 &&
+         fread(&length, sizeof(length), 1, file) == 1 &&
+         length <= MAX_FILENAME_LENGTH &&
+         fread(name_buffer, 1, length, file) == length;
+    if (ok) {
+      set.dentries.push_back(DentryKey{parent32, std::string(name_buffer, length)});
+    }
+  }
+  fclose(file);
+  if (!ok) {
+    return false;
+  }
+
+  set.blocks.assign(blocks.begin(), blocks.end());
+  drop_out_of_range(set.blocks, total_blocks);
+  drop_out_of_range(set.inodes, total_inodes);
+  drop_out_of_range(set.directories, total_inodes);
+  set.dentries.erase(
+      std::remove_if(set.dentries.begin(), set.dentries.end(),
+                     [&](const DentryKey& key) {
+                       return key.parent < 0 || key.parent >= total_inodes ||
+                              key.name.empty();
+                     }),
+      set.dentries.end());
+  return true;
+}
+
+// ==============================================================================
+// 后台线程
+// ==============================================================================
+
+/**
+ * @brief 先完成一次预热，之后按间隔定期写回，直到被停止。
+ */
+void CacheWarmer::worker_loop(WarmSet set) {
+  prefetch(set);
+  prefetch_done_.store(!stop_requested());
+  set = WarmSet();
+
+  std::chrono::seconds interval = save_interval();
+  if (read_only_ || interval.count() == 0) {
+    return;
+  }
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (!stop_.load()) {
+    if (wakeup_.wait_for(lock, interval, [this] { return stop_.load(); })) {
+      break;
+    }
+    lock.unlock();
+    save();
+    lock.lock();
+  }
+}
+
+/**
+ * @brief 按块号、inode 号、目录、目录项的顺序预热，每批只持有共享锁。
+ */
+void CacheWarmer::prefetch(const WarmSet& set) {
+  // 数据块：合并连续区间后整段读取，填充宿主机页缓存
+  std::vector<char> buffer(static_cast<std::size_t>(kMaxRunBlocks) * BLOCK_SIZE);
+  std::size_t index = 0;
+  while (index < set.blocks.size() && !stop_requested()) {
+    auto guard = fs_.acquire_shared_lock();
+    for (std::size_t batch = 0; batch < kBatchSize && index < set.blocks.size();
+         ++batch) {
+      int start = set.blocks[index];
+      int count = 1;
+      while (index + count < set.blocks.size() && count < kMaxRunBlocks &&
+             set.blocks[index + count] == start + count) {
+        ++count;
+      }
+      fs_.disk.read_blocks(start, count, buffer.data());
+      index += count;
+      prefetched_.fetch_add(count);
+    }
+  }
+
+  // inode：按编号升序回填，即按 inode 表的块顺序读取
+  for (std::size_t i = 0; i < set.inodes.size() && !stop_requested();) {
+    auto guard = fs_.acquire_shared_lock();
+    for (std::size_t batch = 0; batch < kBatchSize && i < set.inodes.size();
+         ++batch, ++i) {
+      Inode inode;
+      fs_.inode_manager.read_inode(set.inodes[i], inode);
+      prefetched_.fetch_add(1);
+    }
+  }
+
+  // 目录快照与目录项：只对当前仍是目录的 inode 预热，过期记录静默跳过
+  auto is_directory = [this](int inode_num) {
+    Inode inode;
+    return fs_.inode_manager.is_inode_allocated(inode_num) &&
+           fs_.inode_manager.read_inode(inode_num, inode) &&
+           (inode.mode & FILE_TYPE_DIRECTORY);
+  };
+  for (std::size_t i = 0; i < set.directories.size() && !stop_requested();) {
+    auto guard = fs_.acquire_shared_lock();
+    for (std::size_t batch = 0; batch < kBatchSize && i < set.directories.size();
+         ++batch, ++i) {
+      std::vector<DirectoryEntry> entries;
+      if (is_directory(set.directories[i])) {
+        fs_.directory_manager.read_directory(set.directories[i], entries);
+      }
+      prefetched_.fetch_add(1);
+    }
+  }
+  for (std::size_t i = 0; i < set.dentries.size() && !stop_requested();) {
+    auto guard = fs_.acquire_shared_lock();
+    for (std::size_t batch = 0; batch < kBatchSize && i < set.dentries.size();
+         ++batch, ++i) {
+      const DentryKey& key = set.dentries[i];
+      if (is_directory(key.parent)) {
+        fs_.path_manager.find_inode_in_directory(key.parent, key.name);
+      }
+      prefetched_.fetch_add(1);
+    }
+  }
+}
+
+bool CacheWarmer::stop_requested() const {
+  return stop_.load(std::memory_order_relaxed);
+}
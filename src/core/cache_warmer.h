@@ -0,0 +1,117 @@
+// ==============================================================================
+// @file   cache_warmer.h
+// @brief  缓存热点集合的持久化与挂载后的后台预热
+// ==============================================================================
+
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../utils/common.h"
+#include "path_manager.h"
+
+class FileSystem;
+
+/**
+ * @struct WarmSet
+ * @brief 某一时刻缓存中的热点：inode、目录快照、目录项与它们引用的块。
+ */
+struct WarmSet {
+  std::vector<int> inodes;          ///< inode 缓存中的 inode 号（升序）
+  std::vector<int> directories;     ///< 有已发布快照的目录 inode 号（升序）
+  std::vector<DentryKey> dentries;  ///< 目录项缓存中的 (父目录, 名称)
+  BlockList blocks;                 ///< 热点目录与文件的数据块号（升序、去重）
+
+  /**
+   * @brief 各部分条目数之和。
+   */
+  std::size_t size() const;
+};
+
+/**
+ * @class CacheWarmer
+ * @brief 在卸载时（以及运行中定期）把缓存热点写入镜像旁的 <image>.warm，
+ *        挂载后由后台线程按块号顺序预取，挂载本身不等待预热完成。
+ *
+ * 预热顺序为：先按块号升序合并成连续区间读取数据块，使宿主机页缓存按
+ * 顺序填充；再按 inode 号升序回填 inode 缓存（即 inode 表的块顺序），
+ * 然后加载目录快照，最后重放目录项查找。每一批只持有文件系统共享锁，
+ * 写者可以在批与批之间插入，前台请求从挂载完成起即可正常处理。
+ *
+ * 热点集合只是提示：记录可能已经过期（镜像被其他进程修改，或被重新
+ * 创建），预热时越界的编号被丢弃，其余内容都从磁盘重新读取，不会把过期
+ * 数据放进缓存。只读挂载只预热、不写回。
+ *
+ * 环境变量 DISKSIM_WARM_SET=0 关闭本功能；DISKSIM_WARM_SAVE_S 设置定期
+ * 写回间隔（秒，默认300，0表示只在卸载时写回）。
+ */
+class CacheWarmer {
+ public:
+  explicit CacheWarmer(FileSystem& fs);
+  ~CacheWarmer();
+
+  CacheWarmer(const CacheWarmer&) = delete;
+  CacheWarmer& operator=(const CacheWarmer&) = delete;
+
+  /**
+   * @brief 读取镜像旁的热点集合并启动后台预热线程。
+   * @param image_path 镜像路径。
+   * @param read_only 只读挂载时不写回热点集合。
+   */
+  void start(const std::string& image_path, bool read_only);
+
+  /**
+   * @brief 停止后台线程；可写挂载时写回最终的热点集合。
+   * @details 必须在文件系统仍处于挂载状态、且调用方未持有文件系统锁时调用。
+   */
+  void stop();
+
+  /**
+   * @brief 立即记录并写回当前的热点集合。
+   * @return bool 成功返回true（只读挂载或功能关闭时返回false）。
+   */
+  bool save();
+
+  /**
+   * @brief 预热状态的单行描述。
+   */
+  std::string status() const;
+
+  /**
+   * @brief 热点集合文件路径（<image>.warm）。
+   */
+  static std::string warm_path_for(const std::string& image_path);
+
+  /**
+   * @brief 删除镜像旁的热点集合文件（创建或格式化镜像后调用）。
+   */
+  static void remove_warm_file(const std::string& image_path);
+
+ private:
+  bool capture(WarmSet& set);
+  bool write_file(const WarmSet& set) const;
+  bool read_file(WarmSet& set) const;
+  void worker_loop(WarmSet set);
+  void prefetch(const WarmSet& set);
+  bool stop_requested() const;
+
+  FileSystem& fs_;          ///< 所属文件系统
+  std::string warm_path_;   ///< 热点集合文件路径
+  bool read_only_;          ///< 是否只读挂载
+  bool running_;            ///< 是否已启动
+
+  std::thread worker_;                 ///< 预热与定期写回线程
+  mutable std::mutex mutex_;           ///< 保护停止标志与等待
+  std::condition_variable wakeup_;     ///< 唤醒定期写回等待
+  std::atomic<bool> stop_;             ///< 停止请求
+
+  std::atomic<std::size_t> loaded_;      ///< 读取到的条目数
+  std::atomic<std::size_t> prefetched_;  ///< 已预热的条目数
+  std::atomic<bool> prefetch_done_;      ///< 预热是否完成
+  std::atomic<std::size_t> saves_;       ///< 写回次数
+  std::atomic<std::size_t> saved_;       ///< 最近一次写回的条目数
+};
@@ -0,0 +1,524 @@
+// ==============================================================================
+// @file   checksummed_device.cpp
+// @brief  校验和块设备的实现
+// ==============================================================================
+
+#include "checksummed_device.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <sstream>
+
+#include "../utils/block_utils.h"
+#include "../utils/crc32c.h"
+#include "../utils/slow_op_watchdog.h"
+
+namespace {
+
+const char kChecksumMagic[8] = {'D', 'S', 'I', 'M', 'C', 'R', 'C', '1'};  ///< 魔数
+const std::uint32_t kChecksumVersion = 1;  ///< 格式版本
+const int kHeaderBlocks = 1;               ///< 校验和头占用的块数
+const int kSumsPerBlock = BLOCK_SIZE / sizeof(std::uint32_t);  ///< 每个区块的校验和数
+const int kMinDataBlocks = 16;             ///< 最少数据块数
+
+const int kScrubBlocksPerSecond = 8192;    ///< 后台巡检限速（块/秒）
+const int kScrubBatch = 64;                ///< 每批巡检的块数
+const auto kScrubStartDelay = std::chrono::seconds(5);    ///< 打开后首轮巡检的延迟
+const auto kScrubPassInterval = std::chrono::minutes(5);  ///< 相邻两轮巡检的间隔
+const std::size_t kMaxReportedBlocks = 16;  ///< 巡检结果中最多列出的损坏块数
+
+}  // namespace
+
+// ==============================================================================
+// 构造与析构
+// ==============================================================================
+
+ChecksummedDevice::ChecksummedDevice(std::unique_ptr<BlockDevice> backing)
+    : backing_(std::move(backing)),
+      data_blocks_(0),
+      table_blocks_(0),
+      policy_(static_cast<int>(ChecksumPolicy::Strict)),
+      read_only_(false),
+      trusted_(true),
+      opened_(false),
+      verified_(0),
+      mismatches_(0),
+      scrubbed_(0),
+      scrub_passes_(0),
+      stop_scrubber_(false) {}
+
+ChecksummedDevice::~ChecksummedDevice() { close(); }
+
+// ==============================================================================
+// 格式的创建与识别
+// ==============================================================================
+
+bool ChecksummedDevice::is_checksummed(BlockDevice& backing) {
+  ChecksumHeader header;
+  return read_header(backing, header);
+}
+
+/**
+ * @brief 写入校验和头与空的校验和区。
+ * @details 校验和区块数 t 满足 t * 1024 >= 总块数 - 1 - t，取最小值。
+ */
+bool ChecksummedDevice::initialize(BlockDevice& backing, ChecksumPolicy policy) {
+  int total = backing.get_total_blocks();
+  int table_blocks = (total - kHeaderBlocks + kSumsPerBlock) / (kSumsPerBlock + 1);
+  int data_blocks = total - kHeaderBlocks - table_blocks;
+  if (data_blocks < kMinDataBlocks) {
+    ErrorHandler::log_error(ERROR_INVALID_ARGUMENT,
+                            "Disk too small for a checksum region");
+    return false;
+  }
+
+  auto buffer = BlockUtils::create_block_buffer();
+  for (int i = 0; i < table_blocks; ++i) {
+    if (!backing.write_block(kHeaderBlocks + i, buffer.get())) {
+      return false;
+    }
+  }
+
+  ChecksumHeader header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, kChecksumMagic, sizeof(kChecksumMagic));
+  header.version = kChecksumVersion;
+  header.data_blocks = data_blocks;
+  header.table_blocks = table_blocks;
+  header.policy = static_cast<std::int32_t>(policy);
+  header.clean = 1;
+  memcpy(buffer.get(), &header, sizeof(header));
+  return backing.write_block(0, buffer.get()) && backing.flush();
+}
+
+const char* ChecksummedDevice::policy_name(ChecksumPolicy policy) {
+  switch (policy) {
+    case ChecksumPolicy::Off:
+      return "off";
+    case ChecksumPolicy::Warn:
+      return "warn";
+    case ChecksumPolicy::Strict:
+      return "strict";
+  }
+  return "strict";
+}
+
+// ==============================================================================
+// 打开与关闭
+// ==============================================================================
+
+/**
+ * @brief 载入校验和区并启动后台巡检线程。
+ * @details 上次未正常关闭时，读写打开按数据重建校验和；只读打开无法写回，
+ *          本次会话不做校验。
+ */
+bool ChecksummedDevice::open(bool read_only) {
+  ChecksumHeader header;
+  if (!read_header(*backing_, header)) {
+    ErrorHandler::log_error(ERROR_INVALID_ARGUMENT,
+                            "Invalid checksum region header");
+    return false;
+  }
+
+  data_blocks_ = header.data_blocks;
+  table_blocks_ = header.table_blocks;
+  policy_ = header.policy;
+  read_only_ = read_only;
+  trusted_ = true;
+  sums_.reset(new std::atomic<std::uint32_t>[data_blocks_]);
+  dirty_.reset(new std::atomic<bool>[table_blocks_]);
+  for (int i = 0; i < table_blocks_; ++i) {
+    dirty_[i] = false;
+  }
+  if (!load_table()) {
+    return false;
+  }
+
+  if (!header.clean) {
+    if (read_only_) {
+      trusted_ = false;
+    } else {
+      rebuild_table();
+    }
+  }
+  if (!read_only_ && !write_header(false)) {
+    return false;
+  }
+
+  opened_ = true;
+  if (trusted_) {
+    stop_scrubber_ = false;
+    scrubber_thread_ = std::thread(&ChecksummedDevice::scrubber_loop, this);
+  }
+  return true;
+}
+
+/**
+ * @brief 停止巡检线程，写回校验和区并标记正常关闭。
+ */
+void ChecksummedDevice::close() {
+  if (!opened_) {
+    return;
+  }
+  if (scrubber_thread_.joinable()) {
+    {
+      std::lock_guard<std::mutex> lock(scrubber_mutex_);
+      stop_scrubber_ = true;
+    }
+    scrubber_cv_.notify_all();
+    scrubber_thread_.join();
+  }
+  if (!read_only_ && write_table()) {
+    write_header(true);
+    backing_->flush();
+  }
+  opened_ = false;
+}
+
+bool ChecksummedDevice::set_policy(ChecksumPolicy policy) {
+  if (read_only_) {
+    ErrorHandler::log_error(ERROR_PERMISSION_DENIED,
+                            "Cannot change verify policy: disk is opened read-only");
+    return false;
+  }
+  policy_ = static_cast<int>(policy);
+  return write_header(false);
+}
+
+// ==============================================================================
+// 块级I/O
+// ==============================================================================
+
+bool ChecksummedDevice::read_block(int block_num, char* buffer) {
+  if (!backing_->read_block(kHeaderBlocks + table_blocks_ + block_num, buffer)) {
+    return false;
+  }
+  return verify(block_num, buffer);
+}
+
+bool ChecksummedDevice::write_block(int block_num, const char* buffer) {
+  std::lock_guard<std::mutex> lock(block_locks_[block_num % kLockStripes]);
+  if (!backing_->write_block(kHeaderBlocks + table_blocks_ + block_num, buffer)) {
+    return false;
+  }
+  record(block_num, buffer);
+  return true;
+}
+
+bool ChecksummedDevice::read_blocks(int start_block, int count, char* buffer) {
+  if (!backing_->read_blocks(kHeaderBlocks + table_blocks_ + start_block, count,
+                             buffer)) {
+    return false;
+  }
+  for (int i = 0; i < count; ++i) {
+    if (!verify(start_block + i, buffer + static_cast<size_t>(i) * BLOCK_SIZE)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * @brief 写入连续多块；按升序取得所涉及的分段锁，避免与巡检交错。
+ */
+bool ChecksummedDevice::write_blocks(int start_block, int count,
+                                     const char* buffer) {
+  std::vector<std::unique_lock<std::mutex>> locks;
+  int stripes = std::min(count, kLockStripes);
+  std::vector<int> order;
+  order.reserve(stripes);
+  for (int i = 0; i < stripes; ++i) {
+    order.push_back((start_block + i) % kLockStripes);
+  }
+  std::sort(order.begin(), order.end());
+  for (int stripe : order) {
+    locks.emplace_back(block_locks_[stripe]);
+  }
+
+  if (!backing_->write_blocks(kHeaderBlocks + table_blocks_ + start_block, count,
+                              buffer)) {
+    return false;
+  }
+  for (int i = 0; i < count; ++i) {
+    record(start_block + i, buffer + static_cast<size_t>(i) * BLOCK_SIZE);
+  }
+  return true;
+}
+
+/**
+ * @brief 被释放的块不再校验，巡检也随之跳过。
+ */
+bool ChecksummedDevice::discard_block(int block_num) {
+  {
+    std::lock_guard<std::mutex> lock(block_locks_[block_num % kLockStripes]);
+    sums_[block_num] = 0;
+    dirty_[block_num / kSumsPerBlock] = true;
+  }
+  return backing_->discard_block(kHeaderBlocks + table_blocks_ + block_num);
+}
+
+bool ChecksummedDevice::flush() {
+  if (!read_only_ && !write_table()) {
+    return false;
+  }
+  return backing_->flush();
+}
+
+int ChecksummedDevice::get_total_blocks() const { return data_blocks_; }
+
+std::string ChecksummedDevice::describe() const {
+  std::ostringstream oss;
+  oss << "checksummed (CRC32C " << Crc32c::implementation() << ", verify "
+      << policy_name(static_cast<ChecksumPolicy>(policy_.load())) << ")";
+  if (!trusted_) {
+    oss << std::endl
+        << "    Checksums unverified: image was not closed cleanly";
+  }
+  oss << std::endl
+      << "    Verified reads: " << verified_.load()
+      << ", Mismatches: " << mismatches_.load();
+  oss << std::endl
+      << "    Scrubbed blocks: " << scrubbed_.load()
+      << " (background passes: " << scrub_passes_.load() << ")";
+  std::string backing = backing_->describe();
+  if (backing != "plain") {
+    oss << std::endl << "    Backing device: " << backing;
+  }
+  return oss.str();
+}
+
+void ChecksummedDevice::collect_stats(std::vector<DeviceStats>& stats) const {
+  backing_->collect_stats(stats);
+}
+
+bool ChecksummedDevice::drop_host_cache() {
+  return backing_->drop_host_cache();
+}
+
+// ==============================================================================
+// 巡检
+// ==============================================================================
+
+/**
+ * @brief 立即巡检所有带校验和的块。
+ */
+bool ChecksummedDevice::scrub(ScrubReport& report) {
+  report = ScrubReport();
+  if (!trusted_) {
+    ErrorHandler::log_error(ERROR_IO_ERROR,
+                            "Cannot scrub: checksums were not closed cleanly "
+                            "(open read-write once to rebuild them)");
+    return false;
+  }
+  auto buffer = BlockUtils::create_block_buffer();
+  for (int block = 0; block < data_blocks_; ++block) {
+    scrub_block(block, buffer.get(), report);
+  }
+  return true;
+}
+
+/**
+ * @brief 巡检单个块：持有分段锁读取并比较，避免与并发写入交错。
+ * @return bool 块被检查（带有校验和）时返回true。
+ */
+bool ChecksummedDevice::scrub_block(int block_num, char* buffer,
+                                    ScrubReport& report) {
+  std::lock_guard<std::mutex> lock(block_locks_[block_num % kLockStripes]);
+  std::uint32_t stored = sums_[block_num];
+  if (stored == 0) {
+    return false;
+  }
+
+  bool ok = backing_->read_block(kHeaderBlocks + table_blocks_ + block_num, buffer) &&
+            encode(Crc32c::compute(buffer, BLOCK_SIZE)) == stored;
+  ++report.scanned;
+  ++scrubbed_;
+  if (!ok) {
+    ++report.corrupted;
+    ++mismatches_;
+    if (report.bad_blocks.size() < kMaxReportedBlocks) {
+      report.bad_blocks.push_back(block_num);
+    }
+    ErrorHandler::log_error(ERROR_CHECKSUM_MISMATCH,
+                            "Scrub found corrupted block " +
+                                std::to_string(block_num));
+  }
+  return true;
+}
+
+/**
+ * @brief 后台巡检：按限速逐批检查所有带校验和的块，每轮之间长时间休眠。
+ */
+void ChecksummedDevice::scrubber_loop() {
+  const auto batch_interval = std::chrono::microseconds(
+      1000000LL * kScrubBatch / kScrubBlocksPerSecond);
+  auto wait = [this](auto duration) {
+    std::unique_lock<std::mutex> lock(scrubber_mutex_);
+    return !scrubber_cv_.wait_for(lock, duration,
+                                  [this] { return stop_scrubber_.load(); });
+  };
+
+  auto buffer = BlockUtils::create_block_buffer();
+  if (!wait(kScrubStartDelay)) {
+    return;
+  }
+  while (!stop_scrubber_) {
+    ScrubReport report;
+    int checked = 0;
+    for (int block = 0; block < data_blocks_ && !stop_scrubber_; ++block) {
+      if (scrub_block(block, buffer.get(), report) &&
+          ++checked % kScrubBatch == 0 && !wait(batch_interval)) {
+        return;
+      }
+    }
+    if (stop_scrubber_) {
+      return;
+    }
+    ++scrub_passes_;
+    if (!wait(kScrubPassInterval)) {
+      return;
+    }
+  }
+}
+
+// ==============================================================================
+// 私有辅助方法
+// ==============================================================================
+
+bool ChecksummedDevice::read_header(BlockDevice& backing,
+                                    ChecksumHeader& header) {
+  if (backing.get_total_blocks() < kHeaderBlocks + 1) {
+    return false;
+  }
+  auto buffer = BlockUtils::create_block_buffer();
+  if (!backing.read_block(0, buffer.get())) {
+    return false;
+  }
+  memcpy(&header, buffer.get(), sizeof(header));
+  return memcmp(header.magic, kChecksumMagic, sizeof(kChecksumMagic)) == 0 &&
+         header.version == kChecksumVersion && header.data_blocks > 0 &&
+         header.table_blocks > 0 &&
+         static_cast<long>(header.table_blocks) * kSumsPerBlock >=
+             header.data_blocks &&
+         kHeaderBlocks + header.table_blocks + header.data_blocks <=
+             backing.get_total_blocks() &&
+         header.policy >= static_cast<int>(ChecksumPolicy::Off) &&
+         header.policy <= static_cast<int>(ChecksumPolicy::Strict);
+}
+
+/**
+ * @brief 0 保留为“未记录”，真实校验和为0时存为全1。
+ */
+std::uint32_t ChecksummedDevice::encode(std::uint32_t crc) {
+  return crc == 0 ? 0xFFFFFFFFu : crc;
+}
+
+bool ChecksummedDevice::write_header(bool clean) {
+  ChecksumHeader header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, kChecksumMagic, sizeof(kChecksumMagic));
+  header.version = kChecksumVersion;
+  header.data_blocks = data_blocks_;
+  header.table_blocks = table_blocks_;
+  header.policy = policy_;
+  header.clean = clean ? 1 : 0;
+
+  auto buffer = BlockUtils::create_block_buffer();
+  memcpy(buffer.get(), &header, sizeof(header));
+  return backing_->write_block(0, buffer.get());
+}
+
+bool ChecksummedDevice::load_table() {
+  auto buffer = BlockUtils::create_block_buffer();
+  const auto* sums = reinterpret_cast<const std::uint32_t*>(buffer.get());
+  for (int i = 0; i < table_blocks_; ++i) {
+    if (!backing_->read_block(kHeaderBlocks + i, buffer.get())) {
+      ErrorHandler::log_error(ERROR_IO_ERROR, "Failed to read checksum region");
+      return false;
+    }
+    for (int j = 0; j < kSumsPerBlock; ++j) {
+      int block = i * kSumsPerBlock + j;
+      if (block < data_blocks_) {
+        sums_[block] = sums[j];
+      }
+    }
+  }
+  return true;
+}
+
+/**
+ * @brief 按当前数据重新计算全部校验和（全零块视为未写入）。
+ */
+void ChecksummedDevice::rebuild_table() {
+  auto buffer = BlockUtils::create_block_buffer();
+  auto zero = BlockUtils::create_block_buffer();
+  for (int block = 0; block < data_blocks_; ++block) {
+    if (!backing_->read_block(kHeaderBlocks + table_blocks_ + block,
+                              buffer.get())) {
+      sums_[block] = 0;
+      continue;
+    }
+    sums_[block] = memcmp(buffer.get(), zero.get(), BLOCK_SIZE) == 0
+                       ? 0
+                       : encode(Crc32c::compute(buffer.get(), BLOCK_SIZE));
+  }
+  for (int i = 0; i < table_blocks_; ++i) {
+    dirty_[i] = true;
+  }
+}
+
+/**
+ * @brief 写回被标记为脏的校验和区块。
+ */
+bool ChecksummedDevice::write_table() {
+  SlowOpWatchdog::Phase phase(OpPhase::Flush);
+  std::lock_guard<std::mutex> lock(flush_mutex_);
+  auto buffer = BlockUtils::create_block_buffer();
+  auto* sums = reinterpret_cast<std::uint32_t*>(buffer.get());
+  for (int i = 0; i < table_blocks_; ++i) {
+    if (!dirty_[i].exchange(false)) {
+      continue;
+    }
+    for (int j = 0; j < kSumsPerBlock; ++j) {
+      int block = i * kSumsPerBlock + j;
+      sums[j] = block < data_blocks_ ? sums_[block].load() : 0;
+    }
+    if (!backing_->write_block(kHeaderBlocks + i, buffer.get())) {
+      dirty_[i] = true;
+      ErrorHandler::log_error(ERROR_IO_ERROR, "Failed to write checksum region");
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * @brief 按当前策略校验读到的数据。
+ * @return bool 数据可以返回给调用方时为true。
+ */
+bool ChecksummedDevice::verify(int block_num, const char* buffer) {
+  auto policy = static_cast<ChecksumPolicy>(policy_.load());
+  if (policy == ChecksumPolicy::Off || !trusted_) {
+    return true;
+  }
+  std::uint32_t stored = sums_[block_num];
+  if (stored == 0) {
+    return true;
+  }
+
+  ++verified_;
+  if (encode(Crc32c::compute(buffer, BLOCK_SIZE)) == stored) {
+    return true;
+  }
+  ++mismatches_;
+  ErrorHandler::log_error(ERROR_CHECKSUM_MISMATCH,
+                          "Block " + std::to_string(block_num) +
+                              " failed checksum verification");
+  return policy == ChecksumPolicy::Warn;
+}
+
+void ChecksummedDevice::record(int block_num, const char* buffer) {
+  sums_[block_num] = encode(Crc32c::compute(buffer, BLOCK_SIZE));
+  dirty_[block_num / kSumsPerBlock] = true;
+}
@@ -0,0 +1,161 @@
+// ==============================================================================
+// @file   checksummed_device.h
+// @brief  校验和块设备：为每个块保存 CRC32C，读取时校验，后台巡检器发现静默损坏
+// ==============================================================================
+
+#pragma once
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../utils/common.h"
+#include "../utils/error_codes.h"
+#include "../utils/error_handler.h"
+#include "block_device.h"
+
+/**
+ * @struct ScrubReport
+ * @brief 一次完整巡检的结果。
+ */
+struct ScrubReport {
+  std::uint64_t scanned{0};     ///< 校验过的块数
+  std::uint64_t corrupted{0};   ///< 校验失败的块数
+  std::vector<int> bad_blocks;  ///< 校验失败的逻辑块号（最多记录前若干个）
+};
+
+/**
+ * @class ChecksummedDevice
+ * @brief 在下层块设备之上为每个逻辑块维护一个 CRC32C 校验和。
+ *
+ * 物理布局：块0为校验和头，其后是校验和区（每块4字节，每个区块保存
+ * 1024 个校验和），再之后是数据块（逻辑块 b 位于 1 + table_blocks + b）。
+ * 校验和区在打开时整体载入内存，写入时只更新内存并把所在区块标记为脏，
+ * 刷新或关闭时才写回，因此每次写入只多一次 CRC32C 计算。头中的 clean
+ * 标志在打开后清零、正常关闭后置位；打开时发现未正常关闭则按数据重建
+ * 校验和，避免把崩溃前未写回的校验和误报为损坏。
+ *
+ * 校验和为0表示该块自创建以来未写入或已被释放（不做校验）。读取时按
+ * 校验策略处理不匹配：strict 返回 I/O 错误，warn 记录错误但返回数据，
+ * off 不校验。后台巡检线程按限速逐块读取所有带校验和的块并报告损坏；
+ * `scrub` 命令可以立即执行一次不限速的完整巡检。
+ */
+class ChecksummedDevice : public BlockDevice {
+ public:
+  /**
+   * @brief 构造函数，接管下层设备的所有权。
+   * @param backing 已打开的下层块设备。
+   */
+  explicit ChecksummedDevice(std::unique_ptr<BlockDevice> backing);
+  ~ChecksummedDevice() override;
+
+  /**
+   * @brief 检查下层设备是否带有校验和区。
+   */
+  static bool is_checksummed(BlockDevice& backing);
+
+  /**
+   * @brief 在下层设备上写入校验和头与空的校验和区。
+   * @param backing 已打开的下层块设备。
+   * @param policy 读取时的校验策略。
+   * @return bool 成功返回true。
+   */
+  static bool initialize(BlockDevice& backing, ChecksumPolicy policy);
+
+  /**
+   * @brief 策略名称（"strict" / "warn" / "off"）。
+   */
+  static const char* policy_name(ChecksumPolicy policy);
+
+  /**
+   * @brief 载入校验和区并启动后台巡检线程。
+   * @param read_only 为true时不写回头与校验和区。
+   * @return bool 成功返回true。
+   */
+  bool open(bool read_only = false);
+
+  /**
+   * @brief 停止巡检线程，写回校验和区并标记正常关闭。
+   */
+  void close();
+
+  /**
+   * @brief 修改并持久化读取时的校验策略。
+   */
+  bool set_policy(ChecksumPolicy policy);
+
+  /**
+   * @brief 立即对所有带校验和的块执行一次完整巡检（不限速）。
+   * @param report 巡检结果。
+   * @return bool 巡检能够完成（不论是否发现损坏）时返回true。
+   */
+  bool scrub(ScrubReport& report);
+
+  bool read_block(int block_num, char* buffer) override;
+  bool write_block(int block_num, const char* buffer) override;
+  bool read_blocks(int start_block, int count, char* buffer) override;
+  bool write_blocks(int start_block, int count, const char* buffer) override;
+  bool discard_block(int block_num) override;
+  bool flush() override;
+  int get_total_blocks() const override;
+  std::string describe() const override;
+  void collect_stats(std::vector<DeviceStats>& stats) const override;
+  bool drop_host_cache() override;
+
+ private:
+  /**
+   * @struct ChecksumHeader
+   * @brief 块0中的校验和头。
+   */
+  struct ChecksumHeader {
+    char magic[8];               ///< 魔数 "DSIMCRC1"
+    std::uint32_t version;       ///< 格式版本
+    std::int32_t data_blocks;    ///< 数据块数
+    std::int32_t table_blocks;   ///< 校验和区块数
+    std::int32_t policy;         ///< 校验策略（ChecksumPolicy）
+    std::int32_t clean;          ///< 上次是否正常关闭
+  };
+
+  static constexpr int kLockStripes = 64;  ///< 写入与巡检之间的块分段锁数量
+
+  static bool read_header(BlockDevice& backing, ChecksumHeader& header);
+  static std::uint32_t encode(std::uint32_t crc);
+  bool write_header(bool clean);
+  bool load_table();
+  void rebuild_table();
+  bool write_table();
+  bool verify(int block_num, const char* buffer);
+  void record(int block_num, const char* buffer);
+  bool scrub_block(int block_num, char* buffer, ScrubReport& report);
+  void scrubber_loop();
+
+  std::unique_ptr<BlockDevice> backing_;  ///< 下层块设备
+  int data_blocks_;                       ///< 数据块数
+  int table_blocks_;                      ///< 校验和区块数
+  std::atomic<int> policy_;               ///< 当前校验策略
+  bool read_only_;                        ///< 是否只读打开
+  bool trusted_;                          ///< 校验和是否可信（只读打开未正常关闭的镜像时为false）
+  bool opened_;                           ///< 是否已打开
+
+  std::unique_ptr<std::atomic<std::uint32_t>[]> sums_;  ///< 每块的校验和（0为未记录）
+  std::unique_ptr<std::atomic<bool>[]> dirty_;          ///< 校验和区块是否需要写回
+  std::array<std::mutex, kLockStripes> block_locks_;    ///< 写入与巡检之间的块分段锁
+  std::mutex flush_mutex_;                              ///< 串行化校验和区的写回
+
+  // --- 统计 ---
+  std::atomic<std::uint64_t> verified_;        ///< 读取时校验的块数
+  std::atomic<std::uint64_t> mismatches_;      ///< 读取或巡检发现的不匹配次数
+  std::atomic<std::uint64_t> scrubbed_;        ///< 巡检过的块数
+  std::atomic<std::uint64_t> scrub_passes_;    ///< 完成的后台巡检轮数
+
+  // --- 后台巡检 ---
+  std::thread scrubber_thread_;          ///< 巡检线程
+  std::mutex scrubber_mutex_;            ///< 巡检线程等待用互斥锁
+  std::condition_variable scrubber_cv_;  ///< 巡检线程唤醒条件变量
+  std::atomic<bool> stop_scrubber_;      ///< 停止标志
+};
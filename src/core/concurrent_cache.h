@@ -0,0 +1,229 @@
+// ==============================================================================
+// @file   concurrent_cache.h
+// @brief  读无锁的并发哈希缓存：读者在纪元保护下遍历桶链，写者按桶分段加锁
+// ==============================================================================
+
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+#include "../utils/epoch_reclaimer.h"
+#include "../utils/memory_accounting.h"
+
+/**
+ * @class ConcurrentCache
+ * @brief 固定桶数的哈希缓存，查找不加锁、不写任何共享缓存行。
+ *
+ * 每个桶是一条单向链表，节点发布后不再修改（替换时新建节点顶替旧节点）。
+ * 写者持有桶所在分段的互斥锁修改链表，用 release 存储发布新指针；被摘下
+ * 的节点交给 EpochReclaimer，在所有可能看到它的读者离开后才释放。读者在
+ * EpochReclaimer::Guard 内以 acquire 加载遍历链表，并把命中的值复制出来。
+ *
+ * 缓存是有界的：每条链最多保留 max_chain 个节点，插入时截掉最旧的尾部，
+ * 被截掉的键下次查找时未命中，由调用方重新加载。
+ *
+ * @tparam Key 键类型，需支持 ==。
+ * @tparam Value 值类型，需可复制。
+ * @tparam Hash 哈希函数对象；若要用探测键查找（lookup 的模板重载），
+ *              它还需能对探测键求哈希，且 Key 需能与探测键比较。
+ */
+template <typename Key, typename Value, typename Hash = std::hash<Key>>
+class ConcurrentCache {
+ public:
+  /**
+   * @brief 构造函数。
+   * @param buckets 桶数（向上取整为2的幂）。
+   * @param max_chain 每个桶最多保留的节点数。
+   */
+  explicit ConcurrentCache(std::size_t buckets = 4096,
+                           std::size_t max_chain = 8)
+      : max_chain_(max_chain == 0 ? 1 : max_chain) {
+    std::size_t count = 1;
+    while (count < buckets) {
+      count <<= 1;
+    }
+    mask_ = count - 1;
+    buckets_.reset(new std::atomic<Node*>[count]);
+    for (std::size_t i = 0; i < count; ++i) {
+      buckets_[i].store(nullptr, std::memory_order_relaxed);
+    }
+    MemoryAccounting::on_allocate(MemSubsystem::Caches,
+                                  count * sizeof(std::atomic<Node*>));
+  }
+
+  /**
+   * @brief 析构函数：此时不应再有读者，直接释放所有节点。
+   */
+  ~ConcurrentCache() {
+    for (std::size_t i = 0; i <= mask_; ++i) {
+      Node* node = buckets_[i].load(std::memory_order_relaxed);
+      while (node != nullptr) {
+        Node* next = node->next.load(std::memory_order_relaxed);
+        delete node;
+        node = next;
+      }
+    }
+    MemoryAccounting::on_deallocate(MemSubsystem::Caches,
+                                    (mask_ + 1) * sizeof(std::atomic<Node*>));
+  }
+
+  ConcurrentCache(const ConcurrentCache&) = delete;
+  ConcurrentCache& operator=(const ConcurrentCache&) = delete;
+
+  /**
+   * @brief 查找键，命中时复制值（不加锁）。
+   * @param probe 键或可与键比较的探测键。
+   * @param value 命中时写入的值。
+   * @return bool 命中返回true。
+   */
+  template <typename Probe>
+  bool lookup(const Probe& probe, Value& value) const {
+    EpochReclaimer::Guard guard;
+    const std::atomic<Node*>& head = buckets_[hash_(probe) & mask_];
+    for (Node* node = head.load(std::memory_order_acquire); node != nullptr;
+         node = node->next.load(std::memory_order_acquire)) {
+      if (node->key == probe) {
+        value = node->value;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  /**
+   * @brief 插入或替换键对应的值。
+   */
+  void insert(const Key& key, const Value& value) { store(key, value, true); }
+
+  /**
+   * @brief 仅在键不存在时插入。
+   * @details 用于未命中后的回填：回填的数据可能在读取期间已被写者更新，
+   *          不能覆盖写者刚写入的较新值。
+   */
+  void insert_if_absent(const Key& key, const Value& value) {
+    store(key, value, false);
+  }
+
+  /**
+   * @brief 删除键。
+   */
+  template <typename Probe>
+  void erase(const Probe& probe) {
+    std::size_t index = hash_(probe) & mask_;
+    std::lock_guard<std::mutex> lock(locks_[index % kLockStripes]);
+    std::atomic<Node*>* link = &buckets_[index];
+    for (Node* node = link->load(std::memory_order_relaxed); node != nullptr;
+         node = link->load(std::memory_order_relaxed)) {
+      if (node->key == probe) {
+        link->store(node->next.load(std::memory_order_relaxed),
+                    std::memory_order_release);
+        EpochReclaimer::instance().retire(node);
+        return;
+      }
+      link = &node->next;
+    }
+  }
+
+  /**
+   * @brief 在纪元保护下遍历所有缓存项（不加锁，遍历期间的并发修改可能可见也可能不可见）。
+   * @param fn 以 (const Key&, const Value&) 调用的函数对象。
+   */
+  template <typename Fn>
+  void for_each(Fn&& fn) const {
+    EpochReclaimer::Guard guard;
+    for (std::size_t i = 0; i <= mask_; ++i) {
+      for (Node* node = buckets_[i].load(std::memory_order_acquire);
+           node != nullptr; node = node->next.load(std::memory_order_acquire)) {
+        fn(node->key, node->value);
+      }
+    }
+  }
+
+  /**
+   * @brief 清空缓存（格式化或卸载时调用）。
+   */
+  void clear() {
+    for (std::size_t i = 0; i <= mask_; ++i) {
+      Node* chain;
+      {
+        std::lock_guard<std::mutex> lock(locks_[i % kLockStripes]);
+        chain = buckets_[i].exchange(nullptr, std::memory_order_acq_rel);
+      }
+      retire_chain(chain);
+    }
+  }
+
+ private:
+  /**
+   * @struct Node
+   * @brief 链表节点，键和值在发布后不再修改；生存期计入缓存子系统的内存统计。
+   */
+  struct Node {
+    Key key;
+    Value value;
+    std::atomic<Node*> next;
+
+    Node(const Key& k, const Value& v, Node* n) : key(k), value(v), next(n) {
+      MemoryAccounting::on_allocate(MemSubsystem::Caches, sizeof(Node));
+    }
+    ~Node() { MemoryAccounting::on_deallocate(MemSubsystem::Caches, sizeof(Node)); }
+  };
+
+  static constexpr std::size_t kLockStripes = 64;  ///< 写者的桶分段锁数量
+
+  void store(const Key& key, const Value& value, bool replace) {
+    std::size_t index = hash_(key) & mask_;
+    Node* trimmed = nullptr;
+    {
+      std::lock_guard<std::mutex> lock(locks_[index % kLockStripes]);
+      std::atomic<Node*>& head = buckets_[index];
+
+      // 已存在：替换为新节点（读者要么看到旧节点，要么看到新节点）
+      std::atomic<Node*>* link = &head;
+      for (Node* node = link->load(std::memory_order_relaxed); node != nullptr;
+           node = link->load(std::memory_order_relaxed)) {
+        if (node->key == key) {
+          if (!replace) {
+            return;
+          }
+          Node* fresh =
+              new Node(key, value, node->next.load(std::memory_order_relaxed));
+          link->store(fresh, std::memory_order_release);
+          EpochReclaimer::instance().retire(node);
+          return;
+        }
+        link = &node->next;
+      }
+
+      // 新键插入链头，超出长度上限的尾部整段摘下
+      head.store(new Node(key, value, head.load(std::memory_order_relaxed)),
+                 std::memory_order_release);
+      Node* node = head.load(std::memory_order_relaxed);
+      for (std::size_t kept = 1; node != nullptr && kept < max_chain_; ++kept) {
+        node = node->next.load(std::memory_order_relaxed);
+      }
+      if (node != nullptr) {
+        trimmed = node->next.exchange(nullptr, std::memory_order_acq_rel);
+      }
+    }
+    retire_chain(trimmed);
+  }
+
+  static void retire_chain(Node* node) {
+    while (node != nullptr) {
+      Node* next = node->next.load(std::memory_order_relaxed);
+      EpochReclaimer::instance().retire(node);
+      node = next;
+    }
+  }
+
+  std::unique_ptr<std::atomic<Node*>[]> buckets_;    ///< 桶头指针
+  std::size_t mask_;                                 ///< 桶数减一
+  std::size_t max_chain_;                            ///< 每个桶的节点上限
+  std::array<std::mutex, kLockStripes> locks_;       ///< 写者的桶分段锁
+  Hash hash_;                                        ///< 哈希函数
+};
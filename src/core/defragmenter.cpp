@@ -0,0 +1,348 @@
+// ==============================================================================
+// @file   defragmenter.cpp
+// @brief  在线碎片整理的实现
+// ==============================================================================
+
+#include "defragmenter.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+
+#include "filesystem.h"
+
+namespace {
+
+constexpr std::chrono::seconds kIdleInterval(60);  ///< 后台两轮整理之间的空闲时间
+
+/**
+ * @brief 后台整理时文件之间的暂停，取自 DISKSIM_DEFRAG_PAUSE_MS（默认20毫秒）。
+ */
+std::chrono::milliseconds pause_interval() {
+  const char* value = std::getenv("DISKSIM_DEFRAG_PAUSE_MS");
+  if (value == nullptr) {
+    return std::chrono::milliseconds(20);
+  }
+  long ms = std::atol(value);
+  return std::chrono::milliseconds(ms > 0 ? ms : 0);
+}
+
+}  // namespace
+
+// ==============================================================================
+// DefragStats
+// ==============================================================================
+
+void DefragStats::merge(const DefragStats& other) {
+  files_scanned += other.files_scanned;
+  files_fragmented += other.files_fragmented;
+  files_defragmented += other.files_defragmented;
+  files_skipped += other.files_skipped;
+  blocks_moved += other.blocks_moved;
+  extents_before += other.extents_before;
+  extents_after += other.extents_after;
+}
+
+std::string DefragStats::summary() const {
+  std::ostringstream oss;
+  oss << "Defrag: " << files_scanned << " files scanned, " << files_fragmented
+      << " fragmented, " << files_defragmented << " defragmented, "
+      << files_skipped << " skipped | " << blocks_moved << " blocks moved | extents "
+      << extents_before << " -> " << extents_after;
+  return oss.str();
+}
+
+// ==============================================================================
+// 构造与析构
+// ==============================================================================
+
+Defragmenter::Defragmenter(FileSystem& fs)
+    : fs_(fs), active_inode_(-1), active_dirty_(false), stop_(false),
+      running_(false), passes_(0), defragmented_(0), moved_(0) {}
+
+Defragmenter::~Defragmenter() {
+  // 文件系统卸载时已经停止；这里只兜底回收线程
+  stop_.store(true);
+  wakeup_.notify_all();
+  if (worker_.joinable()) {
+    worker_.join();
+  }
+}
+
+// ==============================================================================
+// 公共接口
+// ==============================================================================
+
+bool Defragmenter::run(const std::string& path, DefragStats& stats) {
+  std::vector<int> inodes;
+  if (!collect_files(path, inodes)) {
+    return false;
+  }
+  for (int inode_num : inodes) {
+    if (!defragment_inode(inode_num, stats)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool Defragmenter::start_background() {
+  if (running_) {
+    return true;
+  }
+  stop_.store(false);
+  running_ = true;
+  worker_ = std::thread(&Defragmenter::worker_loop, this);
+  return true;
+}
+
+void Defragmenter::stop() {
+  if (!running_) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_.store(true);
+  }
+  wakeup_.notify_all();
+  if (worker_.joinable()) {
+    worker_.join();
+  }
+  running_ = false;
+}
+
+std::string Defragmenter::status() const {
+  std::ostringstream oss;
+  oss << "Defrag: " << (running_ ? "background" : "idle");
+  if (running_) {
+    oss << " (pass " << passes_.load() + 1 << ")";
+  }
+  oss << " | files defragmented " << defragmented_.load() << " | blocks moved "
+      << moved_.load();
+  return oss.str();
+}
+
+void Defragmenter::note_modified(int inode_num) {
+  if (active_inode_.load(std::memory_order_relaxed) == inode_num) {
+    active_dirty_ = true;
+  }
+}
+
+std::size_t Defragmenter::count_extents(const BlockList& blocks) {
+  std::size_t extents = blocks.empty() ? 0 : 1;
+  for (std::size_t i = 1; i < blocks.size(); ++i) {
+    if (blocks[i] != blocks[i - 1] + 1) {
+      ++extents;
+    }
+  }
+  return extents;
+}
+
+// ==============================================================================
+// 整理过程
+// ==============================================================================
+
+/**
+ * @brief 在共享锁下收集路径下的普通文件（目录按深度优先遍历）。
+ */
+bool Defragmenter::collect_files(const std::string& path,
+                                 std::vector<int>& inodes) {
+  auto guard = fs_.acquire_shared_lock();
+  if (!fs_.ensure_mounted("defrag") || !fs_.ensure_writable("defrag")) {
+    return false;
+  }
+
+  int root = fs_.path_manager.find_inode(path);
+  if (root == -1) {
+    ErrorHandler::log_error(ERROR_FILE_NOT_FOUND, "Path not found: " + path);
+    return false;
+  }
+
+  std::vector<int> pending = {root};
+  while (!pending.empty()) {
+    int inode_num = pending.back();
+    pending.pop_back();
+
+    Inode inode;
+    if (!fs_.inode_manager.read_inode(inode_num, inode)) {
+      return false;
+    }
+    if (!(inode.mode & FILE_TYPE_DIRECTORY)) {
+      inodes.push_back(inode_num);
+      continue;
+    }
+
+    std::vector<DirectoryEntry> entries;
+    if (!fs_.directory_manager.read_directory(inode_num, entries)) {
+      return false;
+    }
+    for (const DirectoryEntry& entry : entries) {
+      std::string name(entry.name, strnlen(entry.name, MAX_FILENAME_LENGTH));
+      if (!name.empty() && name != "." && name != "..") {
+        pending.push_back(entry.inode_number);
+      }
+    }
+  }
+  return true;
+}
+
+/**
+ * @brief 整理单个文件：预留、分批搬迁、校验后切换块指针。
+ * @return bool 只有 I/O 错误或文件系统被卸载时返回false。
+ */
+bool Defragmenter::defragment_inode(int inode_num, DefragStats& stats) {
+  std::lock_guard<std::mutex> run_lock(run_mutex_);
+
+  BlockList old_blocks;
+  BlockList movable;
+  BlockList new_blocks;
+  {
+    auto guard = fs_.acquire_unique_lock();
+    if (!fs_.mounted || fs_.read_only_) {
+      return false;
+    }
+    Inode inode;
+    if (!fs_.inode_manager.is_inode_allocated(inode_num) ||
+        !fs_.inode_manager.read_inode(inode_num, inode) ||
+        (inode.mode & FILE_TYPE_DIRECTORY)) {
+      return true;  // 收集之后被删除或替换为目录
+    }
+    if (!fs_.inode_manager.get_data_blocks(inode_num, old_blocks)) {
+      return false;
+    }
+    ++stats.files_scanned;
+
+    // 共享尾块由多个文件共用，原样保留，只搬迁私有块
+    movable = old_blocks;
+    if (InodeManager::is_tail_packed(inode) && !movable.empty()) {
+      movable.pop_back();
+    }
+    std::size_t extents = count_extents(movable);
+    if (extents <= 1) {
+      return true;
+    }
+    ++stats.files_fragmented;
+    stats.extents_before += extents;
+
+    if (!fs_.inode_manager.reserve_contiguous_blocks(
+            static_cast<int>(movable.size()), new_blocks)) {
+      ++stats.files_skipped;
+      stats.extents_after += extents;
+      return true;
+    }
+    active_inode_.store(inode_num);
+    active_dirty_ = false;
+  }
+
+  if (!copy_blocks(movable, new_blocks)) {
+    abandon(new_blocks);
+    ++stats.files_skipped;
+    stats.extents_after += count_extents(movable);
+    return !stop_requested();
+  }
+
+  auto guard = fs_.acquire_unique_lock();
+  active_inode_.store(-1);
+  if (!fs_.mounted) {
+    return false;
+  }
+
+  BlockList current;
+  bool unchanged = !active_dirty_ && fs_.inode_manager.is_inode_allocated(inode_num) &&
+                   fs_.inode_manager.get_data_blocks(inode_num, current) &&
+                   current == old_blocks;
+  BlockList target = new_blocks;
+  if (movable.size() < old_blocks.size()) {
+    target.push_back(old_blocks.back());
+  }
+  if (!unchanged || !fs_.inode_manager.replace_data_blocks(inode_num, target)) {
+    fs_.inode_manager.release_data_blocks(new_blocks);
+    ++stats.files_skipped;
+    stats.extents_after += count_extents(unchanged ? movable : current);
+    return true;
+  }
+
+  ++stats.files_defragmented;
+  stats.blocks_moved += new_blocks.size();
+  stats.extents_after += 1;
+  defragmented_.fetch_add(1);
+  moved_.fetch_add(new_blocks.size());
+  return true;
+}
+
+/**
+ * @brief 把旧块的数据复制到连续的新区间。
+ * @details 每批在共享锁下进行：旧块按连续段整段读入缓冲区，再一次写入新区间。
+ */
+bool Defragmenter::copy_blocks(const BlockList& from, const BlockList& to) {
+  std::vector<char> buffer(static_cast<std::size_t>(kCopyBlocks) * BLOCK_SIZE);
+  std::size_t index = 0;
+  while (index < from.size()) {
+    if (stop_requested()) {
+      return false;
+    }
+    auto guard = fs_.acquire_shared_lock();
+    if (!fs_.mounted) {
+      return false;
+    }
+
+    std::size_t batch = std::min<std::size_t>(kCopyBlocks, from.size() - index);
+    std::size_t done = 0;
+    while (done < batch) {
+      int start = from[index + done];
+      int count = 1;
+      while (done + count < batch && from[index + done + count] == start + count) {
+        ++count;
+      }
+      if (!fs_.disk.read_blocks(start, count, buffer.data() + done * BLOCK_SIZE)) {
+        return false;
+      }
+      done += count;
+    }
+    if (!fs_.disk.write_blocks(to[index], static_cast<int>(batch), buffer.data())) {
+      return false;
+    }
+    index += batch;
+  }
+  return true;
+}
+
+/**
+ * @brief 放弃当前文件的搬迁并归还预留区间。
+ */
+void Defragmenter::abandon(const BlockList& reserved) {
+  auto guard = fs_.acquire_unique_lock();
+  active_inode_.store(-1);
+  if (fs_.mounted) {
+    fs_.inode_manager.release_data_blocks(reserved);
+  }
+}
+
+/**
+ * @brief 循环整理整个命名空间，直到被停止。
+ */
+void Defragmenter::worker_loop() {
+  std::chrono::milliseconds pause = pause_interval();
+  while (!stop_requested()) {
+    std::vector<int> inodes;
+    if (collect_files("/", inodes)) {
+      DefragStats stats;
+      for (int inode_num : inodes) {
+        if (stop_requested() || !defragment_inode(inode_num, stats)) {
+          break;
+        }
+        std::unique_lock<std::mutex> lock(mutex_);
+        wakeup_.wait_for(lock, pause, [this] { return stop_.load(); });
+      }
+      passes_.fetch_add(stop_requested() ? 0 : 1);
+    }
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    wakeup_.wait_for(lock, kIdleInterval, [this] { return stop_.load(); });
+  }
+}
+
+bool Defragmenter::stop_requested() const {
+  return stop_.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,130 @@
+// ==============================================================================
+// @file   defragmenter.h
+// @brief  在线碎片整理：把不连续的文件搬迁到连续区间
+// ==============================================================================
+
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../utils/common.h"
+
+class FileSystem;
+
+/**
+ * @struct DefragStats
+ * @brief 一次碎片整理的统计。
+ */
+struct DefragStats {
+  std::size_t files_scanned = 0;       ///< 检查过的普通文件数
+  std::size_t files_fragmented = 0;    ///< 不连续（多于一个区间）的文件数
+  std::size_t files_defragmented = 0;  ///< 已搬迁到连续区间的文件数
+  std::size_t files_skipped = 0;       ///< 没有足够长的空闲区间或搬迁期间被修改而跳过的文件数
+  std::size_t blocks_moved = 0;        ///< 搬迁的数据块数
+  std::size_t extents_before = 0;      ///< 不连续文件整理前的区间总数
+  std::size_t extents_after = 0;       ///< 这些文件整理后的区间总数
+
+  /**
+   * @brief 累加另一份统计。
+   */
+  void merge(const DefragStats& other);
+
+  /**
+   * @brief 单行摘要。
+   */
+  std::string summary() const;
+};
+
+/**
+ * @class Defragmenter
+ * @brief 找出数据块不连续的普通文件，分配一段连续区间并以大块顺序 I/O
+ *        搬迁数据，最后在文件系统独占锁下一次性切换块指针。
+ *
+ * 每个文件分三步：
+ *   1. 独占锁下读取块列表；已连续的文件跳过，否则用首次适配预留一段
+ *      连续区间（立即写回位图），并登记为正在搬迁的文件；
+ *   2. 按最多 kCopyBlocks 块一批，在共享锁下把旧块合并成连续段整段读出、
+ *      整段写入新区间；批与批之间释放锁，文件在搬迁期间始终可读写；
+ *   3. 独占锁下确认搬迁期间文件没有被写入或删除（写入与删除会调用
+ *      note_modified）且块列表未变，然后由 InodeManager::replace_data_blocks
+ *      写入新指针并释放旧块；否则归还预留区间、留待下次整理。
+ *
+ * 后台模式由一个线程循环整理整个命名空间，文件之间暂停
+ * DISKSIM_DEFRAG_PAUSE_MS 毫秒（默认20），一轮结束后空闲60秒再开始
+ * 下一轮。打包在共享尾块中的文件尾部不参与搬迁。
+ */
+class Defragmenter {
+ public:
+  explicit Defragmenter(FileSystem& fs);
+  ~Defragmenter();
+
+  Defragmenter(const Defragmenter&) = delete;
+  Defragmenter& operator=(const Defragmenter&) = delete;
+
+  /**
+   * @brief 整理路径下的全部普通文件（路径为文件时只整理该文件）。
+   * @details 调用方不得持有文件系统锁。
+   * @param path 已规范化的路径。
+   * @param[out] stats 本次整理的统计（累加）。
+   * @return bool 成功返回true（个别文件被跳过不算失败）。
+   */
+  bool run(const std::string& path, DefragStats& stats);
+
+  /**
+   * @brief 启动后台整理线程（已在运行时直接返回true）。
+   */
+  bool start_background();
+
+  /**
+   * @brief 停止后台整理线程；正在搬迁的文件会被放弃并归还预留区间。
+   * @details 必须在调用方未持有文件系统锁时调用。
+   */
+  void stop();
+
+  /**
+   * @brief 整理状态的单行描述。
+   */
+  std::string status() const;
+
+  /**
+   * @brief 文件被写入或删除时调用（调用方持有文件系统独占锁）。
+   * @param inode_num 被修改的inode号。
+   */
+  void note_modified(int inode_num);
+
+  /**
+   * @brief 块列表中连续区间的个数。
+   */
+  static std::size_t count_extents(const BlockList& blocks);
+
+ private:
+  static constexpr int kCopyBlocks = 64;  ///< 每批搬迁的块数（256KB）
+
+  bool collect_files(const std::string& path, std::vector<int>& inodes);
+  bool defragment_inode(int inode_num, DefragStats& stats);
+  bool copy_blocks(const BlockList& from, const BlockList& to);
+  void abandon(const BlockList& reserved);
+  void worker_loop();
+  bool stop_requested() const;
+
+  FileSystem& fs_;  ///< 所属文件系统
+
+  std::mutex run_mutex_;          ///< 串行化前台与后台的逐文件搬迁
+  std::atomic<int> active_inode_;  ///< 正在搬迁的inode号（-1表示无）
+  bool active_dirty_;             ///< 正在搬迁的文件是否被修改（由文件系统独占锁保护）
+
+  std::thread worker_;              ///< 后台整理线程
+  mutable std::mutex mutex_;        ///< 保护停止标志与等待
+  std::condition_variable wakeup_;  ///< 唤醒空闲等待
+  std::atomic<bool> stop_;          ///< 停止请求
+  bool running_;                    ///< 后台线程是否已启动
+
+  std::atomic<std::size_t> passes_;        ///< 后台完成的整理轮数
+  std::atomic<std::size_t> defragmented_;  ///< 累计整理的文件数（含前台）
+  std::atomic<std::size_t> moved_;         ///< 累计搬迁的数据块数（含前台）
+};
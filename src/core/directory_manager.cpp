@@ -9,6 +9,9 @@
 #include <cstring>
 #include <string>
 
+#include "../utils/slow_op_watchdog.h"
+#include "../utils/trace_probes.h"
+
 // ==============================================================================
 // 构造与析构
 // ==============================================================================
@@ -18,11 +21,16 @@
  * @param disk DiskSimulator对象的引用。
  * @param inode_manager InodeManager对象的引用。
  * @param path_manager PathManager对象的引用。
+ * @param name_index 全局文件名索引的引用。
  */
 DirectoryManager::DirectoryManager(DiskSimulator& disk,
                                    InodeManager& inode_manager,
-                                   PathManager& path_manager)
-    : disk(disk), inode_manager(inode_manager), path_manager(path_manager) {
+                                   PathManager& path_manager,
+                                   NameIndex& name_index)
+    : disk(disk),
+      inode_manager(inode_manager),
+      path_manager(path_manager),
+      name_index(name_index) {
 }
 
 // ==============================================================================
@@ -38,21 +46,20 @@ bool DirectoryManager::create_directory(const std::string& path) {
   // 检查文件系统是否已挂载
   // 这需要在主文件系统类中进行检查
 
-  if (path_manager.file_exists(path)) {
-    ErrorHandler::log_error(ERROR_FILE_ALREADY_EXISTS,
-                            "Directory already exists: " + path);
+  // 一遍解析同时得到父目录与目标是否存在
+  ResolvedPath resolved;
+  if (!path_manager.resolve(path, resolved)) {
+    ErrorHandler::log_error(ERROR_FILE_NOT_FOUND,
+                            "Parent directory not found: " +
+                                std::string(PathManager::parent_view(path)));
     return false;
   }
-
-  std::string parent_path = path_manager.get_parent_path(path);
-  std::string basename = path_manager.get_basename(path);
-
-  int parent_inode = path_manager.find_inode(parent_path);
-  if (parent_inode == -1) {
-    ErrorHandler::log_error(ERROR_FILE_NOT_FOUND,
-                            "Parent directory not found: " + parent_path);
+  if (resolved.inode != -1) {
+    ErrorHandler::log_error(ERROR_FILE_ALREADY_EXISTS,
+                            "Directory already exists: " + path);
     return false;
   }
+  int parent_inode = resolved.parent;
 
   // 分配新的inode
   int new_inode;
@@ -77,7 +84,7 @@ bool DirectoryManager::create_directory(const std::string& path) {
   }
 
   // 分配一个数据块给目录 (这会自动更新inode中的direct_blocks并保存)
-  std::vector<int> blocks;
+  BlockList blocks;
   if (!inode_manager.allocate_data_blocks(new_inode, 1, blocks)) {
     ErrorHandler::log_error(ERROR_NO_FREE_BLOCKS,
                             "Failed to allocate directory data block: " + path);
@@ -112,7 +119,7 @@ bool DirectoryManager::create_directory(const std::string& path) {
   }
 
   // 在父目录中添加条目
-  if (!add_directory_entry(parent_inode, basename, new_inode)) {
+  if (!add_directory_entry(parent_inode, resolved.name, new_inode)) {
     inode_manager.free_inode(new_inode);
     return false;
   }
@@ -141,6 +148,33 @@ bool DirectoryManager::list_directory(const std::string& path,
   return read_directory(inode_num, entries);
 }
 
+/**
+ * @brief 固定目录当前的快照版本。
+ * @details 调用方持有文件系统共享锁完成路径解析与固定，之后即可释放锁，
+ *          在 EpochReclaimer::Guard 内无锁遍历快照；写者随后发布的新版本
+ *          不会影响它。
+ */
+DirectorySnapshot DirectoryManager::pin_directory(const std::string& path) {
+  int inode_num = path_manager.find_inode(path);
+  if (inode_num == -1) {
+    ErrorHandler::log_error(ERROR_FILE_NOT_FOUND,
+                            "Directory not found: " + path);
+    return nullptr;
+  }
+
+  return load_snapshot(inode_num);
+}
+
+void DirectoryManager::clear_snapshots() { snapshots_.clear(); }
+
+std::vector<int> DirectoryManager::cached_directories() const {
+  return snapshots_.directories();
+}
+
+void DirectoryManager::retire_snapshot(int inode_num) {
+  snapshots_.retire(inode_num);
+}
+
 /**
  * @brief 删除目录，检查是否为空后释放资源。
  * @param path 要删除的目录路径。
@@ -156,12 +190,13 @@ bool DirectoryManager::remove_directory(const std::string& path) {
     return false;
   }
 
-  int inode_num = path_manager.find_inode(path);
-  if (inode_num == -1) {
+  ResolvedPath resolved;
+  if (!path_manager.resolve(path, resolved) || resolved.inode == -1) {
     ErrorHandler::log_error(ERROR_FILE_NOT_FOUND,
                             "Directory not found: " + path);
     return false;
   }
+  int inode_num = resolved.inode;
 
   Inode inode;
   if (!load_directory_inode(inode_num, inode)) {
@@ -180,73 +215,34 @@ bool DirectoryManager::remove_directory(const std::string& path) {
     return false;
   }
 
-  std::string parent_path = path_manager.get_parent_path(path);
-  std::string basename = path_manager.get_basename(path);
-
-  int parent_inode = path_manager.find_inode(parent_path);
-  if (parent_inode == -1) {
-    ErrorHandler::log_error(ERROR_FILE_NOT_FOUND,
-                            "Parent directory not found: " + parent_path);
-    return false;
-  }
-
   // 从父目录中移除条目
-  if (!remove_directory_entry(parent_inode, basename)) {
+  if (!remove_directory_entry(resolved.parent, resolved.name)) {
     return false;
   }
 
-  // 释放inode和数据块
+  // 释放inode和数据块；inode号可能被复用，先撤下旧目录的快照和目录项缓存
+  snapshots_.retire(inode_num);
+  path_manager.forget_entry(inode_num, ".");
+  path_manager.forget_entry(inode_num, "..");
   return inode_manager.free_inode(inode_num);
 }
 
 /**
  * @brief 读取目录内容，返回目录条目列表。
+ * @details 优先复制已发布的快照版本，未缓存时从磁盘读取并发布。
  * @param inode_num 目录的inode号。
  * @param entries 用于存储目录条目的向量。
  * @return bool 读取成功返回true，否则返回false。
  */
 bool DirectoryManager::read_directory(int inode_num,
                                       std::vector<DirectoryEntry>& entries) {
-  Inode inode;
-  if (!load_directory_inode(inode_num, inode)) {
+  EpochReclaimer::Guard guard;
+  DirectorySnapshot snapshot = load_snapshot(inode_num);
+  if (!snapshot) {
     return false;
   }
 
-  entries.clear();
-
-  if (inode.size == 0) {
-    return true;
-  }
-
-  // 获取数据块
-  std::vector<int> blocks;
-  if (!inode_manager.get_data_blocks(inode_num, blocks)) {
-    ErrorHandler::log_error(ERROR_IO_ERROR,
-                            "Failed to get data blocks for directory inode: " +
-                                std::to_string(inode_num));
-    return false;
-  }
-
-  // 读取目录数据
-  char buffer[BLOCK_SIZE];
-  for (int block_num : blocks) {
-    if (!disk.read_block(block_num, buffer)) {
-      ErrorHandler::log_error(
-          ERROR_IO_ERROR,
-          "Failed to read directory block: " + std::to_string(block_num));
-      return false;
-    }
-
-    DirectoryEntry* entry = reinterpret_cast<DirectoryEntry*>(buffer);
-    int max_entries = BLOCK_SIZE / sizeof(DirectoryEntry);
-
-    for (int i = 0; i < max_entries; i++) {
-      if (entry[i].name_length > 0) {
-        entries.push_back(entry[i]);
-      }
-    }
-  }
-
+  entries.assign(snapshot->entries.begin(), snapshot->entries.end());
   return true;
 }
 
@@ -258,6 +254,9 @@ bool DirectoryManager::read_directory(int inode_num,
  */
 bool DirectoryManager::write_directory(
     int inode_num, const std::vector<DirectoryEntry>& entries) {
+  // 写入中途失败时磁盘内容不确定，先撤下旧版本，成功后再发布新版本
+  snapshots_.retire(inode_num);
+
   // 读取目录inode
   Inode inode;
   if (!inode_manager.read_inode(inode_num, inode)) {
@@ -271,7 +270,7 @@ bool DirectoryManager::write_directory(
   uint32_t required_blocks = BlockUtils::calculate_blocks_needed(required_size);
 
   // 获取当前块
-  std::vector<int> current_blocks;
+  BlockList current_blocks;
   if (!inode_manager.get_data_blocks(inode_num, current_blocks)) {
     ErrorHandler::log_error(ERROR_IO_ERROR,
                             "Failed to get data blocks for directory inode: " +
@@ -282,7 +281,7 @@ bool DirectoryManager::write_directory(
   // 如果需要，分配额外的块
   if (current_blocks.size() < required_blocks) {
     uint32_t additional_blocks = required_blocks - current_blocks.size();
-    std::vector<int> new_blocks;
+    BlockList new_blocks;
     if (!inode_manager.allocate_data_blocks(inode_num, additional_blocks,
                                             new_blocks)) {
       ErrorHandler::log_error(
@@ -291,6 +290,13 @@ bool DirectoryManager::write_directory(
       return false;
     }
 
+    // allocate_data_blocks 已把新块指针写入inode，重新读取以免下面写回旧指针
+    if (!inode_manager.read_inode(inode_num, inode)) {
+      ErrorHandler::log_error(ERROR_IO_ERROR,
+                              "Failed to refresh directory inode after allocation");
+      return false;
+    }
+
     // 分配后刷新块列表
     current_blocks.clear();
     if (!inode_manager.get_data_blocks(inode_num, current_blocks)) {
@@ -301,6 +307,7 @@ bool DirectoryManager::write_directory(
   }
 
   // 将目录条目写入块
+  SlowOpWatchdog::Phase phase(OpPhase::DataIo);
   int entries_per_block = BLOCK_SIZE / sizeof(DirectoryEntry);
   int entry_index = 0;
 
@@ -342,9 +349,12 @@ bool DirectoryManager::write_directory(
 
   if (!inode_manager.write_inode(inode_num, inode)) {
     ErrorHandler::log_error(ERROR_IO_ERROR, "Failed to update directory inode");
+    snapshots_.retire(inode_num);
     return false;
   }
 
+  // 写时复制：以新内容发布新版本，正在遍历旧版本的读者不受影响
+  snapshots_.publish(inode_num, entries);
   return true;
 }
 
@@ -356,7 +366,7 @@ bool DirectoryManager::write_directory(
  * @return bool 添加成功返回true，否则返回false。
  */
 bool DirectoryManager::add_directory_entry(int dir_inode,
-                                           const std::string& name,
+                                           std::string_view name,
                                            int inode_num) {
   std::vector<DirectoryEntry> entries;
   if (!read_directory(dir_inode, entries)) {
@@ -366,7 +376,7 @@ bool DirectoryManager::add_directory_entry(int dir_inode,
   // 检查条目是否已存在
   if (find_entry_index(entries, name) != -1) {
     ErrorHandler::log_error(ERROR_FILE_ALREADY_EXISTS,
-                            "Directory entry already exists: " + name);
+                            "Directory entry already exists: " + std::string(name));
     return false;
   }
 
@@ -376,13 +386,17 @@ bool DirectoryManager::add_directory_entry(int dir_inode,
   new_entry.inode_number = inode_num;
   int name_len =
       std::min(static_cast<int>(name.length()), MAX_FILENAME_LENGTH - 1);
-  strncpy(new_entry.name, name.c_str(), name_len);
+  memcpy(new_entry.name, name.data(), name_len);
   new_entry.name[name_len] = '\0';
   new_entry.name_length = name_len;
 
   entries.push_back(new_entry);
 
-  return write_directory(dir_inode, entries);
+  if (!write_directory(dir_inode, entries)) {
+    return false;
+  }
+  name_index.record_add(dir_inode, inode_num, new_entry.name);
+  return true;
 }
 
 /**
@@ -392,7 +406,7 @@ bool DirectoryManager::add_directory_entry(int dir_inode,
  * @return bool 移除成功返回true，否则返回false。
  */
 bool DirectoryManager::remove_directory_entry(int dir_inode,
-                                              const std::string& name) {
+                                              std::string_view name) {
   std::vector<DirectoryEntry> entries;
   if (!read_directory(dir_inode, entries)) {
     return false;
@@ -401,12 +415,19 @@ bool DirectoryManager::remove_directory_entry(int dir_inode,
   int index = find_entry_index(entries, name);
   if (index == -1) {
     ErrorHandler::log_error(ERROR_FILE_NOT_FOUND,
-                            "Directory entry not found: " + name);
+                            "Directory entry not found: " + std::string(name));
     return false;
   }
 
+  DirectoryEntry removed = entries[index];
   entries.erase(entries.begin() + index);
-  return write_directory(dir_inode, entries);
+  // 写入中途失败时磁盘上是否仍有该条目不确定，先使缓存失效
+  path_manager.forget_entry(dir_inode, name);
+  if (!write_directory(dir_inode, entries)) {
+    return false;
+  }
+  name_index.record_remove(dir_inode, removed.inode_number, removed.name);
+  return true;
 }
 
 bool DirectoryManager::load_directory_inode(int inode_num, Inode& inode) {
@@ -426,10 +447,68 @@ bool DirectoryManager::load_directory_inode(int inode_num, Inode& inode) {
   return true;
 }
 
+/**
+ * @brief 取得目录的快照版本，未缓存时从磁盘读取并发布。
+ * @details 调用方至少持有文件系统共享锁，因此读取期间磁盘上的目录内容
+ *          不会被写者修改，发布的版本与磁盘一致；返回的版本只在调用方
+ *          持有的 EpochReclaimer::Guard 内有效。
+ */
+DirectorySnapshot DirectoryManager::load_snapshot(int inode_num) {
+  Inode inode;
+  if (!load_directory_inode(inode_num, inode)) {
+    return nullptr;
+  }
+
+  DirectorySnapshot snapshot = snapshots_.pin(inode_num);
+  if (snapshot) {
+    DISKSIM_PROBE1(dirsnap__hit, inode_num);
+    return snapshot;
+  }
+  DISKSIM_PROBE1(dirsnap__miss, inode_num);
+
+  std::vector<DirectoryEntry> entries;
+  if (inode.size == 0) {
+    return snapshots_.publish(inode_num, entries);
+  }
+
+  // 获取数据块
+  BlockList blocks;
+  if (!inode_manager.get_data_blocks(inode_num, blocks)) {
+    ErrorHandler::log_error(ERROR_IO_ERROR,
+                            "Failed to get data blocks for directory inode: " +
+                                std::to_string(inode_num));
+    return nullptr;
+  }
+
+  // 读取目录数据
+  SlowOpWatchdog::Phase phase(OpPhase::DataIo);
+  char buffer[BLOCK_SIZE];
+  for (int block_num : blocks) {
+    if (!disk.read_block(block_num, buffer)) {
+      ErrorHandler::log_error(
+          ERROR_IO_ERROR,
+          "Failed to read directory block: " + std::to_string(block_num));
+      return nullptr;
+    }
+
+    DirectoryEntry* entry = reinterpret_cast<DirectoryEntry*>(buffer);
+    int max_entries = BLOCK_SIZE / sizeof(DirectoryEntry);
+
+    for (int i = 0; i < max_entries; i++) {
+      if (entry[i].name_length > 0) {
+        entries.push_back(entry[i]);
+      }
+    }
+  }
+
+  return snapshots_.publish(inode_num, entries);
+}
+
 int DirectoryManager::find_entry_index(
-    const std::vector<DirectoryEntry>& entries, const std::string& name) const {
+    const std::vector<DirectoryEntry>& entries, std::string_view name) const {
   for (size_t i = 0; i < entries.size(); ++i) {
-    if (strncmp(entries[i].name, name.c_str(), MAX_FILENAME_LENGTH) == 0) {
+    if (static_cast<size_t>(entries[i].name_length) == name.size() &&
+        memcmp(entries[i].name, name.data(), name.size()) == 0) {
       return static_cast<int>(i);
     }
   }
@@ -6,6 +6,7 @@
 #pragma once
 #include <map>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include "../utils/block_utils.h"
@@ -14,8 +15,10 @@
 #include "../utils/error_handler.h"
 #include "../utils/file_operations_utils.h"
 #include "../utils/path_utils.h"
+#include "directory_snapshots.h"
 #include "disk_simulator.h"
 #include "inode_manager.h"
+#include "name_index.h"
 #include "path_manager.h"
 
 /**
@@ -29,9 +32,10 @@ class DirectoryManager {
    * @param disk DiskSimulator对象的引用。
    * @param inode_manager InodeManager对象的引用。
    * @param path_manager PathManager对象的引用。
+   * @param name_index 全局文件名索引的引用（未启用时记录为空操作）。
    */
   DirectoryManager(DiskSimulator& disk, InodeManager& inode_manager,
-                   PathManager& path_manager);
+                   PathManager& path_manager, NameIndex& name_index);
 
   /**
    * @brief 创建新目录，分配inode并初始化目录结构。
@@ -49,6 +53,31 @@ class DirectoryManager {
   bool list_directory(const std::string& path,
                       std::vector<DirectoryEntry>& entries);
 
+  /**
+   * @brief 固定目录当前的快照版本，供调用方释放文件系统锁后遍历。
+   * @details 目录尚未缓存时从磁盘读取并发布为新版本。调用方须在固定前
+   *          构造 EpochReclaimer::Guard，并在遍历结束后才释放。
+   * @param path 目录路径。
+   * @return DirectorySnapshot 失败返回空指针。
+   */
+  DirectorySnapshot pin_directory(const std::string& path);
+
+  /**
+   * @brief 撤下全部目录快照（格式化后或卸载时调用）。
+   */
+  void clear_snapshots();
+
+  /**
+   * @brief 列出当前有快照的目录inode号（用于记录热点集合）。
+   */
+  std::vector<int> cached_directories() const;
+
+  /**
+   * @brief 撤下单个目录的快照（目录内容被绕过本模块改写后调用）。
+   * @param inode_num 目录的inode号。
+   */
+  void retire_snapshot(int inode_num);
+
   /**
    * @brief 删除目录，检查是否为空后释放资源。
    * @param path 要删除的目录路径。
@@ -80,7 +109,7 @@ class DirectoryManager {
    * @param inode_num 对应的inode号。
    * @return bool 添加成功返回true，否则返回false。
    */
-  bool add_directory_entry(int dir_inode, const std::string& name,
+  bool add_directory_entry(int dir_inode, std::string_view name,
                            int inode_num);
 
   /**
@@ -89,14 +118,18 @@ class DirectoryManager {
    * @param name 要移除的条目名称。
    * @return bool 移除成功返回true，否则返回false。
    */
-  bool remove_directory_entry(int dir_inode, const std::string& name);
+  bool remove_directory_entry(int dir_inode, std::string_view name);
 
  private:
   DiskSimulator& disk;          ///< 磁盘模拟器引用
   InodeManager& inode_manager;  ///< Inode管理器引用
   PathManager& path_manager;    ///< 路径管理器引用
+  NameIndex& name_index;        ///< 全局文件名索引引用
+  DirectorySnapshots snapshots_;  ///< 目录内容的已发布版本
+
+  DirectorySnapshot load_snapshot(int inode_num);
 
   bool load_directory_inode(int inode_num, Inode& inode);
   int find_entry_index(const std::vector<DirectoryEntry>& entries,
-                       const std::string& name) const;
+                       std::string_view name) const;
 };
\ No newline at end of file
@@ -0,0 +1,101 @@
+// ==============================================================================
+// @file   directory_snapshots.cpp
+// @brief  目录多版本快照的实现
+// ==============================================================================
+
+#include "directory_snapshots.h"
+
+DirectorySnapshots::DirectorySnapshots()
+    : slots_(new Slot[kSlotCount]), next_version_(1) {
+  for (std::size_t i = 0; i < kSlotCount; ++i) {
+    slots_[i].store(nullptr, std::memory_order_relaxed);
+  }
+  MemoryAccounting::on_allocate(MemSubsystem::Directories,
+                                kSlotCount * sizeof(Slot));
+}
+
+DirectorySnapshots::~DirectorySnapshots() {
+  for (std::size_t i = 0; i < kSlotCount; ++i) {
+    delete slots_[i].load(std::memory_order_relaxed);
+  }
+  MemoryAccounting::on_deallocate(MemSubsystem::Directories,
+                                  kSlotCount * sizeof(Slot));
+}
+
+DirectorySnapshot DirectorySnapshots::pin(int inode_num) const {
+  const DirectoryVersion* current =
+      slot_for(inode_num).load(std::memory_order_acquire);
+  return current != nullptr && current->inode_num == inode_num ? current
+                                                               : nullptr;
+}
+
+/**
+ * @brief 发布目录的新版本。
+ * @details 新版本构造完成后以 release 交换进槽位，读者看到指针时条目已经
+ *          完整可见；换下的旧版本（可能属于同槽位的另一个目录）延迟回收。
+ */
+DirectorySnapshot DirectorySnapshots::publish(
+    int inode_num, const std::vector<DirectoryEntry>& entries) {
+  auto* fresh = new DirectoryVersion();
+  fresh->inode_num = inode_num;
+  fresh->version = next_version_.fetch_add(1, std::memory_order_relaxed);
+  fresh->entries.assign(entries.begin(), entries.end());
+
+  release(slot_for(inode_num).exchange(fresh, std::memory_order_acq_rel));
+  return fresh;
+}
+
+/**
+ * @brief 撤下目录的当前版本。
+ * @details 槽位可能已被同槽位的其他目录占用，只在仍属于该目录时换下。
+ */
+void DirectorySnapshots::retire(int inode_num) {
+  Slot& slot = slot_for(inode_num);
+  const DirectoryVersion* current = slot.load(std::memory_order_acquire);
+  while (current != nullptr && current->inode_num == inode_num) {
+    if (slot.compare_exchange_weak(current, nullptr,
+                                   std::memory_order_acq_rel,
+                                   std::memory_order_acquire)) {
+      release(current);
+      return;
+    }
+  }
+}
+
+void DirectorySnapshots::clear() {
+  for (std::size_t i = 0; i < kSlotCount; ++i) {
+    release(slots_[i].exchange(nullptr, std::memory_order_acq_rel));
+  }
+}
+
+std::size_t DirectorySnapshots::size() const {
+  std::size_t count = 0;
+  for (std::size_t i = 0; i < kSlotCount; ++i) {
+    if (slots_[i].load(std::memory_order_relaxed) != nullptr) {
+      ++count;
+    }
+  }
+  return count;
+}
+
+std::vector<int> DirectorySnapshots::directories() const {
+  EpochReclaimer::Guard guard;
+  std::vector<int> inodes;
+  for (std::size_t i = 0; i < kSlotCount; ++i) {
+    const DirectoryVersion* current = slots_[i].load(std::memory_order_acquire);
+    if (current != nullptr) {
+      inodes.push_back(current->inode_num);
+    }
+  }
+  return inodes;
+}
+
+DirectorySnapshots::Slot& DirectorySnapshots::slot_for(int inode_num) const {
+  return slots_[static_cast<unsigned>(inode_num) % kSlotCount];
+}
+
+void DirectorySnapshots::release(const DirectoryVersion* version) {
+  if (version != nullptr) {
+    EpochReclaimer::instance().retire(const_cast<DirectoryVersion*>(version));
+  }
+}
@@ -0,0 +1,104 @@
+// ==============================================================================
+// @file   directory_snapshots.h
+// @brief  目录内容的多版本快照：读者固定一个版本后无锁遍历，写者发布新版本
+// ==============================================================================
+
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "../utils/common.h"
+#include "../utils/epoch_reclaimer.h"
+#include "../utils/memory_accounting.h"
+
+/**
+ * @struct DirectoryVersion
+ * @brief 某个目录在某一时刻的完整内容，发布后不再修改。
+ */
+struct DirectoryVersion {
+  using EntryList = std::vector<
+      DirectoryEntry,
+      TrackedAllocator<DirectoryEntry, MemSubsystem::Directories>>;
+
+  int inode_num;          ///< 所属目录的inode号
+  std::uint64_t version;  ///< 发布序号，越大越新
+  EntryList entries;      ///< 目录条目（计入目录子系统的内存统计）
+};
+
+/// 被读者固定的目录版本；只在调用方持有的 EpochReclaimer::Guard 生存期内有效
+using DirectorySnapshot = const DirectoryVersion*;
+
+/**
+ * @class DirectorySnapshots
+ * @brief 按目录inode保存最新发布的只读目录版本（写时复制）。
+ *
+ * 版本表是按inode号直接映射的原子指针槽位，同一槽位上的目录互相淘汰，
+ * 被淘汰的目录下次访问时重新从磁盘加载。写者在文件系统独占锁下把新的
+ * 目录内容写入磁盘后调用 publish，以原子交换用新的不可变版本替换旧版本；
+ * 读者在 EpochReclaimer::Guard 内以 acquire 加载取得当前版本，之后即可
+ * 释放文件系统锁，在无锁状态下遍历，期间写者发布的新版本互不影响。被换下
+ * 的旧版本交给 EpochReclaimer 延迟释放，持有 Guard 的读者看到的永远是某个
+ * 完整一致的目录状态。pin 不加锁，也不对共享缓存行执行原子读改写。
+ */
+class DirectorySnapshots {
+ public:
+  DirectorySnapshots();
+
+  /**
+   * @brief 析构函数：此时不应再有读者，直接释放所有版本。
+   */
+  ~DirectorySnapshots();
+
+  DirectorySnapshots(const DirectorySnapshots&) = delete;
+  DirectorySnapshots& operator=(const DirectorySnapshots&) = delete;
+
+  /**
+   * @brief 固定目录的当前版本（调用方须持有 EpochReclaimer::Guard）。
+   * @param inode_num 目录的inode号。
+   * @return DirectorySnapshot 尚未缓存时返回空指针。
+   */
+  DirectorySnapshot pin(int inode_num) const;
+
+  /**
+   * @brief 发布目录的新版本，替换旧版本（旧版本延迟到宽限期结束后回收）。
+   * @param inode_num 目录的inode号。
+   * @param entries 新的目录条目。
+   * @return DirectorySnapshot 刚发布的版本（调用方须持有 EpochReclaimer::Guard）。
+   */
+  DirectorySnapshot publish(int inode_num,
+                            const std::vector<DirectoryEntry>& entries);
+
+  /**
+   * @brief 撤下目录的当前版本（目录被删除或内容未能确定时调用）。
+   */
+  void retire(int inode_num);
+
+  /**
+   * @brief 撤下全部版本（格式化或卸载时调用）。
+   */
+  void clear();
+
+  /**
+   * @brief 当前缓存的目录数。
+   */
+  std::size_t size() const;
+
+  /**
+   * @brief 列出当前缓存了版本的目录inode号。
+   */
+  std::vector<int> directories() const;
+
+ private:
+  using Slot = std::atomic<const DirectoryVersion*>;
+
+  static constexpr std::size_t kSlotCount = 4096;  ///< 槽位数（最多缓存的目录数）
+
+  Slot& slot_for(int inode_num) const;
+  static void release(const DirectoryVersion* version);
+
+  std::unique_ptr<Slot[]> slots_;              ///< inode号取模 -> 最新版本
+  std::atomic<std::uint64_t> next_version_;    ///< 下一个发布序号
+};
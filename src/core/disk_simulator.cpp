@@ -4,10 +4,32 @@
 // ==============================================================================
 
 #include "disk_simulator.h"
+#include <cstdlib>
 #include <cstring>
+#include <iomanip>
 #include <iostream>
-#include <sys/file.h>
-#include <unistd.h>
+#include <sstream>
+#include <vector>
+
+#include "../utils/trace_probes.h"
+#include "checksummed_device.h"
+#include "file_block_device.h"
+#include "log_structured_device.h"
+#include "mirrored_device.h"
+#include "striped_device.h"
+#include "tiered_device.h"
+
+namespace {
+
+/**
+ * @brief 环境变量 DISKSIM_HEATMAP=1 时打开磁盘即开始记录块访问热度。
+ */
+bool heatmap_enabled_by_env() {
+  const char* value = std::getenv("DISKSIM_HEATMAP");
+  return value != nullptr && std::strcmp(value, "1") == 0;
+}
+
+}  // namespace
 
 // ==============================================================================
 // 构造与析构
@@ -17,11 +39,11 @@
  * @brief 构造函数，初始化磁盘状态。
  */
 DiskSimulator::DiskSimulator()
-    : disk_file(nullptr),
-      disk_size(0),
+    : disk_size(0),
       total_blocks(0),
       disk_open(false),
-      lock_acquired(false) {}
+      read_only_(false),
+      checksums_(nullptr) {}
 
 /**
  * @brief 析构函数，确保磁盘文件被正确关闭。
@@ -35,109 +57,149 @@ DiskSimulator::~DiskSimulator() {
 // ==============================================================================
 
 /**
- * @brief 创建一个新的虚拟磁盘文件。
- * @details 使用fseek创建一个稀疏文件，速度远快于逐块写入。
+ * @brief 创建一个新的虚拟磁盘文件（普通模式）。
  * @param path 要创建的磁盘文件的路径。
  * @param size_mb 磁盘文件的大小（以MB为单位）。
  * @return bool 操作成功返回true，否则返回false。
  */
 bool DiskSimulator::create_disk(const std::string& path, int size_mb) {
+  return create_disk(path, size_mb, DeviceOptions());
+}
+
+/**
+ * @brief 按指定设备选项创建一个新的虚拟磁盘文件。
+ * @details 镜像文件以稀疏文件方式创建；条带与镜像模式创建全部成员文件并写入集合头；
+ *          启用校验和时在其上写入校验和头与空的校验和区；日志结构模式再在最上层
+ *          额外写入检查点头与映射表。启用分层时另外写入 <path>.tier 并新建快速层文件。
+ * @param path 要创建的磁盘文件的路径。
+ * @param size_mb 磁盘文件的大小（以MB为单位）。
+ * @param options 设备选项。
+ * @return bool 操作成功返回true，否则返回false。
+ */
+bool DiskSimulator::create_disk(const std::string& path, int size_mb,
+                                const DeviceOptions& options) {
   if (disk_open) {
     ErrorHandler::log_error(ERROR_FILE_ALREADY_OPEN, "Create failed: A disk file is already open");
     return false;
   }
 
-  FILE* file = fopen(path.c_str(), "wb");
-  if (!file) {
-    ErrorHandler::log_error(ERROR_IO_ERROR, "Failed to create disk file: " + path);
+  long size_bytes = static_cast<long>(size_mb) * 1024 * 1024;
+  if (options.tier_fast_mb >= size_mb) {
+    ErrorHandler::log_error(ERROR_INVALID_ARGUMENT,
+                            "Create failed: Fast tier must be smaller than the disk");
+    return false;
+  }
+  // 旧镜像的分层配置不能沿用到新镜像
+  TieredDevice::remove_config(path);
+
+  bool created;
+  if (options.stripe_members > 1) {
+    created = StripedDevice::create(path, size_bytes, options.stripe_members,
+                                    options.stripe_blocks);
+  } else if (options.mirror_members > 1) {
+    created = MirroredDevice::create(path, size_bytes, options.mirror_members);
+  } else {
+    created = FileBlockDevice::create(path, size_bytes);
+  }
+  if (!created) {
     return false;
   }
 
-  disk_size = static_cast<long>(size_mb) * 1024 * 1024;
-  if (disk_size <= 0) {
-      ErrorHandler::log_error(ERROR_INVALID_ARGUMENT, "Disk size must be a positive number");
-      fclose(file);
+  if (options.checksums) {
+    std::unique_ptr<BlockDevice> backing = open_physical(path, false);
+    if (!backing ||
+        !ChecksummedDevice::initialize(*backing, options.verify)) {
       return false;
+    }
   }
 
-  // 使用fseek创建稀疏文件，比逐块写入快得多
-  if (fseek(file, disk_size - 1, SEEK_SET) != 0) {
-      ErrorHandler::log_error(ERROR_IO_ERROR, "Failed to extend disk file with fseek");
-      fclose(file);
+  if (options.mode == DeviceMode::LogStructured) {
+    std::unique_ptr<BlockDevice> physical = open_physical(path, false);
+    if (!physical ||
+        !LogStructuredDevice::initialize(*physical, options.segment_blocks)) {
       return false;
+    }
   }
-  if (fwrite("", 1, 1, file) != 1) {
-      ErrorHandler::log_error(ERROR_IO_ERROR, "Failed to write the last byte of the disk file");
-      fclose(file);
-      return false;
+
+  if (options.tier_fast_mb > 0 &&
+      !TieredDevice::create(path, options.tier_fast_path, options.tier_fast_mb)) {
+    return false;
   }
 
-  fclose(file);
   disk_path = path;
   return true;
 }
 
 /**
- * @brief 打开一个已存在的磁盘文件。
+ * @brief 打开一个已存在的磁盘文件，并根据镜像头选择块设备实现。
+ * @details 只读打开时镜像加共享锁，多个进程可以同时读取；日志结构层不启动
+ *          清理器，镜像集合不写集合头也不重同步。镜像旁有分层配置时在整个
+ *          设备栈之上叠加快速层，读写打开时把元数据区固定在快速层。
  * @param path 要打开的磁盘文件的路径。
+ * @param read_only 是否只读打开。
  * @return bool 操作成功返回true，否则返回false。
  */
-bool DiskSimulator::open_disk(const std::string& path) {
+bool DiskSimulator::open_disk(const std::string& path, bool read_only) {
   if (disk_open) {
     ErrorHandler::log_error(ERROR_FILE_ALREADY_OPEN, "Open failed: A disk file is already open");
     return false;
   }
 
-  disk_file = fopen(path.c_str(), "rb+");
-  if (!disk_file) {
-    ErrorHandler::log_error(ERROR_IO_ERROR, "Failed to open disk file: " + path);
+  std::unique_ptr<BlockDevice> physical = open_physical(path, read_only);
+  if (!physical) {
     return false;
   }
+  checksums_ = dynamic_cast<ChecksummedDevice*>(physical.get());
 
-  int fd = fileno(disk_file);
-  if (fd == -1) {
-    ErrorHandler::log_error(ERROR_IO_ERROR,
-                            "Failed to resolve file descriptor for: " + path);
-    fclose(disk_file);
-    disk_file = nullptr;
-    return false;
+  if (LogStructuredDevice::is_log_structured(*physical)) {
+    auto log_device = std::make_unique<LogStructuredDevice>(std::move(physical));
+    if (!log_device->open(read_only)) {
+      return false;
+    }
+    device_ = std::move(log_device);
+  } else {
+    device_ = std::move(physical);
   }
 
-  if (flock(fd, LOCK_EX) != 0) {
-    ErrorHandler::log_error(ERROR_IO_ERROR, "Failed to lock disk file: " + path);
-    fclose(disk_file);
-    disk_file = nullptr;
-    return false;
+  TierConfig tier;
+  TieredDevice* tiered = nullptr;
+  if (TieredDevice::load_config(path, tier)) {
+    auto tiered_device = std::make_unique<TieredDevice>(std::move(device_));
+    if (!tiered_device->open(tier, read_only)) {
+      checksums_ = nullptr;
+      return false;
+    }
+    tiered = tiered_device.get();
+    device_ = std::move(tiered_device);
   }
-  lock_acquired = true;
 
-  // 计算文件大小和总块数
-  fseek(disk_file, 0, SEEK_END);
-  disk_size = ftell(disk_file);
-  fseek(disk_file, 0, SEEK_SET);
-  total_blocks = disk_size / BLOCK_SIZE;
+  // 文件系统看到的是逻辑块数
+  total_blocks = device_->get_total_blocks();
+  disk_size = static_cast<long>(total_blocks) * BLOCK_SIZE;
+  if (tiered) {
+    tiered->pin_metadata(calculate_layout().data_blocks_start);
+  }
 
   disk_path = path;
   disk_open = true;
+  read_only_ = read_only;
+  heatmap_.attach(total_blocks, heatmap_enabled_by_env());
   return true;
 }
 
 /**
  * @brief 关闭当前打开的磁盘文件。
+ * @details 先让设备持久化内部状态（日志结构模式写入检查点），再释放文件锁。
  */
 void DiskSimulator::close_disk() {
-  if (disk_file) {
-    if (lock_acquired) {
-      int fd = fileno(disk_file);
-      if (fd != -1) {
-        flock(fd, LOCK_UN);
-      }
-      lock_acquired = false;
-    }
-    fclose(disk_file);
-    disk_file = nullptr;
+  if (device_) {
+    device_->flush();
+    device_.reset();
   }
+  checksums_ = nullptr;
+  heatmap_.set_enabled(false);
   disk_open = false;
+  read_only_ = false;
 }
 
 /**
@@ -149,6 +211,7 @@ bool DiskSimulator::format_disk() {
     ErrorHandler::log_error(ERROR_FILE_NOT_OPEN, "Format failed: Disk not open");
     return false;
   }
+  if (!is_writable()) return false;
 
   DiskLayout layout = calculate_layout();
 
@@ -171,18 +234,9 @@ bool DiskSimulator::format_disk() {
  */
 bool DiskSimulator::read_block(int block_num, char* buffer) {
   if (!is_ready_for_io(block_num)) return false;
-  
-  {
-    std::lock_guard<std::mutex> lock(disk_mutex_);
-    if (!seek_to_block(block_num)) return false;
-
-    if (fread(buffer, 1, BLOCK_SIZE, disk_file) != BLOCK_SIZE) {
-      ErrorHandler::log_error(ERROR_IO_ERROR, "Failed to read block: " + std::to_string(block_num));
-      return false;
-    }
-  }
-
-  return true;
+  DISKSIM_PROBE2(block__read, block_num, 1);
+  heatmap_.record(block_num, 1, false);
+  return device_->read_block(block_num, buffer);
 }
 
 /**
@@ -192,20 +246,48 @@ bool DiskSimulator::read_block(int block_num, char* buffer) {
  * @return bool 操作成功返回true，否则返回false。
  */
 bool DiskSimulator::write_block(int block_num, const char* buffer) {
-  if (!is_ready_for_io(block_num)) return false;
-  
-  {
-    std::lock_guard<std::mutex> lock(disk_mutex_);
-    if (!seek_to_block(block_num)) return false;
+  if (!is_ready_for_io(block_num) || !is_writable()) return false;
+  DISKSIM_PROBE2(block__write, block_num, 1);
+  heatmap_.record(block_num, 1, true);
+  return device_->write_block(block_num, buffer);
+}
 
-    if (fwrite(buffer, 1, BLOCK_SIZE, disk_file) != BLOCK_SIZE) {
-      ErrorHandler::log_error(ERROR_IO_ERROR, "Failed to write block: " + std::to_string(block_num));
-      return false;
-    }
+/**
+ * @brief 读取连续的多个数据块，由设备决定是否合并或并行传输。
+ * @param start_block 起始块号。
+ * @param count 块数。
+ * @param buffer 输出缓冲区（大小应为 count * BLOCK_SIZE）。
+ * @return bool 操作成功返回true，否则返回false。
+ */
+bool DiskSimulator::read_blocks(int start_block, int count, char* buffer) {
+  if (!is_ready_for_range(start_block, count)) return false;
+  DISKSIM_PROBE2(block__read, start_block, count);
+  heatmap_.record(start_block, count, false);
+  return device_->read_blocks(start_block, count, buffer);
+}
 
-    fflush(disk_file); // 确保数据立即写入磁盘
-  }
-  return true;
+/**
+ * @brief 写入连续的多个数据块，由设备决定是否合并或并行传输。
+ * @param start_block 起始块号。
+ * @param count 块数。
+ * @param buffer 输入缓冲区（大小应为 count * BLOCK_SIZE）。
+ * @return bool 操作成功返回true，否则返回false。
+ */
+bool DiskSimulator::write_blocks(int start_block, int count, const char* buffer) {
+  if (!is_ready_for_range(start_block, count) || !is_writable()) return false;
+  DISKSIM_PROBE2(block__write, start_block, count);
+  heatmap_.record(start_block, count, true);
+  return device_->write_blocks(start_block, count, buffer);
+}
+
+/**
+ * @brief 通知设备某个块的内容已不再需要。
+ * @param block_num 被释放的块号。
+ * @return bool 操作成功返回true，否则返回false。
+ */
+bool DiskSimulator::discard_block(int block_num) {
+  if (!is_ready_for_io(block_num) || !is_writable()) return false;
+  return device_->discard_block(block_num);
 }
 
 // ==============================================================================
@@ -213,10 +295,12 @@ bool DiskSimulator::write_block(int block_num, const char* buffer) {
 // ==============================================================================
 
 bool DiskSimulator::is_open() const { return disk_open; }
+bool DiskSimulator::is_read_only() const { return read_only_; }
 int DiskSimulator::get_total_blocks() const { return total_blocks; }
 long DiskSimulator::get_disk_size() const { return disk_size; }
 int DiskSimulator::get_block_size() const { return BLOCK_SIZE; }
 std::string DiskSimulator::get_disk_path() const { return disk_path; }
+BlockHeatMap& DiskSimulator::heatmap() { return heatmap_; }
 
 /**
  * @brief 计算并返回磁盘布局。
@@ -248,6 +332,79 @@ DiskLayout DiskSimulator::calculate_layout() const {
   return layout;
 }
 
+bool DiskSimulator::has_checksums() const { return checksums_ != nullptr; }
+
+/**
+ * @brief 立即巡检所有带校验和的块。
+ * @param report 巡检结果。
+ * @return bool 巡检完成返回true。
+ */
+bool DiskSimulator::scrub(ScrubReport& report) {
+  if (!has_checksum_layer("Scrub")) return false;
+  return checksums_->scrub(report);
+}
+
+/**
+ * @brief 修改并持久化读取时的校验策略。
+ * @param policy 新策略。
+ * @return bool 成功返回true。
+ */
+bool DiskSimulator::set_checksum_policy(ChecksumPolicy policy) {
+  if (!has_checksum_layer("Set verify policy") || !is_writable()) return false;
+  return checksums_->set_policy(policy);
+}
+
+/**
+ * @brief 生成设备模式与I/O统计报告。
+ * @return std::string 格式化的报告文本。
+ */
+std::string DiskSimulator::get_device_report() const {
+  std::ostringstream oss;
+  if (!device_) {
+    oss << "Device: not open" << std::endl;
+    return oss.str();
+  }
+
+  std::vector<DeviceStats> stats;
+  device_->collect_stats(stats);
+
+  oss << std::fixed << std::setprecision(1);
+  oss << "Device Statistics:" << std::endl;
+  oss << "  Mode: " << device_->describe() << std::endl;
+  for (const auto& entry : stats) {
+    std::uint64_t total = entry.reads + entry.writes;
+    double sequential_pct =
+        total ? 100.0 * static_cast<double>(entry.sequential) / total : 0.0;
+    oss << "  Backend: " << entry.name << std::endl;
+    oss << "    Reads: " << entry.reads << ", Writes: " << entry.writes
+        << std::endl;
+    oss << "    Sequential: " << sequential_pct << "%, Seeks: " << entry.seeks
+        << " (avg distance "
+        << (entry.seeks ? entry.seek_distance / entry.seeks : 0) << " blocks)"
+        << std::endl;
+    oss << "    Simulated device time: " << entry.simulated_ms << " ms"
+        << std::endl;
+    oss << "    Access hint: " << entry.access_hint << " (" << entry.hints
+        << " hints)" << std::endl;
+  }
+  return oss.str();
+}
+
+/**
+ * @brief 写回设备状态后丢弃宿主机页缓存，供冷缓存测量使用。
+ * @return bool 成功返回true。
+ */
+bool DiskSimulator::drop_host_cache() {
+  if (!device_) {
+    ErrorHandler::log_error(ERROR_FILE_NOT_OPEN, "Drop cache failed: Disk not open");
+    return false;
+  }
+  if (!read_only_ && !device_->flush()) {
+    return false;
+  }
+  return device_->drop_host_cache();
+}
+
 // ==============================================================================
 // 私有辅助方法
 // ==============================================================================
@@ -270,19 +427,89 @@ bool DiskSimulator::is_ready_for_io(int block_num) const {
 }
 
 /**
- * @brief 将文件指针移动到指定块的起始位置。
- * @param block_num 目标块号。
- * @return bool 操作成功返回true。
+ * @brief 检查一段连续块是否全部位于磁盘范围内。
+ * @param start_block 起始块号。
+ * @param count 块数。
+ * @return bool 如果就绪且有效则返回true。
  */
-bool DiskSimulator::seek_to_block(int block_num) {
-  long offset = static_cast<long>(block_num) * BLOCK_SIZE;
-  if (fseek(disk_file, offset, SEEK_SET) != 0) {
-    ErrorHandler::log_error(ERROR_IO_ERROR, "Failed to seek to block: " + std::to_string(block_num));
+bool DiskSimulator::is_ready_for_range(int start_block, int count) const {
+  if (count <= 0) {
+    ErrorHandler::log_error(ERROR_INVALID_ARGUMENT, "I/O operation failed: Invalid block count: " + std::to_string(count));
+    return false;
+  }
+  return is_ready_for_io(start_block) && is_ready_for_io(start_block + count - 1);
+}
+
+/**
+ * @brief 检查磁盘是否允许写入。
+ * @return bool 读写打开返回true。
+ */
+bool DiskSimulator::is_writable() const {
+  if (read_only_) {
+    ErrorHandler::log_error(ERROR_PERMISSION_DENIED, "Write rejected: Disk is opened read-only");
     return false;
   }
   return true;
 }
 
+/**
+ * @brief 检查设备栈中是否有校验和层。
+ * @param operation 操作名称，用于错误信息。
+ * @return bool 有校验和层返回true。
+ */
+bool DiskSimulator::has_checksum_layer(const char* operation) const {
+  if (!disk_open) {
+    ErrorHandler::log_error(ERROR_FILE_NOT_OPEN, std::string(operation) + " failed: Disk not open");
+    return false;
+  }
+  if (!checksums_) {
+    ErrorHandler::log_error(ERROR_INVALID_ARGUMENT, std::string(operation) + " failed: Disk was created without --checksums");
+    return false;
+  }
+  return true;
+}
+
+/**
+ * @brief 打开镜像文件，若其为条带或镜像集合的成员0则组装整个集合；
+ *        带有校验和区时再在其上叠加校验和层。
+ * @param path 镜像文件路径。
+ * @param read_only 是否只读打开（集合成员沿用同一方式）。
+ * @return std::unique_ptr<BlockDevice> 下层设备，失败返回空指针。
+ */
+std::unique_ptr<BlockDevice> DiskSimulator::open_physical(const std::string& path,
+                                                          bool read_only) {
+  auto file = std::make_unique<FileBlockDevice>();
+  if (!file->open(path, read_only)) {
+    return nullptr;
+  }
+
+  std::unique_ptr<BlockDevice> backing;
+  if (StripedDevice::is_striped(*file)) {
+    auto striped = std::make_unique<StripedDevice>();
+    if (!striped->open(std::move(file))) {
+      return nullptr;
+    }
+    backing = std::move(striped);
+  } else if (MirroredDevice::is_mirrored(*file)) {
+    auto mirrored = std::make_unique<MirroredDevice>();
+    if (!mirrored->open(std::move(file))) {
+      return nullptr;
+    }
+    backing = std::move(mirrored);
+  } else {
+    backing = std::move(file);
+  }
+
+  if (ChecksummedDevice::is_checksummed(*backing)) {
+    auto checksummed = std::make_unique<ChecksummedDevice>(std::move(backing));
+    if (!checksummed->open(read_only)) {
+      return nullptr;
+    }
+    return checksummed;
+  }
+  return backing;
+}
+
 /**
  * @brief 初始化超级块并写入磁盘。
  * @param layout 磁盘布局信息。
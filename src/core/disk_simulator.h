@@ -1,18 +1,25 @@
 #pragma once
-#include <cstdio>
+#include <memory>
 #include <string>
-#include <mutex>
 
 #include "../utils/common.h"
 #include "../utils/error_codes.h"
 #include "../utils/error_handler.h"
 #include "../utils/block_utils.h"
+#include "block_device.h"
+#include "block_heatmap.h"
+#include "checksummed_device.h"
 
 /**
  * @class DiskSimulator
  * @brief 模拟磁盘，提供块级的原子读写操作。
  *
  * 通过一个大文件模拟物理磁盘，并负责处理磁盘的创建、打开、格式化以及块数据的读写。
+ * 实际的块放置由 BlockDevice 决定：普通镜像直接按块偏移读写，条带镜像把块
+ * 交错分布到多个成员文件，镜像集合把每块写入所有成员并在成员间分摊读取，
+ * 日志结构镜像则经由块映射表把写入追加到段中（可叠加在条带或镜像集合
+ * 之上）。启用校验和的镜像在上述物理层之上、日志结构层之下为每个块保存
+ * CRC32C。打开时根据镜像头自动识别模式。
  */
 class DiskSimulator {
  public:
@@ -34,12 +41,23 @@ class DiskSimulator {
    */
   bool create_disk(const std::string& path, int size_mb);
 
+  /**
+   * @brief 按指定设备选项创建一个新的磁盘文件。
+   * @param path 要创建的磁盘文件的路径。
+   * @param size_mb 磁盘文件的大小（以MB为单位）。
+   * @param options 设备选项（块放置模式等）。
+   * @return bool 操作成功返回true，否则返回false。
+   */
+  bool create_disk(const std::string& path, int size_mb,
+                   const DeviceOptions& options);
+
   /**
    * @brief 打开一个已存在的磁盘文件。
    * @param path 要打开的磁盘文件的路径。
+   * @param read_only 为true时以只读共享方式打开，拒绝一切写入。
    * @return bool 操作成功返回true，否则返回false。
    */
-  bool open_disk(const std::string& path);
+  bool open_disk(const std::string& path, bool read_only = false);
 
   /**
    * @brief 从磁盘读取一个数据块。
@@ -57,6 +75,31 @@ class DiskSimulator {
    */
   bool write_block(int block_num, const char* buffer);
 
+  /**
+   * @brief 读取连续的多个数据块。
+   * @param start_block 起始块号。
+   * @param count 块数。
+   * @param buffer 用于存储读取数据的缓冲区。
+   * @return bool 操作成功返回true，否则返回false。
+   */
+  bool read_blocks(int start_block, int count, char* buffer);
+
+  /**
+   * @brief 写入连续的多个数据块。
+   * @param start_block 起始块号。
+   * @param count 块数。
+   * @param buffer 包含要写入数据的缓冲区。
+   * @return bool 操作成功返回true，否则返回false。
+   */
+  bool write_blocks(int start_block, int count, const char* buffer);
+
+  /**
+   * @brief 通知设备某个块的内容已不再需要。
+   * @param block_num 被释放的块号。
+   * @return bool 操作成功返回true，否则返回false。
+   */
+  bool discard_block(int block_num);
+
   /**
    * @brief 格式化磁盘，创建文件系统结构。
    * @return bool 操作成功返回true，否则返回false。
@@ -74,6 +117,12 @@ class DiskSimulator {
    */
   bool is_open() const;
 
+  /**
+   * @brief 检查磁盘是否以只读方式打开。
+   * @return bool 只读打开返回true。
+   */
+  bool is_read_only() const;
+
   /**
    * @brief 获取磁盘总块数。
    * @return int 磁盘的总块数。
@@ -104,20 +153,59 @@ class DiskSimulator {
    */
   DiskLayout calculate_layout() const;
 
+  /**
+   * @brief 镜像是否带有块校验和。
+   */
+  bool has_checksums() const;
+
+  /**
+   * @brief 立即巡检所有带校验和的块。
+   * @param report 巡检结果。
+   * @return bool 巡检完成返回true（未启用校验和时返回false）。
+   */
+  bool scrub(ScrubReport& report);
+
+  /**
+   * @brief 修改并持久化读取时的校验策略。
+   * @param policy 新策略。
+   * @return bool 成功返回true。
+   */
+  bool set_checksum_policy(ChecksumPolicy policy);
+
+  /**
+   * @brief 生成设备模式与I/O统计报告。
+   * @return std::string 格式化的报告文本。
+   */
+  std::string get_device_report() const;
+
+  /**
+   * @brief 把设备的内部状态写回镜像，再丢弃镜像在宿主机页缓存中的页面。
+   * @return bool 成功返回true。
+   */
+  bool drop_host_cache();
+
+  /**
+   * @brief 逻辑块访问热度统计（默认关闭，DISKSIM_HEATMAP=1 时打开磁盘即开始记录）。
+   */
+  BlockHeatMap& heatmap();
+
  private:
   std::string disk_path;  ///< 磁盘文件路径
-  FILE* disk_file;        ///< 磁盘文件指针
-  long disk_size;         ///< 磁盘大小（字节）
-  int total_blocks;       ///< 磁盘总块数
+  std::unique_ptr<BlockDevice> device_;  ///< 底层块设备
+  long disk_size;         ///< 逻辑磁盘大小（字节）
+  int total_blocks;       ///< 逻辑总块数
   bool disk_open;         ///< 磁盘是否打开标志
-  bool lock_acquired;     ///< 是否持有跨进程锁
-
-  // --- 线程同步 ---
-  mutable std::mutex disk_mutex_;    ///< 保护磁盘文件操作的互斥锁
+  bool read_only_;        ///< 是否只读打开
+  ChecksummedDevice* checksums_;  ///< 设备栈中的校验和层（未启用时为空）
+  BlockHeatMap heatmap_;          ///< 逻辑块访问热度
 
   // --- 私有辅助函数 ---
   bool is_ready_for_io(int block_num) const;
-  bool seek_to_block(int block_num);
+  bool is_ready_for_range(int start_block, int count) const;
+  bool is_writable() const;
+  bool has_checksum_layer(const char* operation) const;
+  static std::unique_ptr<BlockDevice> open_physical(const std::string& path,
+                                                    bool read_only);
   bool initialize_superblock(const DiskLayout& layout);
   bool initialize_bitmaps(const DiskLayout& layout);
   bool initialize_inode_table(const DiskLayout& layout);
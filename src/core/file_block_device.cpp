@@ -0,0 +1,418 @@
+// ==============================================================================
+// @file   file_block_device.cpp
+// @brief  基于单个镜像文件的物理块设备实现
+// ==============================================================================
+
+#include "file_block_device.h"
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+
+constexpr int kPatternWindow = 64;       ///< 判断访问模式的窗口（访问次数）
+constexpr int kSequentialPercent = 75;   ///< 顺序访问占比不低于该值时视为顺序模式
+constexpr int kRandomPercent = 25;       ///< 顺序访问占比不高于该值时视为随机模式
+constexpr int kReadaheadBlocks = 32;     ///< 顺序模式下每次 WILLNEED 预读的块数
+
+}  // namespace
+
+// ==============================================================================
+// 构造与析构
+// ==============================================================================
+
+FileBlockDevice::FileBlockDevice()
+    : fd_(-1), size_(0), total_blocks_(0), lock_acquired_(false),
+      read_only_(false), mapping_(nullptr), last_block_(-1),
+      window_accesses_(0), window_sequential_(0),
+      pattern_(AccessPattern::Normal), readahead_mark_(0) {}
+
+FileBlockDevice::~FileBlockDevice() {
+  close();
+}
+
+// ==============================================================================
+// 生命周期
+// ==============================================================================
+
+/**
+ * @brief 创建指定大小的稀疏镜像文件。
+ * @details 使用 ftruncate 扩展文件长度，速度远快于逐块写入。
+ */
+bool FileBlockDevice::create(const std::string& path, long size_bytes) {
+  if (size_bytes <= 0) {
+    ErrorHandler::log_error(ERROR_INVALID_ARGUMENT,
+                            "Disk size must be a positive number");
+    return false;
+  }
+
+  int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (fd == -1) {
+    ErrorHandler::log_error(ERROR_IO_ERROR,
+                            "Failed to create disk file: " + path);
+    return false;
+  }
+
+  if (ftruncate(fd, size_bytes) != 0) {
+    ErrorHandler::log_error(ERROR_IO_ERROR,
+                            "Failed to extend disk file: " + path);
+    ::close(fd);
+    return false;
+  }
+
+  ::close(fd);
+  return true;
+}
+
+/**
+ * @brief 打开镜像文件并加锁：读写模式加独占锁，只读模式加共享锁。
+ */
+bool FileBlockDevice::open(const std::string& path, bool read_only) {
+  if (fd_ != -1) {
+    ErrorHandler::log_error(ERROR_FILE_ALREADY_OPEN,
+                            "Open failed: A disk file is already open");
+    return false;
+  }
+
+  int fd = ::open(path.c_str(), read_only ? O_RDONLY : O_RDWR);
+  if (fd == -1) {
+    ErrorHandler::log_error(ERROR_IO_ERROR, "Failed to open disk file: " + path);
+    return false;
+  }
+
+  if (flock(fd, read_only ? LOCK_SH : LOCK_EX) != 0) {
+    ErrorHandler::log_error(ERROR_IO_ERROR, "Failed to lock disk file: " + path);
+    ::close(fd);
+    return false;
+  }
+
+  off_t size = lseek(fd, 0, SEEK_END);
+  if (size < 0) {
+    ErrorHandler::log_error(ERROR_IO_ERROR,
+                            "Failed to determine disk size: " + path);
+    flock(fd, LOCK_UN);
+    ::close(fd);
+    return false;
+  }
+
+  // 只读镜像不会被本进程修改，且其他进程无法同时持有独占锁，映射内容稳定
+  if (read_only && size > 0) {
+    void* mapping = mmap(nullptr, static_cast<size_t>(size), PROT_READ,
+                         MAP_SHARED, fd, 0);
+    mapping_ = mapping == MAP_FAILED ? nullptr : static_cast<const char*>(mapping);
+  }
+
+  fd_ = fd;
+  lock_acquired_ = true;
+  read_only_ = read_only;
+  path_ = path;
+  size_ = static_cast<long>(size);
+  total_blocks_ = static_cast<int>(size_ / BLOCK_SIZE);
+
+  std::lock_guard<std::mutex> lock(stats_mutex_);
+  stats_ = DeviceStats();
+  stats_.name = path_;
+  last_block_ = -1;
+  window_accesses_ = 0;
+  window_sequential_ = 0;
+  pattern_ = AccessPattern::Normal;
+  readahead_mark_ = 0;
+  return true;
+}
+
+/**
+ * @brief 释放锁并关闭文件。
+ */
+void FileBlockDevice::close() {
+  if (fd_ == -1) {
+    return;
+  }
+  if (mapping_) {
+    munmap(const_cast<char*>(mapping_), static_cast<size_t>(size_));
+    mapping_ = nullptr;
+  }
+  if (lock_acquired_) {
+    flock(fd_, LOCK_UN);
+    lock_acquired_ = false;
+  }
+  ::close(fd_);
+  fd_ = -1;
+  read_only_ = false;
+}
+
+// ==============================================================================
+// 块级I/O
+// ==============================================================================
+
+bool FileBlockDevice::read_block(int block_num, char* buffer) {
+  off_t offset = static_cast<off_t>(block_num) * BLOCK_SIZE;
+  if (mapping_ && offset + BLOCK_SIZE <= size_) {
+    memcpy(buffer, mapping_ + offset, BLOCK_SIZE);
+  } else if (pread(fd_, buffer, BLOCK_SIZE, offset) != BLOCK_SIZE) {
+    ErrorHandler::log_error(ERROR_IO_ERROR,
+                            "Failed to read block: " + std::to_string(block_num));
+    return false;
+  }
+  issue_hint(account_access(block_num, false));
+  return true;
+}
+
+bool FileBlockDevice::write_block(int block_num, const char* buffer) {
+  if (read_only_) {
+    return reject_write(block_num);
+  }
+  off_t offset = static_cast<off_t>(block_num) * BLOCK_SIZE;
+  if (pwrite(fd_, buffer, BLOCK_SIZE, offset) != BLOCK_SIZE) {
+    ErrorHandler::log_error(
+        ERROR_IO_ERROR, "Failed to write block: " + std::to_string(block_num));
+    return false;
+  }
+  issue_hint(account_access(block_num, true));
+  return true;
+}
+
+/**
+ * @brief 以一次 pread 读取连续的多个块。
+ */
+bool FileBlockDevice::read_blocks(int start_block, int count, char* buffer) {
+  off_t offset = static_cast<off_t>(start_block) * BLOCK_SIZE;
+  ssize_t length = static_cast<ssize_t>(count) * BLOCK_SIZE;
+  if (mapping_ && offset + length <= size_) {
+    memcpy(buffer, mapping_ + offset, static_cast<size_t>(length));
+  } else if (pread(fd_, buffer, length, offset) != length) {
+    ErrorHandler::log_error(ERROR_IO_ERROR,
+                            "Failed to read blocks: " + std::to_string(start_block) +
+                                "+" + std::to_string(count));
+    return false;
+  }
+  account_range(start_block, count, false);
+  return true;
+}
+
+/**
+ * @brief 以一次 pwrite 写入连续的多个块。
+ */
+bool FileBlockDevice::write_blocks(int start_block, int count,
+                                   const char* buffer) {
+  if (read_only_) {
+    return reject_write(start_block);
+  }
+  off_t offset = static_cast<off_t>(start_block) * BLOCK_SIZE;
+  ssize_t length = static_cast<ssize_t>(count) * BLOCK_SIZE;
+  if (pwrite(fd_, buffer, length, offset) != length) {
+    ErrorHandler::log_error(ERROR_IO_ERROR,
+                            "Failed to write blocks: " + std::to_string(start_block) +
+                                "+" + std::to_string(count));
+    return false;
+  }
+  account_range(start_block, count, true);
+  return true;
+}
+
+int FileBlockDevice::get_total_blocks() const { return total_blocks_; }
+long FileBlockDevice::get_size() const { return size_; }
+const std::string& FileBlockDevice::get_path() const { return path_; }
+
+bool FileBlockDevice::is_read_only() const { return read_only_; }
+
+int FileBlockDevice::head_position() const {
+  std::lock_guard<std::mutex> lock(stats_mutex_);
+  return last_block_;
+}
+
+void FileBlockDevice::set_latency_model(const DeviceLatencyModel& model) {
+  std::lock_guard<std::mutex> lock(stats_mutex_);
+  latency_model_ = model;
+}
+
+std::string FileBlockDevice::describe() const {
+  return "plain";
+}
+
+void FileBlockDevice::collect_stats(std::vector<DeviceStats>& stats) const {
+  std::lock_guard<std::mutex> lock(stats_mutex_);
+  stats.push_back(stats_);
+}
+
+/**
+ * @brief 写回脏页后丢弃镜像文件在宿主机页缓存中的页面。
+ * @details 只读映射先以 MADV_DONTNEED 解除本进程的页表引用，否则被映射的
+ * 页面不会被 POSIX_FADV_DONTNEED 回收。模拟磁头位置一并复位。
+ */
+bool FileBlockDevice::drop_host_cache() {
+  if (fd_ == -1) {
+    return false;
+  }
+  if (!read_only_ && fdatasync(fd_) != 0) {
+    ErrorHandler::log_error(ERROR_IO_ERROR, "Failed to sync disk file: " + path_);
+    return false;
+  }
+  if (mapping_) {
+    madvise(const_cast<char*>(mapping_), static_cast<size_t>(size_), MADV_DONTNEED);
+  }
+  if (posix_fadvise(fd_, 0, 0, POSIX_FADV_DONTNEED) != 0) {
+    ErrorHandler::log_error(ERROR_IO_ERROR,
+                            "Failed to drop host page cache: " + path_);
+    return false;
+  }
+
+  std::lock_guard<std::mutex> lock(stats_mutex_);
+  last_block_ = -1;
+  readahead_mark_ = 0;
+  return true;
+}
+
+// ==============================================================================
+// 私有辅助方法
+// ==============================================================================
+
+/**
+ * @brief 按延迟模型累计一次访问的统计，并决定是否需要向宿主机发出提示。
+ */
+FileBlockDevice::HintRequest FileBlockDevice::account_access(int block_num,
+                                                             bool is_write) {
+  std::lock_guard<std::mutex> lock(stats_mutex_);
+  if (is_write) {
+    ++stats_.writes;
+  } else {
+    ++stats_.reads;
+  }
+
+  HintRequest hint;
+  double cost = latency_model_.transfer_ms_per_block;
+  bool sequential = last_block_ != -1 && block_num == last_block_ + 1;
+  if (sequential) {
+    ++stats_.sequential;
+  } else {
+    std::uint64_t distance =
+        last_block_ == -1 ? 0 : std::abs(block_num - last_block_);
+    ++stats_.seeks;
+    stats_.seek_distance += distance;
+    cost += latency_model_.seek_base_ms;
+    if (total_blocks_ > 0) {
+      cost += latency_model_.full_stroke_ms * static_cast<double>(distance) /
+              total_blocks_;
+    }
+    // 寻道后从新位置重新开始预读
+    readahead_mark_ = block_num;
+  }
+  stats_.simulated_ms += cost;
+  last_block_ = block_num;
+
+  // 每个窗口结束时按顺序访问占比切换模式
+  ++window_accesses_;
+  if (sequential) {
+    ++window_sequential_;
+  }
+  if (window_accesses_ >= kPatternWindow) {
+    int percent = window_sequential_ * 100 / window_accesses_;
+    AccessPattern pattern = AccessPattern::Normal;
+    if (percent >= kSequentialPercent) {
+      pattern = AccessPattern::Sequential;
+    } else if (percent <= kRandomPercent) {
+      pattern = AccessPattern::Random;
+    }
+    if (pattern != pattern_) {
+      pattern_ = pattern;
+      hint.change_pattern = true;
+      hint.pattern = pattern;
+    }
+    window_accesses_ = 0;
+    window_sequential_ = 0;
+  }
+
+  if (!is_write && pattern_ == AccessPattern::Sequential &&
+      block_num >= readahead_mark_ && block_num + 1 < total_blocks_) {
+    hint.prefetch_block = block_num + 1;
+    readahead_mark_ = block_num + kReadaheadBlocks / 2;
+  }
+  return hint;
+}
+
+/**
+ * @brief 累计一次连续多块传输的统计（首块可能寻道，其余均为顺序访问）。
+ */
+void FileBlockDevice::account_range(int start_block, int count, bool is_write) {
+  HintRequest hint;
+  for (int i = 0; i < count; ++i) {
+    merge_hint(hint, account_access(start_block + i, is_write));
+  }
+  issue_hint(hint);
+}
+
+/**
+ * @brief 合并一次多块传输中逐块产生的提示：模式取最后一次切换，预读取最靠后的位置。
+ */
+void FileBlockDevice::merge_hint(HintRequest& into, const HintRequest& from) const {
+  if (from.change_pattern) {
+    into.change_pattern = true;
+    into.pattern = from.pattern;
+  }
+  if (from.prefetch_block > into.prefetch_block) {
+    into.prefetch_block = from.prefetch_block;
+  }
+}
+
+/**
+ * @brief 在统计锁之外发出 fadvise/madvise 提示；提示失败不影响 I/O 结果。
+ */
+void FileBlockDevice::issue_hint(const HintRequest& hint) {
+  if (!hint.change_pattern && hint.prefetch_block < 0) {
+    return;
+  }
+
+  std::uint64_t issued = 0;
+  const char* name = nullptr;
+  if (hint.change_pattern) {
+    int advice = POSIX_FADV_NORMAL;
+    int map_advice = MADV_NORMAL;
+    name = "normal";
+    if (hint.pattern == AccessPattern::Sequential) {
+      advice = POSIX_FADV_SEQUENTIAL;
+      map_advice = MADV_SEQUENTIAL;
+      name = "sequential";
+    } else if (hint.pattern == AccessPattern::Random) {
+      advice = POSIX_FADV_RANDOM;
+      map_advice = MADV_RANDOM;
+      name = "random";
+    }
+    if (posix_fadvise(fd_, 0, 0, advice) == 0) {
+      ++issued;
+    }
+    if (mapping_ && madvise(const_cast<char*>(mapping_),
+                            static_cast<size_t>(size_), map_advice) == 0) {
+      ++issued;
+    }
+  }
+
+  if (hint.prefetch_block >= 0) {
+    int count = std::min(kReadaheadBlocks, total_blocks_ - hint.prefetch_block);
+    if (posix_fadvise(fd_, static_cast<off_t>(hint.prefetch_block) * BLOCK_SIZE,
+                      static_cast<off_t>(count) * BLOCK_SIZE,
+                      POSIX_FADV_WILLNEED) == 0) {
+      ++issued;
+    }
+  }
+
+  std::lock_guard<std::mutex> lock(stats_mutex_);
+  stats_.hints += issued;
+  if (name != nullptr) {
+    stats_.access_hint = name;
+  }
+}
+
+/**
+ * @brief 拒绝对只读设备的写入。
+ */
+bool FileBlockDevice::reject_write(int block_num) const {
+  ErrorHandler::log_error(ERROR_PERMISSION_DENIED,
+                          "Write to read-only device " + path_ + " at block " +
+                              std::to_string(block_num));
+  return false;
+}
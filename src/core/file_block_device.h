@@ -0,0 +1,133 @@
+// ==============================================================================
+// @file   file_block_device.h
+// @brief  基于单个镜像文件的物理块设备
+// ==============================================================================
+
+#pragma once
+#include <mutex>
+#include <string>
+
+#include "../utils/common.h"
+#include "../utils/error_codes.h"
+#include "../utils/error_handler.h"
+#include "block_device.h"
+
+/**
+ * @class FileBlockDevice
+ * @brief 以一个宿主机文件模拟物理磁盘，逻辑块号即文件内的块偏移。
+ *
+ * 使用 pread/pwrite 做定位读写，调用之间不共享文件偏移，因此多个线程
+ * 可以并发访问而无需全局互斥。读写打开时对文件加 flock 独占锁，防止多个
+ * 进程同时操作同一镜像；只读打开时加共享锁并把整个文件 mmap 到内存，
+ * 多个只读进程可以同时读取同一镜像，读块退化为一次内存拷贝。每次访问按
+ * DeviceLatencyModel 累计顺序/寻道统计。
+ *
+ * 统计同时按每64次访问为一个窗口判断访问模式：顺序访问占多数时向宿主机
+ * 发出 POSIX_FADV_SEQUENTIAL（映射区同时 MADV_SEQUENTIAL），并在顺序读
+ * 越过预读标记时对后续块发出 WILLNEED；寻道占多数时发出 RANDOM 关闭
+ * 内核预读。模式不变时不重复发提示。
+ */
+class FileBlockDevice : public BlockDevice {
+ public:
+  FileBlockDevice();
+  ~FileBlockDevice() override;
+
+  /**
+   * @brief 创建指定大小的稀疏镜像文件。
+   * @param path 文件路径。
+   * @param size_bytes 文件大小（字节）。
+   * @return bool 成功返回true。
+   */
+  static bool create(const std::string& path, long size_bytes);
+
+  /**
+   * @brief 打开镜像文件并加锁。
+   * @param path 文件路径。
+   * @param read_only 为true时以只读方式打开、加共享锁并映射文件。
+   * @return bool 成功返回true。
+   */
+  bool open(const std::string& path, bool read_only = false);
+
+  /**
+   * @brief 释放锁并关闭文件。
+   */
+  void close();
+
+  bool read_block(int block_num, char* buffer) override;
+  bool write_block(int block_num, const char* buffer) override;
+  bool read_blocks(int start_block, int count, char* buffer) override;
+  bool write_blocks(int start_block, int count, const char* buffer) override;
+  int get_total_blocks() const override;
+  std::string describe() const override;
+  void collect_stats(std::vector<DeviceStats>& stats) const override;
+
+  /**
+   * @brief 写回脏页后丢弃镜像文件在宿主机页缓存中的页面。
+   */
+  bool drop_host_cache() override;
+
+  /**
+   * @brief 获取文件大小（字节）。
+   */
+  long get_size() const;
+
+  /**
+   * @brief 获取文件路径。
+   */
+  const std::string& get_path() const;
+
+  /**
+   * @brief 是否以只读方式打开。
+   */
+  bool is_read_only() const;
+
+  /**
+   * @brief 获取模拟磁头位置（上一次访问的块号，未访问时为-1）。
+   */
+  int head_position() const;
+
+  /**
+   * @brief 替换延迟模型（例如把分层存储的快速层建模为闪存）。
+   */
+  void set_latency_model(const DeviceLatencyModel& model);
+
+ private:
+  /**
+   * @enum AccessPattern
+   * @brief 根据最近访问窗口判断出的访问模式。
+   */
+  enum class AccessPattern { Normal, Sequential, Random };
+
+  /**
+   * @struct HintRequest
+   * @brief 统计时决定、释放统计锁后再发出的宿主机提示。
+   */
+  struct HintRequest {
+    bool change_pattern = false;  ///< 是否需要切换访问模式提示
+    AccessPattern pattern = AccessPattern::Normal;  ///< 新的访问模式
+    int prefetch_block = -1;      ///< 预读起始块，-1表示不预读
+  };
+
+  HintRequest account_access(int block_num, bool is_write);
+  void account_range(int start_block, int count, bool is_write);
+  void merge_hint(HintRequest& into, const HintRequest& from) const;
+  void issue_hint(const HintRequest& hint);
+  bool reject_write(int block_num) const;
+
+  std::string path_;     ///< 镜像文件路径
+  int fd_;               ///< 文件描述符
+  long size_;            ///< 文件大小（字节）
+  int total_blocks_;     ///< 总块数
+  bool lock_acquired_;   ///< 是否持有跨进程锁
+  bool read_only_;       ///< 是否只读打开
+  const char* mapping_;  ///< 只读打开时的文件映射（映射失败时为空，退回 pread）
+
+  DeviceLatencyModel latency_model_;  ///< 延迟模型参数
+  DeviceStats stats_;                 ///< I/O统计
+  int last_block_;                    ///< 上一次访问的块号
+  int window_accesses_;               ///< 当前模式窗口内的访问次数
+  int window_sequential_;             ///< 当前模式窗口内的顺序访问次数
+  AccessPattern pattern_;             ///< 当前向宿主机声明的访问模式
+  int readahead_mark_;                ///< 顺序读越过该块号时发出下一次预读
+  mutable std::mutex stats_mutex_;    ///< 保护统计数据的互斥锁
+};
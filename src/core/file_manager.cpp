@@ -27,26 +27,26 @@ int FileManager::create_file(const std::string& path, int mode) {
   // 检查文件系统是否已挂载
   // 这需要在主文件系统类中进行检查
 
-  // 检查文件是否已存在
-  if (file_exists(path)) {
-    ErrorHandler::log_error(ERROR_FILE_ALREADY_EXISTS,
-                            "File already exists: " + path);
+  if (ErrorHandler::is_error(PathUtils::validate_path(path))) {
+    ErrorHandler::log_error(ERROR_INVALID_PATH, "Invalid path: " + path);
     return -1;
   }
 
-  // 验证并解析路径使用辅助方法
-  std::string filename, directory;
-  if (!path_manager.validate_and_parse_path(path, filename, directory)) {
+  // 一遍解析同时得到父目录、文件是否已存在与文件名
+  ResolvedPath resolved;
+  if (!path_manager.resolve(path, resolved)) {
+    ErrorHandler::log_error(ERROR_FILE_NOT_FOUND,
+                            "Parent directory not found: " +
+                                std::string(PathManager::parent_view(path)));
     return -1;
   }
-
-  // 查找父目录inode
-  int parent_inode = path_manager.find_inode(directory);
-  if (parent_inode == -1) {
-    ErrorHandler::log_error(ERROR_FILE_NOT_FOUND,
-                            "Parent directory not found: " + directory);
+  if (resolved.inode != -1) {
+    ErrorHandler::log_error(ERROR_FILE_ALREADY_EXISTS,
+                            "File already exists: " + path);
     return -1;
   }
+  int parent_inode = resolved.parent;
+  std::string_view filename = resolved.name;
 
   // 分配并初始化文件inode使用辅助方法
   int new_inode = allocate_file_inode(filename);
@@ -62,6 +62,7 @@ int FileManager::create_file(const std::string& path, int mode) {
     return -1;
   }
 
+  // 尾部打包标志由文件系统维护，不接受调用方设置
   inode.mode = FILE_TYPE_REGULAR | mode;
   if (!inode_manager.write_inode(new_inode, inode)) {
     ErrorHandler::log_error(ERROR_IO_ERROR, "Failed to update inode mode");
@@ -73,7 +74,8 @@ int FileManager::create_file(const std::string& path, int mode) {
   if (!directory_manager.add_directory_entry(parent_inode, filename,
                                              new_inode)) {
     ErrorHandler::log_error(ERROR_IO_ERROR,
-                            "Failed to append directory entry: " + filename);
+                            "Failed to append directory entry: " +
+                                std::string(filename));
     inode_manager.free_inode(new_inode);
     return -1;
   }
@@ -86,31 +88,25 @@ bool FileManager::delete_file(const std::string& path) {
   // 检查文件系统是否已挂载
   // 这需要在主文件系统类中进行检查
 
-  int inode_num = path_manager.find_inode(path);
-  if (inode_num == -1) {
+  // 一遍解析同时得到文件与父目录，不再分别查找父路径与基本名称
+  ResolvedPath resolved;
+  if (!path_manager.resolve(path, resolved) || resolved.inode == -1) {
     ErrorHandler::log_error(ERROR_FILE_NOT_FOUND, "File not found: " + path);
     return false;
   }
+  int inode_num = resolved.inode;
 
   Inode inode;
   if (!load_regular_file_inode(inode_num, inode, path)) {
     return false;
   }
 
-  std::string parent_path = path_manager.get_parent_path(path);
-  std::string basename = path_manager.get_basename(path);
-
-  int parent_inode = path_manager.find_inode(parent_path);
-  if (parent_inode == -1) {
-    ErrorHandler::log_error(ERROR_FILE_NOT_FOUND,
-                            "Parent directory not found: " + parent_path);
+  // 从父目录中移除条目
+  if (!directory_manager.remove_directory_entry(resolved.parent,
+                                                resolved.name)) {
     return false;
   }
 
-  // 从父目录中移除条目
-  // 这需要通过DirectoryManager来实现
-  // 目前，我们假设它在主FileSystem类中可用
-
   // 释放inode和数据块
   return inode_manager.free_inode(inode_num);
 }
@@ -168,6 +164,10 @@ bool FileManager::close_file(int fd) {
   }
 
   update_file_modification_time(it->second.inode_num);
+  // 写入过的文件关闭时把小尾部并入共享尾块；失败时文件保持原样，不影响关闭
+  if (it->second.modified) {
+    inode_manager.pack_tail(it->second.inode_num);
+  }
   free_file_descriptor(fd);
   return true;
 }
@@ -182,6 +182,21 @@ int FileManager::read_file(int fd, char* buffer, int size) {
     return -1;
   }
 
+  int bytes_read = read_file_at(fd, desc, buffer, size);
+  if (bytes_read <= 0) {
+    return bytes_read;
+  }
+
+  // 更新文件位置
+  file_descriptors[fd].position += bytes_read;
+  update_file_access_time(desc.inode_num);
+
+  return bytes_read;
+}
+
+// 按描述符快照中的位置读取数据，不访问描述符表
+int FileManager::read_file_at(int fd, const FileDescriptor& desc, char* buffer,
+                              int size) {
   if (!(desc.mode & OPEN_MODE_READ)) {
     ErrorHandler::log_error(
         ERROR_INVALID_ARGUMENT,
@@ -204,7 +219,7 @@ int FileManager::read_file(int fd, char* buffer, int size) {
   int bytes_to_read = std::min(size, inode.size - desc.position);
 
   // 获取数据块
-  std::vector<int> blocks;
+  BlockList blocks;
   if (!inode_manager.get_data_blocks(desc.inode_num, blocks)) {
     ErrorHandler::log_error(
         ERROR_IO_ERROR,
@@ -212,14 +227,12 @@ int FileManager::read_file(int fd, char* buffer, int size) {
     return -1;
   }
 
-  if (!read_data_from_blocks(blocks, desc.position, buffer, bytes_to_read)) {
+  int tail_offset = InodeManager::tail_offset(inode);
+  if (!read_data_from_blocks(blocks, desc.position, buffer, bytes_to_read,
+                             tail_offset)) {
     return -1;
   }
 
-  // 更新文件位置
-  file_descriptors[fd].position += bytes_to_read;
-  update_file_access_time(desc.inode_num);
-
   return bytes_to_read;
 }
 
@@ -247,6 +260,18 @@ int FileManager::write_file(int fd, const char* buffer, int size) {
     return -1;
   }
 
+  // 写入触及共享尾块中的尾部（或越过它）时先把尾部搬回独占块，
+  // 写入路径只处理普通块布局；只改写前面私有块的写入不必搬动
+  if (InodeManager::is_tail_packed(inode) &&
+      desc.position + size > (inode.size - 1) / BLOCK_SIZE * BLOCK_SIZE) {
+    if (!inode_manager.unpack_tail(desc.inode_num) ||
+        !inode_manager.read_inode(desc.inode_num, inode)) {
+      ErrorHandler::log_error(
+          ERROR_IO_ERROR, "Failed to unpack file tail for fd=" + std::to_string(fd));
+      return -1;
+    }
+  }
+
   // 计算需要的块数
   int current_blocks = (inode.size + BLOCK_SIZE - 1) / BLOCK_SIZE;
   int required_blocks = (desc.position + size + BLOCK_SIZE - 1) / BLOCK_SIZE;
@@ -254,7 +279,7 @@ int FileManager::write_file(int fd, const char* buffer, int size) {
 
   // 分配额外的块（如果需要）
   if (additional_blocks > 0) {
-    std::vector<int> new_blocks;
+    BlockList new_blocks;
     if (!inode_manager.allocate_data_blocks(desc.inode_num, additional_blocks,
                                             new_blocks)) {
       ErrorHandler::log_error(
@@ -272,7 +297,7 @@ int FileManager::write_file(int fd, const char* buffer, int size) {
   }
 
   // 获取所有数据块
-  std::vector<int> blocks;
+  BlockList blocks;
   if (!inode_manager.get_data_blocks(desc.inode_num, blocks)) {
     ErrorHandler::log_error(
         ERROR_IO_ERROR,
@@ -298,6 +323,7 @@ int FileManager::write_file(int fd, const char* buffer, int size) {
   }
 
   file_descriptors[fd].position += size;
+  file_descriptors[fd].modified = true;
   return size;
 }
 
@@ -349,6 +375,7 @@ bool FileManager::allocate_file_descriptor(int inode_num, int mode, int& fd) {
   desc.mode = mode;
   desc.position = 0;
   desc.open = true;
+  desc.modified = false;
 
   file_descriptors[fd] = desc;
   return true;
@@ -368,8 +395,11 @@ bool FileManager::get_file_descriptor(int fd, FileDescriptor& desc) {
   return true;
 }
 
-// 更新文件访问时间
+// 更新文件访问时间（只读挂载时不写回）
 void FileManager::update_file_access_time(int inode_num) {
+  if (disk.is_read_only()) {
+    return;
+  }
   Inode inode;
   if (inode_manager.read_inode(inode_num, inode)) {
     inode.access_time = time(nullptr);
@@ -377,8 +407,11 @@ void FileManager::update_file_access_time(int inode_num) {
   }
 }
 
-// 更新文件修改时间
+// 更新文件修改时间（只读挂载时不写回）
 void FileManager::update_file_modification_time(int inode_num) {
+  if (disk.is_read_only()) {
+    return;
+  }
   Inode inode;
   if (inode_manager.read_inode(inode_num, inode)) {
     inode.modification_time = time(nullptr);
@@ -409,10 +442,11 @@ void FileManager::free_file_descriptor(int fd) {
 }
 
 // 从数据块读取数据到缓冲区
-bool FileManager::read_data_from_blocks(const std::vector<int>& blocks,
-                                        int offset, char* buffer, int size) {
+bool FileManager::read_data_from_blocks(const BlockList& blocks,
+                                        int offset, char* buffer, int size,
+                                        int tail_offset) {
   if (!FileOperationsUtils::read_data_from_blocks(disk, blocks, offset, buffer,
-                                                  size)) {
+                                                  size, tail_offset)) {
     ErrorHandler::log_error(
         ERROR_IO_ERROR,
         "Failed to read data blocks at offset " + std::to_string(offset));
@@ -422,7 +456,7 @@ bool FileManager::read_data_from_blocks(const std::vector<int>& blocks,
 }
 
 // 将缓冲区数据写入到数据块
-bool FileManager::write_data_to_blocks(const std::vector<int>& blocks,
+bool FileManager::write_data_to_blocks(const BlockList& blocks,
                                        int offset, const char* buffer,
                                        int size) {
   if (!FileOperationsUtils::write_data_to_blocks(disk, blocks, offset, buffer,
@@ -436,11 +470,12 @@ bool FileManager::write_data_to_blocks(const std::vector<int>& blocks,
 }
 
 // 分配文件inode
-int FileManager::allocate_file_inode(const std::string& filename) {
+int FileManager::allocate_file_inode(std::string_view filename) {
   int new_inode;
   if (!inode_manager.allocate_inode(new_inode)) {
     ErrorHandler::log_error(ERROR_NO_FREE_INODES,
-                            "Failed to allocate inode for file: " + filename);
+                            "Failed to allocate inode for file: " +
+                                std::string(filename));
     return -1;
   }
 
@@ -450,7 +485,8 @@ int FileManager::allocate_file_inode(const std::string& filename) {
 
   if (!inode_manager.write_inode(new_inode, inode)) {
     ErrorHandler::log_error(ERROR_IO_ERROR,
-                            "Failed to write inode for file: " + filename);
+                            "Failed to write inode for file: " +
+                                std::string(filename));
     inode_manager.free_inode(new_inode);
     return -1;
   }
@@ -6,6 +6,7 @@
 #pragma once
 #include <map>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include "../utils/block_utils.h"
@@ -74,6 +75,17 @@ class FileManager {
    */
   int read_file(int fd, char* buffer, int size);
 
+  /**
+   * @brief 从描述符快照记录的位置读取数据，不修改描述符表也不更新访问时间。
+   * @details 供只读挂载下的并发读取使用，调用方负责推进读写位置。
+   * @param fd 文件描述符（仅用于错误信息）。
+   * @param desc 文件描述符信息的快照。
+   * @param buffer 用于存储读取数据的缓冲区。
+   * @param size 要读取的字节数。
+   * @return int 实际读取的字节数，失败返回-1。
+   */
+  int read_file_at(int fd, const FileDescriptor& desc, char* buffer, int size);
+
   /**
    * @brief 向文件中写入数据。
    * @param fd 文件描述符。
@@ -116,13 +128,13 @@ class FileManager {
   bool get_file_descriptor(int fd, FileDescriptor& desc);
 
   /**
-   * @brief 更新文件访问时间。
+   * @brief 更新文件访问时间（只读挂载时跳过）。
    * @param inode_num inode号。
    */
   void update_file_access_time(int inode_num);
 
   /**
-   * @brief 更新文件修改时间。
+   * @brief 更新文件修改时间（只读挂载时跳过）。
    * @param inode_num inode号。
    */
   void update_file_modification_time(int inode_num);
@@ -145,10 +157,11 @@ class FileManager {
    * @param offset 偏移量。
    * @param buffer 输出缓冲区。
    * @param size 要读取的大小。
+   * @param tail_offset 最后一块为共享尾块时尾部在块内的偏移（默认0）。
    * @return bool 读取成功返回true，否则返回false。
    */
-  bool read_data_from_blocks(const std::vector<int>& blocks, int offset,
-                             char* buffer, int size);
+  bool read_data_from_blocks(const BlockList& blocks, int offset,
+                             char* buffer, int size, int tail_offset = 0);
 
   /**
    * @brief 将缓冲区数据写入到数据块。
@@ -158,7 +171,7 @@ class FileManager {
    * @param size 要写入的大小。
    * @return bool 写入成功返回true，否则返回false。
    */
-  bool write_data_to_blocks(const std::vector<int>& blocks, int offset,
+  bool write_data_to_blocks(const BlockList& blocks, int offset,
                             const char* buffer, int size);
 
   /**
@@ -166,7 +179,7 @@ class FileManager {
    * @param filename 文件名。
    * @return int 分配的inode号，失败返回-1。
    */
-  int allocate_file_inode(const std::string& filename);
+  int allocate_file_inode(std::string_view filename);
 
  private:
   DiskSimulator& disk;          ///< 磁盘模拟器引用
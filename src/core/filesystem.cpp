@@ -14,11 +14,14 @@
 FileSystem::FileSystem()
     : inode_manager(disk),
       mounted(false),
+      read_only_(false),
       next_fd(3),
       path_manager(disk, inode_manager),
-      directory_manager(disk, inode_manager, path_manager),
+      directory_manager(disk, inode_manager, path_manager, name_index),
       file_manager(disk, inode_manager, path_manager, directory_manager,
-                   file_descriptors, next_fd) {
+                   file_descriptors, next_fd),
+      cache_warmer_(*this),
+      defragmenter_(*this) {
 }
 
 // 文件系统析构函数，确保在销毁时卸载文件系统
@@ -29,45 +32,105 @@ FileSystem::~FileSystem() {
 }
 
 // 挂载文件系统，从磁盘文件加载超级块和位图
-bool FileSystem::mount(const std::string& disk_path) {
+bool FileSystem::mount(const std::string& disk_path, bool read_only) {
+  SlowOpWatchdog::Operation op("mount", disk_path);
+  return mount_internal(disk_path, true, read_only);
+}
+
+// 挂载文件系统；with_mounts 为 true 时同时挂载镜像挂载表中记录的子镜像，
+// read_only 为 true 时以共享锁只读打开镜像，所有元数据写入（含访问时间）都被跳过或拒绝
+bool FileSystem::mount_internal(const std::string& disk_path,
+                                bool with_mounts, bool read_only) {
   if (mounted) {
     ErrorHandler::log_error(ERROR_INVALID_ARGUMENT,
                             "File system already mounted");
     return false;
   }
 
-  if (!disk.open_disk(disk_path)) {
+  // 分片清单：由路由器挂载各分片，自身不打开磁盘
+  if (ShardRouter::is_manifest(disk_path)) {
+    auto router = std::make_unique<ShardRouter>();
+    if (!router->open(disk_path, read_only)) {
+      return false;
+    }
+    shard_router_ = std::move(router);
+    read_only_ = read_only;
+    mounted = true;
+    return true;
+  }
+
+  if (!disk.open_disk(disk_path, read_only)) {
     return false;
   }
+  read_only_ = read_only;
 
   if (!initialize_after_open()) {
     disk.close_disk();
+    read_only_ = false;
+    return false;
+  }
+
+  if (!name_index.open(disk_path, read_only)) {
+    disk.close_disk();
+    read_only_ = false;
     return false;
   }
 
   mounted = true;
+  if (with_mounts) {
+    mount_table.open(disk_path, read_only);
+  }
+  // 后台预热上次记录的热点，挂载不等待预热完成
+  cache_warmer_.start(disk_path, read_only);
   return true;
 }
 
 // 卸载文件系统，关闭所有打开的文件并关闭磁盘
 bool FileSystem::unmount() {
+  SlowOpWatchdog::Operation op("unmount");
   if (!ensure_mounted("unmount")) {
     return false;
   }
 
+  if (shard_router_) {
+    shard_router_->close();
+    shard_router_.reset();
+    mounted = false;
+    read_only_ = false;
+    return true;
+  }
+
+  // 先停止后台整理，再在缓存仍然有效时记录热点集合
+  defragmenter_.stop();
+  cache_warmer_.stop();
+  mount_table.close();
   close_all_files();
+  directory_manager.clear_snapshots();
+  path_manager.clear_cache();
+  inode_manager.clear_cache();
+  name_index.close();
   disk.close_disk();
   mounted = false;
+  read_only_ = false;
   return true;
 }
 
 // 格式化已挂载的文件系统，重新加载位图
 bool FileSystem::format() {
+  SlowOpWatchdog::Operation op("format");
+  // 格式化会清空位图，后台整理预留的区间随之失效
+  defragmenter_.stop();
   auto guard = acquire_unique_lock();
-  if (!ensure_mounted("format")) {
+  if (!ensure_mounted("format") || !ensure_writable("format")) {
     return false;
   }
 
+  if (shard_router_) {
+    return shard_router_->format();
+  }
+
+  directory_manager.clear_snapshots();
+  path_manager.clear_cache();
   if (!disk.format_disk()) {
     return false;
   }
@@ -88,7 +151,11 @@ bool FileSystem::format() {
     return false;
   }
 
-  return true;
+  // 挂载点目录已随格式化消失，挂载表一并清空
+  if (!mount_table.clear()) {
+    return false;
+  }
+  return name_index.reset();
 }
 
 // 检查文件系统是否已挂载
@@ -97,35 +164,52 @@ bool FileSystem::is_mounted() const {
   return mounted;
 }
 
+// 检查文件系统是否为只读挂载
+bool FileSystem::is_read_only() const {
+  auto guard = acquire_shared_lock();
+  return read_only_;
+}
+
 // 创建新文件，分配inode并在父目录中添加条目
 int FileSystem::create_file(const std::string& path, int mode) {
-  auto guard = acquire_unique_lock();
-  if (!ensure_mounted("create_file")) {
-    return -1;
+  SlowOpWatchdog::Operation op("create_file", path);
+  if (shard_router_) {
+    return shard_router_->create_file(path, mode);
   }
 
-  std::string normalized_path = PathUtils::normalize_path(path);
+  std::string normalized_storage;
+  const std::string& normalized_path =
+      PathUtils::normalize_path(path, normalized_storage);
+  MountTable::Route route;
+  if (mount_table.resolve(normalized_path, route)) {
+    return route.fs->create_file(route.path, mode);
+  }
 
-  // 检查文件是否已存在
-  if (path_manager.file_exists(normalized_path)) {
-    ErrorHandler::log_error(ERROR_FILE_ALREADY_EXISTS,
-                            "File already exists: " + normalized_path);
+  auto guard = acquire_unique_lock();
+  if (!ensure_mounted("create_file") || !ensure_writable("create_file")) {
     return -1;
   }
 
-  // 使用辅助方法验证和解析路径
-  std::string filename, directory;
-  if (!validate_and_parse_path(normalized_path, filename, directory)) {
+  if (ErrorHandler::is_error(PathUtils::validate_path(normalized_path))) {
+    ErrorHandler::log_error(ERROR_INVALID_PATH, "Invalid path: " + normalized_path);
     return -1;
   }
 
-  // 查找父目录inode
-  int parent_inode = path_manager.find_inode(directory);
-  if (parent_inode == -1) {
+  // 一遍解析同时得到父目录、文件是否已存在与文件名
+  ResolvedPath resolved;
+  if (!path_manager.resolve(normalized_path, resolved)) {
     ErrorHandler::log_error(ERROR_FILE_NOT_FOUND,
-                            "Parent directory not found: " + directory);
+                            "Parent directory not found: " +
+                                std::string(PathManager::parent_view(normalized_path)));
+    return -1;
+  }
+  if (resolved.inode != -1) {
+    ErrorHandler::log_error(ERROR_FILE_ALREADY_EXISTS,
+                            "File already exists: " + normalized_path);
     return -1;
   }
+  int parent_inode = resolved.parent;
+  std::string_view filename = resolved.name;
 
   // 使用辅助方法分配和初始化文件inode
   int new_inode = allocate_file_inode(filename);
@@ -141,6 +225,7 @@ int FileSystem::create_file(const std::string& path, int mode) {
     return -1;
   }
 
+  // 尾部打包标志由文件系统维护，不接受调用方设置
   inode.mode = FILE_TYPE_REGULAR | mode;
   if (!inode_manager.write_inode(new_inode, inode)) {
     ErrorHandler::log_error(ERROR_IO_ERROR, "Failed to update inode mode");
@@ -151,7 +236,8 @@ int FileSystem::create_file(const std::string& path, int mode) {
   // 将目录条目添加到父目录
   if (!add_directory_entry(parent_inode, filename, new_inode)) {
     ErrorHandler::log_error(ERROR_IO_ERROR,
-                            "Failed to add directory entry for: " + filename);
+                            "Failed to add directory entry for: " +
+                                std::string(filename));
     inode_manager.free_inode(new_inode);
     return -1;
   }
@@ -161,19 +247,32 @@ int FileSystem::create_file(const std::string& path, int mode) {
 
 // 删除文件，从父目录中移除条目并释放inode和数据块
 bool FileSystem::delete_file(const std::string& path) {
+  SlowOpWatchdog::Operation op("delete_file", path);
+  if (shard_router_) {
+    return shard_router_->delete_file(path);
+  }
+
+  std::string normalized_storage;
+  const std::string& normalized_path =
+      PathUtils::normalize_path(path, normalized_storage);
+  MountTable::Route route;
+  if (mount_table.resolve(normalized_path, route)) {
+    return route.fs->delete_file(route.path);
+  }
+
   auto guard = acquire_unique_lock();
-  if (!ensure_mounted("delete_file")) {
+  if (!ensure_mounted("delete_file") || !ensure_writable("delete_file")) {
     return false;
   }
 
-  std::string normalized_path = PathUtils::normalize_path(path);
-
-  int inode_num = path_manager.find_inode(normalized_path);
-  if (inode_num == -1) {
+  // 一遍解析同时得到文件与父目录，不再分别查找父路径与基本名称
+  ResolvedPath resolved;
+  if (!path_manager.resolve(normalized_path, resolved) || resolved.inode == -1) {
     ErrorHandler::log_error(ERROR_FILE_NOT_FOUND,
                             "File not found: " + normalized_path);
     return false;
   }
+  int inode_num = resolved.inode;
 
   Inode inode;
   if (!inode_manager.read_inode(inode_num, inode)) {
@@ -187,50 +286,101 @@ bool FileSystem::delete_file(const std::string& path) {
     return false;
   }
 
-  std::string basename;
-  std::string parent_path;
-  if (!validate_and_parse_path(normalized_path, basename, parent_path)) {
-    return false;
-  }
-
-  int parent_inode = path_manager.find_inode(parent_path);
-  if (parent_inode == -1) {
-    return false;
-  }
-
   // 从父目录中移除条目
-  if (!remove_directory_entry(parent_inode, basename)) {
+  if (!remove_directory_entry(resolved.parent, resolved.name)) {
     return false;
   }
 
   // 释放inode和数据块
+  defragmenter_.note_modified(inode_num);
   return inode_manager.free_inode(inode_num);
 }
 
 // 检查文件是否存在
 bool FileSystem::file_exists(const std::string& path) {
+  if (shard_router_) {
+    return shard_router_->file_exists(path);
+  }
+
+  std::string normalized_storage;
+  const std::string& normalized_path =
+      PathUtils::normalize_path(path, normalized_storage);
+  MountTable::Route route;
+  if (mount_table.resolve(normalized_path, route)) {
+    return route.fs->file_exists(route.path);
+  }
+
   auto guard = acquire_shared_lock();
   if (!ensure_mounted("file_exists")) {
     return false;
   }
 
-  std::string normalized_path = PathUtils::normalize_path(path);
   return path_manager.file_exists(normalized_path);
 }
 
 // 打开文件，分配文件描述符
 int FileSystem::open_file(const std::string& path, int mode) {
+  SlowOpWatchdog::Operation op("open_file", path);
+  if (shard_router_) {
+    return shard_router_->open_file(path, mode);
+  }
+
+  std::string normalized_storage;
+  const std::string& normalized_path =
+      PathUtils::normalize_path(path, normalized_storage);
+  MountTable::Route route;
+  if (mount_table.resolve(normalized_path, route)) {
+    int child_fd = route.fs->open_file(route.path, mode);
+    return child_fd < 0 ? child_fd
+                        : mount_table.register_fd(route.fs, child_fd);
+  }
+
+  if (read_only_) {
+    if (mode & (OPEN_MODE_WRITE | OPEN_MODE_CREATE | OPEN_MODE_APPEND)) {
+      ensure_writable("open_file");
+      return -1;
+    }
+    auto guard = acquire_shared_lock();
+    if (!ensure_mounted("open_file")) {
+      return -1;
+    }
+    FdGuard fd_guard(fd_mutex_);
+    return file_manager.open_file(normalized_path, mode);
+  }
+
   auto guard = acquire_unique_lock();
   if (!ensure_mounted("open_file")) {
     return -1;
   }
 
-  std::string normalized_path = PathUtils::normalize_path(path);
   return file_manager.open_file(normalized_path, mode);
 }
 
 // 关闭文件，释放文件描述符并更新修改时间
 bool FileSystem::close_file(int fd) {
+  SlowOpWatchdog::Operation op("close_file", fd);
+  if (shard_router_) {
+    return shard_router_->close_file(fd);
+  }
+
+  MountTable::FdRoute route;
+  if (mount_table.resolve_fd(fd, route)) {
+    if (!route.fs->close_file(route.fd)) {
+      return false;
+    }
+    mount_table.release_fd(fd);
+    return true;
+  }
+
+  if (read_only_) {
+    auto guard = acquire_shared_lock();
+    if (!ensure_mounted("close_file")) {
+      return false;
+    }
+    FdGuard fd_guard(fd_mutex_);
+    return close_file_internal(fd);
+  }
+
   auto guard = acquire_unique_lock();
   if (!ensure_mounted("close_file")) {
     return false;
@@ -245,6 +395,20 @@ bool FileSystem::close_file_internal(int fd) {
 
 // 从文件中读取数据
 int FileSystem::read_file(int fd, char* buffer, int size) {
+  SlowOpWatchdog::Operation op("read_file", fd);
+  if (shard_router_) {
+    return shard_router_->read_file(fd, buffer, size);
+  }
+
+  MountTable::FdRoute route;
+  if (mount_table.resolve_fd(fd, route)) {
+    return route.fs->read_file(route.fd, buffer, size);
+  }
+
+  if (read_only_ || opened_read_only(fd)) {
+    return read_file_shared(fd, buffer, size);
+  }
+
   auto guard = acquire_unique_lock();
   if (!ensure_mounted("read_file")) {
     return -1;
@@ -253,18 +417,87 @@ int FileSystem::read_file(int fd, char* buffer, int size) {
   return file_manager.read_file(fd, buffer, size);
 }
 
+// 描述符是否只以读方式打开；这样的描述符在可写挂载上也走共享锁读取
+bool FileSystem::opened_read_only(int fd) const {
+  auto guard = acquire_shared_lock();
+  FdGuard fd_guard(fd_mutex_);
+  auto it = file_descriptors.find(fd);
+  return it != file_descriptors.end() && !(it->second.mode & OPEN_MODE_WRITE);
+}
+
+// 共享锁下的读取（只读挂载，或可写挂载上只读打开的描述符）：写者持独占锁，
+// 读取期间不会有写入；描述符表仅在取快照和推进位置时加锁。访问时间只在
+// 打开时更新，读取本身不写 inode
+int FileSystem::read_file_shared(int fd, char* buffer, int size) {
+  auto guard = acquire_shared_lock();
+  if (!ensure_mounted("read_file")) {
+    return -1;
+  }
+
+  FileDescriptor desc;
+  {
+    FdGuard fd_guard(fd_mutex_);
+    if (!file_manager.get_file_descriptor(fd, desc)) {
+      return -1;
+    }
+  }
+
+  int bytes_read = file_manager.read_file_at(fd, desc, buffer, size);
+  if (bytes_read > 0) {
+    FdGuard fd_guard(fd_mutex_);
+    auto it = file_descriptors.find(fd);
+    if (it != file_descriptors.end()) {
+      it->second.position = desc.position + bytes_read;
+    }
+  }
+  return bytes_read;
+}
+
 // 向文件中写入数据
 int FileSystem::write_file(int fd, const char* buffer, int size) {
+  SlowOpWatchdog::Operation op("write_file", fd);
+  if (shard_router_) {
+    return shard_router_->write_file(fd, buffer, size);
+  }
+
+  MountTable::FdRoute route;
+  if (mount_table.resolve_fd(fd, route)) {
+    return route.fs->write_file(route.fd, buffer, size);
+  }
+
   auto guard = acquire_unique_lock();
-  if (!ensure_mounted("write_file")) {
+  if (!ensure_mounted("write_file") || !ensure_writable("write_file")) {
     return -1;
   }
 
+  auto it = file_descriptors.find(fd);
+  if (it != file_descriptors.end()) {
+    defragmenter_.note_modified(it->second.inode_num);
+  }
+
   return file_manager.write_file(fd, buffer, size);
 }
 
 // 设置文件读写位置
 bool FileSystem::seek_file(int fd, int position) {
+  if (shard_router_) {
+    return shard_router_->seek_file(fd, position);
+  }
+
+  MountTable::FdRoute route;
+  if (mount_table.resolve_fd(fd, route)) {
+    return route.fs->seek_file(route.fd, position);
+  }
+
+  if (read_only_) {
+    auto guard = acquire_shared_lock();
+    if (!ensure_mounted("seek_file")) {
+      return false;
+    }
+    FdGuard fd_guard(fd_mutex_);
+    return file_manager.seek_file(fd, position);
+  }
+
   auto guard = acquire_unique_lock();
   if (!ensure_mounted("seek_file")) {
     return false;
@@ -275,40 +508,145 @@ bool FileSystem::seek_file(int fd, int position) {
 
 // 创建新目录，分配inode并初始化目录结构
 bool FileSystem::create_directory(const std::string& path) {
+  SlowOpWatchdog::Operation op("create_directory", path);
+  if (shard_router_) {
+    return shard_router_->create_directory(path);
+  }
+
+  std::string normalized_storage;
+  const std::string& normalized_path =
+      PathUtils::normalize_path(path, normalized_storage);
+  MountTable::Route route;
+  if (mount_table.resolve(normalized_path, route)) {
+    return route.fs->create_directory(route.path);
+  }
+
   auto guard = acquire_unique_lock();
-  if (!ensure_mounted("create_directory")) {
+  if (!ensure_mounted("create_directory") || !ensure_writable("create_directory")) {
     return false;
   }
 
-  std::string normalized_path = PathUtils::normalize_path(path);
   return directory_manager.create_directory(normalized_path);
 }
 
+// 批量创建目录与文件：整批只加一次独占锁，适合复制目录树时成批建立结构
+bool FileSystem::create_batch(
+    const std::vector<std::string>& directories,
+    const std::vector<std::pair<std::string, int>>& files) {
+  SlowOpWatchdog::Operation op("create_batch");
+
+  // 分片或落在挂载点下的路径需要逐个路由，退化为逐条调用公共接口
+  bool routed = shard_router_ != nullptr;
+  MountTable::Route route;
+  std::string normalized_storage;
+  for (const std::string& path : directories) {
+    routed = routed || mount_table.resolve(
+                           PathUtils::normalize_path(path, normalized_storage), route);
+  }
+  for (const auto& file : files) {
+    routed = routed || mount_table.resolve(
+                           PathUtils::normalize_path(file.first, normalized_storage), route);
+  }
+  if (routed) {
+    for (const std::string& path : directories) {
+      if (!create_directory(path)) {
+        return false;
+      }
+    }
+    for (const auto& file : files) {
+      if (create_file(file.first, file.second) == -1) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  auto guard = acquire_unique_lock();
+  if (!ensure_mounted("create_batch") || !ensure_writable("create_batch")) {
+    return false;
+  }
+
+  for (const std::string& path : directories) {
+    if (!directory_manager.create_directory(
+            PathUtils::normalize_path(path, normalized_storage))) {
+      return false;
+    }
+  }
+  for (const auto& file : files) {
+    if (file_manager.create_file(PathUtils::normalize_path(file.first, normalized_storage),
+                                 file.second) == -1) {
+      return false;
+    }
+  }
+  return true;
+}
+
 // 列出目录内容，返回目录条目列表
 bool FileSystem::list_directory(const std::string& path,
                                 std::vector<DirectoryEntry>& entries) {
-  auto guard = acquire_shared_lock();
-  if (!ensure_mounted("list_directory")) {
+  SlowOpWatchdog::Operation op("list_directory", path);
+  if (shard_router_) {
+    return shard_router_->list_directory(path, entries);
+  }
+
+  std::string normalized_storage;
+  const std::string& normalized_path =
+      PathUtils::normalize_path(path, normalized_storage);
+  MountTable::Route route;
+  if (mount_table.resolve(normalized_path, route)) {
+    return route.fs->list_directory(route.path, entries);
+  }
+
+  // 只在解析路径并固定目录版本期间持有共享锁，复制条目时不持锁，
+  // 大目录的列举因此不会拖住等待独占锁的写者；纪元保护保证复制完成前
+  // 被换下的版本不会释放
+  EpochReclaimer::Guard epoch_guard;
+  DirectorySnapshot snapshot;
+  {
+    auto guard = acquire_shared_lock();
+    if (!ensure_mounted("list_directory")) {
+      return false;
+    }
+
+    snapshot = directory_manager.pin_directory(normalized_path);
+  }
+  if (!snapshot) {
     return false;
   }
 
-  std::string normalized_path = PathUtils::normalize_path(path);
-  return directory_manager.list_directory(normalized_path, entries);
+  entries.assign(snapshot->entries.begin(), snapshot->entries.end());
+  return true;
 }
 
 // 删除目录，检查是否为空后释放资源
 bool FileSystem::remove_directory(const std::string& path) {
+  SlowOpWatchdog::Operation op("remove_directory", path);
+  if (shard_router_) {
+    return shard_router_->remove_directory(path);
+  }
+
+  std::string normalized_storage;
+  const std::string& normalized_path =
+      PathUtils::normalize_path(path, normalized_storage);
+  MountTable::Route route;
+  if (mount_table.resolve(normalized_path, route)) {
+    return route.fs->remove_directory(route.path);
+  }
+
   auto guard = acquire_unique_lock();
-  if (!ensure_mounted("remove_directory")) {
+  if (!ensure_mounted("remove_directory") || !ensure_writable("remove_directory")) {
     return false;
   }
 
-  std::string normalized_path = PathUtils::normalize_path(path);
   return directory_manager.remove_directory(normalized_path);
 }
 
 // 获取磁盘信息，包括大小、块数、inode数等
 bool FileSystem::get_disk_info(std::string& info) {
+  if (shard_router_) {
+    return shard_router_->get_disk_info(info);
+  }
+
   auto guard = acquire_shared_lock();
   if (!ensure_mounted("get_disk_info")) {
     return false;
@@ -323,6 +661,11 @@ bool FileSystem::get_disk_info(std::string& info) {
   oss << "  Free Blocks: " << inode_manager.get_free_data_blocks() << std::endl;
   oss << "  Total Inodes: " << inode_manager.get_total_inodes() << std::endl;
   oss << "  Free Inodes: " << inode_manager.get_free_inodes() << std::endl;
+  std::size_t packed_tails = 0;
+  std::size_t tail_blocks = 0;
+  inode_manager.get_tail_stats(packed_tails, tail_blocks);
+  oss << "  Packed Tails: " << packed_tails << " files in " << tail_blocks
+      << " shared blocks" << std::endl;
   oss << "  Mount Time: " << ctime(&superblock.mount_time);
   oss << "  Write Time: " << ctime(&superblock.write_time);
 
@@ -330,13 +673,304 @@ bool FileSystem::get_disk_info(std::string& info) {
   return true;
 }
 
+// 获取块设备模式与I/O统计（顺序/寻道次数、模拟设备时间等）
+bool FileSystem::get_device_stats(std::string& report) {
+  if (shard_router_) {
+    return shard_router_->get_device_stats(report);
+  }
+
+  auto guard = acquire_shared_lock();
+  if (!ensure_mounted("get_device_stats")) {
+    return false;
+  }
+
+  report = disk.get_device_report();
+  mount_table.for_each([&](const MountInfo& info, FileSystem& child) {
+    std::string child_report;
+    if (child.get_device_stats(child_report)) {
+      report += "Mount " + info.mount_point + " (" + info.image_path + "):\n";
+      report += child_report;
+    }
+  });
+  return true;
+}
+
+// 缓存热点集合的预热与写回状态（分片模式下逐个分片列出）
+bool FileSystem::get_warm_set_status(std::string& status) {
+  if (shard_router_) {
+    return shard_router_->get_warm_set_status(status);
+  }
+  if (!ensure_mounted("get_warm_set_status")) {
+    return false;
+  }
+  status = cache_warmer_.status() + "\n";
+  return true;
+}
+
+// 开始或停止记录块访问热度；挂载点上的子镜像一并切换
+bool FileSystem::set_heatmap_enabled(bool enabled) {
+  if (shard_router_) {
+    return shard_router_->set_heatmap_enabled(enabled);
+  }
+
+  auto guard = acquire_shared_lock();
+  if (!ensure_mounted("set_heatmap_enabled")) {
+    return false;
+  }
+  disk.heatmap().set_enabled(enabled);
+  mount_table.for_each([&](const MountInfo&, FileSystem& child) {
+    child.set_heatmap_enabled(enabled);
+  });
+  return true;
+}
+
+// 清空块访问热度统计
+bool FileSystem::reset_heatmap() {
+  if (shard_router_) {
+    return shard_router_->reset_heatmap();
+  }
+
+  auto guard = acquire_shared_lock();
+  if (!ensure_mounted("reset_heatmap")) {
+    return false;
+  }
+  disk.heatmap().reset();
+  mount_table.for_each([&](const MountInfo&, FileSystem& child) {
+    child.reset_heatmap();
+  });
+  return true;
+}
+
+// 块访问热度报告（计数为原子量，只需共享锁保证磁盘保持挂载）
+bool FileSystem::get_heatmap_report(std::string& report) {
+  if (shard_router_) {
+    return shard_router_->get_heatmap_report(report);
+  }
+
+  auto guard = acquire_shared_lock();
+  if (!ensure_mounted("get_heatmap_report")) {
+    return false;
+  }
+  report = disk.heatmap().report(disk.calculate_layout());
+  mount_table.for_each([&](const MountInfo& info, FileSystem& child) {
+    std::string child_report;
+    if (child.get_heatmap_report(child_report)) {
+      report += "Mount " + info.mount_point + " (" + info.image_path + "):\n";
+      report += child_report;
+    }
+  });
+  return true;
+}
+
+// 清空内部缓存并丢弃宿主机页缓存，使后续访问从磁盘冷启动
+bool FileSystem::drop_caches() {
+  SlowOpWatchdog::Operation op("drop_caches");
+  if (shard_router_) {
+    return shard_router_->drop_caches();
+  }
+
+  auto guard = acquire_unique_lock();
+  if (!ensure_mounted("drop_caches")) {
+    return false;
+  }
+
+  // 三类缓存都是写穿的，直接清空不会丢失数据
+  directory_manager.clear_snapshots();
+  path_manager.clear_cache();
+  inode_manager.clear_cache();
+  bool ok = disk.drop_host_cache();
+  mount_table.for_each([&](const MountInfo&, FileSystem& child) {
+    ok = child.drop_caches() && ok;
+  });
+  return ok;
+}
+
+// 立即巡检所有带校验和的块，生成巡检报告
+bool FileSystem::scrub(std::string& report, bool& corrupted) {
+  SlowOpWatchdog::Operation op("scrub");
+  if (shard_router_) {
+    return shard_router_->scrub(report, corrupted);
+  }
+
+  auto guard = acquire_shared_lock();
+  if (!ensure_mounted("scrub")) {
+    return false;
+  }
+
+  ScrubReport result;
+  if (!disk.scrub(result)) {
+    return false;
+  }
+
+  std::ostringstream oss;
+  oss << "Scrub complete: " << result.scanned << " blocks checked, "
+      << result.corrupted << " corrupted" << std::endl;
+  if (!result.bad_blocks.empty()) {
+    oss << "  Corrupted blocks:";
+    for (int block : result.bad_blocks) {
+      oss << " " << block;
+    }
+    oss << std::endl;
+  }
+  report = oss.str();
+  corrupted = result.corrupted > 0;
+  return true;
+}
+
+// 修改读取时的块校验策略（持久化到校验和头）
+bool FileSystem::set_verify_policy(ChecksumPolicy policy) {
+  if (shard_router_) {
+    return shard_router_->set_verify_policy(policy);
+  }
+
+  auto guard = acquire_unique_lock();
+  if (!ensure_mounted("set_verify_policy") ||
+      !ensure_writable("set_verify_policy")) {
+    return false;
+  }
+  return disk.set_checksum_policy(policy);
+}
+
+// 整理路径下的碎片文件；路径落在挂载点内时交给子文件系统
+bool FileSystem::defragment(const std::string& path,
+                            std::string& report) {
+  SlowOpWatchdog::Operation op("defragment", path);
+  if (shard_router_) {
+    return shard_router_->defragment(path, report);
+  }
+
+  std::string normalized_storage;
+  const std::string& normalized_path =
+      PathUtils::normalize_path(path, normalized_storage);
+  MountTable::Route route;
+  if (mount_table.resolve(normalized_path, route)) {
+    return route.fs->defragment(route.path, report);
+  }
+
+  // 整理过程逐文件、逐批自行加锁，这里不持有文件系统锁
+  DefragStats stats;
+  if (!defragmenter_.run(normalized_path, stats)) {
+    return false;
+  }
+  report = stats.summary() + "\n";
+  return true;
+}
+
+// 启动后台碎片整理线程
+bool FileSystem::start_background_defrag() {
+  if (shard_router_) {
+    return shard_router_->start_background_defrag();
+  }
+
+  {
+    auto guard = acquire_shared_lock();
+    if (!ensure_mounted("defrag") || !ensure_writable("defrag")) {
+      return false;
+    }
+  }
+  return defragmenter_.start_background();
+}
+
+// 停止后台碎片整理线程
+bool FileSystem::stop_background_defrag() {
+  if (shard_router_) {
+    return shard_router_->stop_background_defrag();
+  }
+  if (!ensure_mounted("defrag")) {
+    return false;
+  }
+  defragmenter_.stop();
+  return true;
+}
+
+// 碎片整理状态（分片模式下逐个分片列出）
+bool FileSystem::get_defrag_status(std::string& status) {
+  if (shard_router_) {
+    return shard_router_->get_defrag_status(status);
+  }
+  if (!ensure_mounted("get_defrag_status")) {
+    return false;
+  }
+  status = defragmenter_.status() + "\n";
+  return true;
+}
+
+// 把镜像挂载到根文件系统中已存在的目录上
+bool FileSystem::attach_mount(const std::string& mount_point,
+                              const std::string& image_path) {
+  std::string normalized_path = PathUtils::normalize_path(mount_point);
+  {
+    auto guard = acquire_shared_lock();
+    if (!ensure_mounted("attach_mount") || !ensure_writable("attach_mount")) {
+      return false;
+    }
+    if (shard_router_) {
+      ErrorHandler::log_error(ERROR_MOUNT_FAILED,
+                              "Mounts are not supported on a sharded namespace");
+      return false;
+    }
+
+    MountTable::Route route;
+    if (mount_table.resolve(normalized_path, route)) {
+      ErrorHandler::log_error(ERROR_ALREADY_MOUNTED,
+                              "Mount point overlaps an existing mount: " +
+                                  normalized_path);
+      return false;
+    }
+
+    Inode inode;
+    int inode_num = path_manager.find_inode(normalized_path);
+    if (inode_num == -1 || !inode_manager.read_inode(inode_num, inode) ||
+        !(inode.mode & FILE_TYPE_DIRECTORY)) {
+      ErrorHandler::log_error(ERROR_NOT_A_DIRECTORY,
+                              "Mount point is not a directory: " +
+                                  normalized_path);
+      return false;
+    }
+  }
+
+  return mount_table.add(normalized_path, image_path);
+}
+
+// 卸载挂载点上的镜像
+bool FileSystem::detach_mount(const std::string& mount_point) {
+  if (!is_mounted()) {
+    return ensure_mounted("detach_mount");
+  }
+  if (is_read_only()) {
+    return ensure_writable("detach_mount");
+  }
+  return mount_table.remove(PathUtils::normalize_path(mount_point));
+}
+
+// 列出所有挂载点
+bool FileSystem::list_mounts(std::vector<MountInfo>& mounts) {
+  auto guard = acquire_shared_lock();
+  if (!ensure_mounted("list_mounts")) {
+    return false;
+  }
+  mount_table.list(mounts);
+  return true;
+}
+
 bool FileSystem::is_directory(const std::string& path) {
+  if (shard_router_) {
+    return shard_router_->is_directory(path);
+  }
+
+  std::string normalized_storage;
+  const std::string& normalized_path =
+      PathUtils::normalize_path(path, normalized_storage);
+  MountTable::Route route;
+  if (mount_table.resolve(normalized_path, route)) {
+    return route.fs->is_directory(route.path);
+  }
+
   auto guard = acquire_shared_lock();
   if (!ensure_mounted("is_directory")) {
     return false;
   }
 
-  std::string normalized_path = PathUtils::normalize_path(path);
   int inode_num = path_manager.find_inode(normalized_path);
   if (inode_num == -1) {
     return false;
@@ -350,6 +984,133 @@ bool FileSystem::is_directory(const std::string& path) {
   return (inode.mode & FILE_TYPE_DIRECTORY) != 0;
 }
 
+// 获取路径对应的inode元数据
+bool FileSystem::stat(const std::string& path, Inode& inode) {
+  SlowOpWatchdog::Operation op("stat", path);
+  if (shard_router_) {
+    return shard_router_->stat(path, inode);
+  }
+
+  std::string normalized_storage;
+  const std::string& normalized_path =
+      PathUtils::normalize_path(path, normalized_storage);
+  MountTable::Route route;
+  if (mount_table.resolve(normalized_path, route)) {
+    return route.fs->stat(route.path, inode);
+  }
+
+  auto guard = acquire_shared_lock();
+  if (!ensure_mounted("stat")) {
+    return false;
+  }
+
+  int inode_num = path_manager.find_inode(normalized_path);
+  if (inode_num == -1 || !inode_manager.read_inode(inode_num, inode)) {
+    return false;
+  }
+  return true;
+}
+
+// 通过全局文件名索引按名称查找路径
+bool FileSystem::locate(const std::string& name,
+                        std::vector<std::string>& paths) {
+  if (shard_router_) {
+    return shard_router_->locate(name, paths);
+  }
+
+  auto guard = acquire_shared_lock();
+  if (!ensure_mounted("locate")) {
+    return false;
+  }
+
+  if (!name_index.is_enabled()) {
+    ErrorHandler::log_error(
+        ERROR_INVALID_ARGUMENT,
+        "Name index is not enabled (run 'locate --build' first)");
+    return false;
+  }
+  if (!name_index.locate(name, paths)) {
+    return false;
+  }
+
+  // 启用了索引的挂载点也参与查找，结果加上挂载前缀
+  mount_table.for_each([&](const MountInfo& info, FileSystem& child) {
+    std::vector<std::string> child_paths;
+    if (!child.name_index_enabled() || !child.locate(name, child_paths)) {
+      return;
+    }
+    for (const std::string& child_path : child_paths) {
+      paths.push_back(child_path == "/" ? info.mount_point
+                                        : info.mount_point + child_path);
+    }
+  });
+  return true;
+}
+
+// 遍历目录树重建全局文件名索引
+bool FileSystem::build_name_index() {
+  SlowOpWatchdog::Operation op("build_name_index");
+  if (shard_router_) {
+    return shard_router_->build_name_index();
+  }
+
+  auto guard = acquire_unique_lock();
+  if (!ensure_mounted("build_name_index") || !ensure_writable("build_name_index")) {
+    return false;
+  }
+
+  std::vector<std::pair<std::string, NameIndexEntry>> collected;
+  std::vector<int> pending = {0};
+  while (!pending.empty()) {
+    int dir_inode = pending.back();
+    pending.pop_back();
+
+    std::vector<DirectoryEntry> entries;
+    if (!directory_manager.read_directory(dir_inode, entries)) {
+      return false;
+    }
+
+    for (const DirectoryEntry& entry : entries) {
+      std::string name(entry.name,
+                       strnlen(entry.name, MAX_FILENAME_LENGTH));
+      if (name.empty() || name == "." || name == "..") {
+        continue;
+      }
+      collected.push_back({name, {dir_inode, entry.inode_number}});
+
+      Inode inode;
+      if (inode_manager.read_inode(entry.inode_number, inode) &&
+          (inode.mode & FILE_TYPE_DIRECTORY)) {
+        pending.push_back(entry.inode_number);
+      }
+    }
+  }
+
+  return name_index.rebuild(disk.get_disk_path(), collected);
+}
+
+// 停用并删除全局文件名索引
+bool FileSystem::drop_name_index() {
+  if (shard_router_) {
+    return shard_router_->drop_name_index();
+  }
+
+  auto guard = acquire_unique_lock();
+  if (!ensure_mounted("drop_name_index") || !ensure_writable("drop_name_index")) {
+    return false;
+  }
+  return name_index.drop(disk.get_disk_path());
+}
+
+// 全局文件名索引是否启用
+bool FileSystem::name_index_enabled() const {
+  if (shard_router_) {
+    return shard_router_->name_index_enabled();
+  }
+
+  return name_index.is_enabled();
+}
+
 // 获取路径的父目录路径
 std::string FileSystem::get_parent_path(const std::string& path) {
   return path_manager.get_parent_path(path);
@@ -376,39 +1137,26 @@ int FileSystem::find_inode(const std::string& path) {
     return -1;
   }
 
-  std::string normalized_path = PathUtils::normalize_path(path);
-  return path_manager.find_inode(normalized_path);
+  std::string normalized_storage;
+  return path_manager.find_inode(PathUtils::normalize_path(path, normalized_storage));
 }
 
 // 在指定目录中查找文件或子目录的inode号
 int FileSystem::find_inode_in_directory(int parent_inode,
-                                        const std::string& name) {
-  // 此功能在path_manager内部使用
-  // 我们可以创建一个临时的直接实现或使用目录
-  // 管理器
-  std::vector<DirectoryEntry> entries;
-  if (!directory_manager.read_directory(parent_inode, entries)) {
-    return -1;
-  }
-
-  for (const DirectoryEntry& entry : entries) {
-    if (strcmp(entry.name, name.c_str()) == 0) {
-      return entry.inode_number;
-    }
-  }
-
-  return -1;
+                                        std::string_view name) {
+  // 经由路径管理器查找，命中目录项缓存时不读取目录
+  return path_manager.find_inode_in_directory(parent_inode, name);
 }
 
 // 在目录中添加新的条目
-bool FileSystem::add_directory_entry(int dir_inode, const std::string& name,
+bool FileSystem::add_directory_entry(int dir_inode, std::string_view name,
                                      int inode_num) {
   return directory_manager.add_directory_entry(dir_inode, name, inode_num);
 }
 
 // 从目录中移除条目
 bool FileSystem::remove_directory_entry(int dir_inode,
-                                        const std::string& name) {
+                                        std::string_view name) {
   return directory_manager.remove_directory_entry(dir_inode, name);
 }
 
@@ -431,7 +1179,7 @@ bool FileSystem::read_directory(int inode_num,
   }
 
   // 获取数据块
-  std::vector<int> blocks;
+  BlockList blocks;
   if (!inode_manager.get_data_blocks(inode_num, blocks)) {
     return false;
   }
@@ -459,6 +1207,10 @@ bool FileSystem::read_directory(int inode_num,
 // 写入目录内容到磁盘
 bool FileSystem::write_directory(int inode_num,
                                  const std::vector<DirectoryEntry>& entries) {
+  // 绕过目录管理器直接改写目录块，已发布的版本和目录项缓存随之失效
+  directory_manager.retire_snapshot(inode_num);
+  path_manager.clear_cache();
+
   // 读取目录inode
   Inode inode;
   if (!inode_manager.read_inode(inode_num, inode)) {
@@ -472,7 +1224,7 @@ bool FileSystem::write_directory(int inode_num,
   uint32_t required_blocks = BlockUtils::calculate_blocks_needed(required_size);
 
   // 获取当前块
-  std::vector<int> current_blocks;
+  BlockList current_blocks;
   if (!inode_manager.get_data_blocks(inode_num, current_blocks)) {
     ErrorHandler::log_error(ERROR_IO_ERROR,
                             "Failed to get data blocks for directory inode: " +
@@ -483,7 +1235,7 @@ bool FileSystem::write_directory(int inode_num,
   // 如果需要，分配额外的块
   if (current_blocks.size() < required_blocks) {
     uint32_t additional_blocks = required_blocks - current_blocks.size();
-    std::vector<int> new_blocks;
+    BlockList new_blocks;
     if (!inode_manager.allocate_data_blocks(inode_num, additional_blocks,
                                             new_blocks)) {
       ErrorHandler::log_error(
@@ -586,7 +1338,7 @@ void FileSystem::update_file_modification_time(int inode_num) {
 }
 
 // 从数据块读取数据到缓冲区
-bool FileSystem::read_data_from_blocks(const std::vector<int>& blocks,
+bool FileSystem::read_data_from_blocks(const BlockList& blocks,
                                        int offset, char* buffer, int size) {
   if (!ensure_mounted("read_data_from_blocks")) {
     return false;
@@ -596,7 +1348,7 @@ bool FileSystem::read_data_from_blocks(const std::vector<int>& blocks,
 }
 
 // 将缓冲区数据写入到数据块
-bool FileSystem::write_data_to_blocks(const std::vector<int>& blocks,
+bool FileSystem::write_data_to_blocks(const BlockList& blocks,
                                       int offset, const char* buffer,
                                       int size) {
   if (!ensure_mounted("write_data_to_blocks")) {
@@ -625,11 +1377,12 @@ void FileSystem::free_file_descriptor(int fd) {
 }
 
 // 辅助方法，用于分配和初始化文件inode
-int FileSystem::allocate_file_inode(const std::string& filename) {
+int FileSystem::allocate_file_inode(std::string_view filename) {
   int new_inode;
   if (!inode_manager.allocate_inode(new_inode)) {
     ErrorHandler::log_error(ERROR_NO_FREE_INODES,
-                            "Failed to allocate inode for file: " + filename);
+                            "Failed to allocate inode for file: " +
+                                std::string(filename));
     return -1;
   }
 
@@ -638,7 +1391,8 @@ int FileSystem::allocate_file_inode(const std::string& filename) {
 
   if (!inode_manager.write_inode(new_inode, inode)) {
     ErrorHandler::log_error(ERROR_IO_ERROR,
-                            "Failed to write inode for file: " + filename);
+                            "Failed to write inode for file: " +
+                                std::string(filename));
     inode_manager.free_inode(new_inode);
     return -1;
   }
@@ -749,7 +1503,7 @@ bool FileSystem::ensure_root_directory() {
     return true;
   }
 
-  std::vector<int> blocks;
+  BlockList blocks;
   if (!inode_manager.get_data_blocks(root_inode_num, blocks)) {
     return false;
   }
@@ -793,6 +1547,19 @@ bool FileSystem::initialize_after_open() {
     return false;
   }
 
+  // 只读挂载不能补建根目录，只检查它是否存在
+  if (disk.is_read_only()) {
+    Inode root_inode;
+    if (!inode_manager.is_inode_allocated(0) ||
+        !inode_manager.read_inode(0, root_inode) ||
+        !(root_inode.mode & FILE_TYPE_DIRECTORY)) {
+      ErrorHandler::log_error(ERROR_IO_ERROR,
+                              "Root directory missing on read-only image");
+      return false;
+    }
+    return true;
+  }
+
   if (!ensure_root_directory()) {
     ErrorHandler::log_error(ERROR_IO_ERROR,
                             "Failed to initialize root directory");
@@ -814,6 +1581,18 @@ bool FileSystem::ensure_mounted(const char* operation) const {
   return false;
 }
 
+bool FileSystem::ensure_writable(const char* operation) const {
+  if (!read_only_) {
+    return true;
+  }
+
+  std::string op_name = operation ? operation : "operation";
+  ErrorHandler::log_error(
+      ERROR_PERMISSION_DENIED,
+      op_name + " is not allowed: file system is mounted read-only");
+  return false;
+}
+
 void FileSystem::close_all_files() {
   std::vector<int> open_fds;
   open_fds.reserve(file_descriptors.size());
@@ -826,12 +1605,28 @@ void FileSystem::close_all_files() {
   }
 }
 
+// 先尝试不阻塞地取锁，取不到时触发 lock__contended 探针后再等待；
+// 等待时间计入慢操作看门狗的 lock wait 阶段
 std::shared_lock<std::shared_mutex> FileSystem::acquire_shared_lock() const {
-  return std::shared_lock<std::shared_mutex>(fs_mutex_);
+  SlowOpWatchdog::Phase phase(OpPhase::LockWait);
+  std::shared_lock<std::shared_mutex> lock(fs_mutex_, std::try_to_lock);
+  if (!lock.owns_lock()) {
+    DISKSIM_PROBE1(lock__contended, 0);
+    lock.lock();
+  }
+  DISKSIM_PROBE1(lock__acquired, 0);
+  return lock;
 }
 
 std::unique_lock<std::shared_mutex> FileSystem::acquire_unique_lock() const {
-  return std::unique_lock<std::shared_mutex>(fs_mutex_);
+  SlowOpWatchdog::Phase phase(OpPhase::LockWait);
+  std::unique_lock<std::shared_mutex> lock(fs_mutex_, std::try_to_lock);
+  if (!lock.owns_lock()) {
+    DISKSIM_PROBE1(lock__contended, 1);
+    lock.lock();
+  }
+  DISKSIM_PROBE1(lock__acquired, 1);
+  return lock;
 }
 
 // 使用PathUtils验证和解析路径的辅助方法
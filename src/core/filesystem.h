@@ -5,8 +5,10 @@
 
 #pragma once
 #include <map>
+#include <memory>
 #include <mutex>
 #include <shared_mutex>
+#include <string_view>
 #include <vector>
 
 #include "../utils/block_utils.h"
@@ -16,13 +18,20 @@
 #include "../utils/file_operations_utils.h"
 #include "../utils/path_utils.h"
 #include "../utils/path_utils_extended.h"
+#include "../utils/slow_op_watchdog.h"
+#include "../utils/trace_probes.h"
 #include "bitmap_manager.h"
 #include "block_manager.h"
+#include "cache_warmer.h"
+#include "defragmenter.h"
 #include "directory_manager.h"
 #include "disk_simulator.h"
 #include "file_manager.h"
 #include "inode_manager.h"
+#include "mount_table.h"
+#include "name_index.h"
 #include "path_manager.h"
+#include "shard_router.h"
 
 // 文件系统高级API
 class FileSystem {
@@ -32,14 +41,16 @@ class FileSystem {
   // 析构函数
   ~FileSystem();
 
-  // 挂载磁盘
-  bool mount(const std::string& disk_path);
+  // 挂载磁盘；read_only 为 true 时以共享锁只读挂载，允许多个进程同时读取
+  bool mount(const std::string& disk_path, bool read_only = false);
   // 卸载磁盘
   bool unmount();
   // 格式化文件系统
   bool format();
   // 检查文件系统是否已挂载
   bool is_mounted() const;
+  // 检查文件系统是否为只读挂载
+  bool is_read_only() const;
 
   // 创建文件
   int create_file(const std::string& path, int mode);
@@ -61,6 +72,9 @@ class FileSystem {
 
   // 创建目录
   bool create_directory(const std::string& path);
+  // 在一次独占锁内依次创建一批目录（父目录在前）和空文件（路径, 权限位），遇到第一个失败即返回
+  bool create_batch(const std::vector<std::string>& directories,
+                    const std::vector<std::pair<std::string, int>>& files);
   // 列出目录内容
   bool list_directory(const std::string& path,
                       std::vector<DirectoryEntry>& entries);
@@ -69,9 +83,53 @@ class FileSystem {
 
   // 获取磁盘信息
   bool get_disk_info(std::string& info);
+  // 获取块设备模式与I/O统计
+  bool get_device_stats(std::string& report);
+  // 缓存热点集合的预热与写回状态
+  bool get_warm_set_status(std::string& status);
+  // 开始或停止记录块访问热度
+  bool set_heatmap_enabled(bool enabled);
+  // 清空块访问热度统计
+  bool reset_heatmap();
+  // 块访问热度报告：区域强度、顺序/随机比例与最热的元数据块
+  bool get_heatmap_report(std::string& report);
+  // 清空目录快照、目录项缓存与 inode 缓存，并丢弃镜像的宿主机页缓存（冷缓存测量）
+  bool drop_caches();
+  // 立即巡检所有带校验和的块；corrupted 输出是否发现损坏
+  bool scrub(std::string& report, bool& corrupted);
+  // 修改读取时的块校验策略
+  bool set_verify_policy(ChecksumPolicy policy);
+
+  // 把路径下不连续的文件搬迁到连续区间，report 输出整理摘要
+  bool defragment(const std::string& path, std::string& report);
+  // 启动后台碎片整理线程
+  bool start_background_defrag();
+  // 停止后台碎片整理线程
+  bool stop_background_defrag();
+  // 碎片整理状态
+  bool get_defrag_status(std::string& status);
+
+  // 把镜像挂载到已存在的目录上（持久化到 <image>.mounts）
+  bool attach_mount(const std::string& mount_point,
+                    const std::string& image_path);
+  // 卸载挂载点上的镜像
+  bool detach_mount(const std::string& mount_point);
+  // 列出所有挂载点
+  bool list_mounts(std::vector<MountInfo>& mounts);
 
   // 判断路径是否为目录
   bool is_directory(const std::string& path);
+  // 获取路径对应的inode元数据（类型、大小、时间戳等）
+  bool stat(const std::string& path, Inode& inode);
+
+  // 通过全局文件名索引按名称查找路径（索引未启用时返回false）
+  bool locate(const std::string& name, std::vector<std::string>& paths);
+  // 遍历目录树重建并启用全局文件名索引
+  bool build_name_index();
+  // 停用并删除全局文件名索引
+  bool drop_name_index();
+  // 全局文件名索引是否启用
+  bool name_index_enabled() const;
 
   // 获取父路径
   std::string get_parent_path(const std::string& path);
@@ -79,18 +137,29 @@ class FileSystem {
   std::string get_basename(const std::string& path);
 
  private:
+  friend class CacheWarmer;
+  friend class Defragmenter;
+  friend class MountTable;
+  friend class ShardRouter;
+
   DiskSimulator disk;                              // 磁盘模拟器
   Superblock superblock;                           // 超级块
   InodeManager inode_manager;                      // Inode管理器
   DiskLayout layout;                               // 磁盘布局
   bool mounted;                                    // 挂载标志
+  bool read_only_;                                 // 只读挂载标志
   std::map<int, FileDescriptor> file_descriptors;  // 打开文件描述符表
   int next_fd;                                     // 下一个可用的文件描述符
 
   // 新增模块管理器
+  NameIndex name_index;                // 全局文件名索引
   PathManager path_manager;            // 路径管理器
   DirectoryManager directory_manager;  // 目录管理器
   FileManager file_manager;            // 文件管理器
+  MountTable mount_table;              // 子镜像挂载表
+  std::unique_ptr<ShardRouter> shard_router_;  // 分片模式下的命名空间路由器
+  CacheWarmer cache_warmer_;           // 缓存热点集合的后台预热与写回
+  Defragmenter defragmenter_;          // 在线碎片整理
 
   // --- 私有辅助函数 ---
   // 这些函数仅供内部使用，由公共方法调用
@@ -99,12 +168,12 @@ class FileSystem {
   // 查找路径对应的inode
   int find_inode(const std::string& path);
   // 在目录中查找inode
-  int find_inode_in_directory(int parent_inode, const std::string& name);
+  int find_inode_in_directory(int parent_inode, std::string_view name);
   // 添加目录项
-  bool add_directory_entry(int dir_inode, const std::string& name,
+  bool add_directory_entry(int dir_inode, std::string_view name,
                            int inode_num);
   // 删除目录项
-  bool remove_directory_entry(int dir_inode, const std::string& name);
+  bool remove_directory_entry(int dir_inode, std::string_view name);
   // 读取目录
   bool read_directory(int inode_num, std::vector<DirectoryEntry>& entries);
   // 写入目录
@@ -119,10 +188,10 @@ class FileSystem {
   // 更新文件修改时间
   void update_file_modification_time(int inode_num);
   // 从数据块读取数据
-  bool read_data_from_blocks(const std::vector<int>& blocks, int offset,
+  bool read_data_from_blocks(const BlockList& blocks, int offset,
                              char* buffer, int size);
   // 向数据块写入数据
-  bool write_data_to_blocks(const std::vector<int>& blocks, int offset,
+  bool write_data_to_blocks(const BlockList& blocks, int offset,
                             const char* buffer, int size);
   // 分配文件描述符
   int allocate_file_descriptor();
@@ -132,14 +201,19 @@ class FileSystem {
   // 重构函数的辅助方法
   bool validate_and_parse_path(const std::string& path, std::string& filename,
                                std::string& directory);
-  int allocate_file_inode(const std::string& filename);
+  int allocate_file_inode(std::string_view filename);
 
+  bool mount_internal(const std::string& disk_path, bool with_mounts,
+                      bool read_only = false);
   bool ensure_root_directory();
   bool load_superblock();
   bool initialize_after_open();
   bool ensure_mounted(const char* operation) const;
+  bool ensure_writable(const char* operation) const;
   void close_all_files();
   bool close_file_internal(int fd);
+  bool opened_read_only(int fd) const;
+  int read_file_shared(int fd, char* buffer, int size);
 
   /**
    * @brief 获取共享锁，用于只读操作。
@@ -151,5 +225,14 @@ class FileSystem {
    */
   [[nodiscard]] std::unique_lock<std::shared_mutex> acquire_unique_lock() const;
 
+  using FdGuard = std::lock_guard<std::mutex>;
+
   mutable std::shared_mutex fs_mutex_;  ///< 文件系统读写锁
+
+  /**
+   * @brief 只读挂载时保护文件描述符表。
+   * @details 只读挂载下打开、读取、定位、关闭都只持有共享锁，多个线程可同时
+   *          读取数据块，仅在访问描述符表时短暂持有此互斥量。
+   */
+  mutable std::mutex fd_mutex_;
 };
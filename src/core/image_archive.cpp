@@ -0,0 +1,360 @@
+// ==============================================================================
+// @file   image_archive.cpp
+// @brief  紧凑镜像归档的实现
+// ==============================================================================
+
+#include "image_archive.h"
+
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+#include <vector>
+
+#include "bitmap_manager.h"
+#include "disk_simulator.h"
+#include "../utils/block_codec.h"
+#include "../utils/crc32c.h"
+#include "../utils/error_handler.h"
+
+namespace {
+
+const char kArchiveMagic[4] = {'D', 'S', 'I', 'A'};
+const std::uint32_t kArchiveVersion = 1;
+const std::uint32_t kFlagCompressed = 0x1;
+const std::int32_t kEndOfRecords = -1;
+
+/**
+ * @struct ArchiveHeader
+ * @brief 归档头：块数、块大小、标志与镜像布局（导入时用于校验）。
+ */
+struct ArchiveHeader {
+  char magic[4];
+  std::uint32_t version;
+  std::int32_t total_blocks;
+  std::int32_t block_size;
+  std::uint32_t flags;
+  DiskLayout layout;
+};
+
+/**
+ * @brief 打开归档文件；"-" 对应标准输入/标准输出。
+ */
+FILE* open_stream(const std::string& path, bool for_write) {
+  if (path == "-") {
+    return for_write ? stdout : stdin;
+  }
+  return fopen(path.c_str(), for_write ? "wb" : "rb");
+}
+
+/**
+ * @brief 关闭归档文件（标准流只刷新不关闭）。
+ */
+bool close_stream(FILE* file) {
+  if (file == stdout || file == stdin) {
+    return fflush(file) == 0;
+  }
+  return fclose(file) == 0;
+}
+
+bool is_zero_block(const char* data) {
+  static const char zero[BLOCK_SIZE] = {};
+  return memcmp(data, zero, BLOCK_SIZE) == 0;
+}
+
+bool same_layout(const DiskLayout& a, const DiskLayout& b) {
+  return a.superblock_start == b.superblock_start &&
+         a.superblock_blocks == b.superblock_blocks &&
+         a.inode_bitmap_start == b.inode_bitmap_start &&
+         a.inode_bitmap_blocks == b.inode_bitmap_blocks &&
+         a.data_bitmap_start == b.data_bitmap_start &&
+         a.data_bitmap_blocks == b.data_bitmap_blocks &&
+         a.inode_table_start == b.inode_table_start &&
+         a.inode_table_blocks == b.inode_table_blocks &&
+         a.data_blocks_start == b.data_blocks_start &&
+         a.data_blocks_count == b.data_blocks_count;
+}
+
+/**
+ * @class RecordWriter
+ * @brief 把连续的块写成一条记录，并累积 CRC32C 与输出字节数。
+ */
+class RecordWriter {
+ public:
+  RecordWriter(FILE* file, bool compress)
+      : file_(file), compress_(compress),
+        packed_(BlockCodec::max_compressed_size(BLOCK_SIZE)) {}
+
+  bool write_run(std::int32_t start, std::int32_t count, const char* data) {
+    if (!put(&start, sizeof(start)) || !put(&count, sizeof(count))) {
+      return false;
+    }
+    for (std::int32_t i = 0; i < count; ++i) {
+      const char* block = data + static_cast<std::size_t>(i) * BLOCK_SIZE;
+      crc_ = Crc32c::compute(block, BLOCK_SIZE, crc_);
+      if (!compress_) {
+        if (!put(block, BLOCK_SIZE)) return false;
+        continue;
+      }
+      // 压缩后不变小的块原样保存，长度字段等于 BLOCK_SIZE
+      std::uint32_t length = static_cast<std::uint32_t>(
+          BlockCodec::compress(block, BLOCK_SIZE, packed_.data()));
+      const char* payload = packed_.data();
+      if (length >= static_cast<std::uint32_t>(BLOCK_SIZE)) {
+        length = BLOCK_SIZE;
+        payload = block;
+      }
+      if (!put(&length, sizeof(length)) || !put(payload, length)) return false;
+    }
+    return true;
+  }
+
+  bool finish() {
+    std::int32_t end = kEndOfRecords;
+    std::int32_t zero = 0;
+    return put(&end, sizeof(end)) && put(&zero, sizeof(zero)) &&
+           put(&crc_, sizeof(crc_));
+  }
+
+  bool put(const void* data, std::size_t length) {
+    bytes_ += length;
+    return fwrite(data, 1, length, file_) == length;
+  }
+
+  std::size_t bytes() const { return bytes_; }
+
+ private:
+  FILE* file_;
+  bool compress_;
+  std::vector<char> packed_;
+  std::uint32_t crc_ = 0;
+  std::size_t bytes_ = 0;
+};
+
+}  // namespace
+
+// ==============================================================================
+// ArchiveStats
+// ==============================================================================
+
+std::string ArchiveStats::summary(const char* verb) const {
+  std::ostringstream oss;
+  oss << verb << " " << stored_blocks << " of " << total_blocks << " blocks ("
+      << total_blocks * BLOCK_SIZE / (1024 * 1024) << " MB image, "
+      << (archive_bytes + 1023) / 1024 << " KB archive"
+      << (compressed ? ", compressed" : "") << ")";
+  return oss.str();
+}
+
+// ==============================================================================
+// 导出
+// ==============================================================================
+
+bool ImageArchive::export_image(const std::string& image_path,
+                                const std::string& archive_path, bool compress,
+                                ArchiveStats& stats) {
+  DiskSimulator disk;
+  if (!disk.open_disk(image_path, true)) {
+    ErrorHandler::log_error(ERROR_IO_ERROR, "Cannot open disk file: " + image_path);
+    return false;
+  }
+
+  DiskLayout layout = disk.calculate_layout();
+  char block[BLOCK_SIZE];
+  Superblock superblock;
+  if (!disk.read_block(layout.superblock_start, block)) {
+    return false;
+  }
+  memcpy(&superblock, block, sizeof(Superblock));
+  if (superblock.magic_number != MAGIC_NUMBER) {
+    ErrorHandler::log_error(ERROR_INVALID_ARGUMENT,
+                            "Disk is not formatted: " + image_path);
+    return false;
+  }
+
+  BitmapManager data_bitmap(layout.data_blocks_count);
+  if (!data_bitmap.load_from_disk(disk, layout.data_bitmap_start,
+                                  layout.data_bitmap_blocks)) {
+    ErrorHandler::log_error(ERROR_IO_ERROR, "Failed to load data bitmap: " + image_path);
+    return false;
+  }
+
+  FILE* file = open_stream(archive_path, true);
+  if (!file) {
+    ErrorHandler::log_error(ERROR_IO_ERROR, "Cannot create archive: " + archive_path);
+    return false;
+  }
+
+  ArchiveHeader header{};
+  memcpy(header.magic, kArchiveMagic, sizeof(kArchiveMagic));
+  header.version = kArchiveVersion;
+  header.total_blocks = disk.get_total_blocks();
+  header.block_size = BLOCK_SIZE;
+  header.flags = compress ? kFlagCompressed : 0;
+  header.layout = layout;
+
+  RecordWriter writer(file, compress);
+  bool ok = writer.put(&header, sizeof(header));
+
+  // 元数据区全部参与，数据区只取位图中已分配的块
+  auto selected = [&](int block_num) {
+    return block_num < layout.data_blocks_start ||
+           data_bitmap.is_allocated(block_num - layout.data_blocks_start);
+  };
+
+  std::vector<char> buffer(static_cast<std::size_t>(kRunBlocks) * BLOCK_SIZE);
+  int total = header.total_blocks;
+  int block_num = 0;
+  while (ok && block_num < total) {
+    if (!selected(block_num)) {
+      ++block_num;
+      continue;
+    }
+    int count = 1;
+    while (block_num + count < total && count < kRunBlocks && selected(block_num + count)) {
+      ++count;
+    }
+    if (!disk.read_blocks(block_num, count, buffer.data())) {
+      ok = false;
+      break;
+    }
+
+    // 段内的全零块不写入归档，其余连续块各成一条记录
+    int i = 0;
+    while (ok && i < count) {
+      const char* data = buffer.data() + static_cast<std::size_t>(i) * BLOCK_SIZE;
+      if (is_zero_block(data)) {
+        ++i;
+        continue;
+      }
+      int run = 1;
+      while (i + run < count &&
+             !is_zero_block(buffer.data() + static_cast<std::size_t>(i + run) * BLOCK_SIZE)) {
+        ++run;
+      }
+      ok = writer.write_run(block_num + i, run, data);
+      stats.stored_blocks += run;
+      i += run;
+    }
+    block_num += count;
+  }
+  ok = ok && writer.finish();
+  ok = close_stream(file) && ok;
+
+  stats.total_blocks = total;
+  stats.archive_bytes = writer.bytes();
+  stats.compressed = compress;
+  if (!ok) {
+    ErrorHandler::log_error(ERROR_IO_ERROR, "Failed to write archive: " + archive_path);
+    if (archive_path != "-") {
+      remove(archive_path.c_str());
+    }
+  }
+  return ok;
+}
+
+// ==============================================================================
+// 导入
+// ==============================================================================
+
+bool ImageArchive::import_image(const std::string& archive_path,
+                                const std::string& image_path,
+                                const DeviceOptions& options, ArchiveStats& stats) {
+  if (options.shards > 1) {
+    ErrorHandler::log_error(ERROR_INVALID_ARGUMENT,
+                            "import-image cannot create a shard set");
+    return false;
+  }
+
+  FILE* file = open_stream(archive_path, false);
+  if (!file) {
+    ErrorHandler::log_error(ERROR_FILE_NOT_FOUND, "Cannot open archive: " + archive_path);
+    return false;
+  }
+
+  ArchiveHeader header{};
+  std::size_t bytes = fread(&header, 1, sizeof(header), file);
+  if (bytes != sizeof(header) ||
+      memcmp(header.magic, kArchiveMagic, sizeof(kArchiveMagic)) != 0 ||
+      header.version != kArchiveVersion || header.block_size != BLOCK_SIZE ||
+      header.total_blocks <= 0 || header.total_blocks % (1024 * 1024 / BLOCK_SIZE) != 0) {
+    ErrorHandler::log_error(ERROR_INVALID_ARGUMENT, "Not a disk image archive: " + archive_path);
+    close_stream(file);
+    return false;
+  }
+
+  // 按原镜像大小新建镜像；设备模式改变逻辑块数时布局无法对应，拒绝导入
+  int size_mb = header.total_blocks / (1024 * 1024 / BLOCK_SIZE);
+  DiskSimulator disk;
+  if (!disk.create_disk(image_path, size_mb, options) || !disk.open_disk(image_path)) {
+    ErrorHandler::log_error(ERROR_IO_ERROR, "Failed to create disk: " + image_path);
+    close_stream(file);
+    return false;
+  }
+  if (disk.get_total_blocks() != header.total_blocks ||
+      !same_layout(disk.calculate_layout(), header.layout)) {
+    ErrorHandler::log_error(ERROR_INVALID_ARGUMENT,
+                            "Device options change the block count of the image; "
+                            "import into a plain, striped or mirrored image instead");
+    close_stream(file);
+    return false;
+  }
+
+  bool compressed = (header.flags & kFlagCompressed) != 0;
+  std::vector<char> buffer(static_cast<std::size_t>(kRunBlocks) * BLOCK_SIZE);
+  std::vector<char> packed(BLOCK_SIZE);
+  std::uint32_t crc = 0;
+  bool ok = true;
+  while (ok) {
+    std::int32_t start = 0;
+    std::int32_t count = 0;
+    ok = fread(&start, sizeof(start), 1, file) == 1 &&
+         fread(&count, sizeof(count), 1, file) == 1;
+    bytes += sizeof(start) + sizeof(count);
+    if (!ok || start == kEndOfRecords) {
+      break;
+    }
+    if (start < 0 || count <= 0 || count > kRunBlocks ||
+        start > header.total_blocks - count) {
+      ok = false;
+      break;
+    }
+
+    for (std::int32_t i = 0; ok && i < count; ++i) {
+      char* block = buffer.data() + static_cast<std::size_t>(i) * BLOCK_SIZE;
+      std::uint32_t length = BLOCK_SIZE;
+      if (compressed) {
+        ok = fread(&length, sizeof(length), 1, file) == 1 &&
+             length <= static_cast<std::uint32_t>(BLOCK_SIZE);
+        bytes += sizeof(length);
+      }
+      if (!ok) {
+        break;
+      }
+      if (length == static_cast<std::uint32_t>(BLOCK_SIZE)) {
+        ok = fread(block, 1, BLOCK_SIZE, file) == static_cast<std::size_t>(BLOCK_SIZE);
+      } else {
+        ok = fread(packed.data(), 1, length, file) == length &&
+             BlockCodec::decompress(packed.data(), length, block, BLOCK_SIZE);
+      }
+      bytes += length;
+      crc = ok ? Crc32c::compute(block, BLOCK_SIZE, crc) : crc;
+    }
+    ok = ok && disk.write_blocks(start, count, buffer.data());
+    stats.stored_blocks += count;
+  }
+
+  std::uint32_t expected_crc = 0;
+  ok = ok && fread(&expected_crc, sizeof(expected_crc), 1, file) == 1 &&
+       expected_crc == crc;
+  bytes += sizeof(expected_crc);
+  close_stream(file);
+
+  stats.total_blocks = header.total_blocks;
+  stats.archive_bytes = bytes;
+  stats.compressed = compressed;
+  if (!ok) {
+    ErrorHandler::log_error(ERROR_IO_ERROR,
+                            "Archive is truncated or corrupt; " + image_path + " is incomplete");
+  }
+  return ok;
+}
@@ -0,0 +1,72 @@
+// ==============================================================================
+// @file   image_archive.h
+// @brief  只包含已分配块的紧凑镜像归档（export-image / import-image）
+// ==============================================================================
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "block_device.h"
+
+/**
+ * @struct ArchiveStats
+ * @brief 一次导出或导入的统计。
+ */
+struct ArchiveStats {
+  std::size_t total_blocks = 0;    ///< 镜像总块数
+  std::size_t stored_blocks = 0;   ///< 归档中保存的块数
+  std::size_t archive_bytes = 0;   ///< 归档大小（字节）
+  bool compressed = false;         ///< 块数据是否经过压缩
+
+  /**
+   * @brief 单行摘要。
+   * @param verb "Exported" 或 "Imported"。
+   */
+  std::string summary(const char* verb) const;
+};
+
+/**
+ * @class ImageArchive
+ * @brief 把镜像的逻辑块流式写成紧凑归档，或从归档重建镜像。
+ *
+ * 导出时按数据块位图挑选块：元数据区（超级块、位图、inode表）全部参与，
+ * 数据区只取位图中已分配的块；全零块一律省略（导入时新镜像本就是零）。
+ * 选中的块按连续段（每段最多 kRunBlocks 块）整段读取，以
+ * “起始块号、块数、块数据”的记录顺序写出，末尾是结束记录和全部块内容
+ * 的 CRC32C。可选用 BlockCodec 逐块压缩，压缩后不变小的块原样保存。
+ *
+ * 归档通过逻辑块读写，与镜像的设备模式（普通、日志结构、条带、镜像、
+ * 校验和）无关；导入时按给定的设备选项新建镜像。路径为 "-" 时使用
+ * 标准输出/标准输入，可以直接通过管道在主机之间传输。
+ */
+class ImageArchive {
+ public:
+  /**
+   * @brief 导出镜像。
+   * @param image_path 已格式化的镜像路径（以只读方式打开）。
+   * @param archive_path 输出归档路径，"-" 表示标准输出。
+   * @param compress 是否压缩块数据。
+   * @param[out] stats 导出统计。
+   * @return bool 成功返回true。
+   */
+  static bool export_image(const std::string& image_path,
+                           const std::string& archive_path, bool compress,
+                           ArchiveStats& stats);
+
+  /**
+   * @brief 由归档新建镜像（已存在的镜像会被覆盖）。
+   * @param archive_path 归档路径，"-" 表示标准输入。
+   * @param image_path 要创建的镜像路径。
+   * @param options 新镜像的设备选项（不支持分片）。
+   * @param[out] stats 导入统计。
+   * @return bool 成功返回true；失败时镜像内容不完整。
+   */
+  static bool import_image(const std::string& archive_path,
+                           const std::string& image_path,
+                           const DeviceOptions& options, ArchiveStats& stats);
+
+ private:
+  static constexpr int kRunBlocks = 256;  ///< 每条记录最多包含的块数（1MB）
+};
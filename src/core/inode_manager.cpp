@@ -5,10 +5,34 @@
 
 #include "inode_manager.h"
 #include "disk_simulator.h"
+#include <algorithm>
+#include <cstdlib>
 #include <cstring>
 #include <iostream>
 #include <vector>
 #include <memory> // for std::unique_ptr
+#include "../utils/slow_op_watchdog.h"
+#include "../utils/trace_probes.h"
+
+namespace {
+
+/**
+ * @brief 环境变量 DISKSIM_TAIL_PACKING=0 时不再打包新的尾部。
+ */
+bool tail_packing_enabled() {
+    const char* value = std::getenv("DISKSIM_TAIL_PACKING");
+    return value == nullptr || std::strcmp(value, "0") != 0;
+}
+
+/**
+ * @brief 打包尾部所在的块下标与长度（调用方保证 inode.size > 0）。
+ */
+void tail_location(const Inode& inode, int& index, int& length) {
+    index = (inode.size - 1) / BLOCK_SIZE;
+    length = inode.size - index * BLOCK_SIZE;
+}
+
+}  // namespace
 
 // ==============================================================================
 // 构造与析构
@@ -63,6 +87,11 @@ bool InodeManager::initialize(const DiskLayout& layout) {
         return false;
     }
     
+    inode_cache_.clear();
+    {
+        std::lock_guard<std::mutex> lock(tail_mutex_);
+        tail_map_.clear();
+    }
     initialized = true;
     return true;
 }
@@ -140,18 +169,28 @@ bool InodeManager::free_inode(int inode_num) {
 bool InodeManager::read_inode(int inode_num, Inode& inode) {
     if (!check_initialized("read_inode")) return false;
 
+    if (inode_cache_.lookup(inode_num, inode)) {
+        DISKSIM_PROBE1(inode__hit, inode_num);
+        return true;
+    }
+    DISKSIM_PROBE1(inode__miss, inode_num);
+
+    SlowOpWatchdog::Phase phase(OpPhase::InodeIo);
     int block_num, offset_in_block;
     if (!get_inode_position(inode_num, block_num, offset_in_block)) {
         return false; // 错误已在get_inode_position中记录
     }
 
     auto buffer = BlockUtils::create_block_buffer();
+    // 未命中时在块锁内读盘并回填，不会把写者刚更新的内容回填成旧值
+    std::lock_guard<std::mutex> lock(inode_block_locks_[block_num % kInodeBlockLocks]);
     if (!disk.read_block(block_num, buffer.get())) {
         ErrorHandler::log_error(ErrorCode::ERROR_IO_ERROR, "Failed to read block for inode " + std::to_string(inode_num));
         return false;
     }
     
     memcpy(&inode, buffer.get() + offset_in_block, sizeof(Inode));
+    inode_cache_.insert_if_absent(inode_num, inode);
     return true;
 }
 
@@ -164,13 +203,17 @@ bool InodeManager::read_inode(int inode_num, Inode& inode) {
 bool InodeManager::write_inode(int inode_num, const Inode& inode) {
     if (!check_initialized("write_inode")) return false;
 
+    SlowOpWatchdog::Phase phase(OpPhase::InodeIo);
+
     int block_num, offset_in_block;
     if (!get_inode_position(inode_num, block_num, offset_in_block)) {
         return false;
     }
 
     auto buffer = BlockUtils::create_block_buffer();
-    // Read-Modify-Write: 必须先读出整个块，再修改，以免破坏块内其他inode
+    // Read-Modify-Write: 必须先读出整个块，再修改，以免破坏块内其他inode；
+    // 同一块的读改写与缓存更新一起串行化，缓存总与最后写入磁盘的内容一致
+    std::lock_guard<std::mutex> lock(inode_block_locks_[block_num % kInodeBlockLocks]);
     if (!disk.read_block(block_num, buffer.get())) {
         ErrorHandler::log_error(ErrorCode::ERROR_IO_ERROR, "Failed to read block for writing inode " + std::to_string(inode_num));
         return false;
@@ -180,9 +223,11 @@ bool InodeManager::write_inode(int inode_num, const Inode& inode) {
     
     if (!disk.write_block(block_num, buffer.get())) {
         ErrorHandler::log_error(ErrorCode::ERROR_IO_ERROR, "Failed to write block for inode " + std::to_string(inode_num));
+        inode_cache_.erase(inode_num);
         return false;
     }
     
+    inode_cache_.insert(inode_num, inode);
     return true;
 }
 
@@ -193,7 +238,7 @@ bool InodeManager::write_inode(int inode_num, const Inode& inode) {
  * @param[out] new_block_nums 分配到的新数据块的编号列表。
  * @return bool 成功返回true，失败返回false。
  */
-bool InodeManager::allocate_data_blocks(int inode_num, int block_count, std::vector<int>& new_block_nums) {
+bool InodeManager::allocate_data_blocks(int inode_num, int block_count, BlockList& new_block_nums) {
     if (!check_initialized("allocate_data_blocks") || block_count <= 0) return false;
 
     new_block_nums.clear();
@@ -246,9 +291,11 @@ bool InodeManager::free_data_blocks(int inode_num) {
  * @param[out] block_nums 获取到的数据块编号列表。
  * @return bool 成功返回true，失败返回false。
  */
-bool InodeManager::get_data_blocks(int inode_num, std::vector<int>& block_nums) {
+bool InodeManager::get_data_blocks(int inode_num, BlockList& block_nums) {
     if (!check_initialized("get_data_blocks")) return false;
 
+    SlowOpWatchdog::Phase phase(OpPhase::BlockMap);
+
     Inode inode;
     if (!read_inode(inode_num, inode)) return false;
 
@@ -260,7 +307,7 @@ bool InodeManager::get_data_blocks(int inode_num, std::vector<int>& block_nums)
 
     // 收集间接块
     if (inode.indirect_block != -1) {
-        std::vector<int> indirect_blocks;
+        BlockList indirect_blocks;
         if (read_indirect_block(inode.indirect_block, indirect_blocks)) {
             block_nums.insert(block_nums.end(), indirect_blocks.begin(), indirect_blocks.end());
         } else {
@@ -270,10 +317,10 @@ bool InodeManager::get_data_blocks(int inode_num, std::vector<int>& block_nums)
     
     // 处理二级间接块
     if (inode.double_indirect_block != -1) {
-        std::vector<int> double_indirect_blocks;
+        BlockList double_indirect_blocks;
         if (read_indirect_block(inode.double_indirect_block, double_indirect_blocks)) {
             for (int indirect_block_num : double_indirect_blocks) {
-                std::vector<int> indirect_blocks;
+                BlockList indirect_blocks;
                 if (read_indirect_block(indirect_block_num, indirect_blocks)) {
                     block_nums.insert(block_nums.end(), indirect_blocks.begin(), indirect_blocks.end());
                 } else {
@@ -288,6 +335,206 @@ bool InodeManager::get_data_blocks(int inode_num, std::vector<int>& block_nums)
     return true;
 }
 
+/**
+ * @brief 分配一段连续的数据块，并立即保存数据位图。
+ * @param block_count 需要的块数量。
+ * @param[out] block_nums 分配到的连续数据块号。
+ * @return bool 成功返回true；没有足够长的连续空闲区间时返回false。
+ */
+bool InodeManager::reserve_contiguous_blocks(int block_count, BlockList& block_nums) {
+    if (!check_initialized("reserve_contiguous_blocks") || block_count <= 0) return false;
+
+    int first_bit;
+    if (!data_bitmap->allocate_run(block_count, first_bit)) {
+        return false;
+    }
+
+    block_nums.clear();
+    for (int i = 0; i < block_count; ++i) {
+        block_nums.push_back(layout.data_blocks_start + first_bit + i);
+    }
+    return save_data_bitmap();
+}
+
+/**
+ * @brief 释放未关联到inode的数据块。
+ * @param block_nums 要释放的数据块号。
+ * @return bool 成功返回true，失败返回false。
+ */
+bool InodeManager::release_data_blocks(const BlockList& block_nums) {
+    if (!check_initialized("release_data_blocks")) return false;
+
+    for (int block : block_nums) {
+        data_bitmap->free_bit(block - layout.data_blocks_start);
+        disk.discard_block(block);
+    }
+    return save_data_bitmap();
+}
+
+/**
+ * @brief 用新的数据块列表替换inode的全部块指针。
+ * @param inode_num inode号。
+ * @param block_nums 新的数据块号。
+ * @return bool 成功返回true，失败返回false。
+ */
+bool InodeManager::replace_data_blocks(int inode_num, const BlockList& block_nums) {
+    if (!check_initialized("replace_data_blocks")) return false;
+
+    SlowOpWatchdog::Phase phase(OpPhase::BlockMap);
+    Inode inode;
+    if (!read_inode(inode_num, inode)) return false;
+
+    Inode old_inode = inode;
+    if (!build_block_pointers(inode, block_nums)) {
+        ErrorHandler::log_error(ErrorCode::ERROR_IO_ERROR, "Failed to build block pointers for inode " + std::to_string(inode_num));
+        return false;
+    }
+
+    // 写入inode即完成切换；此后旧块不再被引用，可以释放
+    if (!write_inode(inode_num, inode)) {
+        free_indirect_block(inode.indirect_block);
+        if (inode.double_indirect_block != -1) {
+            BlockList pointer_blocks;
+            read_indirect_block(inode.double_indirect_block, pointer_blocks);
+            for (int block : pointer_blocks) {
+                free_indirect_block(block);
+            }
+            free_indirect_block(inode.double_indirect_block);
+        }
+        return false;
+    }
+
+    // 打包的尾部不参与搬迁，新的块列表原样引用同一共享尾块
+    free_all_data_blocks_for_inode(old_inode, true);
+    return save_data_bitmap();
+}
+
+/**
+ * @brief 把普通文件最后一个部分块打包进共享尾块。
+ * @param inode_num inode号。
+ * @return bool 成功（或无需打包）返回true，失败返回false。
+ */
+bool InodeManager::pack_tail(int inode_num) {
+    if (!check_initialized("pack_tail")) return false;
+    if (!tail_packing_enabled()) return true;
+
+    Inode inode;
+    if (!read_inode(inode_num, inode)) return false;
+    if ((inode.mode & FILE_TYPE_DIRECTORY) || is_tail_packed(inode) || inode.size <= 0) {
+        return true;
+    }
+    int index, length;
+    tail_location(inode, index, length);
+    if (length == BLOCK_SIZE || length > TailBlockMap::kMaxTailBytes ||
+        index >= DIRECT_BLOCKS_COUNT || inode.direct_blocks[index] == 0) {
+        return true;
+    }
+
+    SlowOpWatchdog::Phase phase(OpPhase::BlockMap);
+    std::lock_guard<std::mutex> lock(tail_mutex_);
+    if (!tail_map_.is_loaded() && !load_tail_map()) return false;
+
+    int old_block = inode.direct_blocks[index];
+    int tail_block, offset;
+    if (!tail_map_.find_space(length, tail_block, offset)) {
+        // 没有可容纳的尾块：文件自己的最后一块就地成为新的共享尾块，尾部位于偏移0
+        inode.tail_ref = 1;
+        if (!write_inode(inode_num, inode)) return false;
+        tail_map_.add(old_block, 0, length);
+        return true;
+    }
+
+    auto data = BlockUtils::create_block_buffer();
+    auto shared = BlockUtils::create_block_buffer();
+    if (!disk.read_block(old_block, data.get()) || !disk.read_block(tail_block, shared.get())) {
+        return false;
+    }
+    // 先把尾部写进共享块的空闲槽位，再切换inode，最后释放私有块
+    memcpy(shared.get() + offset, data.get(), length);
+    if (!disk.write_block(tail_block, shared.get())) return false;
+
+    inode.direct_blocks[index] = tail_block;
+    inode.tail_ref = offset + 1;
+    if (!write_inode(inode_num, inode)) return false;
+    tail_map_.add(tail_block, offset, length);
+
+    data_bitmap->free_bit(old_block - layout.data_blocks_start);
+    disk.discard_block(old_block);
+    return save_data_bitmap();
+}
+
+/**
+ * @brief 把打包的尾部搬回私有块。
+ * @param inode_num inode号。
+ * @return bool 成功（或未打包）返回true，失败返回false。
+ */
+bool InodeManager::unpack_tail(int inode_num) {
+    if (!check_initialized("unpack_tail")) return false;
+
+    Inode inode;
+    if (!read_inode(inode_num, inode)) return false;
+    if (!is_tail_packed(inode) || inode.size <= 0) return true;
+    int index, length;
+    tail_location(inode, index, length);
+
+    SlowOpWatchdog::Phase phase(OpPhase::BlockMap);
+    std::lock_guard<std::mutex> lock(tail_mutex_);
+    if (!tail_map_.is_loaded() && !load_tail_map()) return false;
+
+    int tail_block = inode.direct_blocks[index];
+    int offset = tail_offset(inode);
+    auto shared = BlockUtils::create_block_buffer();
+    if (!disk.read_block(tail_block, shared.get())) return false;
+
+    // 唯一的占用者直接收回整个尾块，否则搬到新分配的私有块
+    bool sole = tail_map_.release(tail_block, offset, length);
+    int target = tail_block;
+    if (!sole) {
+        uint32_t block_index;
+        if (!allocate_single_block(block_index)) {
+            tail_map_.add(tail_block, offset, length);
+            ErrorHandler::log_error(ErrorCode::ERROR_NO_FREE_BLOCKS, "No free block to unpack tail of inode " + std::to_string(inode_num));
+            return false;
+        }
+        target = static_cast<int>(block_index);
+    }
+
+    auto data = BlockUtils::create_block_buffer();
+    memcpy(data.get(), shared.get() + offset, length);
+    inode.direct_blocks[index] = target;
+    inode.tail_ref = 0;
+    if (!disk.write_block(target, data.get()) || !write_inode(inode_num, inode)) {
+        if (!sole) {
+            data_bitmap->free_bit(target - layout.data_blocks_start);
+        }
+        tail_map_.add(tail_block, offset, length);
+        return false;
+    }
+    return sole || save_data_bitmap();
+}
+
+/**
+ * @brief 统计打包的尾部数与共享尾块数。
+ */
+void InodeManager::get_tail_stats(std::size_t& tails, std::size_t& blocks) {
+    tails = 0;
+    blocks = 0;
+    if (!initialized) return;
+
+    std::lock_guard<std::mutex> lock(tail_mutex_);
+    if (!tail_map_.is_loaded() && !load_tail_map()) return;
+    tails = tail_map_.tail_count();
+    blocks = tail_map_.block_count();
+}
+
+bool InodeManager::is_tail_packed(const Inode& inode) {
+    return inode.tail_ref > 0;
+}
+
+int InodeManager::tail_offset(const Inode& inode) {
+    return is_tail_packed(inode) ? inode.tail_ref - 1 : 0;
+}
+
 /** 
  * @brief 检查inode是否已分配。
  * @param inode_num inode号。
@@ -328,9 +575,26 @@ int InodeManager::get_free_data_blocks() const {
  */
 bool InodeManager::reload_bitmap() {
     if (!check_initialized("reload_bitmap")) return false;
+    // 格式化已清零inode表，缓存的内容与尾块占用表全部过期
+    inode_cache_.clear();
+    {
+        std::lock_guard<std::mutex> lock(tail_mutex_);
+        tail_map_.clear();
+    }
     return load_bitmaps();
 }
 
+/**
+ * @brief 清空inode缓存。
+ */
+void InodeManager::clear_cache() {
+    inode_cache_.clear();
+}
+
+void InodeManager::cached_inodes(std::vector<int>& inodes) const {
+    inode_cache_.for_each([&](int inode_num, const Inode&) { inodes.push_back(inode_num); });
+}
+
 // ==============================================================================
 // 私有辅助方法
 // ==============================================================================
@@ -360,6 +624,7 @@ bool InodeManager::load_bitmaps() {
  * @return bool 保存成功返回true。
  */
 bool InodeManager::save_inode_bitmap() {
+    SlowOpWatchdog::Phase phase(OpPhase::BitmapSave);
     return inode_bitmap->save_to_disk(disk, layout.inode_bitmap_start, layout.inode_bitmap_blocks);
 }
 
@@ -368,6 +633,7 @@ bool InodeManager::save_inode_bitmap() {
  * @return bool 保存成功返回true。
  */
 bool InodeManager::save_data_bitmap() {
+    SlowOpWatchdog::Phase phase(OpPhase::BitmapSave);
     return data_bitmap->save_to_disk(disk, layout.data_bitmap_start, layout.data_bitmap_blocks);
 }
 
@@ -391,6 +657,53 @@ bool InodeManager::get_inode_position(int inode_num, int& block_num, int& offset
     return true;
 }
 
+/**
+ * @brief 扫描inode表，由带打包标志的inode重建尾块占用表（调用方持有 tail_mutex_）。
+ * @return bool 成功返回true。
+ */
+bool InodeManager::load_tail_map() {
+    constexpr int kChunkBlocks = 32;
+    const int inodes_per_block = BLOCK_SIZE / sizeof(Inode);
+    std::vector<char> buffer(static_cast<size_t>(kChunkBlocks) * BLOCK_SIZE);
+
+    tail_map_.clear();
+    for (int start = 0; start < layout.inode_table_blocks; start += kChunkBlocks) {
+        int count = std::min(kChunkBlocks, layout.inode_table_blocks - start);
+        if (!disk.read_blocks(layout.inode_table_start + start, count, buffer.data())) {
+            ErrorHandler::log_error(ErrorCode::ERROR_IO_ERROR, "Failed to scan inode table for packed tails");
+            return false;
+        }
+        for (int i = 0; i < count * inodes_per_block; ++i) {
+            int inode_num = start * inodes_per_block + i;
+            if (!inode_bitmap->is_allocated(inode_num)) continue;
+
+            Inode inode;
+            int block_offset = (i / inodes_per_block) * BLOCK_SIZE + (i % inodes_per_block) * sizeof(Inode);
+            memcpy(&inode, buffer.data() + block_offset, sizeof(Inode));
+            if (!is_tail_packed(inode) || inode.size <= 0) continue;
+
+            int index, length;
+            tail_location(inode, index, length);
+            if (index < DIRECT_BLOCKS_COUNT) {
+                tail_map_.add(inode.direct_blocks[index], tail_offset(inode), length);
+            }
+        }
+    }
+    tail_map_.mark_loaded();
+    return true;
+}
+
+/**
+ * @brief 归还尾部占用的槽位；尾块因此空闲时释放该块（调用方持有 tail_mutex_）。
+ */
+void InodeManager::release_tail(int block, int offset, int length) {
+    if (!tail_map_.is_loaded() && !load_tail_map()) return;
+    if (tail_map_.release(block, offset, length)) {
+        data_bitmap->free_bit(block - layout.data_blocks_start);
+        disk.discard_block(block);
+    }
+}
+
 /**
  * @brief 初始化一个新的inode结构体。
  * @param[out] inode 要被初始化的inode对象。
@@ -410,30 +723,56 @@ void InodeManager::initialize_new_inode(Inode& inode) {
  * @brief 释放一个inode指向的所有数据块。
  * @param inode 需要释放数据块的inode对象。
  */
-void InodeManager::free_all_data_blocks_for_inode(Inode& inode) {
+void InodeManager::free_all_data_blocks_for_inode(Inode& inode, bool keep_tail) {
+    // 打包的尾部不占私有块：归还它在共享尾块中的槽位（碎片整理切换时原样保留）
+    if (is_tail_packed(inode) && inode.size > 0) {
+        int index, length;
+        tail_location(inode, index, length);
+        if (!keep_tail) {
+            std::lock_guard<std::mutex> lock(tail_mutex_);
+            release_tail(inode.direct_blocks[index], tail_offset(inode), length);
+        }
+        inode.direct_blocks[index] = 0;
+        inode.tail_ref = 0;
+    }
+
     // 释放直接块
     for (int& block_ptr : inode.direct_blocks) {
         if (block_ptr != 0) {
             data_bitmap->free_bit(block_ptr - layout.data_blocks_start);
+            disk.discard_block(block_ptr);
             block_ptr = 0;
         }
     }
 
     // 释放间接块
     if (inode.indirect_block != -1) {
-        std::vector<int> indirect_blocks;
+        BlockList indirect_blocks;
         if (read_indirect_block(inode.indirect_block, indirect_blocks)) {
             for (int block : indirect_blocks) {
                 data_bitmap->free_bit(block - layout.data_blocks_start);
+                disk.discard_block(block);
             }
         }
         free_indirect_block(inode.indirect_block);
         inode.indirect_block = -1;
     }
 
-    // 释放二级间接块
+    // 释放二级间接块：先释放它指向的各个间接块及其数据块，再释放自身
     if (inode.double_indirect_block != -1) {
-        // 注意：当前实现简化，仅释放其自身，未处理其指向的间接块列表
+        BlockList pointer_blocks;
+        if (read_indirect_block(inode.double_indirect_block, pointer_blocks)) {
+            for (int pointer_block : pointer_blocks) {
+                BlockList indirect_blocks;
+                if (read_indirect_block(pointer_block, indirect_blocks)) {
+                    for (int block : indirect_blocks) {
+                        data_bitmap->free_bit(block - layout.data_blocks_start);
+                        disk.discard_block(block);
+                    }
+                }
+                free_indirect_block(pointer_block);
+            }
+        }
         free_indirect_block(inode.double_indirect_block);
         inode.double_indirect_block = -1;
     }
@@ -445,7 +784,8 @@ void InodeManager::free_all_data_blocks_for_inode(Inode& inode) {
  * @param[out] data_blocks 读取到的数据块编号列表。
  * @return bool 成功返回true。
  */
-bool InodeManager::read_indirect_block(int block_num, std::vector<int>& data_blocks) {
+bool InodeManager::read_indirect_block(int block_num, BlockList& data_blocks) {
+    SlowOpWatchdog::Phase phase(OpPhase::BlockMap);
     auto buffer = BlockUtils::create_block_buffer();
     if (!disk.read_block(block_num, buffer.get())) return false;
 
@@ -464,7 +804,8 @@ bool InodeManager::read_indirect_block(int block_num, std::vector<int>& data_blo
  * @param data_blocks 要写入的数据块编号列表。
  * @return bool 成功返回true。
  */
-bool InodeManager::write_indirect_block(int block_num, const std::vector<int>& data_blocks) {
+bool InodeManager::write_indirect_block(int block_num, const BlockList& data_blocks) {
+    SlowOpWatchdog::Phase phase(OpPhase::BlockMap);
     auto buffer = BlockUtils::create_block_buffer();
     int* blocks = reinterpret_cast<int*>(buffer.get());
     size_t max_blocks = BLOCK_SIZE / sizeof(int);
@@ -500,7 +841,9 @@ bool InodeManager::allocate_indirect_block(int& block_num) {
  */
 bool InodeManager::free_indirect_block(int block_num) {
     if (block_num == -1) return true; // 如果块号无效，则认为操作成功
-    return data_bitmap->free_bit(block_num - layout.data_blocks_start);
+    if (!data_bitmap->free_bit(block_num - layout.data_blocks_start)) return false;
+    // 告知设备该块已失效，日志结构模式可据此直接回收其物理位置
+    return disk.discard_block(block_num);
 }
 
 /**
@@ -546,10 +889,11 @@ bool InodeManager::allocate_multiple_blocks(size_t count, std::vector<uint32_t>&
  * @return bool 成功返回true。
  */
 bool InodeManager::update_inode_block_pointers(uint32_t inode_id, const std::vector<uint32_t>& block_indices) {
+    SlowOpWatchdog::Phase phase(OpPhase::BlockMap);
     Inode inode;
     if (!read_inode(inode_id, inode)) return false;
 
-    std::vector<int> all_blocks;
+    BlockList all_blocks;
     if (!get_data_blocks(inode_id, all_blocks)) return false;
 
     all_blocks.insert(all_blocks.end(), block_indices.begin(), block_indices.end());
@@ -577,7 +921,7 @@ bool InodeManager::update_inode_block_pointers(uint32_t inode_id, const std::vec
                         return false;
                     }
                 }
-                std::vector<int> indirect_blocks;
+                BlockList indirect_blocks;
                 if (inode.indirect_block != -1) {
                     read_indirect_block(inode.indirect_block, indirect_blocks);
                 }
@@ -602,7 +946,7 @@ bool InodeManager::update_inode_block_pointers(uint32_t inode_id, const std::vec
                     return false;
                 }
 
-                std::vector<int> double_indirect_block_pointers;
+                BlockList double_indirect_block_pointers;
                 read_indirect_block(inode.double_indirect_block, double_indirect_block_pointers);
 
                 int target_indirect_block_num = 0;
@@ -624,7 +968,7 @@ bool InodeManager::update_inode_block_pointers(uint32_t inode_id, const std::vec
                     }
                 }
 
-                std::vector<int> indirect_blocks;
+                BlockList indirect_blocks;
                 read_indirect_block(target_indirect_block_num, indirect_blocks);
                 indirect_blocks.push_back(all_blocks[i]);
                 if (!write_indirect_block(target_indirect_block_num, indirect_blocks)) {
@@ -637,3 +981,68 @@ bool InodeManager::update_inode_block_pointers(uint32_t inode_id, const std::vec
     inode.modification_time = time(nullptr);
     return write_inode(inode_id, inode);
 }
+
+/**
+ * @brief 按给定的数据块列表重新填写inode的块指针，间接块全部新分配。
+ * @details 不读取也不修改旧的间接块；失败时释放本次新分配的间接块，inode中的
+ *          指针字段处于未定义状态，调用方不得写回。
+ * @param[in,out] inode 要填写指针的inode对象。
+ * @param block_nums 数据块号（按文件内顺序）。
+ * @return bool 成功返回true。
+ */
+bool InodeManager::build_block_pointers(Inode& inode, const BlockList& block_nums) {
+    const size_t per_block = BLOCK_SIZE / sizeof(int);
+    std::vector<int> allocated;  // 本次新分配的间接块，失败时回滚
+    auto allocate = [&](int& block_num) {
+        if (!allocate_indirect_block(block_num)) return false;
+        allocated.push_back(block_num);
+        return true;
+    };
+    auto rollback = [&]() {
+        for (int block : allocated) {
+            free_indirect_block(block);
+        }
+        return false;
+    };
+
+    memset(inode.direct_blocks, 0, sizeof(inode.direct_blocks));
+    inode.indirect_block = -1;
+    inode.double_indirect_block = -1;
+
+    size_t index = 0;
+    for (; index < block_nums.size() && index < DIRECT_BLOCKS_COUNT; ++index) {
+        inode.direct_blocks[index] = block_nums[index];
+    }
+
+    if (index < block_nums.size()) {
+        size_t count = std::min(per_block, block_nums.size() - index);
+        BlockList chunk(block_nums.begin() + index, block_nums.begin() + index + count);
+        if (!allocate(inode.indirect_block) || !write_indirect_block(inode.indirect_block, chunk)) {
+            return rollback();
+        }
+        index += count;
+    }
+
+    if (index < block_nums.size()) {
+        if (!allocate(inode.double_indirect_block)) return rollback();
+        BlockList pointer_blocks;
+        while (index < block_nums.size()) {
+            if (pointer_blocks.size() >= per_block) {
+                ErrorHandler::log_error(ERROR_DISK_FULL, "File size exceeds double indirect block limit");
+                return rollback();
+            }
+            size_t count = std::min(per_block, block_nums.size() - index);
+            BlockList chunk(block_nums.begin() + index, block_nums.begin() + index + count);
+            int pointer_block;
+            if (!allocate(pointer_block) || !write_indirect_block(pointer_block, chunk)) {
+                return rollback();
+            }
+            pointer_blocks.push_back(pointer_block);
+            index += count;
+        }
+        if (!write_indirect_block(inode.double_indirect_block, pointer_blocks)) {
+            return rollback();
+        }
+    }
+    return true;
+}
@@ -4,6 +4,10 @@
 #include "../utils/block_utils.h"
 #include "../utils/error_handler.h"
 #include "bitmap_manager.h"
+#include "concurrent_cache.h"
+#include "tail_block_map.h"
+#include <array>
+#include <mutex>
 #include <vector>
 
 class DiskSimulator;  // 前向声明
@@ -70,7 +74,7 @@ class InodeManager {
    * @return bool 操作成功返回true，否则返回false。
    */
   bool allocate_data_blocks(int inode_num, int block_count,
-                            std::vector<int>& block_nums);
+                            BlockList& block_nums);
 
   /**
    * @brief 释放指定inode的所有数据块。
@@ -85,7 +89,62 @@ class InodeManager {
    * @param[out] block_nums 存储数据块号的向量。
    * @return bool 操作成功返回true，否则返回false。
    */
-  bool get_data_blocks(int inode_num, std::vector<int>& block_nums);
+  bool get_data_blocks(int inode_num, BlockList& block_nums);
+
+  /**
+   * @brief 分配一段连续的数据块（不关联到任何inode，用于碎片整理搬迁）。
+   * @param block_count 需要的块数量。
+   * @param[out] block_nums 分配到的连续数据块号。
+   * @return bool 操作成功返回true；没有足够长的连续空闲区间时返回false（不记录错误）。
+   */
+  bool reserve_contiguous_blocks(int block_count, BlockList& block_nums);
+
+  /**
+   * @brief 释放未关联到inode的数据块（搬迁放弃时归还预留的区间）。
+   * @param block_nums 要释放的数据块号。
+   * @return bool 操作成功返回true，否则返回false。
+   */
+  bool release_data_blocks(const BlockList& block_nums);
+
+  /**
+   * @brief 用新的数据块列表替换inode的全部块指针，并释放旧的数据块与间接块。
+   * @details 先写好新的间接块，再一次写入inode完成切换，最后释放旧块；
+   *          文件大小与时间戳保持不变。调用方负责保证新块已包含文件数据。
+   * @param inode_num 目标inode号。
+   * @param block_nums 新的数据块号（按文件内顺序）。
+   * @return bool 操作成功返回true，否则返回false。
+   */
+  bool replace_data_blocks(int inode_num, const BlockList& block_nums);
+
+  /**
+   * @brief 把普通文件最后一个部分块打包进共享尾块，释放其私有块。
+   * @details 只处理尾部不超过 TailBlockMap::kMaxTailBytes、且最后一块为直接块的
+   *          文件；不满足条件或已打包时直接返回true。环境变量
+   *          DISKSIM_TAIL_PACKING=0 关闭打包（已打包的文件照常读取与解包）。
+   * @param inode_num 目标inode号。
+   * @return bool 操作成功（或无需打包）返回true，否则返回false。
+   */
+  bool pack_tail(int inode_num);
+
+  /**
+   * @brief 把打包的尾部搬回新的私有块（文件被写入前调用）。
+   * @param inode_num 目标inode号。
+   * @return bool 操作成功（或未打包）返回true，否则返回false。
+   */
+  bool unpack_tail(int inode_num);
+
+  /**
+   * @brief 统计打包的尾部数与共享尾块数（必要时先扫描inode表）。
+   * @param[out] tails 打包的尾部数。
+   * @param[out] blocks 共享尾块数。
+   */
+  void get_tail_stats(std::size_t& tails, std::size_t& blocks);
+
+  /** @brief inode的最后一个部分块是否打包在共享尾块中。 */
+  static bool is_tail_packed(const Inode& inode);
+
+  /** @brief 打包尾部在共享尾块内的字节偏移（未打包时为0）。 */
+  static int tail_offset(const Inode& inode);
 
   /**
    * @brief 检查指定的inode是否已分配。
@@ -109,7 +168,20 @@ class InodeManager {
    */
   bool reload_bitmap();
 
+  /**
+   * @brief 清空inode缓存（卸载时调用；初始化与重新加载位图时自动清空）。
+   */
+  void clear_cache();
+
+  /**
+   * @brief 列出当前缓存中的inode号（用于记录热点集合）。
+   * @param[out] inodes 输出的inode号。
+   */
+  void cached_inodes(std::vector<int>& inodes) const;
+
  private:
+  static constexpr int kInodeBlockLocks = 64;  ///< inode表块的分段写锁数量
+
   DiskSimulator& disk;          ///< 磁盘模拟器引用
   BitmapManager* inode_bitmap;  ///< inode位图管理器
   BitmapManager* data_bitmap;   ///< 数据块位图管理器
@@ -124,17 +196,28 @@ class InodeManager {
   bool load_data_bitmap();
   bool save_data_bitmap();
   void initialize_new_inode(Inode& inode);
-  void free_all_data_blocks_for_inode(Inode& inode);
-  bool read_indirect_block(int block_num, std::vector<int>& data_blocks);
-  bool write_indirect_block(int block_num, const std::vector<int>& data_blocks);
+  void free_all_data_blocks_for_inode(Inode& inode, bool keep_tail = false);
+  bool read_indirect_block(int block_num, BlockList& data_blocks);
+  bool write_indirect_block(int block_num, const BlockList& data_blocks);
   bool allocate_indirect_block(int& block_num);
   bool free_indirect_block(int block_num);
   bool allocate_single_block(uint32_t& block_index);
   bool allocate_multiple_blocks(size_t count, std::vector<uint32_t>& block_indices);
   bool update_inode_block_pointers(uint32_t inode_id, const std::vector<uint32_t>& block_indices);
+  bool build_block_pointers(Inode& inode, const BlockList& block_nums);
   bool get_inode_position(int inode_num, int& block_num, int& offset_in_block) const;
+  bool load_tail_map();
+  void release_tail(int block, int offset, int length);
 
   // --- 线程同步 ---
   mutable std::mutex inode_mutex_;    ///< 保护inode操作的互斥锁
   mutable std::mutex bitmap_mutex_;   ///< 保护位图操作的互斥锁
+  std::array<std::mutex, kInodeBlockLocks> inode_block_locks_;  ///< 串行化同一inode表块的读改写
+
+  // --- 缓存 ---
+  ConcurrentCache<int, Inode> inode_cache_;  ///< inode号 -> inode内容（写穿透）
+
+  // --- 尾块打包 ---
+  std::mutex tail_mutex_;    ///< 保护尾块占用表与共享尾块的读改写
+  TailBlockMap tail_map_;    ///< 共享尾块槽位占用（由inode表推导）
 };
\ No newline at end of file
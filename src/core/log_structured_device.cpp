@@ -0,0 +1,728 @@
+// ==============================================================================
+// @file   log_structured_device.cpp
+// @brief  日志结构块设备的实现
+// ==============================================================================
+
+#include "log_structured_device.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+
+#include "../utils/block_utils.h"
+#include "../utils/slow_op_watchdog.h"
+
+namespace {
+
+const char kLogMagic[8] = {'D', 'S', 'I', 'M', 'L', 'O', 'G', '1'};  ///< 魔数
+const std::uint32_t kLogVersion = 1;           ///< 格式版本
+const int kHeaderSlots = 2;                    ///< 检查点头数量
+const int kCapacityPercent = 80;               ///< 逻辑容量占段容量的百分比
+const int kMinSegments = 6;                    ///< 最少段数
+const std::size_t kReservedSegments = 2;       ///< 仅供清理器使用的保留段数
+const int kIntsPerBlock = BLOCK_SIZE / sizeof(int);
+const auto kCleanerInterval = std::chrono::milliseconds(200);
+
+}  // namespace
+
+// ==============================================================================
+// 构造与析构
+// ==============================================================================
+
+LogStructuredDevice::LogStructuredDevice(
+    std::unique_ptr<BlockDevice> physical)
+    : physical_(std::move(physical)),
+      logical_blocks_(0),
+      segment_blocks_(0),
+      segment_count_(0),
+      map_blocks_(0),
+      segments_start_(0),
+      head_segment_(0),
+      head_offset_(0),
+      sequence_(0),
+      checkpoint_slot_(0),
+      dirty_(false),
+      opened_(false),
+      read_only_(false),
+      user_writes_(0),
+      relocated_blocks_(0),
+      cleaned_segments_(0),
+      checkpoint_writes_(0),
+      checkpoints_(0),
+      cleaner_wakeup_(false),
+      stop_cleaner_(false) {}
+
+LogStructuredDevice::~LogStructuredDevice() {
+  close();
+}
+
+// ==============================================================================
+// 格式化与检测
+// ==============================================================================
+
+/**
+ * @brief 检查物理设备是否为日志结构格式（任一检查点头有效即可）。
+ */
+bool LogStructuredDevice::is_log_structured(BlockDevice& physical) {
+  LogHeader header;
+  for (int slot = 0; slot < kHeaderSlots; ++slot) {
+    if (read_header(physical, slot, header)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * @brief 在物理设备上写入空的日志结构元数据。
+ */
+bool LogStructuredDevice::initialize(BlockDevice& physical,
+                                     int segment_blocks) {
+  LogHeader header;
+  if (!compute_geometry(physical.get_total_blocks(), segment_blocks, header)) {
+    ErrorHandler::log_error(
+        ERROR_INVALID_ARGUMENT,
+        "Disk too small for log-structured mode with segment size " +
+            std::to_string(segment_blocks));
+    return false;
+  }
+
+  // 两份映射表都初始化为全部未映射（-1）
+  auto buffer = BlockUtils::create_block_buffer();
+  memset(buffer.get(), 0xFF, BLOCK_SIZE);
+  for (int i = 0; i < header.map_blocks * kHeaderSlots; ++i) {
+    if (!physical.write_block(kHeaderSlots + i, buffer.get())) {
+      return false;
+    }
+  }
+
+  BlockList empty_map(header.logical_blocks, -1);
+  header.map_checksum = checksum_map(empty_map);
+  header.sequence = 1;
+
+  auto header_buffer = BlockUtils::create_block_buffer();
+  memcpy(header_buffer.get(), &header, sizeof(LogHeader));
+  if (!physical.write_block(0, header_buffer.get())) {
+    return false;
+  }
+
+  // 槽位1写入一个无效头，确保旧数据不会被误认为检查点
+  auto zero_buffer = BlockUtils::create_block_buffer();
+  return physical.write_block(1, zero_buffer.get());
+}
+
+// ==============================================================================
+// 生命周期
+// ==============================================================================
+
+/**
+ * @brief 加载最新的检查点并启动后台清理器。
+ */
+bool LogStructuredDevice::open(bool read_only) {
+  {
+    std::unique_lock<std::shared_mutex> lock(state_mutex_);
+    if (!load_checkpoint()) {
+      return false;
+    }
+    opened_ = true;
+    read_only_ = read_only;
+  }
+  if (read_only) {
+    return true;
+  }
+
+  stop_cleaner_ = false;
+  cleaner_thread_ = std::thread(&LogStructuredDevice::cleaner_loop, this);
+  return true;
+}
+
+/**
+ * @brief 停止清理器并写入最终检查点。
+ */
+void LogStructuredDevice::close() {
+  if (cleaner_thread_.joinable()) {
+    {
+      std::lock_guard<std::mutex> wake_lock(cleaner_mutex_);
+      stop_cleaner_ = true;
+    }
+    cleaner_cv_.notify_all();
+    cleaner_thread_.join();
+  }
+
+  std::unique_lock<std::shared_mutex> lock(state_mutex_);
+  if (opened_) {
+    if (dirty_ || !pending_free_.empty()) {
+      checkpoint_locked();
+    }
+    opened_ = false;
+  }
+}
+
+// ==============================================================================
+// 块级I/O
+// ==============================================================================
+
+/**
+ * @brief 读取一个逻辑块；从未写入或已丢弃的块读出全零。
+ */
+bool LogStructuredDevice::read_block(int block_num, char* buffer) {
+  std::shared_lock<std::shared_mutex> lock(state_mutex_);
+  int physical_block = map_[block_num];
+  if (physical_block < 0) {
+    memset(buffer, 0, BLOCK_SIZE);
+    return true;
+  }
+  return physical_->read_block(physical_block, buffer);
+}
+
+/**
+ * @brief 将逻辑块追加写入到当前段。
+ */
+bool LogStructuredDevice::write_block(int block_num, const char* buffer) {
+  if (read_only_) {
+    ErrorHandler::log_error(ERROR_PERMISSION_DENIED,
+                            "Write to read-only log-structured device at block " +
+                                std::to_string(block_num));
+    return false;
+  }
+  bool wake_cleaner = false;
+  {
+    std::unique_lock<std::shared_mutex> lock(state_mutex_);
+    if (!append_locked(block_num, buffer, false)) {
+      return false;
+    }
+    ++user_writes_;
+    wake_cleaner = free_segments_.size() < low_watermark();
+  }
+  if (wake_cleaner) {
+    {
+      std::lock_guard<std::mutex> wake_lock(cleaner_mutex_);
+      cleaner_wakeup_ = true;
+    }
+    cleaner_cv_.notify_one();
+  }
+  return true;
+}
+
+/**
+ * @brief 丢弃逻辑块，使其物理位置立即失效。
+ */
+bool LogStructuredDevice::discard_block(int block_num) {
+  std::unique_lock<std::shared_mutex> lock(state_mutex_);
+  if (map_[block_num] >= 0) {
+    unmap_locked(block_num);
+    dirty_ = true;
+  }
+  return true;
+}
+
+/**
+ * @brief 写入检查点，使此前的所有写入在重新打开后可见。
+ */
+bool LogStructuredDevice::flush() {
+  std::unique_lock<std::shared_mutex> lock(state_mutex_);
+  if (!dirty_ && pending_free_.empty()) {
+    return physical_->flush();
+  }
+  return checkpoint_locked() && physical_->flush();
+}
+
+int LogStructuredDevice::get_total_blocks() const { return logical_blocks_; }
+
+/**
+ * @brief 描述段使用情况与写放大。
+ */
+std::string LogStructuredDevice::describe() const {
+  std::shared_lock<std::shared_mutex> lock(state_mutex_);
+  std::uint64_t live_blocks = 0;
+  for (int live : segment_live_) {
+    live_blocks += live;
+  }
+  std::uint64_t physical_writes =
+      user_writes_ + relocated_blocks_ + checkpoint_writes_;
+
+  std::ostringstream oss;
+  oss << std::fixed << std::setprecision(2);
+  oss << "log-structured (" << segment_count_ << " segments x "
+      << segment_blocks_ << " blocks, map " << map_blocks_ << " blocks, "
+      << free_segments_.size()
+      << " free, live " << live_blocks << "/"
+      << static_cast<std::uint64_t>(segment_count_) * segment_blocks_
+      << " blocks)" << std::endl;
+  oss << "    Cleaner: " << cleaned_segments_ << " segments cleaned, "
+      << relocated_blocks_ << " blocks relocated, " << checkpoint_writes_
+      << " checkpoint blocks in " << checkpoints_ << " checkpoints"
+      << std::endl;
+  oss << "    Write amplification: "
+      << (user_writes_ ? static_cast<double>(physical_writes) / user_writes_
+                       : 0.0);
+  std::string backing = physical_->describe();
+  if (backing != "plain") {
+    oss << std::endl << "    Backing device: " << backing;
+  }
+  return oss.str();
+}
+
+void LogStructuredDevice::collect_stats(std::vector<DeviceStats>& stats) const {
+  physical_->collect_stats(stats);
+}
+
+bool LogStructuredDevice::drop_host_cache() {
+  return physical_->drop_host_cache();
+}
+
+// ==============================================================================
+// 检查点
+// ==============================================================================
+
+/**
+ * @brief 根据物理块数和段大小计算布局。
+ */
+bool LogStructuredDevice::compute_geometry(int physical_blocks,
+                                           int segment_blocks,
+                                           LogHeader& header) {
+  if (segment_blocks < 8 || physical_blocks <= 0) {
+    return false;
+  }
+
+  // 先按物理块数估计映射表上限，再据此确定段数和逻辑容量
+  int map_upper = (physical_blocks + kIntsPerBlock - 1) / kIntsPerBlock;
+  int segment_count =
+      (physical_blocks - kHeaderSlots - kHeaderSlots * map_upper) /
+      segment_blocks;
+  if (segment_count < kMinSegments) {
+    return false;
+  }
+
+  long logical =
+      static_cast<long>(segment_count) * segment_blocks * kCapacityPercent / 100;
+  int map_blocks = static_cast<int>((logical + kIntsPerBlock - 1) / kIntsPerBlock);
+  segment_count = (physical_blocks - kHeaderSlots - kHeaderSlots * map_blocks) /
+                  segment_blocks;
+
+  memset(&header, 0, sizeof(LogHeader));
+  memcpy(header.magic, kLogMagic, sizeof(kLogMagic));
+  header.version = kLogVersion;
+  header.logical_blocks = static_cast<std::int32_t>(logical);
+  header.segment_blocks = segment_blocks;
+  header.segment_count = segment_count;
+  header.map_blocks = map_blocks;
+  header.head_segment = 0;
+  header.head_offset = 0;
+  return true;
+}
+
+/**
+ * @brief 计算映射表的 FNV-1a 校验和。
+ */
+std::uint64_t LogStructuredDevice::checksum_map(const BlockList& map) {
+  std::uint64_t hash = 1469598103934665603ULL;
+  const unsigned char* bytes = reinterpret_cast<const unsigned char*>(map.data());
+  std::size_t length = map.size() * sizeof(int);
+  for (std::size_t i = 0; i < length; ++i) {
+    hash ^= bytes[i];
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+/**
+ * @brief 读取并校验指定槽位的检查点头。
+ */
+bool LogStructuredDevice::read_header(BlockDevice& physical, int slot,
+                                      LogHeader& header) {
+  if (physical.get_total_blocks() < kHeaderSlots) {
+    return false;
+  }
+  auto buffer = BlockUtils::create_block_buffer();
+  if (!physical.read_block(slot, buffer.get())) {
+    return false;
+  }
+  memcpy(&header, buffer.get(), sizeof(LogHeader));
+  return memcmp(header.magic, kLogMagic, sizeof(kLogMagic)) == 0 &&
+         header.version == kLogVersion && header.logical_blocks > 0 &&
+         header.segment_blocks > 0 && header.segment_count > 0 &&
+         header.map_blocks > 0 && header.head_segment >= 0 &&
+         header.head_segment < header.segment_count &&
+         header.head_offset >= 0 &&
+         header.head_offset <= header.segment_blocks;
+}
+
+/**
+ * @brief 选择序号最大且映射表校验通过的检查点，重建内存状态。
+ */
+bool LogStructuredDevice::load_checkpoint() {
+  LogHeader best;
+  int best_slot = -1;
+  BlockList best_map;
+  BlockList slot_maps[kHeaderSlots];  // 各槽位通过校验的映射表
+
+  for (int slot = 0; slot < kHeaderSlots; ++slot) {
+    LogHeader header;
+    if (!read_header(*physical_, slot, header)) {
+      continue;
+    }
+    int start = kHeaderSlots + slot * header.map_blocks;
+    BlockList map(static_cast<std::size_t>(header.map_blocks) *
+                         kIntsPerBlock);
+    bool ok = true;
+    for (int i = 0; i < header.map_blocks && ok; ++i) {
+      ok = physical_->read_block(
+          start + i, reinterpret_cast<char*>(map.data() + i * kIntsPerBlock));
+    }
+    map.resize(header.logical_blocks);
+    if (!ok || checksum_map(map) != header.map_checksum) {
+      continue;
+    }
+    slot_maps[slot] = map;
+    if (best_slot != -1 && header.sequence <= best.sequence) {
+      continue;
+    }
+
+    best = header;
+    best_slot = slot;
+    best_map = std::move(map);
+  }
+
+  if (best_slot == -1) {
+    ErrorHandler::log_error(ERROR_IO_ERROR,
+                            "No valid log-structured checkpoint found");
+    return false;
+  }
+
+  logical_blocks_ = best.logical_blocks;
+  segment_blocks_ = best.segment_blocks;
+  segment_count_ = best.segment_count;
+  map_blocks_ = best.map_blocks;
+  segments_start_ = kHeaderSlots + kHeaderSlots * map_blocks_;
+  head_segment_ = best.head_segment;
+  head_offset_ = best.head_offset;
+  sequence_ = best.sequence;
+  checkpoint_slot_ = best_slot;
+  map_ = std::move(best_map);
+
+  // 加载的槽位与内存映射一致；另一槽位只有与之不同（或无效）的映射块为脏
+  map_dirty_.assign(map_blocks_, 0);
+  for (int slot = 0; slot < kHeaderSlots; ++slot) {
+    if (slot == best_slot) {
+      continue;
+    }
+    const BlockList& other = slot_maps[slot];
+    for (int i = 0; i < map_blocks_; ++i) {
+      int first = i * kIntsPerBlock;
+      int count = std::min(kIntsPerBlock, logical_blocks_ - first);
+      if (static_cast<int>(other.size()) != logical_blocks_ ||
+          memcmp(other.data() + first, map_.data() + first,
+                 count * sizeof(int)) != 0) {
+        map_dirty_[i] |= 1u << slot;
+      }
+    }
+  }
+
+  long expected_end =
+      segments_start_ + static_cast<long>(segment_count_) * segment_blocks_;
+  if (expected_end > physical_->get_total_blocks()) {
+    ErrorHandler::log_error(ERROR_IO_ERROR,
+                            "Log-structured geometry exceeds disk size");
+    return false;
+  }
+
+  // 由映射表重建反向映射和每段存活计数
+  reverse_.assign(static_cast<std::size_t>(segment_count_) * segment_blocks_, -1);
+  segment_live_.assign(segment_count_, 0);
+  for (int logical = 0; logical < logical_blocks_; ++logical) {
+    int physical_block = map_[logical];
+    if (physical_block < 0) {
+      continue;
+    }
+    int slot = physical_block - segments_start_;
+    if (slot < 0 || slot >= static_cast<int>(reverse_.size())) {
+      ErrorHandler::log_error(ERROR_IO_ERROR,
+                              "Corrupt log-structured block map");
+      return false;
+    }
+    reverse_[slot] = logical;
+    ++segment_live_[slot / segment_blocks_];
+  }
+
+  segment_state_.assign(segment_count_, SegmentState::Free);
+  free_segments_.clear();
+  pending_free_.clear();
+  for (int segment = 0; segment < segment_count_; ++segment) {
+    if (segment == head_segment_) {
+      segment_state_[segment] = SegmentState::Open;
+    } else if (segment_live_[segment] > 0) {
+      segment_state_[segment] = SegmentState::Sealed;
+    } else {
+      free_segments_.push_back(segment);
+    }
+  }
+
+  dirty_ = false;
+  return true;
+}
+
+/**
+ * @brief 将映射表与头部写入另一个检查点槽位。
+ * @details 只写该槽位上次检查点之后变化过的映射块；先写映射表再写头部，
+ *          头部是提交点，写入成功后才清除该槽位的脏位。崩溃在中途时该槽位
+ *          的映射表校验失败，加载时回到另一个槽位。写入完成后，此前等待的
+ *          空闲段才能被复用。
+ */
+bool LogStructuredDevice::checkpoint_locked() {
+  SlowOpWatchdog::Phase phase(OpPhase::Flush);
+  int slot = (checkpoint_slot_ + 1) % kHeaderSlots;
+  int start = map_start(slot);
+  const std::uint8_t slot_bit = static_cast<std::uint8_t>(1u << slot);
+
+  auto buffer = BlockUtils::create_block_buffer();
+  int written = 0;
+  for (int i = 0; i < map_blocks_; ++i) {
+    if (!(map_dirty_[i] & slot_bit)) {
+      continue;
+    }
+    memset(buffer.get(), 0xFF, BLOCK_SIZE);
+    int first = i * kIntsPerBlock;
+    int count = std::min(kIntsPerBlock, logical_blocks_ - first);
+    memcpy(buffer.get(), map_.data() + first, count * sizeof(int));
+    if (!physical_->write_block(start + i, buffer.get())) {
+      return false;
+    }
+    ++written;
+  }
+
+  LogHeader header;
+  memset(&header, 0, sizeof(LogHeader));
+  memcpy(header.magic, kLogMagic, sizeof(kLogMagic));
+  header.version = kLogVersion;
+  header.logical_blocks = logical_blocks_;
+  header.segment_blocks = segment_blocks_;
+  header.segment_count = segment_count_;
+  header.map_blocks = map_blocks_;
+  header.head_segment = head_segment_;
+  header.head_offset = head_offset_;
+  header.sequence = sequence_ + 1;
+  header.map_checksum = checksum_map(map_);
+
+  memset(buffer.get(), 0, BLOCK_SIZE);
+  memcpy(buffer.get(), &header, sizeof(LogHeader));
+  if (!physical_->write_block(slot, buffer.get())) {
+    return false;
+  }
+
+  for (std::uint8_t& bits : map_dirty_) {
+    bits &= static_cast<std::uint8_t>(~slot_bit);
+  }
+  checkpoint_writes_ += written + 1;
+  ++checkpoints_;
+  sequence_ = header.sequence;
+  checkpoint_slot_ = slot;
+  dirty_ = false;
+
+  for (int segment : pending_free_) {
+    segment_state_[segment] = SegmentState::Free;
+    free_segments_.push_back(segment);
+  }
+  pending_free_.clear();
+  return true;
+}
+
+// ==============================================================================
+// 追加写与段管理
+// ==============================================================================
+
+/**
+ * @brief 把一个逻辑块写到日志尾部并更新映射。
+ * @param for_cleaner 是否由清理器发起（可使用保留段）。
+ */
+bool LogStructuredDevice::append_locked(int logical, const char* buffer,
+                                        bool for_cleaner) {
+  if (!ensure_head_space_locked(for_cleaner)) {
+    return false;
+  }
+
+  int physical_block = segment_start(head_segment_) + head_offset_;
+  if (!physical_->write_block(physical_block, buffer)) {
+    return false;
+  }
+
+  unmap_locked(logical);
+  set_mapping_locked(logical, physical_block);
+  reverse_[physical_block - segments_start_] = logical;
+  ++segment_live_[head_segment_];
+  ++head_offset_;
+  dirty_ = true;
+  return true;
+}
+
+/**
+ * @brief 确保当前段还有空位，写满时封存并切换到下一个空闲段。
+ */
+bool LogStructuredDevice::ensure_head_space_locked(bool for_cleaner) {
+  if (head_offset_ < segment_blocks_) {
+    return true;
+  }
+
+  int sealed = head_segment_;
+  if (segment_live_[sealed] == 0) {
+    segment_state_[sealed] = SegmentState::PendingFree;
+    pending_free_.push_back(sealed);
+  } else {
+    segment_state_[sealed] = SegmentState::Sealed;
+  }
+
+  if (!open_next_segment_locked(for_cleaner)) {
+    return false;
+  }
+  // 每封存一个段写一次检查点，限制崩溃时可能丢失的写入量
+  return checkpoint_locked();
+}
+
+/**
+ * @brief 从空闲段中取出一个作为新的写入段，必要时先同步清理。
+ */
+bool LogStructuredDevice::open_next_segment_locked(bool for_cleaner) {
+  std::size_t reserve = for_cleaner ? 0 : kReservedSegments;
+  while (free_segments_.size() <= reserve) {
+    if (!pending_free_.empty()) {
+      if (!checkpoint_locked()) {
+        return false;
+      }
+      continue;
+    }
+    if (for_cleaner || !clean_one_segment_locked()) {
+      break;
+    }
+  }
+
+  if (free_segments_.empty()) {
+    ErrorHandler::log_error(ERROR_NO_FREE_BLOCKS,
+                            "Log-structured device has no free segments");
+    return false;
+  }
+
+  head_segment_ = free_segments_.front();
+  free_segments_.pop_front();
+  head_offset_ = 0;
+  segment_state_[head_segment_] = SegmentState::Open;
+  return true;
+}
+
+/**
+ * @brief 选择存活块最少的已封存段，把存活块重新追加到日志尾部。
+ * @return bool 成功清理一个段返回true；没有可清理的段返回false。
+ */
+bool LogStructuredDevice::clean_one_segment_locked() {
+  SlowOpWatchdog::Phase phase(OpPhase::Cleaning);
+  int victim = -1;
+  for (int segment = 0; segment < segment_count_; ++segment) {
+    if (segment_state_[segment] != SegmentState::Sealed) {
+      continue;
+    }
+    if (victim == -1 || segment_live_[segment] < segment_live_[victim]) {
+      victim = segment;
+    }
+  }
+  if (victim == -1 || segment_live_[victim] >= segment_blocks_) {
+    return false;
+  }
+
+  auto buffer = BlockUtils::create_block_buffer();
+  int base = victim * segment_blocks_;
+  for (int offset = 0; offset < segment_blocks_; ++offset) {
+    int logical = reverse_[base + offset];
+    if (logical < 0) {
+      continue;
+    }
+    if (!physical_->read_block(segments_start_ + base + offset, buffer.get()) ||
+        !append_locked(logical, buffer.get(), true)) {
+      return false;
+    }
+    ++relocated_blocks_;
+  }
+
+  ++cleaned_segments_;
+  return true;
+}
+
+/**
+ * @brief 解除逻辑块的映射；所在段变空时转入待释放列表。
+ */
+void LogStructuredDevice::unmap_locked(int logical) {
+  int old_block = map_[logical];
+  if (old_block < 0) {
+    return;
+  }
+
+  int slot = old_block - segments_start_;
+  int segment = slot / segment_blocks_;
+  reverse_[slot] = -1;
+  set_mapping_locked(logical, -1);
+  if (--segment_live_[segment] == 0 &&
+      segment_state_[segment] == SegmentState::Sealed) {
+    segment_state_[segment] = SegmentState::PendingFree;
+    pending_free_.push_back(segment);
+  }
+}
+
+/**
+ * @brief 更新映射表项，并把所在映射块标记为两个槽位都需要重写。
+ */
+void LogStructuredDevice::set_mapping_locked(int logical, int physical_block) {
+  map_[logical] = physical_block;
+  map_dirty_[logical / kIntsPerBlock] = (1u << kHeaderSlots) - 1;
+}
+
+int LogStructuredDevice::segment_of(int physical_block) const {
+  return (physical_block - segments_start_) / segment_blocks_;
+}
+
+int LogStructuredDevice::segment_start(int segment) const {
+  return segments_start_ + segment * segment_blocks_;
+}
+
+int LogStructuredDevice::map_start(int slot) const {
+  return kHeaderSlots + slot * map_blocks_;
+}
+
+std::size_t LogStructuredDevice::low_watermark() const {
+  return std::max<std::size_t>(kReservedSegments + 2, segment_count_ / 8);
+}
+
+// ==============================================================================
+// 后台清理器
+// ==============================================================================
+
+/**
+ * @brief 清理线程主循环：空闲段低于水位线时逐段清理。
+ * @details 每清理一个段就释放一次状态锁，避免长时间阻塞前台读写。
+ */
+void LogStructuredDevice::cleaner_loop() {
+  while (!stop_cleaner_) {
+    {
+      std::unique_lock<std::mutex> wait_lock(cleaner_mutex_);
+      cleaner_cv_.wait_for(wait_lock, kCleanerInterval, [this] {
+        return stop_cleaner_.load() || cleaner_wakeup_;
+      });
+      cleaner_wakeup_ = false;
+    }
+    if (stop_cleaner_) {
+      break;
+    }
+
+    while (!stop_cleaner_) {
+      std::unique_lock<std::shared_mutex> lock(state_mutex_);
+      if (free_segments_.size() + pending_free_.size() >= low_watermark()) {
+        if (!pending_free_.empty()) {
+          checkpoint_locked();
+        }
+        break;
+      }
+      if (!clean_one_segment_locked()) {
+        break;
+      }
+    }
+  }
+}
@@ -0,0 +1,168 @@
+// ==============================================================================
+// @file   log_structured_device.h
+// @brief  日志结构块设备：所有写入追加到当前段，后台清理器回收稀疏段
+// ==============================================================================
+
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../utils/common.h"
+#include "../utils/error_codes.h"
+#include "../utils/error_handler.h"
+#include "block_device.h"
+
+/**
+ * @class LogStructuredDevice
+ * @brief 在下层块设备（单个镜像文件或条带集合）之上实现日志结构的块放置。
+ *
+ * 文件系统看到的逻辑块（数据块、inode表块、目录块、位图块）在每次写入时
+ * 都被追加到当前段的下一个空闲位置，原位置随即失效；逻辑块 -> 物理块的
+ * 映射表取代了固定位置，inode表块同样经由该映射定位，因此它同时承担了
+ * inode map 的角色。随机的原地写入由此变为段内的顺序写入。
+ *
+ * 物理布局：
+ *   块0、块1   两个检查点头（交替写入，加载时取序号最大且校验通过者）
+ *   映射区A、B 两份逻辑块映射表，分别对应两个检查点头
+ *   段区       segment_count 个段，每段 segment_blocks 块
+ *
+ * 每当一个段写满时写一次检查点；检查点只重写自该槽位上次检查点以来被
+ * 修改过的映射表块（每个映射块为两个槽位各记一个脏位），因此其代价与
+ * 两次检查点之间的写入范围成正比，而不是与镜像大小成正比。检查点之后
+ * 才允许复用在此之前被释放的段，
+ * 保证崩溃后回到上一个检查点时所引用的数据仍然完好。后台清理器在空闲段
+ * 低于水位线时，选择存活块最少的段，把其中的存活块重新追加到日志尾部，
+ * 从而腾出整段空间。逻辑容量被限制为物理段容量的80%，为清理留出余量。
+ */
+class LogStructuredDevice : public BlockDevice {
+ public:
+  /**
+   * @brief 构造函数，接管下层设备的所有权。
+   * @param physical 已打开的下层块设备。
+   */
+  explicit LogStructuredDevice(std::unique_ptr<BlockDevice> physical);
+  ~LogStructuredDevice() override;
+
+  /**
+   * @brief 检查物理设备是否为日志结构格式。
+   */
+  static bool is_log_structured(BlockDevice& physical);
+
+  /**
+   * @brief 在物理设备上写入空的日志结构元数据。
+   * @param physical 已打开的下层块设备。
+   * @param segment_blocks 每段块数。
+   * @return bool 成功返回true。
+   */
+  static bool initialize(BlockDevice& physical, int segment_blocks);
+
+  /**
+   * @brief 加载最新的检查点并启动后台清理器。
+   * @param read_only 为true时只加载映射表，不启动清理器也不写检查点。
+   * @return bool 成功返回true。
+   */
+  bool open(bool read_only = false);
+
+  /**
+   * @brief 停止清理器并写入最终检查点（下层设备随对象析构关闭）。
+   */
+  void close();
+
+  bool read_block(int block_num, char* buffer) override;
+  bool write_block(int block_num, const char* buffer) override;
+  bool discard_block(int block_num) override;
+  bool flush() override;
+  int get_total_blocks() const override;
+  std::string describe() const override;
+  void collect_stats(std::vector<DeviceStats>& stats) const override;
+  bool drop_host_cache() override;
+
+ private:
+  /**
+   * @struct LogHeader
+   * @brief 检查点头的磁盘格式。
+   */
+  struct LogHeader {
+    char magic[8];                ///< 魔数 "DSIMLOG1"
+    std::uint32_t version;        ///< 格式版本
+    std::int32_t logical_blocks;  ///< 逻辑块数
+    std::int32_t segment_blocks;  ///< 每段块数
+    std::int32_t segment_count;   ///< 段数
+    std::int32_t map_blocks;      ///< 每份映射表占用的块数
+    std::int32_t head_segment;    ///< 当前写入段
+    std::int32_t head_offset;     ///< 当前段内下一个写入位置
+    std::uint64_t sequence;       ///< 检查点序号
+    std::uint64_t map_checksum;   ///< 映射表校验和（FNV-1a）
+  };
+
+  enum class SegmentState { Free, Open, Sealed, PendingFree };
+
+  static bool compute_geometry(int physical_blocks, int segment_blocks,
+                               LogHeader& header);
+  static std::uint64_t checksum_map(const BlockList& map);
+  static bool read_header(BlockDevice& physical, int slot,
+                          LogHeader& header);
+
+  bool load_checkpoint();
+  bool checkpoint_locked();
+  bool append_locked(int logical, const char* buffer, bool for_cleaner);
+  bool ensure_head_space_locked(bool for_cleaner);
+  bool open_next_segment_locked(bool for_cleaner);
+  bool clean_one_segment_locked();
+  void unmap_locked(int logical);
+  void set_mapping_locked(int logical, int physical_block);
+  int segment_of(int physical_block) const;
+  int segment_start(int segment) const;
+  int map_start(int slot) const;
+  std::size_t low_watermark() const;
+  void cleaner_loop();
+
+  std::unique_ptr<BlockDevice> physical_;  ///< 下层块设备
+
+  // --- 几何参数 ---
+  int logical_blocks_;   ///< 逻辑块数
+  int segment_blocks_;   ///< 每段块数
+  int segment_count_;    ///< 段数
+  int map_blocks_;       ///< 每份映射表块数
+  int segments_start_;   ///< 段区起始物理块号
+
+  // --- 运行时状态（由 state_mutex_ 保护） ---
+  BlockList map_;                         ///< 逻辑块 -> 物理块（-1表示未映射）
+  BlockList reverse_;                     ///< 段区槽位 -> 逻辑块（-1表示失效）
+  std::vector<std::uint8_t> map_dirty_;   ///< 每个映射块的脏位（第i位对应检查点槽位i）
+  std::vector<int> segment_live_;         ///< 每段存活块数
+  std::vector<SegmentState> segment_state_;  ///< 每段状态
+  std::deque<int> free_segments_;         ///< 可立即复用的段
+  std::vector<int> pending_free_;         ///< 待下一次检查点后才可复用的段
+  int head_segment_;                      ///< 当前写入段
+  int head_offset_;                       ///< 当前段内写入位置
+  std::uint64_t sequence_;                ///< 最近一次检查点序号
+  int checkpoint_slot_;                   ///< 最近一次检查点所在槽位
+  bool dirty_;                            ///< 自上次检查点以来是否有写入
+  bool opened_;                           ///< 是否已打开
+  bool read_only_;                        ///< 是否只读打开
+
+  // --- 统计 ---
+  std::uint64_t user_writes_;        ///< 来自文件系统的写块次数
+  std::uint64_t relocated_blocks_;   ///< 清理器搬迁的块数
+  std::uint64_t cleaned_segments_;   ///< 清理的段数
+  std::uint64_t checkpoint_writes_;  ///< 检查点写入的块数
+  std::uint64_t checkpoints_;        ///< 写入的检查点次数
+
+  mutable std::shared_mutex state_mutex_;  ///< 保护映射与段状态的读写锁
+
+  // --- 后台清理器 ---
+  std::thread cleaner_thread_;             ///< 清理线程
+  std::mutex cleaner_mutex_;               ///< 清理线程唤醒用互斥锁
+  std::condition_variable cleaner_cv_;     ///< 清理线程唤醒条件变量
+  bool cleaner_wakeup_;                    ///< 前台写入请求清理（由 cleaner_mutex_ 保护）
+  std::atomic<bool> stop_cleaner_;         ///< 停止标志
+};
@@ -0,0 +1,679 @@
+// ==============================================================================
+// @file   mirrored_device.cpp
+// @brief  镜像块设备的实现
+// ==============================================================================
+
+#include "mirrored_device.h"
+
+#include <algorithm>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+
+#include "../utils/block_utils.h"
+
+namespace {
+
+const char kMirrorMagic[8] = {'D', 'S', 'I', 'M', 'M', 'I', 'R', '1'};  ///< 魔数
+const std::uint32_t kMirrorVersion = 1;  ///< 格式版本
+const int kMaxMembers = 8;               ///< 最大成员数（stale_mask 的位宽内）
+const int kBitsPerMapBlock = BLOCK_SIZE * 8;
+const std::size_t kResyncChunk = 256;    ///< 重同步每复制多少块检查一次中断请求
+
+}  // namespace
+
+// ==============================================================================
+// 构造与析构
+// ==============================================================================
+
+MirroredDevice::MirroredDevice()
+    : data_blocks_(0),
+      map_blocks_(0),
+      generation_(0),
+      full_resync_(false),
+      read_only_(false),
+      opened_(false),
+      resynced_blocks_(0),
+      resync_pending_(0),
+      resync_cursor_(-1),
+      stop_resync_(false) {}
+
+MirroredDevice::~MirroredDevice() {
+  close();
+}
+
+// ==============================================================================
+// 集合的创建与识别
+// ==============================================================================
+
+std::string MirroredDevice::member_path(const std::string& primary_path,
+                                        int index) {
+  return index == 0 ? primary_path
+                    : primary_path + ".mirror" + std::to_string(index);
+}
+
+bool MirroredDevice::is_mirrored(FileBlockDevice& physical) {
+  MirrorHeader header;
+  return read_header(physical, header);
+}
+
+/**
+ * @brief 创建全部成员镜像并写入镜像集合头。
+ */
+bool MirroredDevice::create(const std::string& path, long size_bytes,
+                            int members) {
+  long data_blocks = size_bytes / BLOCK_SIZE;
+  if (members < 2 || members > kMaxMembers || data_blocks < 1) {
+    ErrorHandler::log_error(ERROR_INVALID_ARGUMENT,
+                            "Invalid mirror set: " + std::to_string(members) +
+                                " members");
+    return false;
+  }
+
+  MirrorHeader header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, kMirrorMagic, sizeof(kMirrorMagic));
+  header.version = kMirrorVersion;
+  header.member_count = members;
+  header.data_blocks = static_cast<std::int32_t>(data_blocks);
+  header.map_blocks =
+      static_cast<std::int32_t>((data_blocks + kBitsPerMapBlock - 1) / kBitsPerMapBlock);
+  header.map_valid = 1;
+  header.generation = 1;
+
+  long member_bytes =
+      static_cast<long>(1 + header.data_blocks + header.map_blocks) * BLOCK_SIZE;
+  for (int i = 0; i < members; ++i) {
+    std::string member = member_path(path, i);
+    if (!FileBlockDevice::create(member, member_bytes)) {
+      return false;
+    }
+
+    FileBlockDevice device;
+    if (!device.open(member)) {
+      return false;
+    }
+    header.member_index = i;
+    auto buffer = BlockUtils::create_block_buffer();
+    memcpy(buffer.get(), &header, sizeof(header));
+    if (!device.write_block(0, buffer.get())) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// ==============================================================================
+// 生命周期
+// ==============================================================================
+
+/**
+ * @brief 打开其余成员，按集合头代数判定各成员状态并在需要时启动重同步。
+ * @details 代数最大的集合头是权威来源：其 stale_mask 中的成员以及代数落后
+ *          的成员需要重同步；打不开或集合头不匹配的成员视为离线。
+ */
+bool MirroredDevice::open(std::unique_ptr<FileBlockDevice> primary) {
+  MirrorHeader primary_header;
+  if (!read_header(*primary, primary_header) ||
+      primary_header.member_index != 0) {
+    ErrorHandler::log_error(ERROR_INVALID_ARGUMENT,
+                            "Not the first member of a mirror set: " +
+                                primary->get_path());
+    return false;
+  }
+
+  int count = primary_header.member_count;
+  primary_path_ = primary->get_path();
+  read_only_ = primary->is_read_only();
+  data_blocks_ = primary_header.data_blocks;
+  map_blocks_ = primary_header.map_blocks;
+  members_.clear();
+  members_.resize(count);
+  states_.assign(count, MemberState::Offline);
+  inflight_.reset(new std::atomic<int>[count]);
+  std::vector<MirrorHeader> headers(count);
+
+  members_[0] = std::move(primary);
+  headers[0] = primary_header;
+  for (int i = 1; i < count; ++i) {
+    std::string member_file = member_path(primary_path_, i);
+    auto member = std::make_unique<FileBlockDevice>();
+    if (!member->open(member_file, read_only_)) {
+      ErrorHandler::log_error(ERROR_IO_ERROR,
+                              "Mirror member offline: " + member_file);
+      continue;
+    }
+    MirrorHeader& header = headers[i];
+    if (!read_header(*member, header) || header.member_index != i ||
+        header.member_count != count || header.data_blocks != data_blocks_ ||
+        header.map_blocks != map_blocks_) {
+      ErrorHandler::log_error(ERROR_INVALID_ARGUMENT,
+                              "Mirror member does not match set: " + member_file);
+      continue;
+    }
+    members_[i] = std::move(member);
+  }
+
+  int authority = 0;
+  for (int i = 0; i < count; ++i) {
+    inflight_[i] = 0;
+    if (members_[i] && headers[i].generation > headers[authority].generation) {
+      authority = i;
+    }
+  }
+  const MirrorHeader& latest = headers[authority];
+
+  bool cursor_valid = !latest.dirty && latest.resync_cursor > 0 &&
+                      latest.resync_cursor <= data_blocks_;
+  bool any_stale = false;
+  resync_start_.assign(count, 0);
+  for (int i = 0; i < count; ++i) {
+    if (!members_[i]) {
+      any_stale = true;
+      continue;
+    }
+    bool marked = (latest.stale_mask >> i) & 1u;
+    bool behind = headers[i].generation < latest.generation;
+    if (marked || behind) {
+      states_[i] = MemberState::Resyncing;
+      any_stale = true;
+      // 代数落后却未被标记：离线期间的写入没有记入位图
+      if (behind && !marked) {
+        full_resync_ = true;
+      } else if (cursor_valid && ((latest.resync_mask >> i) & 1u)) {
+        resync_start_[i] = latest.resync_cursor;
+      }
+    } else {
+      states_[i] = MemberState::InSync;
+    }
+  }
+  auto source = std::find(states_.begin(), states_.end(), MemberState::InSync);
+  if (source == states_.end()) {
+    ErrorHandler::log_error(ERROR_IO_ERROR,
+                            "No in-sync mirror member available: " + primary_path_);
+    members_.clear();
+    return false;
+  }
+
+  // 上次可写打开后没有正常关闭：崩溃前的写入可能只落到部分成员上，
+  // 只保留一个同步成员作为源，其余成员全量重同步
+  if (latest.dirty) {
+    int source_index = static_cast<int>(source - states_.begin());
+    ErrorHandler::log_error(ERROR_IO_ERROR,
+                            "Mirror set was not shut down cleanly, resyncing from member " +
+                                std::to_string(source_index) + ": " + primary_path_);
+    for (int i = 0; i < count; ++i) {
+      if (i != source_index && states_[i] == MemberState::InSync) {
+        states_[i] = MemberState::Resyncing;
+      }
+      resync_start_[i] = 0;
+    }
+    any_stale = true;
+    full_resync_ = true;
+  }
+
+  changed_map_.assign(static_cast<size_t>(map_blocks_) * BLOCK_SIZE, 0);
+  if (any_stale && (!latest.map_valid || !load_map(*members_[authority]))) {
+    full_resync_ = true;
+  }
+
+  std::lock_guard<std::mutex> lock(state_mutex_);
+  generation_ = latest.generation;
+  if (read_only_) {
+    opened_ = true;
+    return true;
+  }
+  // 集合头带上未关闭标记：运行期间位图只在内存中更新，崩溃后以此触发全量重同步
+  if (!write_headers_locked(!any_stale)) {
+    members_.clear();
+    return false;
+  }
+  opened_ = true;
+
+  if (std::find(states_.begin(), states_.end(), MemberState::Resyncing) !=
+      states_.end()) {
+    int first = data_blocks_;
+    for (int i = 0; i < count; ++i) {
+      if (states_[i] == MemberState::Resyncing) {
+        first = std::min(first, resync_start_[i]);
+      }
+    }
+    resync_pending_ = 0;
+    for (int block = first; block < data_blocks_; ++block) {
+      resync_pending_ += full_resync_ || ((changed_map_[block / 8] >> (block % 8)) & 1u);
+    }
+    stop_resync_ = false;
+    resync_cursor_ = -1;
+    resync_thread_ = std::thread(&MirroredDevice::resync_loop, this);
+  }
+  return true;
+}
+
+/**
+ * @brief 中断重同步并写回集合头与变更块位图。
+ * @details 重同步线程在两个块之间检查中断标志并记下进度；集合头只有在这里
+ *          才写成“已正常关闭”，同时保存进度供下次打开时继续。
+ */
+void MirroredDevice::close() {
+  if (resync_thread_.joinable()) {
+    stop_resync_ = true;
+    resync_thread_.join();
+  }
+
+  std::lock_guard<std::mutex> lock(state_mutex_);
+  if (opened_ && !read_only_) {
+    write_headers_locked(!full_resync_, true);
+    opened_ = false;
+  }
+}
+
+// ==============================================================================
+// 块级I/O
+// ==============================================================================
+
+bool MirroredDevice::read_block(int block_num, char* buffer) {
+  return read_blocks(block_num, 1, buffer);
+}
+
+bool MirroredDevice::write_block(int block_num, const char* buffer) {
+  return write_blocks(block_num, 1, buffer);
+}
+
+/**
+ * @brief 读取连续块：大块请求拆成若干段由不同的同步成员并行读取。
+ */
+bool MirroredDevice::read_blocks(int start_block, int count, char* buffer) {
+  std::vector<int> readers;
+  {
+    std::lock_guard<std::mutex> lock(state_mutex_);
+    for (size_t i = 0; i < states_.size(); ++i) {
+      if (states_[i] == MemberState::InSync) {
+        readers.push_back(static_cast<int>(i));
+      }
+    }
+  }
+
+  auto read_range = [&](int first, int blocks) {
+    // 成员失败时换下一个成员重试，直到没有同步成员可用
+    while (true) {
+      int member = choose_reader(first);
+      if (member < 0) {
+        ErrorHandler::log_error(ERROR_IO_ERROR,
+                                "No in-sync mirror member for block " +
+                                    std::to_string(first));
+        return false;
+      }
+      ++inflight_[member];
+      bool ok = members_[member]->read_blocks(
+          first + 1, blocks,
+          buffer + static_cast<size_t>(first - start_block) * BLOCK_SIZE);
+      --inflight_[member];
+      if (ok) {
+        return true;
+      }
+      member_failed(member);
+    }
+  };
+
+  int parts = std::min(static_cast<int>(readers.size()), count / 4);
+  if (parts < 2) {
+    return read_range(start_block, count);
+  }
+
+  std::atomic<bool> ok(true);
+  std::vector<std::thread> workers;
+  int chunk = (count + parts - 1) / parts;
+  for (int first = start_block; first < start_block + count; first += chunk) {
+    int blocks = std::min(chunk, start_block + count - first);
+    workers.emplace_back([&, first, blocks]() {
+      if (!read_range(first, blocks)) {
+        ok = false;
+      }
+    });
+  }
+  for (auto& worker : workers) {
+    worker.join();
+  }
+  return ok;
+}
+
+/**
+ * @brief 写入连续块：持有涉及的块分段锁后并行写入所有在线成员。
+ */
+bool MirroredDevice::write_blocks(int start_block, int count,
+                                  const char* buffer) {
+  if (read_only_) {
+    ErrorHandler::log_error(ERROR_PERMISSION_DENIED,
+                            "Write to read-only mirror set at block " +
+                                std::to_string(start_block));
+    return false;
+  }
+  std::vector<bool> stripes(kLockStripes, false);
+  for (int i = 0; i < std::min(count, kLockStripes); ++i) {
+    stripes[(start_block + i) % kLockStripes] = true;
+  }
+  // 按固定顺序加锁，避免与重同步线程或其他写入死锁
+  for (int s = 0; s < kLockStripes; ++s) {
+    if (stripes[s]) {
+      block_locks_[s].lock();
+    }
+  }
+  bool ok = write_to_members(start_block, count, buffer);
+  for (int s = kLockStripes - 1; s >= 0; --s) {
+    if (stripes[s]) {
+      block_locks_[s].unlock();
+    }
+  }
+  return ok;
+}
+
+int MirroredDevice::get_total_blocks() const { return data_blocks_; }
+
+std::string MirroredDevice::describe() const {
+  std::lock_guard<std::mutex> lock(state_mutex_);
+  int in_sync = 0;
+  std::string offline;
+  std::string resyncing;
+  for (size_t i = 0; i < states_.size(); ++i) {
+    if (states_[i] == MemberState::InSync) {
+      ++in_sync;
+    } else {
+      std::string& list = states_[i] == MemberState::Offline ? offline : resyncing;
+      list += (list.empty() ? "" : ",") + std::to_string(i);
+    }
+  }
+
+  std::ostringstream oss;
+  oss << "mirrored (" << states_.size() << " members, " << in_sync
+      << " in sync)";
+  if (!resyncing.empty()) {
+    oss << std::endl << "    Resyncing members: " << resyncing << " ("
+        << resync_pending_ << " blocks pending)";
+  }
+  if (!offline.empty()) {
+    oss << std::endl << "    Offline members: " << offline;
+  }
+  oss << std::endl << "    Resynced blocks: " << resynced_blocks_;
+  return oss.str();
+}
+
+void MirroredDevice::collect_stats(std::vector<DeviceStats>& stats) const {
+  for (const auto& member : members_) {
+    if (member) {
+      member->collect_stats(stats);
+    }
+  }
+}
+
+bool MirroredDevice::drop_host_cache() {
+  bool ok = true;
+  for (const auto& member : members_) {
+    if (member) {
+      ok = member->drop_host_cache() && ok;
+    }
+  }
+  return ok;
+}
+
+// ==============================================================================
+// 私有辅助方法
+// ==============================================================================
+
+/**
+ * @brief 读取并校验物理设备块0中的镜像集合头。
+ */
+bool MirroredDevice::read_header(FileBlockDevice& physical,
+                                 MirrorHeader& header) {
+  if (physical.get_total_blocks() < 2) {
+    return false;
+  }
+  auto buffer = BlockUtils::create_block_buffer();
+  if (!physical.read_block(0, buffer.get())) {
+    return false;
+  }
+  memcpy(&header, buffer.get(), sizeof(header));
+  return memcmp(header.magic, kMirrorMagic, sizeof(kMirrorMagic)) == 0 &&
+         header.version == kMirrorVersion && header.member_count >= 2 &&
+         header.member_count <= kMaxMembers && header.member_index >= 0 &&
+         header.member_index < header.member_count &&
+         header.data_blocks > 0 && header.map_blocks > 0 &&
+         physical.get_total_blocks() >=
+             1 + header.data_blocks + header.map_blocks;
+}
+
+/**
+ * @brief 向所有在线成员写入新一代集合头（调用方持有 state_mutex_）。
+ * @param map_valid 为true时同时写出变更块位图，并声明其完整可信。
+ * @param clean 为true时清除未关闭标记并保存被中断的重同步进度（仅 close 使用）。
+ */
+bool MirroredDevice::write_headers_locked(bool map_valid, bool clean) {
+  MirrorHeader header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, kMirrorMagic, sizeof(kMirrorMagic));
+  header.version = kMirrorVersion;
+  header.member_count = static_cast<std::int32_t>(states_.size());
+  header.data_blocks = data_blocks_;
+  header.map_blocks = map_blocks_;
+  header.map_valid = map_valid ? 1 : 0;
+  header.generation = ++generation_;
+  header.dirty = clean ? 0 : 1;
+  for (size_t i = 0; i < states_.size(); ++i) {
+    if (states_[i] != MemberState::InSync) {
+      header.stale_mask |= 1u << i;
+    }
+  }
+  // 每个重同步成员在 max(起始块, 中断位置) 之前都已同步，取其中最小者
+  if (clean && resync_cursor_ >= 0) {
+    int cursor = data_blocks_;
+    for (size_t i = 0; i < states_.size(); ++i) {
+      if (states_[i] == MemberState::Resyncing) {
+        header.resync_mask |= 1u << i;
+        cursor = std::min(cursor, std::max(resync_start_[i], resync_cursor_));
+      }
+    }
+    header.resync_cursor = header.resync_mask ? cursor : 0;
+  }
+
+  bool written = false;
+  auto buffer = BlockUtils::create_block_buffer();
+  for (size_t i = 0; i < states_.size(); ++i) {
+    if (states_[i] == MemberState::Offline) {
+      continue;
+    }
+    header.member_index = static_cast<std::int32_t>(i);
+    memcpy(buffer.get(), &header, sizeof(header));
+    bool ok = true;
+    if (map_valid) {
+      ok = members_[i]->write_blocks(1 + data_blocks_, map_blocks_,
+                                     reinterpret_cast<const char*>(changed_map_.data()));
+    }
+    ok = ok && members_[i]->write_block(0, buffer.get());
+    written = written || ok;
+  }
+  return written;
+}
+
+/**
+ * @brief 从成员读取持久化的变更块位图。
+ */
+bool MirroredDevice::load_map(FileBlockDevice& source) {
+  return source.read_blocks(1 + data_blocks_, map_blocks_,
+                            reinterpret_cast<char*>(changed_map_.data()));
+}
+
+/**
+ * @brief 选择读取成员：在途请求最少者优先，其次是磁头离目标块最近者。
+ * @return int 成员序号，没有同步成员时返回-1。
+ */
+int MirroredDevice::choose_reader(int block_num) {
+  std::lock_guard<std::mutex> lock(state_mutex_);
+  int best = -1;
+  int best_queue = INT_MAX;
+  long best_distance = LONG_MAX;
+  for (size_t i = 0; i < states_.size(); ++i) {
+    if (states_[i] != MemberState::InSync) {
+      continue;
+    }
+    int queue = inflight_[i];
+    int head = members_[i]->head_position();
+    long distance = head < 0 ? 0 : std::labs(static_cast<long>(block_num + 1) - head);
+    if (queue < best_queue || (queue == best_queue && distance < best_distance)) {
+      best = static_cast<int>(i);
+      best_queue = queue;
+      best_distance = distance;
+    }
+  }
+  return best;
+}
+
+/**
+ * @brief 把数据写入所有在线成员（调用方持有对应的块分段锁）。
+ * @return bool 至少一个成员写入成功返回true。
+ */
+bool MirroredDevice::write_to_members(int start_block, int count,
+                                      const char* buffer) {
+  std::vector<size_t> targets;
+  bool has_offline = false;
+  {
+    std::lock_guard<std::mutex> lock(state_mutex_);
+    for (size_t i = 0; i < states_.size(); ++i) {
+      if (states_[i] == MemberState::Offline) {
+        has_offline = true;
+      } else {
+        targets.push_back(i);
+      }
+    }
+  }
+  if (has_offline) {
+    mark_dirty(start_block, count);
+  }
+
+  std::vector<char> results(targets.size(), 0);
+  auto write_member = [&](size_t slot) {
+    results[slot] =
+        members_[targets[slot]]->write_blocks(start_block + 1, count, buffer) ? 1 : 0;
+  };
+  if (targets.size() > 1 && count > 1) {
+    std::vector<std::thread> workers;
+    for (size_t slot = 1; slot < targets.size(); ++slot) {
+      workers.emplace_back(write_member, slot);
+    }
+    write_member(0);
+    for (auto& worker : workers) {
+      worker.join();
+    }
+  } else {
+    for (size_t slot = 0; slot < targets.size(); ++slot) {
+      write_member(slot);
+    }
+  }
+
+  bool any_ok = false;
+  for (size_t slot = 0; slot < targets.size(); ++slot) {
+    if (results[slot]) {
+      any_ok = true;
+    } else {
+      member_failed(targets[slot]);
+      mark_dirty(start_block, count);
+    }
+  }
+  return any_ok;
+}
+
+/**
+ * @brief 在变更块位图中记录一段写入。
+ */
+void MirroredDevice::mark_dirty(int start_block, int count) {
+  std::lock_guard<std::mutex> lock(state_mutex_);
+  for (int block = start_block; block < start_block + count; ++block) {
+    changed_map_[block / 8] |= static_cast<std::uint8_t>(1u << (block % 8));
+  }
+}
+
+/**
+ * @brief 将写入或读取失败的成员标记为离线，并立即持久化离线掩码。
+ */
+void MirroredDevice::member_failed(size_t member) {
+  std::lock_guard<std::mutex> lock(state_mutex_);
+  if (states_[member] == MemberState::Offline) {
+    return;
+  }
+  ErrorHandler::log_error(ERROR_IO_ERROR,
+                          "Mirror member failed, taking it offline: " +
+                              member_path(primary_path_, static_cast<int>(member)));
+  states_[member] = MemberState::Offline;
+  write_headers_locked(false);
+}
+
+/**
+ * @brief 后台重同步：把位图中的块（或全部块）从同步成员复制到重同步成员。
+ * @details 重同步成员同时接收前台写入，因此一遍扫描即可追平；扫描期间的
+ *          复制按块持有分段锁，保证不会用旧数据覆盖并发写入的新数据。
+ *          每个成员从各自的起始块开始（之前的块在上次中断前已复制）；
+ *          每复制完一段检查一次中断请求，close 请求中断时记下下一个待复制
+ *          的块后退出。每次打开至少完成一段，短命令反复打开也能推进进度。
+ */
+void MirroredDevice::resync_loop() {
+  std::vector<int> blocks;
+  std::vector<size_t> targets;
+  {
+    std::lock_guard<std::mutex> lock(state_mutex_);
+    int first = data_blocks_;
+    for (size_t i = 0; i < states_.size(); ++i) {
+      if (states_[i] == MemberState::Resyncing) {
+        targets.push_back(i);
+        first = std::min(first, resync_start_[i]);
+      }
+    }
+    for (int block = first; block < data_blocks_; ++block) {
+      if (full_resync_ || (changed_map_[block / 8] >> (block % 8)) & 1u) {
+        blocks.push_back(block);
+      }
+    }
+    resync_pending_ = static_cast<int>(blocks.size());
+  }
+
+  auto buffer = BlockUtils::create_block_buffer();
+  for (std::size_t index = 0; index < blocks.size(); ++index) {
+    int block = blocks[index];
+    if (index > 0 && index % kResyncChunk == 0 &&
+        stop_resync_.load(std::memory_order_relaxed)) {
+      std::lock_guard<std::mutex> lock(state_mutex_);
+      resync_cursor_ = block;
+      return;
+    }
+    std::lock_guard<std::mutex> block_lock(block_locks_[block % kLockStripes]);
+    int source = choose_reader(block);
+    if (source < 0 || !members_[source]->read_block(block + 1, buffer.get())) {
+      ErrorHandler::log_error(ERROR_IO_ERROR,
+                              "Mirror resync aborted at block " + std::to_string(block));
+      return;
+    }
+    for (size_t member : targets) {
+      if (block >= resync_start_[member] &&
+          !members_[member]->write_block(block + 1, buffer.get())) {
+        member_failed(member);
+      }
+    }
+    std::lock_guard<std::mutex> lock(state_mutex_);
+    ++resynced_blocks_;
+    --resync_pending_;
+  }
+
+  std::lock_guard<std::mutex> lock(state_mutex_);
+  std::fill(resync_start_.begin(), resync_start_.end(), 0);
+  bool has_offline = false;
+  for (size_t i = 0; i < states_.size(); ++i) {
+    if (states_[i] == MemberState::Resyncing) {
+      states_[i] = MemberState::InSync;
+    }
+    has_offline = has_offline || states_[i] == MemberState::Offline;
+  }
+  // 仍有离线成员时保留位图，供其重新上线时使用
+  if (!has_offline) {
+    std::fill(changed_map_.begin(), changed_map_.end(), 0);
+    full_resync_ = false;
+  }
+  write_headers_locked(!has_offline);
+}
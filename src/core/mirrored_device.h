@@ -0,0 +1,152 @@
+// ==============================================================================
+// @file   mirrored_device.h
+// @brief  镜像块设备（RAID-1）：写入所有成员，读取在成员间负载均衡，后台重同步
+// ==============================================================================
+
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../utils/common.h"
+#include "../utils/error_codes.h"
+#include "../utils/error_handler.h"
+#include "block_device.h"
+#include "file_block_device.h"
+
+/**
+ * @class MirroredDevice
+ * @brief 把每个逻辑块同时写入 K 个成员镜像文件，读取时只访问其中一个。
+ *
+ * 成员布局：块0为镜像集合头，块 1..N 为数据块（逻辑块 b 位于 b + 1），
+ * 其后是变更块位图。成员0即传给程序的 `<disk_file>`，其余成员为同目录
+ * 下的 `<disk_file>.mirror<i>`。
+ *
+ * 读取时在同步成员中选择在途请求最少者，相同时选择模拟磁头位置离目标块
+ * 最近者，因此并发读和交错的顺序读可以分摊到所有成员上，冗余反而提升
+ * 读吞吐。
+ *
+ * 打开时缺失或写入失败的成员被标记为离线，此后的每次写入都在变更块位图
+ * 中置位；正常关闭时位图与“离线成员掩码”一起写入所有在线成员的集合头。
+ * 离线成员重新出现后，后台线程按位图（位图不可信时为全部块）从同步成员
+ * 复制数据，完成后该成员重新参与读取。复制与前台写入按块加分段锁，避免
+ * 旧数据覆盖新写入。
+ *
+ * 以可写方式打开时集合头带“未关闭”标记，只有 close 才清除。崩溃后再次
+ * 打开时，中途的写入可能只落到了部分成员上，因此只保留一个同步成员，以它
+ * 为源全量重同步其余成员。close 会中断进行中的重同步，并把已复制到的块号
+ * 写入集合头，下次正常打开时从该处继续。
+ */
+class MirroredDevice : public BlockDevice {
+ public:
+  MirroredDevice();
+  ~MirroredDevice() override;
+
+  /**
+   * @brief 获取第 index 个成员镜像的路径（成员0为主镜像本身）。
+   */
+  static std::string member_path(const std::string& primary_path, int index);
+
+  /**
+   * @brief 检查物理设备是否为镜像集合的成员。
+   */
+  static bool is_mirrored(FileBlockDevice& physical);
+
+  /**
+   * @brief 创建全部成员镜像并写入镜像集合头。
+   * @param path 主镜像路径。
+   * @param size_bytes 逻辑容量（字节），每个成员都保存完整副本。
+   * @param members 成员数。
+   * @return bool 成功返回true。
+   */
+  static bool create(const std::string& path, long size_bytes, int members);
+
+  /**
+   * @brief 以已打开的主镜像为成员0，打开其余成员并在需要时启动重同步。
+   * @details 主镜像以只读方式打开时，其余成员同样只读打开，不写集合头也
+   *          不做重同步，读取只使用同步成员。
+   * @param primary 已打开的主镜像设备。
+   * @return bool 至少有一个同步成员可用时返回true。
+   */
+  bool open(std::unique_ptr<FileBlockDevice> primary);
+
+  /**
+   * @brief 中断重同步并写回集合头（含重同步进度）与变更块位图。
+   */
+  void close();
+
+  bool read_block(int block_num, char* buffer) override;
+  bool write_block(int block_num, const char* buffer) override;
+  bool read_blocks(int start_block, int count, char* buffer) override;
+  bool write_blocks(int start_block, int count, const char* buffer) override;
+  int get_total_blocks() const override;
+  std::string describe() const override;
+  void collect_stats(std::vector<DeviceStats>& stats) const override;
+  bool drop_host_cache() override;
+
+ private:
+  /**
+   * @struct MirrorHeader
+   * @brief 成员块0中的镜像集合头。
+   */
+  struct MirrorHeader {
+    char magic[8];               ///< 魔数 "DSIMMIR1"
+    std::uint32_t version;       ///< 格式版本
+    std::int32_t member_count;   ///< 成员数
+    std::int32_t member_index;   ///< 本成员序号
+    std::int32_t data_blocks;    ///< 数据块数
+    std::int32_t map_blocks;     ///< 变更块位图块数
+    std::uint32_t stale_mask;    ///< 需要重同步的成员掩码
+    std::int32_t map_valid;      ///< 位图是否完整记录了离线期间的写入
+    std::uint64_t generation;    ///< 集合头代数，越大越新
+    std::int32_t dirty;          ///< 以可写方式打开后尚未正常关闭
+    std::int32_t resync_cursor;  ///< 被中断的重同步在此块号之前已完成
+    std::uint32_t resync_mask;   ///< resync_cursor 适用的成员掩码
+  };
+
+  /**
+   * @enum MemberState
+   * @brief 成员状态。
+   */
+  enum class MemberState { InSync, Resyncing, Offline };
+
+  static constexpr int kLockStripes = 64;  ///< 块分段锁数量
+
+  static bool read_header(FileBlockDevice& physical, MirrorHeader& header);
+  bool write_headers_locked(bool map_valid, bool clean = false);
+  bool load_map(FileBlockDevice& source);
+  int choose_reader(int block_num);
+  bool write_to_members(int start_block, int count, const char* buffer);
+  void mark_dirty(int start_block, int count);
+  void member_failed(size_t member);
+  void resync_loop();
+
+  std::vector<std::unique_ptr<FileBlockDevice>> members_;  ///< 成员镜像（离线时为空）
+  std::vector<MemberState> states_;                         ///< 成员状态
+  std::unique_ptr<std::atomic<int>[]> inflight_;            ///< 每个成员的在途读请求数
+  std::string primary_path_;   ///< 主镜像路径
+  int data_blocks_;            ///< 数据块数
+  int map_blocks_;             ///< 位图块数
+  std::uint64_t generation_;   ///< 当前集合头代数
+  bool full_resync_;           ///< 位图不可信，需要复制全部块
+  bool read_only_;             ///< 是否只读打开
+  bool opened_;                ///< 是否已打开
+
+  std::vector<std::uint8_t,
+              TrackedAllocator<std::uint8_t, MemSubsystem::Bitmaps>>
+      changed_map_;  ///< 离线期间被写入的块（按位）
+  std::uint64_t resynced_blocks_;          ///< 已重同步的块数
+  int resync_pending_;                     ///< 尚待复制的块数
+  std::vector<int> resync_start_;          ///< 每个重同步成员的起始块（之前的块已同步）
+  int resync_cursor_;                      ///< 重同步被中断时下一个待复制的块（-1表示未中断）
+  std::atomic<bool> stop_resync_;          ///< 请求中断重同步
+
+  mutable std::mutex state_mutex_;  ///< 保护成员状态、位图与统计
+  std::array<std::mutex, kLockStripes> block_locks_;  ///< 重同步与写入之间的块分段锁
+  std::thread resync_thread_;       ///< 重同步线程
+};
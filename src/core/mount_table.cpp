@@ -0,0 +1,328 @@
+// ==============================================================================
+// @file   mount_table.cpp
+// @brief  挂载表的实现
+// ==============================================================================
+
+#include "mount_table.h"
+
+#include <unistd.h>
+
+#include <climits>
+#include <cstdlib>
+#include <fstream>
+
+#include "filesystem.h"
+
+namespace {
+
+const char kTableHeader[] = "# disk_sim mount table";  ///< 挂载表文件首行
+const int kMountedFdBase = 1 << 20;  ///< 子文件系统描述符的全局编号起点
+
+/**
+ * @brief 获取文件的绝对规范路径，失败时返回原路径。
+ */
+std::string canonical_path(const std::string& path) {
+  char resolved[PATH_MAX];
+  if (realpath(path.c_str(), resolved) == nullptr) {
+    return path;
+  }
+  return resolved;
+}
+
+}  // namespace
+
+// ==============================================================================
+// 构造与析构
+// ==============================================================================
+
+MountTable::MountTable() : read_only_(false), next_fd_(kMountedFdBase) {}
+
+MountTable::~MountTable() {
+  close();
+}
+
+// ==============================================================================
+// 挂载表文件
+// ==============================================================================
+
+std::string MountTable::table_path_for(const std::string& image_path) {
+  return image_path + ".mounts";
+}
+
+bool MountTable::remove_table_file(const std::string& image_path) {
+  std::string path = table_path_for(image_path);
+  if (unlink(path.c_str()) != 0 && access(path.c_str(), F_OK) == 0) {
+    ErrorHandler::log_error(ERROR_IO_ERROR,
+                            "Failed to remove mount table: " + path);
+    return false;
+  }
+  return true;
+}
+
+/**
+ * @brief 加载根镜像的挂载表并挂载其中记录的镜像。
+ */
+bool MountTable::open(const std::string& root_image, bool read_only) {
+  std::unique_lock<std::shared_mutex> lock(table_mutex_);
+  read_only_ = read_only;
+  root_image_ = canonical_path(root_image);
+  table_path_ = table_path_for(root_image);
+  mounts_.clear();
+
+  std::ifstream input(table_path_);
+  if (!input.is_open()) {
+    return true;  // 没有挂载表
+  }
+
+  std::string line;
+  while (std::getline(input, line)) {
+    if (line.empty() || line[0] == '#') {
+      continue;
+    }
+    size_t separator = line.find('\t');
+    if (separator == std::string::npos) {
+      ErrorHandler::log_error(ERROR_INVALID_SYNTAX,
+                              "Malformed mount table entry: " + line);
+      continue;
+    }
+    // 单个镜像挂载失败不影响其余挂载点
+    mount_entry(line.substr(0, separator), line.substr(separator + 1));
+  }
+  return true;
+}
+
+/**
+ * @brief 卸载所有子文件系统。
+ */
+void MountTable::close() {
+  std::unique_lock<std::shared_mutex> lock(table_mutex_);
+  for (auto& entry : mounts_) {
+    entry.fs->unmount();
+  }
+  mounts_.clear();
+
+  std::lock_guard<std::mutex> fd_lock(fd_mutex_);
+  fd_map_.clear();
+}
+
+/**
+ * @brief 卸载所有子文件系统并删除挂载表文件。
+ */
+bool MountTable::clear() {
+  close();
+  if (root_image_.empty()) {
+    return true;
+  }
+  std::unique_lock<std::shared_mutex> lock(table_mutex_);
+  if (unlink(table_path_.c_str()) != 0 && access(table_path_.c_str(), F_OK) == 0) {
+    ErrorHandler::log_error(ERROR_IO_ERROR,
+                            "Failed to remove mount table: " + table_path_);
+    return false;
+  }
+  return true;
+}
+
+/**
+ * @brief 以制表符分隔的文本格式写回挂载表。
+ */
+bool MountTable::save() const {
+  if (mounts_.empty()) {
+    if (unlink(table_path_.c_str()) != 0 && access(table_path_.c_str(), F_OK) == 0) {
+      ErrorHandler::log_error(ERROR_IO_ERROR,
+                              "Failed to remove mount table: " + table_path_);
+      return false;
+    }
+    return true;
+  }
+
+  std::ofstream output(table_path_, std::ios::trunc);
+  if (!output.is_open()) {
+    ErrorHandler::log_error(ERROR_IO_ERROR,
+                            "Failed to write mount table: " + table_path_);
+    return false;
+  }
+  output << kTableHeader << "\n";
+  for (const auto& entry : mounts_) {
+    output << entry.info.mount_point << "\t" << entry.info.image_path << "\n";
+  }
+  return output.good();
+}
+
+// ==============================================================================
+// 挂载与卸载
+// ==============================================================================
+
+/**
+ * @brief 在指定前缀挂载一个镜像并持久化挂载表。
+ */
+bool MountTable::add(const std::string& mount_point,
+                     const std::string& image_path) {
+  std::unique_lock<std::shared_mutex> lock(table_mutex_);
+  if (!mount_entry(mount_point, image_path)) {
+    return false;
+  }
+  if (!save()) {
+    mounts_.back().fs->unmount();
+    mounts_.pop_back();
+    return false;
+  }
+  return true;
+}
+
+/**
+ * @brief 卸载指定前缀上的镜像并持久化挂载表。
+ */
+bool MountTable::remove(const std::string& mount_point) {
+  std::unique_lock<std::shared_mutex> lock(table_mutex_);
+  auto it = mounts_.begin();
+  for (; it != mounts_.end(); ++it) {
+    if (it->info.mount_point == mount_point) {
+      break;
+    }
+  }
+  if (it == mounts_.end()) {
+    ErrorHandler::log_error(ERROR_NOT_MOUNTED,
+                            "Not a mount point: " + mount_point);
+    return false;
+  }
+
+  {
+    std::lock_guard<std::mutex> fd_lock(fd_mutex_);
+    for (const auto& item : fd_map_) {
+      if (item.second.first == it->fs.get()) {
+        ErrorHandler::log_error(ERROR_UNMOUNT_FAILED,
+                                "Mount point busy: " + mount_point);
+        return false;
+      }
+    }
+  }
+
+  it->fs->unmount();
+  mounts_.erase(it);
+  return save();
+}
+
+/**
+ * @brief 校验并挂载单个条目（调用方持有独占锁）。
+ */
+bool MountTable::mount_entry(const std::string& mount_point,
+                             const std::string& image_path) {
+  if (mount_point.empty() || mount_point[0] != '/' || mount_point == "/") {
+    ErrorHandler::log_error(ERROR_INVALID_PATH,
+                            "Invalid mount point: " + mount_point);
+    return false;
+  }
+
+  // 同一镜像只能打开一次：flock 独占锁在同一进程内重复获取会阻塞
+  std::string image = canonical_path(image_path);
+  if (image == root_image_) {
+    ErrorHandler::log_error(ERROR_ALREADY_MOUNTED,
+                            "Image is the root file system: " + image_path);
+    return false;
+  }
+  for (const auto& entry : mounts_) {
+    if (entry.info.image_path == image) {
+      ErrorHandler::log_error(ERROR_ALREADY_MOUNTED,
+                              "Image already mounted at " +
+                                  entry.info.mount_point + ": " + image_path);
+      return false;
+    }
+    if (is_under(mount_point, entry.info.mount_point) ||
+        is_under(entry.info.mount_point, mount_point)) {
+      ErrorHandler::log_error(ERROR_ALREADY_MOUNTED,
+                              "Mount point overlaps " +
+                                  entry.info.mount_point + ": " + mount_point);
+      return false;
+    }
+  }
+
+  auto fs = std::make_unique<FileSystem>();
+  if (!fs->mount_internal(image, false, read_only_)) {
+    ErrorHandler::log_error(ERROR_MOUNT_FAILED,
+                            "Cannot mount " + image_path + " at " + mount_point);
+    return false;
+  }
+
+  MountEntry entry;
+  entry.info.mount_point = mount_point;
+  entry.info.image_path = image;
+  entry.fs = std::move(fs);
+  mounts_.push_back(std::move(entry));
+  return true;
+}
+
+// ==============================================================================
+// 路径与描述符解析
+// ==============================================================================
+
+/**
+ * @brief 按最长前缀匹配把路径解析到子文件系统。
+ */
+bool MountTable::resolve(const std::string& normalized_path,
+                         Route& route) const {
+  std::shared_lock<std::shared_mutex> lock(table_mutex_);
+  const MountEntry* best = nullptr;
+  for (const auto& entry : mounts_) {
+    if (is_under(normalized_path, entry.info.mount_point) &&
+        (best == nullptr ||
+         entry.info.mount_point.size() > best->info.mount_point.size())) {
+      best = &entry;
+    }
+  }
+  if (best == nullptr) {
+    return false;
+  }
+
+  route.fs = best->fs.get();
+  route.path = normalized_path.size() == best->info.mount_point.size()
+                   ? "/"
+                   : normalized_path.substr(best->info.mount_point.size());
+  route.guard = std::move(lock);
+  return true;
+}
+
+void MountTable::list(std::vector<MountInfo>& mounts) const {
+  std::shared_lock<std::shared_mutex> lock(table_mutex_);
+  mounts.clear();
+  for (const auto& entry : mounts_) {
+    mounts.push_back(entry.info);
+  }
+}
+
+int MountTable::register_fd(FileSystem* fs, int child_fd) {
+  std::lock_guard<std::mutex> lock(fd_mutex_);
+  int fd = next_fd_++;
+  fd_map_[fd] = std::make_pair(fs, child_fd);
+  return fd;
+}
+
+bool MountTable::resolve_fd(int fd, FdRoute& route) const {
+  if (fd < kMountedFdBase) {
+    return false;
+  }
+  std::shared_lock<std::shared_mutex> lock(table_mutex_);
+  std::lock_guard<std::mutex> fd_lock(fd_mutex_);
+  auto it = fd_map_.find(fd);
+  if (it == fd_map_.end()) {
+    return false;
+  }
+  route.fs = it->second.first;
+  route.fd = it->second.second;
+  route.guard = std::move(lock);
+  return true;
+}
+
+void MountTable::release_fd(int fd) {
+  std::lock_guard<std::mutex> lock(fd_mutex_);
+  fd_map_.erase(fd);
+}
+
+/**
+ * @brief 判断路径是否等于前缀或位于前缀目录之下。
+ */
+bool MountTable::is_under(const std::string& path, const std::string& prefix) {
+  if (path.compare(0, prefix.size(), prefix) != 0) {
+    return false;
+  }
+  return path.size() == prefix.size() || path[prefix.size()] == '/';
+}
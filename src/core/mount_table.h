@@ -0,0 +1,178 @@
+// ==============================================================================
+// @file   mount_table.h
+// @brief  挂载表：在同一命名空间的不同前缀下挂载多个磁盘镜像
+// ==============================================================================
+
+#pragma once
+#include <map>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <vector>
+
+#include "../utils/common.h"
+#include "../utils/error_codes.h"
+#include "../utils/error_handler.h"
+
+class FileSystem;
+
+/**
+ * @struct MountInfo
+ * @brief 一个挂载点的描述信息。
+ */
+struct MountInfo {
+  std::string mount_point;  ///< 挂载前缀，例如 "/data"
+  std::string image_path;   ///< 镜像文件的绝对路径
+};
+
+/**
+ * @class MountTable
+ * @brief 把路径前缀映射到独立的子文件系统。
+ *
+ * 每个挂载点拥有自己的 FileSystem 实例，因而拥有独立的读写锁、缓存和
+ * 块设备，不同挂载点上的操作互不阻塞，可以把负载分散到多个镜像（以及
+ * 它们所在的宿主磁盘）上。挂载表保存在根镜像旁的 `<image>.mounts`
+ * 文件中，文件系统挂载根镜像时自动挂载其中记录的镜像。
+ *
+ * 路径按最长前缀匹配；挂载点必须是根镜像中已存在的目录，且挂载点之间
+ * 不允许嵌套。子文件系统返回的文件描述符被重映射到独立的编号空间，
+ * 避免与根文件系统的描述符冲突。
+ */
+class MountTable {
+ public:
+  /**
+   * @struct Route
+   * @brief 路径解析结果；持有挂载表的共享锁，保证子文件系统在使用期间不被卸载。
+   */
+  struct Route {
+    FileSystem* fs{nullptr};                    ///< 目标子文件系统
+    std::string path;                           ///< 子文件系统内的路径
+    std::shared_lock<std::shared_mutex> guard;  ///< 挂载表共享锁
+  };
+
+  /**
+   * @struct FdRoute
+   * @brief 文件描述符解析结果。
+   */
+  struct FdRoute {
+    FileSystem* fs{nullptr};                    ///< 目标子文件系统
+    int fd{-1};                                 ///< 子文件系统内的描述符
+    std::shared_lock<std::shared_mutex> guard;  ///< 挂载表共享锁
+  };
+
+  MountTable();
+  ~MountTable();
+
+  /**
+   * @brief 获取镜像对应的挂载表文件路径。
+   */
+  static std::string table_path_for(const std::string& image_path);
+
+  /**
+   * @brief 删除镜像对应的挂载表文件（不存在时视为成功）。
+   */
+  static bool remove_table_file(const std::string& image_path);
+
+  /**
+   * @brief 加载根镜像的挂载表并挂载其中记录的镜像。
+   * @details 单个镜像挂载失败只记录错误并跳过，不影响根文件系统的挂载。
+   * @param root_image 根镜像路径。
+   * @param read_only 为true时以只读方式挂载表中的镜像。
+   * @return bool 挂载表文件可读（或不存在）返回true。
+   */
+  bool open(const std::string& root_image, bool read_only = false);
+
+  /**
+   * @brief 卸载所有子文件系统。
+   */
+  void close();
+
+  /**
+   * @brief 卸载所有子文件系统并删除挂载表文件。
+   * @return bool 成功返回true。
+   */
+  bool clear();
+
+  /**
+   * @brief 在指定前缀挂载一个镜像并持久化挂载表。
+   * @param mount_point 已规范化的挂载前缀。
+   * @param image_path 镜像文件路径。
+   * @return bool 成功返回true。
+   */
+  bool add(const std::string& mount_point, const std::string& image_path);
+
+  /**
+   * @brief 卸载指定前缀上的镜像并持久化挂载表。
+   * @param mount_point 已规范化的挂载前缀。
+   * @return bool 成功返回true；仍有打开的文件时返回false。
+   */
+  bool remove(const std::string& mount_point);
+
+  /**
+   * @brief 按最长前缀匹配把路径解析到子文件系统。
+   * @param normalized_path 已规范化的绝对路径。
+   * @param[out] route 解析结果。
+   * @return bool 路径位于某个挂载点之下返回true，属于根文件系统返回false。
+   */
+  bool resolve(const std::string& normalized_path, Route& route) const;
+
+  /**
+   * @brief 列出所有挂载点。
+   */
+  void list(std::vector<MountInfo>& mounts) const;
+
+  /**
+   * @brief 在持有共享锁的情况下依次访问每个挂载点。
+   * @param fn 回调，签名为 void(const MountInfo&, FileSystem&)。
+   */
+  template <typename Fn>
+  void for_each(Fn&& fn) const {
+    std::shared_lock<std::shared_mutex> lock(table_mutex_);
+    for (const auto& entry : mounts_) {
+      fn(entry.info, *entry.fs);
+    }
+  }
+
+  /**
+   * @brief 为子文件系统的描述符分配一个全局描述符。
+   * @details 调用方应仍持有解析该路径时得到的 Route，防止子文件系统被并发卸载。
+   * @param fs 子文件系统。
+   * @param child_fd 子文件系统内的描述符。
+   * @return int 全局描述符。
+   */
+  int register_fd(FileSystem* fs, int child_fd);
+
+  /**
+   * @brief 解析全局描述符。
+   * @return bool 描述符属于某个子文件系统返回true。
+   */
+  bool resolve_fd(int fd, FdRoute& route) const;
+
+  /**
+   * @brief 释放全局描述符映射。
+   */
+  void release_fd(int fd);
+
+ private:
+  struct MountEntry {
+    MountInfo info;                   ///< 挂载点描述
+    std::unique_ptr<FileSystem> fs;   ///< 子文件系统
+  };
+
+  bool mount_entry(const std::string& mount_point,
+                   const std::string& image_path);
+  bool save() const;
+  static bool is_under(const std::string& path, const std::string& prefix);
+
+  std::string root_image_;         ///< 根镜像的绝对路径
+  std::string table_path_;         ///< 挂载表文件路径
+  bool read_only_;                 ///< 子镜像是否只读挂载
+  std::vector<MountEntry> mounts_;  ///< 挂载点列表
+
+  std::map<int, std::pair<FileSystem*, int>> fd_map_;  ///< 全局描述符 -> (子文件系统, 子描述符)
+  int next_fd_;                                        ///< 下一个全局描述符
+
+  mutable std::shared_mutex table_mutex_;  ///< 保护挂载点列表
+  mutable std::mutex fd_mutex_;            ///< 保护描述符映射（可在持有 table_mutex_ 时获取）
+};
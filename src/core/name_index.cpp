@@ -0,0 +1,399 @@
+// ==============================================================================
+// @file   name_index.cpp
+// @brief  全局文件名索引的实现
+// ==============================================================================
+
+#include "name_index.h"
+
+#include <algorithm>
+#include <cstring>
+#include <unistd.h>
+
+#include "../utils/slow_op_watchdog.h"
+
+namespace {
+
+const char kIndexMagic[4] = {'D', 'S', 'N', 'I'};  ///< 索引文件魔数
+const std::uint32_t kIndexVersion = 1;              ///< 索引文件版本
+const char kRecordAdd = 'A';                        ///< 新增记录
+const char kRecordRemove = 'D';                     ///< 删除记录
+const int kMaxPathDepth = 4096;                     ///< 还原路径时的深度上限
+
+/**
+ * @brief 按固定格式写入一条记录：op, parent, inode, name_len, name。
+ */
+bool write_record(FILE* file, char op, int parent_inode, int inode,
+                  const std::string& name) {
+  std::int32_t parent32 = parent_inode;
+  std::int32_t inode32 = inode;
+  std::uint16_t length = static_cast<std::uint16_t>(
+      std::min<std::size_t>(name.size(), MAX_FILENAME_LENGTH));
+  return fwrite(&op, 1, 1, file) == 1 &&
+         fwrite(&parent32, sizeof(parent32), 1, file) == 1 &&
+         fwrite(&inode32, sizeof(inode32), 1, file) == 1 &&
+         fwrite(&length, sizeof(length), 1, file) == 1 &&
+         fwrite(name.data(), 1, length, file) == length;
+}
+
+}  // namespace
+
+// ==============================================================================
+// 构造与析构
+// ==============================================================================
+
+NameIndex::NameIndex()
+    : journal_(nullptr), enabled_(false), journal_records_(0) {}
+
+NameIndex::~NameIndex() {
+  close();
+}
+
+// ==============================================================================
+// 生命周期
+// ==============================================================================
+
+/**
+ * @brief 若镜像旁存在索引文件则加载并启用。
+ */
+bool NameIndex::open(const std::string& image_path, bool read_only) {
+  std::lock_guard<std::mutex> lock(index_mutex_);
+  index_path_ = index_path_for(image_path);
+  enabled_ = false;
+  by_name_.clear();
+  by_inode_.clear();
+
+  if (access(index_path_.c_str(), F_OK) != 0) {
+    return true;  // 未启用索引
+  }
+
+  if (!load_file()) {
+    ErrorHandler::log_error(ERROR_IO_ERROR,
+                            "Failed to load name index: " + index_path_);
+    return false;
+  }
+
+  if (read_only) {
+    enabled_ = true;
+    return true;
+  }
+
+  journal_ = fopen(index_path_.c_str(), "ab");
+  if (!journal_) {
+    ErrorHandler::log_error(ERROR_IO_ERROR,
+                            "Failed to open name index journal: " + index_path_);
+    return false;
+  }
+  enabled_ = true;
+  return true;
+}
+
+/**
+ * @brief 将内存中的索引压缩写回并关闭文件。
+ */
+void NameIndex::close() {
+  std::lock_guard<std::mutex> lock(index_mutex_);
+  if (enabled_ && journal_records_ > 0) {
+    write_snapshot();
+  }
+  if (journal_) {
+    fclose(journal_);
+    journal_ = nullptr;
+  }
+  enabled_ = false;
+  by_name_.clear();
+  by_inode_.clear();
+}
+
+bool NameIndex::is_enabled() const {
+  std::lock_guard<std::mutex> lock(index_mutex_);
+  return enabled_;
+}
+
+/**
+ * @brief 以给定条目集合重建索引并启用。
+ */
+bool NameIndex::rebuild(
+    const std::string& image_path,
+    const std::vector<std::pair<std::string, NameIndexEntry>>& entries) {
+  std::lock_guard<std::mutex> lock(index_mutex_);
+  index_path_ = index_path_for(image_path);
+  by_name_.clear();
+  by_inode_.clear();
+  for (const auto& item : entries) {
+    apply_add(item.second.parent_inode, item.second.inode, item.first);
+  }
+
+  if (!write_snapshot()) {
+    enabled_ = false;
+    return false;
+  }
+  enabled_ = true;
+  return true;
+}
+
+/**
+ * @brief 清空索引内容，保持启用状态。
+ */
+bool NameIndex::reset() {
+  std::lock_guard<std::mutex> lock(index_mutex_);
+  if (!enabled_) {
+    return true;
+  }
+  by_name_.clear();
+  by_inode_.clear();
+  return write_snapshot();
+}
+
+/**
+ * @brief 停用并删除索引文件。
+ */
+bool NameIndex::drop(const std::string& image_path) {
+  std::lock_guard<std::mutex> lock(index_mutex_);
+  if (journal_) {
+    fclose(journal_);
+    journal_ = nullptr;
+  }
+  enabled_ = false;
+  journal_records_ = 0;
+  by_name_.clear();
+  by_inode_.clear();
+
+  std::string path = index_path_for(image_path);
+  if (unlink(path.c_str()) != 0 && access(path.c_str(), F_OK) == 0) {
+    ErrorHandler::log_error(ERROR_IO_ERROR,
+                            "Failed to remove name index: " + path);
+    return false;
+  }
+  return true;
+}
+
+// ==============================================================================
+// 维护与查询
+// ==============================================================================
+
+void NameIndex::record_add(int parent_inode, int inode,
+                           const std::string& name) {
+  std::lock_guard<std::mutex> lock(index_mutex_);
+  if (!enabled_) {
+    return;
+  }
+  apply_add(parent_inode, inode, name);
+  append_record(kRecordAdd, parent_inode, inode, name);
+}
+
+void NameIndex::record_remove(int parent_inode, int inode,
+                              const std::string& name) {
+  std::lock_guard<std::mutex> lock(index_mutex_);
+  if (!enabled_) {
+    return;
+  }
+  apply_remove(parent_inode, inode, name);
+  append_record(kRecordRemove, parent_inode, inode, name);
+}
+
+/**
+ * @brief 按名称查找所有出现位置并还原为完整路径。
+ */
+bool NameIndex::locate(const std::string& name,
+                       std::vector<std::string>& paths) const {
+  std::lock_guard<std::mutex> lock(index_mutex_);
+  paths.clear();
+  if (!enabled_) {
+    return false;
+  }
+
+  auto it = by_name_.find(name);
+  if (it == by_name_.end()) {
+    return true;
+  }
+
+  for (const NameIndexEntry& entry : it->second) {
+    std::string path;
+    if (build_path(entry.inode, path)) {
+      paths.push_back(std::move(path));
+    }
+  }
+  std::sort(paths.begin(), paths.end());
+  return true;
+}
+
+std::size_t NameIndex::size() const {
+  std::lock_guard<std::mutex> lock(index_mutex_);
+  return by_inode_.size();
+}
+
+std::string NameIndex::index_path_for(const std::string& image_path) {
+  return image_path + ".nameidx";
+}
+
+void NameIndex::remove_index_file(const std::string& image_path) {
+  unlink(index_path_for(image_path).c_str());
+}
+
+// ==============================================================================
+// 私有辅助方法
+// ==============================================================================
+
+/**
+ * @brief 读取快照与日志记录，回放到内存表中。
+ */
+bool NameIndex::load_file() {
+  FILE* file = fopen(index_path_.c_str(), "rb");
+  if (!file) {
+    return false;
+  }
+
+  char magic[4];
+  std::uint32_t version = 0;
+  if (fread(magic, 1, sizeof(magic), file) != sizeof(magic) ||
+      memcmp(magic, kIndexMagic, sizeof(magic)) != 0 ||
+      fread(&version, sizeof(version), 1, file) != 1 ||
+      version != kIndexVersion) {
+    fclose(file);
+    return false;
+  }
+
+  journal_records_ = 0;
+  char name_buffer[MAX_FILENAME_LENGTH];
+  while (true) {
+    char op;
+    std::int32_t parent32;
+    std::int32_t inode32;
+    std::uint16_t length;
+    if (fread(&op, 1, 1, file) != 1 ||
+        fread(&parent32, sizeof(parent32), 1, file) != 1 ||
+        fread(&inode32, sizeof(inode32), 1, file) != 1 ||
+        fread(&length, sizeof(length), 1, file) != 1 ||
+        length > MAX_FILENAME_LENGTH ||
+        fread(name_buffer, 1, length, file) != length) {
+      break;  // 文件结尾或不完整的尾部记录
+    }
+
+    std::string name(name_buffer, length);
+    if (op == kRecordAdd) {
+      apply_add(parent32, inode32, name);
+    } else if (op == kRecordRemove) {
+      apply_remove(parent32, inode32, name);
+    } else {
+      break;
+    }
+    ++journal_records_;
+  }
+
+  fclose(file);
+  return true;
+}
+
+/**
+ * @brief 将当前内存表写成纯快照（写临时文件后原子替换）。
+ */
+bool NameIndex::write_snapshot() {
+  if (journal_) {
+    fclose(journal_);
+    journal_ = nullptr;
+  }
+
+  std::string temp_path = index_path_ + ".tmp";
+  FILE* file = fopen(temp_path.c_str(), "wb");
+  if (!file) {
+    ErrorHandler::log_error(ERROR_IO_ERROR,
+                            "Failed to write name index: " + temp_path);
+    return false;
+  }
+
+  bool ok = fwrite(kIndexMagic, 1, sizeof(kIndexMagic), file) ==
+                sizeof(kIndexMagic) &&
+            fwrite(&kIndexVersion, sizeof(kIndexVersion), 1, file) == 1;
+  for (const auto& item : by_inode_) {
+    if (!ok) break;
+    ok = write_record(file, kRecordAdd, item.second.first, item.first,
+                      item.second.second);
+  }
+  ok = (fflush(file) == 0) && ok;
+  fclose(file);
+
+  if (!ok || rename(temp_path.c_str(), index_path_.c_str()) != 0) {
+    ErrorHandler::log_error(ERROR_IO_ERROR,
+                            "Failed to write name index: " + index_path_);
+    unlink(temp_path.c_str());
+    return false;
+  }
+
+  journal_records_ = 0;
+  journal_ = fopen(index_path_.c_str(), "ab");
+  return journal_ != nullptr;
+}
+
+/**
+ * @brief 追加一条日志记录并立即刷新。
+ */
+bool NameIndex::append_record(char op, int parent_inode, int inode,
+                              const std::string& name) {
+  SlowOpWatchdog::Phase phase(OpPhase::Flush);
+  if (!journal_ || !write_record(journal_, op, parent_inode, inode, name) ||
+      fflush(journal_) != 0) {
+    ErrorHandler::log_error(ERROR_IO_ERROR,
+                            "Failed to append name index record: " + name);
+    return false;
+  }
+  ++journal_records_;
+  return true;
+}
+
+void NameIndex::apply_add(int parent_inode, int inode,
+                          const std::string& name) {
+  apply_remove(-1, inode, std::string());  // 同一inode只保留最新位置
+  by_name_[name].push_back({parent_inode, inode});
+  by_inode_[inode] = {parent_inode, name};
+}
+
+void NameIndex::apply_remove(int parent_inode, int inode,
+                             const std::string& name) {
+  (void)parent_inode;
+  auto inode_it = by_inode_.find(inode);
+  const std::string& key =
+      inode_it != by_inode_.end() ? inode_it->second.second : name;
+
+  auto name_it = by_name_.find(key);
+  if (name_it != by_name_.end()) {
+    auto& locations = name_it->second;
+    locations.erase(std::remove_if(locations.begin(), locations.end(),
+                                   [inode](const NameIndexEntry& entry) {
+                                     return entry.inode == inode;
+                                   }),
+                    locations.end());
+    if (locations.empty()) {
+      by_name_.erase(name_it);
+    }
+  }
+
+  if (inode_it != by_inode_.end()) {
+    by_inode_.erase(inode_it);
+  }
+}
+
+/**
+ * @brief 沿 inode->父目录 链还原完整路径（根目录inode为0）。
+ */
+bool NameIndex::build_path(int inode, std::string& path) const {
+  std::vector<const std::string*> components;
+  int current = inode;
+  for (int depth = 0; current != 0; ++depth) {
+    auto it = by_inode_.find(current);
+    if (it == by_inode_.end() || depth >= kMaxPathDepth) {
+      return false;
+    }
+    components.push_back(&it->second.second);
+    current = it->second.first;
+  }
+
+  path.clear();
+  for (auto it = components.rbegin(); it != components.rend(); ++it) {
+    path += "/";
+    path += **it;
+  }
+  if (path.empty()) {
+    path = "/";
+  }
+  return true;
+}
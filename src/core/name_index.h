@@ -0,0 +1,137 @@
+// ==============================================================================
+// @file   name_index.h
+// @brief  全局文件名索引：文件名 -> (父目录inode, inode) 的持久化映射
+// ==============================================================================
+
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "../utils/common.h"
+#include "../utils/error_codes.h"
+#include "../utils/error_handler.h"
+
+/**
+ * @struct NameIndexEntry
+ * @brief 一个文件名在索引中的一处出现位置。
+ */
+struct NameIndexEntry {
+  int parent_inode;  ///< 所在目录的inode号
+  int inode;         ///< 条目自身的inode号
+};
+
+/**
+ * @class NameIndex
+ * @brief 可选的全局文件名索引，使按名查找无需遍历目录树。
+ *
+ * 索引保存在磁盘镜像旁的 `<image>.nameidx` 文件中；文件存在即表示启用。
+ * 文件由一个快照段和其后追加的日志记录组成：每次目录项增删都追加一条
+ * 记录并立即刷新，卸载时再压缩为纯快照。加载时遇到不完整的尾部记录
+ * （例如进程中途崩溃）会直接丢弃。
+ *
+ * 内存中同时维护 名称->出现位置 和 inode->(父目录, 名称) 两张表，
+ * 后者用于在不访问磁盘的情况下把查找结果还原为完整路径。
+ */
+class NameIndex {
+ public:
+  NameIndex();
+  ~NameIndex();
+
+  /**
+   * @brief 若镜像旁存在索引文件则加载并启用。
+   * @param image_path 磁盘镜像路径。
+   * @param read_only 为true时只加载索引，不打开日志文件（只读挂载时使用）。
+   * @return bool 未启用或加载成功返回true，文件损坏返回false。
+   */
+  bool open(const std::string& image_path, bool read_only = false);
+
+  /**
+   * @brief 将内存中的索引压缩写回并关闭文件。
+   */
+  void close();
+
+  /**
+   * @brief 索引是否启用。
+   */
+  bool is_enabled() const;
+
+  /**
+   * @brief 以给定条目集合重建索引并启用（覆盖已有内容）。
+   * @param image_path 磁盘镜像路径。
+   * @param entries (名称, 位置) 列表。
+   * @return bool 成功返回true。
+   */
+  bool rebuild(const std::string& image_path,
+               const std::vector<std::pair<std::string, NameIndexEntry>>&
+                   entries);
+
+  /**
+   * @brief 清空索引内容（格式化后调用），保持启用状态。
+   * @return bool 成功返回true。
+   */
+  bool reset();
+
+  /**
+   * @brief 停用并删除索引文件。
+   * @param image_path 磁盘镜像路径。
+   * @return bool 成功返回true。
+   */
+  bool drop(const std::string& image_path);
+
+  /**
+   * @brief 记录新增的目录项。
+   */
+  void record_add(int parent_inode, int inode, const std::string& name);
+
+  /**
+   * @brief 记录移除的目录项。
+   */
+  void record_remove(int parent_inode, int inode, const std::string& name);
+
+  /**
+   * @brief 按名称查找所有出现位置。
+   * @param name 文件或目录名（精确匹配）。
+   * @param[out] paths 还原出的完整路径（已排序）。
+   * @return bool 索引启用返回true（即使没有结果）。
+   */
+  bool locate(const std::string& name, std::vector<std::string>& paths) const;
+
+  /**
+   * @brief 返回索引中的条目总数。
+   */
+  std::size_t size() const;
+
+  /**
+   * @brief 获取镜像对应的索引文件路径。
+   */
+  static std::string index_path_for(const std::string& image_path);
+
+  /**
+   * @brief 删除镜像对应的索引文件（重新创建镜像时调用）。
+   */
+  static void remove_index_file(const std::string& image_path);
+
+ private:
+  bool load_file();
+  bool write_snapshot();
+  bool append_record(char op, int parent_inode, int inode,
+                     const std::string& name);
+  void apply_add(int parent_inode, int inode, const std::string& name);
+  void apply_remove(int parent_inode, int inode, const std::string& name);
+  bool build_path(int inode, std::string& path) const;
+
+  std::string index_path_;  ///< 索引文件路径
+  FILE* journal_;           ///< 追加日志用的文件句柄
+  bool enabled_;            ///< 是否启用
+  std::uint64_t journal_records_;  ///< 自上次快照以来的日志记录数
+
+  std::unordered_map<std::string, std::vector<NameIndexEntry>> by_name_;
+  std::unordered_map<int, std::pair<int, std::string>> by_inode_;
+
+  mutable std::mutex index_mutex_;  ///< 保护索引状态的互斥锁
+};
@@ -6,9 +6,11 @@
 #include "path_manager.h"
 
 #include <cstring>
-#include <sstream>
 #include <string>
 
+#include "../utils/slow_op_watchdog.h"
+#include "../utils/trace_probes.h"
+
 /**
  * @brief 构造函数。
  * @param disk DiskSimulator对象的引用。
@@ -24,22 +26,12 @@ PathManager::PathManager(DiskSimulator& disk, InodeManager& inode_manager)
  * @return std::string 父目录路径。
  */
 std::string PathManager::get_parent_path(const std::string& path) {
-  if (path == "/" || path.empty()) {
-    return "/";
-  }
-
-  // 处理相对路径
-  std::string p = path;
-  if (path[0] != '/') {
-    p = "/" + path;
+  std::string_view parent = parent_view(path);
+  // 相对路径按相对于根目录处理
+  if (parent.empty() || parent[0] != '/') {
+    return "/" + std::string(parent);
   }
-
-  size_t pos = p.find_last_of('/');
-  if (pos == 0) {
-    return "/";
-  }
-
-  return p.substr(0, pos);
+  return std::string(parent);
 }
 
 /**
@@ -48,22 +40,23 @@ std::string PathManager::get_parent_path(const std::string& path) {
  * @return std::string 基本名称。
  */
 std::string PathManager::get_basename(const std::string& path) {
-  if (path == "/" || path.empty()) {
-    return "";
-  }
+  return std::string(basename_view(path));
+}
 
-  // 处理相对路径
-  std::string p = path;
-  if (path[0] != '/') {
-    p = "/" + path;
+std::string_view PathManager::parent_view(std::string_view path) {
+  size_t pos = path.find_last_of('/');
+  if (pos == std::string_view::npos || pos == 0) {
+    return path.empty() || path[0] == '/' ? "/" : "";
   }
+  return path.substr(0, pos);
+}
 
-  size_t pos = p.find_last_of('/');
-  if (pos == std::string::npos) {
-    return path;
+std::string_view PathManager::basename_view(std::string_view path) {
+  if (path == "/") {
+    return "";
   }
-
-  return p.substr(pos + 1);
+  size_t pos = path.find_last_of('/');
+  return pos == std::string_view::npos ? path : path.substr(pos + 1);
 }
 
 /**
@@ -81,24 +74,11 @@ bool PathManager::parse_path(const std::string& path,
     return false;
   }
 
-  if (path == "/") {
-    return true;
-  }
-
-  std::string p = path;
-  // 如果路径不以'/'开头，说明是相对路径，我们假设相对于根目录
-  if (path[0] != '/') {
-    p = "/" + path;
-  }
-
-  p = p.substr(1);  // 去掉开头的 '/'
-  std::stringstream ss(p);
-  std::string component;
-
-  while (std::getline(ss, component, '/')) {
-    if (!component.empty()) {
-      components.push_back(component);
-    }
+  // 相对路径与绝对路径的组件相同（假设相对于根目录）
+  size_t pos = 0;
+  std::string_view component;
+  while (PathUtils::next_component(path, pos, component)) {
+    components.emplace_back(component);
   }
 
   return true;
@@ -106,37 +86,72 @@ bool PathManager::parse_path(const std::string& path,
 
 /**
  * @brief 根据路径查找对应的inode号。
+ * @details 逐个组件查找，组件直接引用 path 中的字符。
  * @param path 要查找的路径。
  * @return int 找到的inode号，失败返回-1。
  */
-int PathManager::find_inode(const std::string& path) {
-  // 根据需要检查mounted状态
+int PathManager::find_inode(std::string_view path) {
+  if (path.empty()) {
+    ErrorHandler::log_error(ERROR_INVALID_PATH, "Empty path provided");
+    return -1;
+  }
 
-  if (path == "/") {
-    return 0;  // 根目录的inode是0
+  SlowOpWatchdog::Phase phase(OpPhase::PathResolution);
+  int current_inode = 0;  // 从根目录开始
+  size_t pos = 0;
+  std::string_view component;
+  while (current_inode != -1 && PathUtils::next_component(path, pos, component)) {
+    current_inode = find_inode_in_directory(current_inode, component);
   }
 
-  std::vector<std::string> components;
-  if (!parse_path(path, components)) {
-    ErrorHandler::log_error(ERROR_INVALID_PATH, "Invalid path: " + path);
-    return -1;
+  return current_inode;
+}
+
+/**
+ * @brief 单遍解析路径：最后一个组件之前的组件决定父目录，最后一个组件在父目录中查找。
+ */
+bool PathManager::resolve(std::string_view path, ResolvedPath& result) {
+  result = ResolvedPath();
+  if (path.empty()) {
+    ErrorHandler::log_error(ERROR_INVALID_PATH, "Empty path provided");
+    return false;
   }
 
-  int current_inode = 0;  // 从根目录开始
+  SlowOpWatchdog::Phase phase(OpPhase::PathResolution);
+  size_t pos = 0;
+  std::string_view component;
+  if (!PathUtils::next_component(path, pos, component)) {
+    result.parent = 0;  // 根目录
+    result.inode = 0;
+    return true;
+  }
 
-  for (const std::string& component : components) {
+  int current_inode = 0;
+  std::string_view next;
+  while (PathUtils::next_component(path, pos, next)) {
     current_inode = find_inode_in_directory(current_inode, component);
     if (current_inode == -1) {
-      return -1;
+      return false;
     }
+    component = next;
   }
 
-  return current_inode;
+  result.parent = current_inode;
+  result.name = component;
+  result.inode = find_inode_in_directory(current_inode, component);
+  return true;
 }
 
-// 在指定目录中查找文件或子目录的inode号
+// 在指定目录中查找文件或子目录的inode号；先查目录项缓存，未命中再扫描目录块
 int PathManager::find_inode_in_directory(int parent_inode,
-                                         const std::string& name) {
+                                         std::string_view name) {
+  int cached = -1;
+  if (dentry_cache_.lookup(DentryProbe{parent_inode, name}, cached)) {
+    DISKSIM_PROBE3(dentry__hit, parent_inode, name.data(), name.size());
+    return cached;
+  }
+  DISKSIM_PROBE3(dentry__miss, parent_inode, name.data(), name.size());
+
   // 读取父目录的inode信息
   Inode parent_inode_info;
   if (!load_directory_inode(parent_inode, parent_inode_info,
@@ -145,7 +160,7 @@ int PathManager::find_inode_in_directory(int parent_inode,
   }
 
   // 获取目录数据块
-  std::vector<int> blocks;
+  BlockList blocks;
   if (!inode_manager.get_data_blocks(parent_inode, blocks)) {
     ErrorHandler::log_error(ERROR_IO_ERROR,
                             "Failed to get data blocks for directory inode=" +
@@ -168,7 +183,12 @@ int PathManager::find_inode_in_directory(int parent_inode,
 
     for (int i = 0; i < max_entries; i++) {
       if (entry[i].name_length > 0 &&
-          strcmp(entry[i].name, name.c_str()) == 0) {
+          static_cast<size_t>(entry[i].name_length) == name.size() &&
+          memcmp(entry[i].name, name.data(), name.size()) == 0) {
+        // 回填期间写者可能已删除该条目并使缓存失效，但写者持有文件系统
+        // 独占锁，与持共享锁的查找互斥，回填的结果不会过期
+        dentry_cache_.insert_if_absent(DentryKey{parent_inode, std::string(name)},
+                                       entry[i].inode_number);
         return entry[i].inode_number;
       }
     }
@@ -186,17 +206,10 @@ bool PathManager::validate_and_parse_path(const std::string& path,
     return false;
   }
 
-  filename = PathUtils::extract_filename(path);
-  directory = PathUtils::extract_directory(path);
-
-  if (directory == ".") {
-    directory = "/";
-  }
-
-  if (directory.empty()) {
-    directory = "/";
-  }
-
+  // 直接从路径中截取，没有'/'的相对路径的目录为根目录
+  std::string_view parent = parent_view(path);
+  filename.assign(basename_view(path));
+  directory.assign(parent.empty() ? std::string_view("/") : parent);
   return true;
 }
 
@@ -205,6 +218,17 @@ bool PathManager::file_exists(const std::string& path) {
   return find_inode(path) != -1;
 }
 
+void PathManager::forget_entry(int parent_inode, std::string_view name) {
+  dentry_cache_.erase(DentryProbe{parent_inode, name});
+}
+
+void PathManager::clear_cache() { dentry_cache_.clear(); }
+
+void PathManager::cached_dentries(std::vector<DentryKey>& entries) const {
+  dentry_cache_.for_each(
+      [&](const DentryKey& key, int) { entries.push_back(key); });
+}
+
 bool PathManager::load_directory_inode(int inode_num, Inode& inode,
                                        const std::string& context_hint) {
   if (!inode_manager.read_inode(inode_num, inode)) {
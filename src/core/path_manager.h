@@ -4,16 +4,74 @@
 // ==============================================================================
 
 #pragma once
+#include <cstddef>
+#include <functional>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include "../utils/common.h"
 #include "../utils/error_codes.h"
 #include "../utils/error_handler.h"
 #include "../utils/path_utils.h"
+#include "concurrent_cache.h"
 #include "disk_simulator.h"
 #include "inode_manager.h"
 
+/**
+ * @struct DentryKey
+ * @brief 目录项缓存的键：父目录inode与条目名。
+ */
+struct DentryKey {
+  int parent;        ///< 父目录inode号
+  std::string name;  ///< 条目名
+};
+
+/**
+ * @struct DentryProbe
+ * @brief 查找目录项缓存时使用的探测键，引用调用方的名字而不复制。
+ */
+struct DentryProbe {
+  int parent;             ///< 父目录inode号
+  std::string_view name;  ///< 条目名（可以是路径中的一个组件）
+};
+
+inline bool operator==(const DentryKey& key, const DentryProbe& probe) {
+  return key.parent == probe.parent && key.name == probe.name;
+}
+
+inline bool operator==(const DentryKey& lhs, const DentryKey& rhs) {
+  return lhs.parent == rhs.parent && lhs.name == rhs.name;
+}
+
+/**
+ * @struct DentryHash
+ * @brief 目录项键与探测键共用的哈希函数。
+ */
+struct DentryHash {
+  std::size_t operator()(int parent, std::string_view name) const {
+    // std::hash<std::string_view> 与 std::hash<std::string> 对相同字符给出相同结果
+    return std::hash<std::string_view>()(name) ^
+           (static_cast<std::size_t>(parent) * 0x9E3779B97F4A7C15ULL);
+  }
+  std::size_t operator()(const DentryKey& key) const {
+    return (*this)(key.parent, key.name);
+  }
+  std::size_t operator()(const DentryProbe& probe) const {
+    return (*this)(probe.parent, probe.name);
+  }
+};
+
+/**
+ * @struct ResolvedPath
+ * @brief 一次路径解析的结果：父目录、目标条目与条目名。
+ */
+struct ResolvedPath {
+  int parent{-1};         ///< 父目录inode号（根目录为0）
+  int inode{-1};          ///< 目标inode号，条目不存在时为-1
+  std::string_view name;  ///< 最后一个组件，指向被解析的路径（根目录为空）
+};
+
 /**
  * @class PathManager
  * @brief 路径管理器，负责处理路径解析、验证和inode查找。
@@ -41,6 +99,16 @@ class PathManager {
    */
   std::string get_basename(const std::string& path);
 
+  /**
+   * @brief 父目录部分（不复制），例如 "/a/b" 为 "/a"，"/a" 为 "/"。
+   */
+  static std::string_view parent_view(std::string_view path);
+
+  /**
+   * @brief 最后一个'/'之后的部分（不复制）。
+   */
+  static std::string_view basename_view(std::string_view path);
+
   /**
    * @brief 解析路径字符串为路径组件列表。
    * @param path 要解析的路径。
@@ -55,7 +123,17 @@ class PathManager {
    * @param path 要查找的路径。
    * @return int 找到的inode号，失败返回-1。
    */
-  int find_inode(const std::string& path);
+  int find_inode(std::string_view path);
+
+  /**
+   * @brief 单遍解析路径，同时得到父目录、目标inode与条目名。
+   * @details 逐个组件查找，不构造中间字符串；创建与删除只需解析一次，
+   *          而不必分别查找路径、父路径与基本名称。
+   * @param path 要解析的路径（result.name 指向其中的字符，使用期间须有效）。
+   * @param[out] result 解析结果；目标不存在时 inode 为-1。
+   * @return bool 父目录存在返回true（目标本身可以不存在），否则返回false。
+   */
+  bool resolve(std::string_view path, ResolvedPath& result);
 
   /**
    * @brief 在指定目录中查找文件或子目录的inode号。
@@ -63,7 +141,7 @@ class PathManager {
    * @param name 要查找的文件或目录名。
    * @return int 找到的inode号，失败返回-1。
    */
-  int find_inode_in_directory(int parent_inode, const std::string& name);
+  int find_inode_in_directory(int parent_inode, std::string_view name);
 
   /**
    * @brief 验证并解析路径。
@@ -82,10 +160,31 @@ class PathManager {
    */
   bool file_exists(const std::string& path);
 
+  /**
+   * @brief 使目录中某个条目的缓存失效（条目被删除时调用）。
+   * @param parent_inode 父目录的inode号。
+   * @param name 条目名。
+   */
+  void forget_entry(int parent_inode, std::string_view name);
+
+  /**
+   * @brief 清空目录项缓存（格式化、卸载或整体改写目录时调用）。
+   */
+  void clear_cache();
+
+  /**
+   * @brief 列出当前缓存中的目录项键（用于记录热点集合）。
+   * @param[out] entries 输出的 (父目录inode, 名称)。
+   */
+  void cached_dentries(std::vector<DentryKey>& entries) const;
+
  private:
   DiskSimulator& disk;          ///< 磁盘模拟器引用
   InodeManager& inode_manager;  ///< Inode管理器引用
 
+  /// (父目录inode, 名称) -> 子inode；只缓存磁盘上确实存在的条目
+  ConcurrentCache<DentryKey, int, DentryHash> dentry_cache_;
+
   bool load_directory_inode(int inode_num, Inode& inode,
                             const std::string& context_hint);
 };
\ No newline at end of file
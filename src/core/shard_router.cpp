@@ -0,0 +1,612 @@
+// ==============================================================================
+// @file   shard_router.cpp
+// @brief  分片命名空间路由器的实现
+// ==============================================================================
+
+#include "shard_router.h"
+
+#include <cstring>
+#include <fstream>
+#include <unordered_set>
+
+#include "../utils/path_utils.h"
+#include "disk_simulator.h"
+#include "filesystem.h"
+#include "mount_table.h"
+#include "name_index.h"
+
+namespace {
+
+const char kManifestHeader[] = "# disk_sim shard set";  ///< 清单文件首行
+const int kMaxShards = 64;                               ///< 分片数上限
+
+/**
+ * @brief 规范化路径并保证以 '/' 开头。
+ */
+std::string absolute_path(const std::string& path) {
+  std::string normalized = PathUtils::normalize_path(path);
+  if (normalized.empty()) {
+    return "/";
+  }
+  return normalized[0] == '/' ? normalized : "/" + normalized;
+}
+
+/**
+ * @brief 获取规范路径的父目录路径。
+ */
+std::string parent_of(const std::string& path) {
+  size_t pos = path.find_last_of('/');
+  return pos == 0 || pos == std::string::npos ? "/" : path.substr(0, pos);
+}
+
+/**
+ * @brief 获取清单文件所在目录（带结尾 '/'，当前目录时为空）。
+ */
+std::string directory_of(const std::string& path) {
+  size_t pos = path.find_last_of('/');
+  return pos == std::string::npos ? "" : path.substr(0, pos + 1);
+}
+
+}  // namespace
+
+// ==============================================================================
+// 构造与析构
+// ==============================================================================
+
+ShardRouter::ShardRouter() = default;
+
+ShardRouter::~ShardRouter() {
+  close();
+}
+
+// ==============================================================================
+// 清单文件
+// ==============================================================================
+
+bool ShardRouter::is_manifest(const std::string& path) {
+  std::ifstream input(path);
+  std::string line;
+  return input.is_open() && std::getline(input, line) &&
+         line.compare(0, strlen(kManifestHeader), kManifestHeader) == 0;
+}
+
+/**
+ * @brief 创建分片镜像与清单文件。
+ * @details 分片镜像命名为 `<manifest>.shard<i>`，清单中只记录文件名，
+ *          整个分片集合可以随目录一起移动。
+ */
+bool ShardRouter::create(const std::string& manifest_path, int size_mb,
+                         const DeviceOptions& options) {
+  if (options.shards < 2 || options.shards > kMaxShards) {
+    ErrorHandler::log_error(ERROR_INVALID_ARGUMENT,
+                            "Shard count must be between 2 and " +
+                                std::to_string(kMaxShards));
+    return false;
+  }
+
+  DeviceOptions shard_options = options;
+  shard_options.shards = 1;
+
+  std::string base_name = manifest_path.substr(directory_of(manifest_path).size());
+  std::vector<std::string> names;
+  for (int i = 0; i < options.shards; ++i) {
+    std::string name = base_name + ".shard" + std::to_string(i);
+    std::string shard_path = directory_of(manifest_path) + name;
+
+    DiskSimulator disk;
+    if (!disk.create_disk(shard_path, size_mb, shard_options)) {
+      return false;
+    }
+    NameIndex::remove_index_file(shard_path);
+    MountTable::remove_table_file(shard_path);
+    CacheWarmer::remove_warm_file(shard_path);
+    names.push_back(name);
+  }
+
+  std::ofstream output(manifest_path, std::ios::trunc);
+  if (!output.is_open()) {
+    ErrorHandler::log_error(ERROR_IO_ERROR,
+                            "Failed to write shard manifest: " + manifest_path);
+    return false;
+  }
+  output << kManifestHeader << " v1\n";
+  for (const std::string& name : names) {
+    output << name << "\n";
+  }
+  return output.good();
+}
+
+bool ShardRouter::read_manifest(const std::string& manifest_path,
+                                std::vector<std::string>& shard_paths) {
+  std::ifstream input(manifest_path);
+  if (!input.is_open()) {
+    ErrorHandler::log_error(ERROR_IO_ERROR,
+                            "Failed to read shard manifest: " + manifest_path);
+    return false;
+  }
+
+  shard_paths.clear();
+  std::string line;
+  while (std::getline(input, line)) {
+    if (line.empty() || line[0] == '#') {
+      continue;
+    }
+    shard_paths.push_back(line[0] == '/' ? line
+                                         : directory_of(manifest_path) + line);
+  }
+
+  if (shard_paths.size() < 2) {
+    ErrorHandler::log_error(ERROR_INVALID_SYNTAX,
+                            "Shard manifest lists fewer than two images: " +
+                                manifest_path);
+    return false;
+  }
+  return true;
+}
+
+// ==============================================================================
+// 生命周期
+// ==============================================================================
+
+/**
+ * @brief 挂载清单中的全部分片。
+ */
+bool ShardRouter::open(const std::string& manifest_path, bool read_only) {
+  if (!read_manifest(manifest_path, shard_paths_)) {
+    return false;
+  }
+
+  for (const std::string& shard_path : shard_paths_) {
+    auto shard = std::make_unique<FileSystem>();
+    if (!shard->mount_internal(shard_path, false, read_only)) {
+      ErrorHandler::log_error(ERROR_MOUNT_FAILED,
+                              "Cannot mount shard: " + shard_path);
+      close();
+      return false;
+    }
+    shards_.push_back(std::move(shard));
+  }
+  return true;
+}
+
+void ShardRouter::close() {
+  for (auto& shard : shards_) {
+    shard->unmount();
+  }
+  shards_.clear();
+}
+
+size_t ShardRouter::shard_count() const { return shards_.size(); }
+
+bool ShardRouter::format() {
+  for (auto& shard : shards_) {
+    if (!shard->format()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// ==============================================================================
+// 文件操作
+// ==============================================================================
+
+int ShardRouter::create_file(const std::string& path, int mode) {
+  std::string target = absolute_path(path);
+  return shards_[shard_for_entry(target)]->create_file(target, mode);
+}
+
+bool ShardRouter::delete_file(const std::string& path) {
+  std::string target = absolute_path(path);
+  return shards_[shard_for_entry(target)]->delete_file(target);
+}
+
+bool ShardRouter::file_exists(const std::string& path) {
+  std::string target = absolute_path(path);
+  return shards_[shard_for_entry(target)]->file_exists(target);
+}
+
+int ShardRouter::open_file(const std::string& path, int mode) {
+  std::string target = absolute_path(path);
+  size_t index = shard_for_entry(target);
+  int child_fd = shards_[index]->open_file(target, mode);
+  if (child_fd < 0) {
+    return child_fd;
+  }
+  return child_fd * static_cast<int>(shards_.size()) + static_cast<int>(index);
+}
+
+bool ShardRouter::close_file(int fd) {
+  FileSystem* shard = nullptr;
+  int child_fd = -1;
+  return decode_fd(fd, shard, child_fd) && shard->close_file(child_fd);
+}
+
+int ShardRouter::read_file(int fd, char* buffer, int size) {
+  FileSystem* shard = nullptr;
+  int child_fd = -1;
+  if (!decode_fd(fd, shard, child_fd)) {
+    return -1;
+  }
+  return shard->read_file(child_fd, buffer, size);
+}
+
+int ShardRouter::write_file(int fd, const char* buffer, int size) {
+  FileSystem* shard = nullptr;
+  int child_fd = -1;
+  if (!decode_fd(fd, shard, child_fd)) {
+    return -1;
+  }
+  return shard->write_file(child_fd, buffer, size);
+}
+
+bool ShardRouter::seek_file(int fd, int position) {
+  FileSystem* shard = nullptr;
+  int child_fd = -1;
+  return decode_fd(fd, shard, child_fd) && shard->seek_file(child_fd, position);
+}
+
+// ==============================================================================
+// 目录操作
+// ==============================================================================
+
+/**
+ * @brief 在所有分片上创建目录。
+ * @details 同名目录的创建与删除都由父目录所属分片（owner）裁决：先在 owner
+ *          上创建，其独占锁决定并发的 mkdir/rmdir 谁先生效，再按分片号顺序
+ *          复制到其余分片。任一副本失败时撤销已创建的副本。
+ */
+bool ShardRouter::create_directory(const std::string& path) {
+  std::string target = absolute_path(path);
+  size_t owner = shard_for_entry(target);
+  if (!shards_[owner]->create_directory(target)) {
+    return false;
+  }
+
+  std::vector<size_t> created = {owner};
+  for (size_t i = 0; i < shards_.size(); ++i) {
+    if (i == owner) {
+      continue;
+    }
+    if (!shards_[i]->create_directory(target)) {
+      for (auto it = created.rbegin(); it != created.rend(); ++it) {
+        shards_[*it]->remove_directory(target);
+      }
+      return false;
+    }
+    created.push_back(i);
+  }
+  return true;
+}
+
+/**
+ * @brief 列出目录内容。
+ * @details 目录下的文件只放在目录所属分片（home）上，子目录在每个分片上
+ *          都有副本且总是先在 home 上创建（子目录的 owner 正是 home），
+ *          因此 home 上的目录内容已经完整，无需查询其余分片。
+ */
+bool ShardRouter::list_directory(const std::string& path,
+                                 std::vector<DirectoryEntry>& entries) {
+  std::string target = absolute_path(path);
+  return shards_[shard_for_directory(target)]->list_directory(target, entries);
+}
+
+/**
+ * @brief 在所有分片上删除目录。
+ * @details 目录下的文件和子目录都一定出现在目录所属分片（home）上，因此先
+ *          在 home 上删除，由其独占锁原子地完成非空检查——此后在该目录下
+ *          创建条目（同样先落在 home 上）都会失败。随后在父目录所属分片
+ *          （owner）上删除，这是与 create_directory 相同的裁决点：此前 owner
+ *          上仍有该目录，并发的同名 mkdir 在 owner 上即失败。最后按分片号
+ *          顺序删除其余副本，与 mkdir 的复制顺序一致，后到的 mkdir 不会
+ *          越过 rmdir 去创建随后又被删除的副本。任一副本删除失败时，在已
+ *          删除的分片上重新创建该目录，恢复到删除之前的状态。
+ */
+bool ShardRouter::remove_directory(const std::string& path) {
+  std::string target = absolute_path(path);
+  size_t home = shard_for_directory(target);
+  size_t owner = shard_for_entry(target);
+
+  std::vector<size_t> order = {home};
+  if (owner != home) {
+    order.push_back(owner);
+  }
+  for (size_t i = 0; i < shards_.size(); ++i) {
+    if (i != home && i != owner) {
+      order.push_back(i);
+    }
+  }
+
+  for (size_t step = 0; step < order.size(); ++step) {
+    if (shards_[order[step]]->remove_directory(target)) {
+      continue;
+    }
+    // 撤销：先恢复 owner（裁决点）之外的副本，再恢复 owner，最后恢复 home
+    for (size_t undo = step; undo-- > 0;) {
+      shards_[order[undo]]->create_directory(target);
+    }
+    return false;
+  }
+  return true;
+}
+
+bool ShardRouter::is_directory(const std::string& path) {
+  std::string target = absolute_path(path);
+  return shards_[shard_for_entry(target)]->is_directory(target);
+}
+
+bool ShardRouter::stat(const std::string& path, Inode& inode) {
+  std::string target = absolute_path(path);
+  return shards_[shard_for_entry(target)]->stat(target, inode);
+}
+
+// ==============================================================================
+// 信息与索引
+// ==============================================================================
+
+bool ShardRouter::get_disk_info(std::string& info) {
+  info.clear();
+  for (size_t i = 0; i < shards_.size(); ++i) {
+    std::string shard_info;
+    if (!shards_[i]->get_disk_info(shard_info)) {
+      return false;
+    }
+    info += "Shard " + std::to_string(i) + " (" + shard_paths_[i] + "):\n";
+    info += shard_info;
+  }
+  return true;
+}
+
+bool ShardRouter::get_device_stats(std::string& report) {
+  report.clear();
+  for (size_t i = 0; i < shards_.size(); ++i) {
+    std::string shard_report;
+    if (!shards_[i]->get_device_stats(shard_report)) {
+      return false;
+    }
+    report += "Shard " + std::to_string(i) + " (" + shard_paths_[i] + "):\n";
+    report += shard_report;
+  }
+  return true;
+}
+
+/**
+ * @brief 汇总各分片的热点集合状态。
+ */
+bool ShardRouter::get_warm_set_status(std::string& status) {
+  status.clear();
+  for (size_t i = 0; i < shards_.size(); ++i) {
+    std::string shard_status;
+    if (!shards_[i]->get_warm_set_status(shard_status)) {
+      return false;
+    }
+    status += "Shard " + std::to_string(i) + ": " + shard_status;
+  }
+  return true;
+}
+
+/**
+ * @brief 在每个分片上开始或停止记录块访问热度。
+ */
+bool ShardRouter::set_heatmap_enabled(bool enabled) {
+  for (auto& shard : shards_) {
+    if (!shard->set_heatmap_enabled(enabled)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * @brief 清空每个分片的块访问热度统计。
+ */
+bool ShardRouter::reset_heatmap() {
+  for (auto& shard : shards_) {
+    if (!shard->reset_heatmap()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * @brief 逐个分片列出块访问热度报告。
+ */
+bool ShardRouter::get_heatmap_report(std::string& report) {
+  report.clear();
+  for (size_t i = 0; i < shards_.size(); ++i) {
+    std::string shard_report;
+    if (!shards_[i]->get_heatmap_report(shard_report)) {
+      return false;
+    }
+    report += "Shard " + std::to_string(i) + " (" + shard_paths_[i] + "):\n";
+    report += shard_report;
+  }
+  return true;
+}
+
+/**
+ * @brief 清空每个分片的内部缓存与宿主机页缓存。
+ */
+bool ShardRouter::drop_caches() {
+  bool ok = true;
+  for (auto& shard : shards_) {
+    ok = shard->drop_caches() && ok;
+  }
+  return ok;
+}
+
+/**
+ * @brief 逐个分片巡检，报告按分片分段。
+ */
+bool ShardRouter::scrub(std::string& report, bool& corrupted) {
+  report.clear();
+  corrupted = false;
+  for (size_t i = 0; i < shards_.size(); ++i) {
+    std::string shard_report;
+    bool shard_corrupted = false;
+    if (!shards_[i]->scrub(shard_report, shard_corrupted)) {
+      return false;
+    }
+    report += "Shard " + std::to_string(i) + " (" + shard_paths_[i] + "):\n";
+    report += shard_report;
+    corrupted = corrupted || shard_corrupted;
+  }
+  return true;
+}
+
+/**
+ * @brief 目录在每个分片上整理，报告按分片分段；文件只在所属分片上整理。
+ */
+bool ShardRouter::defragment(const std::string& path, std::string& report) {
+  std::string target = absolute_path(path);
+  if (!is_directory(target)) {
+    return shards_[shard_for_entry(target)]->defragment(target, report);
+  }
+
+  report.clear();
+  for (size_t i = 0; i < shards_.size(); ++i) {
+    std::string shard_report;
+    if (!shards_[i]->defragment(target, shard_report)) {
+      return false;
+    }
+    report += "Shard " + std::to_string(i) + ": " + shard_report;
+  }
+  return true;
+}
+
+bool ShardRouter::start_background_defrag() {
+  for (auto& shard : shards_) {
+    if (!shard->start_background_defrag()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool ShardRouter::stop_background_defrag() {
+  bool ok = true;
+  for (auto& shard : shards_) {
+    ok = shard->stop_background_defrag() && ok;
+  }
+  return ok;
+}
+
+bool ShardRouter::get_defrag_status(std::string& status) {
+  status.clear();
+  for (size_t i = 0; i < shards_.size(); ++i) {
+    std::string shard_status;
+    if (!shards_[i]->get_defrag_status(shard_status)) {
+      return false;
+    }
+    status += "Shard " + std::to_string(i) + ": " + shard_status;
+  }
+  return true;
+}
+
+bool ShardRouter::set_verify_policy(ChecksumPolicy policy) {
+  for (auto& shard : shards_) {
+    if (!shard->set_verify_policy(policy)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * @brief 在各分片的文件名索引中查找并合并结果（目录副本去重）。
+ */
+bool ShardRouter::locate(const std::string& name,
+                         std::vector<std::string>& paths) {
+  if (!name_index_enabled()) {
+    ErrorHandler::log_error(
+        ERROR_INVALID_ARGUMENT,
+        "Name index is not enabled (run 'locate --build' first)");
+    return false;
+  }
+
+  std::unordered_set<std::string> seen;
+  for (auto& shard : shards_) {
+    std::vector<std::string> shard_paths;
+    if (!shard->name_index_enabled() || !shard->locate(name, shard_paths)) {
+      continue;
+    }
+    for (const std::string& path : shard_paths) {
+      if (seen.insert(path).second) {
+        paths.push_back(path);
+      }
+    }
+  }
+  return true;
+}
+
+bool ShardRouter::build_name_index() {
+  for (auto& shard : shards_) {
+    if (!shard->build_name_index()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool ShardRouter::drop_name_index() {
+  bool ok = true;
+  for (auto& shard : shards_) {
+    ok = shard->drop_name_index() && ok;
+  }
+  return ok;
+}
+
+bool ShardRouter::name_index_enabled() const {
+  for (const auto& shard : shards_) {
+    if (shard->name_index_enabled()) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// ==============================================================================
+// 私有辅助方法
+// ==============================================================================
+
+/**
+ * @brief 条目所在分片：由父目录路径决定，根目录固定在0号分片。
+ */
+size_t ShardRouter::shard_for_entry(const std::string& normalized_path) const {
+  if (normalized_path == "/") {
+    return 0;
+  }
+  return shard_for_directory(parent_of(normalized_path));
+}
+
+/**
+ * @brief 目录内容（其下的文件）所在分片。
+ */
+size_t ShardRouter::shard_for_directory(
+    const std::string& normalized_path) const {
+  return hash_path(normalized_path) % shards_.size();
+}
+
+bool ShardRouter::decode_fd(int fd, FileSystem*& shard, int& child_fd) const {
+  if (fd < 0 || shards_.empty()) {
+    ErrorHandler::log_error(ERROR_INVALID_FILE_DESCRIPTOR,
+                            "Invalid file descriptor: " + std::to_string(fd));
+    return false;
+  }
+  shard = shards_[fd % shards_.size()].get();
+  child_fd = fd / static_cast<int>(shards_.size());
+  return true;
+}
+
+/**
+ * @brief 路径的 FNV-1a 哈希；放置结果会持久化，因此不能使用 std::hash。
+ */
+std::uint32_t ShardRouter::hash_path(const std::string& path) {
+  std::uint32_t hash = 2166136261u;
+  for (unsigned char ch : path) {
+    hash ^= ch;
+    hash *= 16777619u;
+  }
+  return hash;
+}
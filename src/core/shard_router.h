@@ -0,0 +1,126 @@
+// ==============================================================================
+// @file   shard_router.h
+// @brief  分片命名空间：按父目录路径哈希把条目分布到 N 个独立镜像
+// ==============================================================================
+
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../utils/common.h"
+#include "../utils/error_codes.h"
+#include "../utils/error_handler.h"
+#include "block_device.h"
+
+class FileSystem;
+
+/**
+ * @class ShardRouter
+ * @brief 把一个命名空间分布到多个独立的 FileSystem 实例上。
+ *
+ * 分片集合由一个清单文件描述（即传给程序的 `<disk_file>`），清单中按顺序
+ * 列出各分片镜像。放置规则：
+ *   - 普通文件放在 hash(父目录路径) % N 号分片上，同一目录下的文件总在
+ *     同一分片，不同目录的文件分散到各分片；
+ *   - 目录在所有分片上都存在（各分片都需要完整的祖先链才能解析路径），
+ *     mkdir 与 rmdir 都以父目录所属分片为同名冲突的裁决点，再按分片号
+ *     顺序复制或删除其余副本，中途失败时撤销已完成的分片；
+ *   - 目录所属分片上的内容是完整的（文件只在此处，子目录先在此处创建），
+ *     列目录只查询该分片。
+ *
+ * 各分片拥有独立的锁、缓存和块设备，路由器本身不持有任何锁，因此不同
+ * 目录下的元数据操作可以在各分片上完全并行。文件描述符编码为
+ * `子描述符 * N + 分片号`，无需额外的映射表。
+ */
+class ShardRouter {
+ public:
+  ShardRouter();
+  ~ShardRouter();
+
+  /**
+   * @brief 判断路径是否为分片清单文件。
+   */
+  static bool is_manifest(const std::string& path);
+
+  /**
+   * @brief 创建分片镜像与清单文件。
+   * @param manifest_path 清单文件路径。
+   * @param size_mb 每个分片镜像的大小（MB）。
+   * @param options 设备选项（shards 指定分片数，其余选项应用于每个分片）。
+   * @return bool 成功返回true。
+   */
+  static bool create(const std::string& manifest_path, int size_mb,
+                     const DeviceOptions& options);
+
+  /**
+   * @brief 读取清单文件中的分片镜像路径。
+   * @param manifest_path 清单文件路径。
+   * @param[out] shard_paths 分片镜像路径（已相对清单所在目录解析）。
+   * @return bool 成功返回true。
+   */
+  static bool read_manifest(const std::string& manifest_path,
+                            std::vector<std::string>& shard_paths);
+
+  /**
+   * @brief 挂载清单中的全部分片。
+   * @param manifest_path 清单文件路径。
+   * @param read_only 为true时以只读方式挂载各分片。
+   * @return bool 全部分片挂载成功返回true。
+   */
+  bool open(const std::string& manifest_path, bool read_only = false);
+
+  /**
+   * @brief 卸载全部分片。
+   */
+  void close();
+
+  /**
+   * @brief 分片数量。
+   */
+  size_t shard_count() const;
+
+  // --- 与 FileSystem 公共接口一一对应的路由操作 ---
+  bool format();
+  int create_file(const std::string& path, int mode);
+  bool delete_file(const std::string& path);
+  bool file_exists(const std::string& path);
+  int open_file(const std::string& path, int mode);
+  bool close_file(int fd);
+  int read_file(int fd, char* buffer, int size);
+  int write_file(int fd, const char* buffer, int size);
+  bool seek_file(int fd, int position);
+  bool create_directory(const std::string& path);
+  bool list_directory(const std::string& path,
+                      std::vector<DirectoryEntry>& entries);
+  bool remove_directory(const std::string& path);
+  bool get_disk_info(std::string& info);
+  bool get_device_stats(std::string& report);
+  bool drop_caches();
+  bool get_warm_set_status(std::string& status);
+  bool set_heatmap_enabled(bool enabled);
+  bool reset_heatmap();
+  bool get_heatmap_report(std::string& report);
+  bool scrub(std::string& report, bool& corrupted);
+  bool set_verify_policy(ChecksumPolicy policy);
+  bool defragment(const std::string& path, std::string& report);
+  bool start_background_defrag();
+  bool stop_background_defrag();
+  bool get_defrag_status(std::string& status);
+  bool is_directory(const std::string& path);
+  bool stat(const std::string& path, Inode& inode);
+  bool locate(const std::string& name, std::vector<std::string>& paths);
+  bool build_name_index();
+  bool drop_name_index();
+  bool name_index_enabled() const;
+
+ private:
+  size_t shard_for_entry(const std::string& normalized_path) const;
+  size_t shard_for_directory(const std::string& normalized_path) const;
+  bool decode_fd(int fd, FileSystem*& shard, int& child_fd) const;
+  static std::uint32_t hash_path(const std::string& path);
+
+  std::vector<std::string> shard_paths_;              ///< 分片镜像路径
+  std::vector<std::unique_ptr<FileSystem>> shards_;   ///< 分片文件系统
+};
@@ -0,0 +1,296 @@
+// ==============================================================================
+// @file   striped_device.cpp
+// @brief  条带块设备的实现
+// ==============================================================================
+
+#include "striped_device.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <sstream>
+#include <thread>
+
+#include "../utils/block_utils.h"
+
+namespace {
+
+const char kStripeMagic[8] = {'D', 'S', 'I', 'M', 'S', 'T', 'R', '1'};  ///< 魔数
+const std::uint32_t kStripeVersion = 1;  ///< 格式版本
+const int kHeaderBlocks = 1;             ///< 每个成员开头的集合头块数
+
+}  // namespace
+
+// ==============================================================================
+// 构造与析构
+// ==============================================================================
+
+StripedDevice::StripedDevice()
+    : stripe_blocks_(0), member_blocks_(0), total_blocks_(0) {}
+
+StripedDevice::~StripedDevice() = default;
+
+// ==============================================================================
+// 集合的创建与识别
+// ==============================================================================
+
+std::string StripedDevice::member_path(const std::string& primary_path,
+                                       int index) {
+  return index == 0 ? primary_path
+                    : primary_path + ".stripe" + std::to_string(index);
+}
+
+bool StripedDevice::is_striped(FileBlockDevice& physical) {
+  StripeHeader header;
+  return read_header(physical, header);
+}
+
+/**
+ * @brief 创建全部成员镜像并写入条带集合头。
+ * @details 逻辑容量向下取整到整行（K 个条带单元），每个成员额外占用一个头块。
+ */
+bool StripedDevice::create(const std::string& path, long size_bytes,
+                           int members, int stripe_blocks) {
+  long row_blocks = static_cast<long>(members) * stripe_blocks;
+  long rows = size_bytes / BLOCK_SIZE / row_blocks;
+  if (members < 2 || stripe_blocks < 1 || rows < 1) {
+    ErrorHandler::log_error(ERROR_INVALID_ARGUMENT,
+                            "Disk too small for " + std::to_string(members) +
+                                " stripes of " + std::to_string(stripe_blocks) +
+                                " blocks");
+    return false;
+  }
+
+  StripeHeader header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, kStripeMagic, sizeof(kStripeMagic));
+  header.version = kStripeVersion;
+  header.member_count = members;
+  header.stripe_blocks = stripe_blocks;
+  header.member_blocks = static_cast<std::int32_t>(rows * stripe_blocks);
+
+  long member_bytes =
+      static_cast<long>(kHeaderBlocks + header.member_blocks) * BLOCK_SIZE;
+  for (int i = 0; i < members; ++i) {
+    std::string member = member_path(path, i);
+    if (!FileBlockDevice::create(member, member_bytes)) {
+      return false;
+    }
+
+    FileBlockDevice device;
+    if (!device.open(member)) {
+      return false;
+    }
+    header.member_index = i;
+    auto buffer = BlockUtils::create_block_buffer();
+    memcpy(buffer.get(), &header, sizeof(header));
+    if (!device.write_block(0, buffer.get())) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * @brief 以已打开的主镜像为成员0，打开其余成员并校验集合头。
+ */
+bool StripedDevice::open(std::unique_ptr<FileBlockDevice> primary) {
+  StripeHeader header;
+  if (!read_header(*primary, header) || header.member_index != 0) {
+    ErrorHandler::log_error(ERROR_INVALID_ARGUMENT,
+                            "Not the first member of a stripe set: " +
+                                primary->get_path());
+    return false;
+  }
+
+  std::string path = primary->get_path();
+  bool read_only = primary->is_read_only();
+  members_.clear();
+  members_.push_back(std::move(primary));
+  for (int i = 1; i < header.member_count; ++i) {
+    auto member = std::make_unique<FileBlockDevice>();
+    std::string member_file = member_path(path, i);
+    StripeHeader member_header;
+    if (!member->open(member_file, read_only)) {
+      members_.clear();
+      return false;
+    }
+    if (!read_header(*member, member_header) || member_header.member_index != i ||
+        member_header.member_count != header.member_count ||
+        member_header.stripe_blocks != header.stripe_blocks ||
+        member_header.member_blocks != header.member_blocks) {
+      ErrorHandler::log_error(ERROR_INVALID_ARGUMENT,
+                              "Stripe member does not match set: " + member_file);
+      members_.clear();
+      return false;
+    }
+    members_.push_back(std::move(member));
+  }
+
+  stripe_blocks_ = header.stripe_blocks;
+  member_blocks_ = header.member_blocks;
+  total_blocks_ = member_blocks_ * header.member_count;
+  return true;
+}
+
+// ==============================================================================
+// 块级I/O
+// ==============================================================================
+
+bool StripedDevice::read_block(int block_num, char* buffer) {
+  int member, member_block;
+  locate(block_num, member, member_block);
+  return members_[member]->read_block(member_block, buffer);
+}
+
+bool StripedDevice::write_block(int block_num, const char* buffer) {
+  int member, member_block;
+  locate(block_num, member, member_block);
+  return members_[member]->write_block(member_block, buffer);
+}
+
+bool StripedDevice::read_blocks(int start_block, int count, char* buffer) {
+  return transfer(start_block, count, buffer, nullptr);
+}
+
+bool StripedDevice::write_blocks(int start_block, int count,
+                                 const char* buffer) {
+  return transfer(start_block, count, nullptr, buffer);
+}
+
+int StripedDevice::get_total_blocks() const { return total_blocks_; }
+
+std::string StripedDevice::describe() const {
+  std::ostringstream oss;
+  oss << "striped (" << members_.size() << " members, unit "
+      << stripe_blocks_ << " blocks)";
+  return oss.str();
+}
+
+void StripedDevice::collect_stats(std::vector<DeviceStats>& stats) const {
+  for (const auto& member : members_) {
+    member->collect_stats(stats);
+  }
+}
+
+bool StripedDevice::drop_host_cache() {
+  bool ok = true;
+  for (const auto& member : members_) {
+    ok = member->drop_host_cache() && ok;
+  }
+  return ok;
+}
+
+// ==============================================================================
+// 私有辅助方法
+// ==============================================================================
+
+/**
+ * @brief 读取并校验物理设备块0中的条带集合头。
+ */
+bool StripedDevice::read_header(FileBlockDevice& physical,
+                                StripeHeader& header) {
+  if (physical.get_total_blocks() < kHeaderBlocks + 1) {
+    return false;
+  }
+  auto buffer = BlockUtils::create_block_buffer();
+  if (!physical.read_block(0, buffer.get())) {
+    return false;
+  }
+  memcpy(&header, buffer.get(), sizeof(header));
+  return memcmp(header.magic, kStripeMagic, sizeof(kStripeMagic)) == 0 &&
+         header.version == kStripeVersion && header.member_count >= 2 &&
+         header.member_index >= 0 &&
+         header.member_index < header.member_count &&
+         header.stripe_blocks > 0 && header.member_blocks > 0 &&
+         header.member_blocks % header.stripe_blocks == 0 &&
+         physical.get_total_blocks() >= kHeaderBlocks + header.member_blocks;
+}
+
+/**
+ * @brief 把逻辑块号映射到 (成员, 成员内块号)。
+ */
+void StripedDevice::locate(int block_num, int& member,
+                           int& member_block) const {
+  int unit = block_num / stripe_blocks_;
+  int width = static_cast<int>(members_.size());
+  member = unit % width;
+  member_block = kHeaderBlocks + (unit / width) * stripe_blocks_ +
+                 block_num % stripe_blocks_;
+}
+
+/**
+ * @brief 把一段逻辑块拆分为各成员上的连续传输。
+ * @return bool 涉及多于一个成员时返回true。
+ */
+bool StripedDevice::split(int start_block, int count,
+                          std::vector<std::vector<Extent>>& plan) const {
+  plan.assign(members_.size(), {});
+  int touched = 0;
+  int block = start_block;
+  while (block < start_block + count) {
+    int member, member_block;
+    locate(block, member, member_block);
+    int run = std::min(stripe_blocks_ - block % stripe_blocks_,
+                       start_block + count - block);
+    size_t offset = static_cast<size_t>(block - start_block) * BLOCK_SIZE;
+
+    auto& extents = plan[member];
+    if (extents.empty()) {
+      ++touched;
+    }
+    extents.push_back({member_block, run, offset});
+    block += run;
+  }
+  return touched > 1;
+}
+
+/**
+ * @brief 执行多块传输：跨成员时每个成员一个线程并行读写。
+ */
+bool StripedDevice::transfer(int start_block, int count, char* read_buffer,
+                             const char* write_buffer) {
+  std::vector<std::vector<Extent>> plan;
+  bool parallel = split(start_block, count, plan);
+
+  auto run_member = [&](size_t member) {
+    for (const Extent& extent : plan[member]) {
+      bool ok = read_buffer
+                    ? members_[member]->read_blocks(extent.member_block,
+                                                    extent.count,
+                                                    read_buffer + extent.offset)
+                    : members_[member]->write_blocks(extent.member_block,
+                                                     extent.count,
+                                                     write_buffer + extent.offset);
+      if (!ok) {
+        return false;
+      }
+    }
+    return true;
+  };
+
+  if (!parallel) {
+    for (size_t member = 0; member < plan.size(); ++member) {
+      if (!run_member(member)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  std::atomic<bool> ok(true);
+  std::vector<std::thread> workers;
+  for (size_t member = 0; member < plan.size(); ++member) {
+    if (!plan[member].empty()) {
+      workers.emplace_back([&, member]() {
+        if (!run_member(member)) {
+          ok = false;
+        }
+      });
+    }
+  }
+  for (auto& worker : workers) {
+    worker.join();
+  }
+  return ok;
+}
@@ -0,0 +1,109 @@
+// ==============================================================================
+// @file   striped_device.h
+// @brief  条带块设备（RAID-0）：逻辑块按条带单元轮流分布到多个镜像文件
+// ==============================================================================
+
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../utils/common.h"
+#include "../utils/error_codes.h"
+#include "../utils/error_handler.h"
+#include "block_device.h"
+#include "file_block_device.h"
+
+/**
+ * @class StripedDevice
+ * @brief 把逻辑块空间交错分布到 K 个成员镜像文件上。
+ *
+ * 逻辑块 b 所在的条带单元为 u = b / unit，落在 u % K 号成员上，
+ * 成员内位置为 1 + (u / K) * unit + b % unit。每个成员的块0保存条带
+ * 集合头（成员数、成员序号、条带单元），打开时据此校验成员文件是否
+ * 属于同一集合且顺序正确。成员0即传给程序的 `<disk_file>`，其余成员
+ * 为同目录下的 `<disk_file>.stripe<i>`。
+ *
+ * 跨越多个成员的多块传输按成员拆分，每个成员在独立线程中顺序读写自己
+ * 负责的条带单元，大块顺序 I/O 因此可以同时利用所有成员。单块访问直接
+ * 转发给所在成员，不引入额外开销。
+ */
+class StripedDevice : public BlockDevice {
+ public:
+  StripedDevice();
+  ~StripedDevice() override;
+
+  /**
+   * @brief 获取第 index 个成员镜像的路径（成员0为主镜像本身）。
+   */
+  static std::string member_path(const std::string& primary_path, int index);
+
+  /**
+   * @brief 检查物理设备是否为条带集合的成员。
+   */
+  static bool is_striped(FileBlockDevice& physical);
+
+  /**
+   * @brief 创建全部成员镜像并写入条带集合头。
+   * @param path 主镜像路径。
+   * @param size_bytes 逻辑容量（字节），平均分配到各成员。
+   * @param members 成员数。
+   * @param stripe_blocks 条带单元大小（块）。
+   * @return bool 成功返回true。
+   */
+  static bool create(const std::string& path, long size_bytes, int members,
+                     int stripe_blocks);
+
+  /**
+   * @brief 以已打开的主镜像为成员0，打开其余成员并校验集合头。
+   * @param primary 已打开的主镜像设备（其余成员沿用它的只读/读写方式）。
+   * @return bool 成功返回true。
+   */
+  bool open(std::unique_ptr<FileBlockDevice> primary);
+
+  bool read_block(int block_num, char* buffer) override;
+  bool write_block(int block_num, const char* buffer) override;
+  bool read_blocks(int start_block, int count, char* buffer) override;
+  bool write_blocks(int start_block, int count, const char* buffer) override;
+  int get_total_blocks() const override;
+  std::string describe() const override;
+  void collect_stats(std::vector<DeviceStats>& stats) const override;
+  bool drop_host_cache() override;
+
+ private:
+  /**
+   * @struct StripeHeader
+   * @brief 成员块0中的条带集合头。
+   */
+  struct StripeHeader {
+    char magic[8];                ///< 魔数 "DSIMSTR1"
+    std::uint32_t version;        ///< 格式版本
+    std::int32_t member_count;    ///< 成员数
+    std::int32_t member_index;    ///< 本成员序号
+    std::int32_t stripe_blocks;   ///< 条带单元大小（块）
+    std::int32_t member_blocks;   ///< 每个成员的数据块数
+  };
+
+  /**
+   * @struct Extent
+   * @brief 一段落在单个成员上的连续传输。
+   */
+  struct Extent {
+    int member_block;  ///< 成员内起始块号
+    int count;         ///< 块数
+    size_t offset;     ///< 在调用方缓冲区中的字节偏移
+  };
+
+  static bool read_header(FileBlockDevice& physical, StripeHeader& header);
+  void locate(int block_num, int& member, int& member_block) const;
+  bool split(int start_block, int count,
+             std::vector<std::vector<Extent>>& plan) const;
+  bool transfer(int start_block, int count, char* read_buffer,
+                const char* write_buffer);
+
+  std::vector<std::unique_ptr<FileBlockDevice>> members_;  ///< 成员镜像
+  int stripe_blocks_;   ///< 条带单元大小（块）
+  int member_blocks_;   ///< 每个成员的数据块数
+  int total_blocks_;    ///< 逻辑总块数
+};
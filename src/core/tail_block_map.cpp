@@ -0,0 +1,80 @@
+// ==============================================================================
+// @file   tail_block_map.cpp
+// @brief  共享尾块槽位占用表的实现
+// ==============================================================================
+
+#include "tail_block_map.h"
+
+static_assert(TailBlockMap::kSlots == 64, "slot bitmap must fit in 64 bits");
+
+int TailBlockMap::slots_for(int length) {
+  return (length + kSlotSize - 1) / kSlotSize;
+}
+
+bool TailBlockMap::is_loaded() const {
+  return loaded_;
+}
+
+void TailBlockMap::mark_loaded() {
+  loaded_ = true;
+}
+
+void TailBlockMap::clear() {
+  blocks_.clear();
+  tails_ = 0;
+  loaded_ = false;
+}
+
+void TailBlockMap::add(int block, int offset, int length) {
+  blocks_[block] |= slot_mask(offset, length);
+  ++tails_;
+}
+
+bool TailBlockMap::find_space(int length, int& block, int& offset) const {
+  int needed = slots_for(length);
+  for (const auto& [tail_block, used] : blocks_) {
+    for (int slot = 0; slot + needed <= kSlots; ++slot) {
+      std::uint64_t mask = slot_mask(slot * kSlotSize, length);
+      if ((used & mask) == 0) {
+        block = tail_block;
+        offset = slot * kSlotSize;
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+bool TailBlockMap::release(int block, int offset, int length) {
+  auto it = blocks_.find(block);
+  if (it == blocks_.end()) {
+    return false;
+  }
+  it->second &= ~slot_mask(offset, length);
+  if (tails_ > 0) {
+    --tails_;
+  }
+  if (it->second != 0) {
+    return false;
+  }
+  blocks_.erase(it);
+  return true;
+}
+
+std::size_t TailBlockMap::block_count() const {
+  return blocks_.size();
+}
+
+std::size_t TailBlockMap::tail_count() const {
+  return tails_;
+}
+
+/**
+ * @brief 从 offset 起、覆盖 length 字节的槽位掩码。
+ */
+std::uint64_t TailBlockMap::slot_mask(int offset, int length) {
+  int first = offset / kSlotSize;
+  int count = slots_for(length);
+  std::uint64_t bits = count >= kSlots ? ~0ULL : ((1ULL << count) - 1);
+  return bits << first;
+}
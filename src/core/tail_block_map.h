@@ -0,0 +1,76 @@
+// ==============================================================================
+// @file   tail_block_map.h
+// @brief  共享尾块的槽位占用表
+// ==============================================================================
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <map>
+
+#include "../utils/common.h"
+
+/**
+ * @class TailBlockMap
+ * @brief 记录每个共享尾块中哪些槽位已被文件尾部占用。
+ *
+ * 共享尾块按 kSlotSize 字节划分为 kSlots 个槽位，一个文件尾部占用一段
+ * 连续槽位，起点记录在 inode 的 tail_ref 中。占用表不落盘：它完全由
+ * tail_ref 非零的 inode 推导，挂载后第一次需要时扫描 inode 表重建。本类只做内存中的记账，不进行 I/O，也不加锁。
+ */
+class TailBlockMap {
+ public:
+  static constexpr int kSlotSize = 64;                   ///< 槽位大小（字节）
+  static constexpr int kSlots = BLOCK_SIZE / kSlotSize;  ///< 每块槽位数（64）
+  static constexpr int kMaxTailBytes = 3072;             ///< 参与打包的最大尾部长度
+
+  /**
+   * @brief 长度为 length 的尾部占用的槽位数。
+   */
+  static int slots_for(int length);
+
+  /** @brief 是否已从 inode 表重建。 */
+  bool is_loaded() const;
+
+  /** @brief 标记为已重建。 */
+  void mark_loaded();
+
+  /** @brief 清空占用表（格式化或重新初始化时调用）。 */
+  void clear();
+
+  /**
+   * @brief 登记一个尾部占用的槽位。
+   * @param block 共享尾块号。
+   * @param offset 尾部在块内的字节偏移。
+   * @param length 尾部长度（字节）。
+   */
+  void add(int block, int offset, int length);
+
+  /**
+   * @brief 在已有的尾块中查找能容纳 length 字节的连续空闲槽位（首次适配）。
+   * @param length 尾部长度（字节）。
+   * @param[out] block 找到的尾块号。
+   * @param[out] offset 空闲槽位的字节偏移。
+   * @return bool 找到返回true。
+   */
+  bool find_space(int length, int& block, int& offset) const;
+
+  /**
+   * @brief 归还一个尾部占用的槽位。
+   * @return bool 该块因此不再被任何尾部占用（已从表中移除）时返回true。
+   */
+  bool release(int block, int offset, int length);
+
+  /** @brief 共享尾块数。 */
+  std::size_t block_count() const;
+
+  /** @brief 打包的尾部数。 */
+  std::size_t tail_count() const;
+
+ private:
+  static std::uint64_t slot_mask(int offset, int length);
+
+  std::map<int, std::uint64_t> blocks_;  ///< 尾块号 -> 槽位占用位图
+  std::size_t tails_ = 0;                ///< 打包的尾部数
+  bool loaded_ = false;                  ///< 是否已重建
+};
@@ -0,0 +1,738 @@
+// ==============================================================================
+// @file   tiered_device.cpp
+// @brief  冷热分层块设备的实现
+// ==============================================================================
+
+#include "tiered_device.h"
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <sstream>
+
+#include "../utils/block_utils.h"
+#include "../utils/slow_op_watchdog.h"
+
+namespace {
+
+const char kTierMagic[8] = {'D', 'S', 'I', 'M', 'T', 'I', 'E', 'R'};  ///< 魔数
+const std::uint32_t kTierVersion = 1;      ///< 格式版本
+const char kConfigSuffix[] = ".tier";      ///< 分层配置文件后缀
+const char kFastSuffix[] = ".fast";        ///< 默认快速层文件后缀
+const int kHeaderBlocks = 1;               ///< 分层头占用的块数
+const int kSlotsPerMapBlock = BLOCK_SIZE / sizeof(std::int32_t);  ///< 每个映射区块的槽位数
+const int kMinSlots = 16;                  ///< 最少槽位数
+
+const std::size_t kMigrationBatch = 256;   ///< 每轮最多迁入的块数（1MB）
+const std::uint16_t kPromoteMinHeat = 4;   ///< 迁入所需的最低读计数
+const std::uint16_t kMaxHeat = 0xFFFF;     ///< 读计数上限（饱和不回绕）
+
+/**
+ * @brief 快速层按闪存建模：几乎没有寻道开销。
+ */
+DeviceLatencyModel fast_tier_model() {
+  DeviceLatencyModel model;
+  model.seek_base_ms = 0.02;
+  model.full_stroke_ms = 0.0;
+  model.transfer_ms_per_block = 0.01;
+  return model;
+}
+
+/**
+ * @brief 迁移间隔，取自 DISKSIM_TIER_MIGRATE_MS（默认1000毫秒，最小10毫秒）。
+ */
+std::chrono::milliseconds migrate_interval() {
+  const char* value = std::getenv("DISKSIM_TIER_MIGRATE_MS");
+  long ms = value ? std::atol(value) : 1000;
+  return std::chrono::milliseconds(std::max(ms, 10L));
+}
+
+/**
+ * @brief 是否模拟快速层写入失败，取自 DISKSIM_TIER_FAIL_WRITES（测试用）。
+ * @details 只影响前台写入对驻留副本的更新，迁移仍正常写入快速层。
+ */
+bool simulate_fast_write_errors() {
+  const char* value = std::getenv("DISKSIM_TIER_FAIL_WRITES");
+  return value && std::atoi(value) != 0;
+}
+
+/**
+ * @brief 快速层文件块数对应的映射区块数与槽位数。
+ * @details 映射区块数 m 满足 m * 1024 >= 总块数 - 1 - m，取最小值。
+ */
+void split_fast_blocks(int fast_blocks, int& map_blocks, int& slots) {
+  map_blocks =
+      (fast_blocks - kHeaderBlocks + kSlotsPerMapBlock) / (kSlotsPerMapBlock + 1);
+  slots = fast_blocks - kHeaderBlocks - map_blocks;
+}
+
+/**
+ * @brief 涉及 [start, start + count) 的分段锁编号（升序、去重）。
+ */
+std::vector<int> lock_order(int start_block, int count, int stripes) {
+  std::vector<int> order;
+  int distinct = std::min(count, stripes);
+  order.reserve(distinct);
+  for (int i = 0; i < distinct; ++i) {
+    order.push_back((start_block + i) % stripes);
+  }
+  std::sort(order.begin(), order.end());
+  return order;
+}
+
+}  // namespace
+
+// ==============================================================================
+// 构造与析构
+// ==============================================================================
+
+TieredDevice::TieredDevice(std::unique_ptr<BlockDevice> slow)
+    : slow_(std::move(slow)),
+      total_blocks_(0),
+      slots_(0),
+      map_blocks_(0),
+      pinned_blocks_(0),
+      read_only_(false),
+      opened_(false),
+      cold_start_(false),
+      fail_fast_writes_(false),
+      fast_reads_(0),
+      slow_reads_(0),
+      promotions_(0),
+      evictions_(0),
+      passes_(0),
+      fast_write_errors_(0),
+      stop_migrator_(false) {}
+
+TieredDevice::~TieredDevice() { close(); }
+
+// ==============================================================================
+// 分层配置
+// ==============================================================================
+
+/**
+ * @brief 写入 <image_path>.tier 并新建空的快速层文件。
+ * @details 配置文件为文本：魔数与版本、配置标识、快速层块数、快速层路径各一行。
+ */
+bool TieredDevice::create(const std::string& image_path,
+                          const std::string& fast_path, int fast_mb) {
+  TierConfig config;
+  config.fast_path = fast_path.empty() ? image_path + kFastSuffix : fast_path;
+  config.fast_blocks =
+      static_cast<int>(static_cast<long>(fast_mb) * 1024 * 1024 / BLOCK_SIZE);
+  int map_blocks = 0;
+  int slots = 0;
+  split_fast_blocks(config.fast_blocks, map_blocks, slots);
+  if (slots < kMinSlots) {
+    ErrorHandler::log_error(ERROR_INVALID_ARGUMENT, "Fast tier is too small");
+    return false;
+  }
+
+  std::random_device random;
+  config.set_id = (static_cast<std::uint64_t>(random()) << 32) | random();
+
+  // 新建的快速层全为零，分层头无效，首次打开时从空层开始
+  if (!FileBlockDevice::create(config.fast_path,
+                               static_cast<long>(config.fast_blocks) * BLOCK_SIZE)) {
+    return false;
+  }
+
+  std::ofstream output(image_path + kConfigSuffix, std::ios::trunc);
+  output << "DSIMTIER " << kTierVersion << "\n"
+         << config.set_id << "\n"
+         << config.fast_blocks << "\n"
+         << config.fast_path << "\n";
+  if (!output) {
+    ErrorHandler::log_error(ERROR_IO_ERROR, "Failed to write tier configuration: " +
+                                                image_path + kConfigSuffix);
+    return false;
+  }
+  return true;
+}
+
+bool TieredDevice::load_config(const std::string& image_path, TierConfig& config) {
+  std::ifstream input(image_path + kConfigSuffix);
+  if (!input.is_open()) {
+    return false;
+  }
+
+  std::string magic;
+  std::uint32_t version = 0;
+  input >> magic >> version >> config.set_id >> config.fast_blocks;
+  input.ignore(1, '\n');
+  std::getline(input, config.fast_path);
+  if (!input || magic != "DSIMTIER" || version != kTierVersion ||
+      config.fast_path.empty() || config.fast_blocks <= kHeaderBlocks) {
+    ErrorHandler::log_error(ERROR_INVALID_ARGUMENT, "Invalid tier configuration: " +
+                                                        image_path + kConfigSuffix);
+    return false;
+  }
+  return true;
+}
+
+void TieredDevice::remove_config(const std::string& image_path) {
+  std::remove((image_path + kConfigSuffix).c_str());
+}
+
+// ==============================================================================
+// 打开与关闭
+// ==============================================================================
+
+/**
+ * @brief 打开快速层并载入槽位映射。
+ * @details 读写打开时快速层文件缺失或大小不符则重建；只读打开时快速层
+ *          不可用则直接使用慢速层。
+ */
+bool TieredDevice::open(const TierConfig& config, bool read_only) {
+  config_ = config;
+  read_only_ = read_only;
+  fail_fast_writes_ = simulate_fast_write_errors();
+  total_blocks_ = slow_->get_total_blocks();
+  block_slot_.reset(new std::atomic<int>[total_blocks_]);
+  heat_.reset(new std::atomic<std::uint16_t>[total_blocks_]);
+  for (int i = 0; i < total_blocks_; ++i) {
+    block_slot_[i] = -1;
+    heat_[i] = 0;
+  }
+  split_fast_blocks(config_.fast_blocks, map_blocks_, slots_);
+
+  long fast_bytes = static_cast<long>(config_.fast_blocks) * BLOCK_SIZE;
+  bool present = access(config_.fast_path.c_str(), F_OK) == 0;
+  if (read_only_ && !present) {
+    slots_ = 0;
+    cold_start_ = true;
+    opened_ = true;
+    return true;
+  }
+  if (!present && !FileBlockDevice::create(config_.fast_path, fast_bytes)) {
+    return false;
+  }
+  fast_ = std::make_unique<FileBlockDevice>();
+  if (!fast_->open(config_.fast_path, read_only_)) {
+    return false;
+  }
+  if (fast_->get_total_blocks() < config_.fast_blocks) {
+    if (read_only_) {
+      fast_.reset();
+      slots_ = 0;
+      cold_start_ = true;
+      opened_ = true;
+      return true;
+    }
+    // 快速层文件被截断（例如手工清理），重建为空层
+    fast_.reset();
+    if (!FileBlockDevice::create(config_.fast_path, fast_bytes)) {
+      return false;
+    }
+    fast_ = std::make_unique<FileBlockDevice>();
+    if (!fast_->open(config_.fast_path, read_only_)) {
+      return false;
+    }
+  }
+  fast_->set_latency_model(fast_tier_model());
+
+  slot_block_.assign(slots_, -1);
+  map_dirty_.assign(map_blocks_, false);
+  TierHeader header;
+  memset(&header, 0, sizeof(header));
+  auto buffer = BlockUtils::create_block_buffer();
+  if (fast_->read_block(0, buffer.get())) {
+    memcpy(&header, buffer.get(), sizeof(header));
+  }
+  bool valid = memcmp(header.magic, kTierMagic, sizeof(kTierMagic)) == 0 &&
+               header.version == kTierVersion && header.set_id == config_.set_id &&
+               header.slow_blocks == total_blocks_ && header.slots == slots_ &&
+               header.map_blocks == map_blocks_ && header.clean == 1;
+  cold_start_ = !valid || !load_map();
+  if (cold_start_) {
+    std::fill(slot_block_.begin(), slot_block_.end(), -1);
+    for (int i = 0; i < total_blocks_; ++i) {
+      block_slot_[i] = -1;
+    }
+    map_dirty_.assign(map_blocks_, true);
+  }
+  free_slots_.clear();
+  for (int slot = slots_ - 1; slot >= 0; --slot) {
+    if (slot_block_[slot] < 0) {
+      free_slots_.push_back(slot);
+    }
+  }
+
+  if (!read_only_ && !write_header(false)) {
+    return false;
+  }
+  opened_ = true;
+  if (!read_only_) {
+    stop_migrator_ = false;
+    migrator_thread_ = std::thread(&TieredDevice::migrator_loop, this);
+  }
+  return true;
+}
+
+/**
+ * @brief 固定元数据区：依次复制尚未驻留的块，必要时替换未固定的驻留块。
+ */
+void TieredDevice::pin_metadata(int count) {
+  if (read_only_ || !fast_) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(migrate_mutex_);
+  pinned_blocks_ = std::min({count, slots_ / 2, total_blocks_});
+
+  std::vector<int> victims;
+  for (int slot = 0; slot < slots_; ++slot) {
+    if (slot_block_[slot] >= pinned_blocks_) {
+      victims.push_back(slot);
+    }
+  }
+  for (int block = 0; block < pinned_blocks_; ++block) {
+    if (block_slot_[block] >= 0) {
+      continue;
+    }
+    int slot;
+    bool evict = free_slots_.empty();
+    if (!evict) {
+      slot = free_slots_.back();
+      free_slots_.pop_back();
+    } else if (!victims.empty()) {
+      slot = victims.back();
+      victims.pop_back();
+    } else {
+      break;
+    }
+    if (promote(block, slot)) {
+      ++promotions_;
+      if (evict) {
+        ++evictions_;
+      }
+    } else if (slot_block_[slot] < 0) {
+      free_slots_.push_back(slot);
+    }
+  }
+}
+
+/**
+ * @brief 停止迁移线程，最后迁移一轮，写回映射区并标记正常关闭。
+ */
+void TieredDevice::close() {
+  if (!opened_) {
+    return;
+  }
+  if (migrator_thread_.joinable()) {
+    {
+      std::lock_guard<std::mutex> lock(migrator_mutex_);
+      stop_migrator_ = true;
+    }
+    migrator_cv_.notify_all();
+    migrator_thread_.join();
+  }
+  if (!read_only_ && fast_) {
+    // 把本次会话中变热的块带到下次打开
+    migrate_once();
+    if (write_map() && write_header(true)) {
+      fast_->flush();
+    }
+  }
+  opened_ = false;
+}
+
+// ==============================================================================
+// 块级I/O
+// ==============================================================================
+
+bool TieredDevice::read_block(int block_num, char* buffer) {
+  count_read(block_num);
+  std::shared_lock<std::shared_mutex> lock(block_locks_[block_num % kLockStripes]);
+  int slot = block_slot_[block_num].load(std::memory_order_relaxed);
+  if (slot >= 0) {
+    ++fast_reads_;
+    return fast_->read_block(kHeaderBlocks + map_blocks_ + slot, buffer);
+  }
+  ++slow_reads_;
+  return slow_->read_block(block_num, buffer);
+}
+
+/**
+ * @brief 写穿：先写慢速层，块驻留在快速层时再更新副本。
+ * @details 副本更新失败时撤下该块，之后的读取改走慢速层；数据已经落在
+ *          慢速层，写入本身仍算成功。
+ */
+bool TieredDevice::write_block(int block_num, const char* buffer) {
+  std::unique_lock<std::shared_mutex> lock(block_locks_[block_num % kLockStripes]);
+  if (!slow_->write_block(block_num, buffer)) {
+    return false;
+  }
+  int slot = block_slot_[block_num].load(std::memory_order_relaxed);
+  if (slot < 0 || write_fast_copy(slot, buffer)) {
+    return true;
+  }
+  block_slot_[block_num].store(-1, std::memory_order_relaxed);
+  lock.unlock();
+  release_failed_slot(block_num, slot);
+  return true;
+}
+
+/**
+ * @brief 读取连续多块：驻留的块逐块从快速层读取，其余的连续段整段从慢速层读取。
+ */
+bool TieredDevice::read_blocks(int start_block, int count, char* buffer) {
+  std::vector<std::shared_lock<std::shared_mutex>> locks;
+  for (int stripe : lock_order(start_block, count, kLockStripes)) {
+    locks.emplace_back(block_locks_[stripe]);
+  }
+
+  int i = 0;
+  while (i < count) {
+    int block = start_block + i;
+    char* target = buffer + static_cast<size_t>(i) * BLOCK_SIZE;
+    count_read(block);
+    int slot = block_slot_[block].load(std::memory_order_relaxed);
+    if (slot >= 0) {
+      ++fast_reads_;
+      if (!fast_->read_block(kHeaderBlocks + map_blocks_ + slot, target)) {
+        return false;
+      }
+      ++i;
+      continue;
+    }
+    int run = 1;
+    while (i + run < count &&
+           block_slot_[block + run].load(std::memory_order_relaxed) < 0) {
+      count_read(block + run);
+      ++run;
+    }
+    slow_reads_ += run;
+    if (!slow_->read_blocks(block, run, target)) {
+      return false;
+    }
+    i += run;
+  }
+  return true;
+}
+
+bool TieredDevice::write_blocks(int start_block, int count, const char* buffer) {
+  std::vector<std::unique_lock<std::shared_mutex>> locks;
+  for (int stripe : lock_order(start_block, count, kLockStripes)) {
+    locks.emplace_back(block_locks_[stripe]);
+  }
+
+  if (!slow_->write_blocks(start_block, count, buffer)) {
+    return false;
+  }
+  std::vector<std::pair<int, int>> failed;  // (块号, 槽位)
+  for (int i = 0; i < count; ++i) {
+    int block = start_block + i;
+    int slot = block_slot_[block].load(std::memory_order_relaxed);
+    if (slot >= 0 &&
+        !write_fast_copy(slot, buffer + static_cast<size_t>(i) * BLOCK_SIZE)) {
+      block_slot_[block].store(-1, std::memory_order_relaxed);
+      failed.emplace_back(block, slot);
+    }
+  }
+  locks.clear();
+  for (const auto& entry : failed) {
+    release_failed_slot(entry.first, entry.second);
+  }
+  return true;
+}
+
+/**
+ * @brief 被释放的块热度清零，驻留副本成为迁移时最先被替换的对象。
+ */
+bool TieredDevice::discard_block(int block_num) {
+  heat_[block_num].store(0, std::memory_order_relaxed);
+  return slow_->discard_block(block_num);
+}
+
+bool TieredDevice::flush() {
+  if (!read_only_ && fast_ && (!write_map() || !fast_->flush())) {
+    return false;
+  }
+  return slow_->flush();
+}
+
+bool TieredDevice::drop_host_cache() {
+  bool ok = slow_->drop_host_cache();
+  return (!fast_ || fast_->drop_host_cache()) && ok;
+}
+
+int TieredDevice::get_total_blocks() const { return total_blocks_; }
+
+std::string TieredDevice::describe() const {
+  std::uint64_t fast_reads = fast_reads_.load();
+  std::uint64_t slow_reads = slow_reads_.load();
+  std::uint64_t reads = fast_reads + slow_reads;
+  int resident = 0;
+  for (int i = 0; i < total_blocks_; ++i) {
+    if (block_slot_[i].load(std::memory_order_relaxed) >= 0) {
+      ++resident;
+    }
+  }
+
+  std::ostringstream oss;
+  oss << "tiered (fast tier " << config_.fast_path;
+  if (!fast_) {
+    oss << " unavailable)";
+  } else {
+    oss << ", " << resident << "/" << slots_ << " blocks resident, "
+        << pinned_blocks_ << " pinned" << (cold_start_ ? ", cold start" : "")
+        << ")";
+  }
+  oss << std::endl
+      << "    Fast tier reads: " << fast_reads << " ("
+      << (reads ? 100 * fast_reads / reads : 0) << "%), Slow tier reads: "
+      << slow_reads;
+  oss << std::endl
+      << "    Promotions: " << promotions_.load()
+      << ", Evictions: " << evictions_.load()
+      << " (migration passes: " << passes_.load() << ")";
+  if (std::uint64_t errors = fast_write_errors_.load()) {
+    oss << ", " << errors << " fast tier write errors";
+  }
+  std::string backing = slow_->describe();
+  if (backing != "plain") {
+    oss << std::endl << "    Backing device: " << backing;
+  }
+  return oss.str();
+}
+
+void TieredDevice::collect_stats(std::vector<DeviceStats>& stats) const {
+  slow_->collect_stats(stats);
+  if (fast_) {
+    fast_->collect_stats(stats);
+  }
+}
+
+// ==============================================================================
+// 迁移
+// ==============================================================================
+
+/**
+ * @brief 把一个块复制到指定槽位；槽位原有的块先被撤下。调用者持有 migrate_mutex_。
+ * @return bool 复制成功返回true；失败时槽位变为空。
+ */
+bool TieredDevice::promote(int block_num, int slot) {
+  int victim = slot_block_[slot];
+  int first = block_num % kLockStripes;
+  int second = victim >= 0 ? victim % kLockStripes : first;
+  std::unique_lock<std::shared_mutex> lock_a(block_locks_[std::min(first, second)]);
+  std::unique_lock<std::shared_mutex> lock_b;
+  if (first != second) {
+    lock_b = std::unique_lock<std::shared_mutex>(block_locks_[std::max(first, second)]);
+  }
+
+  // 先撤下旧块，槽位内容被覆盖期间不会再有读取落到这里；旧块可能已因
+  // 写入失败被撤下并迁入别的槽位，此时不能改动它的新映射
+  if (victim >= 0) {
+    if (block_slot_[victim].load(std::memory_order_relaxed) == slot) {
+      block_slot_[victim].store(-1, std::memory_order_relaxed);
+    }
+    slot_block_[slot] = -1;
+  }
+  map_dirty_[slot / kSlotsPerMapBlock] = true;
+
+  auto buffer = BlockUtils::create_block_buffer();
+  if (!slow_->read_block(block_num, buffer.get()) ||
+      !fast_->write_block(kHeaderBlocks + map_blocks_ + slot, buffer.get())) {
+    return false;
+  }
+  slot_block_[slot] = block_num;
+  block_slot_[block_num].store(slot, std::memory_order_relaxed);
+  return true;
+}
+
+/**
+ * @brief 用新数据更新槽位中的驻留副本。调用者持有该块的分段写锁。
+ */
+bool TieredDevice::write_fast_copy(int slot, const char* buffer) {
+  if (fail_fast_writes_) {
+    return false;
+  }
+  return fast_->write_block(kHeaderBlocks + map_blocks_ + slot, buffer);
+}
+
+/**
+ * @brief 副本更新失败的块已在分段锁内撤下，这里把槽位交还空槽位表。
+ * @details 迁移先取 migrate_mutex_ 再加分段锁，因此调用者须先释放分段锁。
+ *          其间槽位可能已被迁移替换，或该块已迁入别的槽位，只有槽位仍记着
+ *          该块且该块没有映射回这个槽位时才回收。
+ */
+void TieredDevice::release_failed_slot(int block_num, int slot) {
+  ++fast_write_errors_;
+  ErrorHandler::log_error(ERROR_IO_ERROR, "Fast tier write failed, block " +
+                                              std::to_string(block_num) +
+                                              " dropped from the fast tier");
+  std::lock_guard<std::mutex> lock(migrate_mutex_);
+  std::unique_lock<std::shared_mutex> block_lock(block_locks_[block_num % kLockStripes]);
+  if (slot_block_[slot] != block_num ||
+      block_slot_[block_num].load(std::memory_order_relaxed) == slot) {
+    return;
+  }
+  slot_block_[slot] = -1;
+  map_dirty_[slot / kSlotsPerMapBlock] = true;
+  free_slots_.push_back(slot);
+}
+
+/**
+ * @brief 一轮迁移：把最热的未驻留块迁入空槽位或替换较冷的驻留块，然后衰减热度。
+ */
+void TieredDevice::migrate_once() {
+  std::lock_guard<std::mutex> lock(migrate_mutex_);
+
+  using Ranked = std::pair<std::uint16_t, int>;  // (热度, 块号或槽位)
+  std::vector<Ranked> candidates;
+  for (int block = pinned_blocks_; block < total_blocks_; ++block) {
+    std::uint16_t heat = heat_[block].load(std::memory_order_relaxed);
+    if (heat >= kPromoteMinHeat && block_slot_[block].load(std::memory_order_relaxed) < 0) {
+      candidates.emplace_back(heat, block);
+    }
+  }
+  std::size_t wanted = std::min(candidates.size(), kMigrationBatch);
+  std::partial_sort(candidates.begin(), candidates.begin() + wanted, candidates.end(),
+                    [](const Ranked& a, const Ranked& b) { return a.first > b.first; });
+  candidates.resize(wanted);
+
+  std::vector<Ranked> victims;
+  if (candidates.size() > free_slots_.size()) {
+    for (int slot = 0; slot < slots_; ++slot) {
+      int block = slot_block_[slot];
+      if (block >= pinned_blocks_) {
+        victims.emplace_back(heat_[block].load(std::memory_order_relaxed), slot);
+      }
+    }
+    std::sort(victims.begin(), victims.end());
+  }
+
+  std::size_t next_victim = 0;
+  for (const Ranked& candidate : candidates) {
+    int slot;
+    bool evict = free_slots_.empty();
+    if (!evict) {
+      slot = free_slots_.back();
+      free_slots_.pop_back();
+    } else if (next_victim < victims.size() &&
+               victims[next_victim].first * 2 < candidate.first) {
+      slot = victims[next_victim++].second;
+    } else {
+      break;  // 剩余候选都不比驻留块热得多，避免来回迁移
+    }
+    if (promote(candidate.second, slot)) {
+      ++promotions_;
+      if (evict) {
+        ++evictions_;
+      }
+    } else if (slot_block_[slot] < 0) {
+      free_slots_.push_back(slot);
+    }
+  }
+
+  for (int block = 0; block < total_blocks_; ++block) {
+    heat_[block].store(heat_[block].load(std::memory_order_relaxed) / 2,
+                       std::memory_order_relaxed);
+  }
+  ++passes_;
+}
+
+/**
+ * @brief 后台迁移：按固定间隔执行迁移，直到设备关闭。
+ */
+void TieredDevice::migrator_loop() {
+  const auto interval = migrate_interval();
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(migrator_mutex_);
+      if (migrator_cv_.wait_for(lock, interval,
+                                [this] { return stop_migrator_.load(); })) {
+        return;
+      }
+    }
+    migrate_once();
+  }
+}
+
+// ==============================================================================
+// 私有辅助方法
+// ==============================================================================
+
+/**
+ * @brief 载入槽位映射；越界或重复的条目视为映射损坏。
+ */
+bool TieredDevice::load_map() {
+  auto buffer = BlockUtils::create_block_buffer();
+  const auto* entries = reinterpret_cast<const std::int32_t*>(buffer.get());
+  for (int i = 0; i < map_blocks_; ++i) {
+    if (!fast_->read_block(kHeaderBlocks + i, buffer.get())) {
+      return false;
+    }
+    for (int j = 0; j < kSlotsPerMapBlock; ++j) {
+      int slot = i * kSlotsPerMapBlock + j;
+      int block = entries[j];
+      if (slot >= slots_ || block < 0) {
+        continue;
+      }
+      if (block >= total_blocks_ || block_slot_[block] >= 0) {
+        return false;
+      }
+      slot_block_[slot] = block;
+      block_slot_[block] = slot;
+    }
+  }
+  return true;
+}
+
+bool TieredDevice::write_header(bool clean) {
+  TierHeader header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, kTierMagic, sizeof(kTierMagic));
+  header.version = kTierVersion;
+  header.set_id = config_.set_id;
+  header.slow_blocks = total_blocks_;
+  header.slots = slots_;
+  header.map_blocks = map_blocks_;
+  header.clean = clean ? 1 : 0;
+
+  auto buffer = BlockUtils::create_block_buffer();
+  memcpy(buffer.get(), &header, sizeof(header));
+  return fast_->write_block(0, buffer.get());
+}
+
+/**
+ * @brief 写回被标记为脏的映射区块。
+ */
+bool TieredDevice::write_map() {
+  SlowOpWatchdog::Phase phase(OpPhase::Flush);
+  std::lock_guard<std::mutex> lock(migrate_mutex_);
+  auto buffer = BlockUtils::create_block_buffer();
+  auto* entries = reinterpret_cast<std::int32_t*>(buffer.get());
+  for (int i = 0; i < map_blocks_; ++i) {
+    if (!map_dirty_[i]) {
+      continue;
+    }
+    for (int j = 0; j < kSlotsPerMapBlock; ++j) {
+      int slot = i * kSlotsPerMapBlock + j;
+      entries[j] = slot < slots_ ? slot_block_[slot] : -1;
+    }
+    if (!fast_->write_block(kHeaderBlocks + i, buffer.get())) {
+      ErrorHandler::log_error(ERROR_IO_ERROR, "Failed to write tier map");
+      return false;
+    }
+    map_dirty_[i] = false;
+  }
+  return true;
+}
+
+/**
+ * @brief 读计数加一（饱和于上限，由迁移轮次衰减）。
+ */
+void TieredDevice::count_read(int block_num) {
+  std::atomic<std::uint16_t>& heat = heat_[block_num];
+  if (heat.load(std::memory_order_relaxed) < kMaxHeat) {
+    heat.fetch_add(1, std::memory_order_relaxed);
+  }
+}
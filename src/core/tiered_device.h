@@ -0,0 +1,174 @@
+// ==============================================================================
+// @file   tiered_device.h
+// @brief  冷热分层块设备：小而快的快速层缓存元数据与热点块，容量留在慢速镜像上
+// ==============================================================================
+
+#pragma once
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../utils/common.h"
+#include "../utils/error_codes.h"
+#include "../utils/error_handler.h"
+#include "block_device.h"
+#include "file_block_device.h"
+
+/**
+ * @struct TierConfig
+ * @brief 镜像旁 <disk_file>.tier 中保存的分层配置。
+ */
+struct TierConfig {
+  std::string fast_path;      ///< 快速层文件路径
+  int fast_blocks{0};         ///< 快速层文件块数
+  std::uint64_t set_id{0};    ///< 创建时生成的随机标识，防止误用其他镜像的快速层
+};
+
+/**
+ * @class TieredDevice
+ * @brief 在完整设备栈之上叠加一个快速层文件（例如位于 tmpfs 或 NVMe 上）。
+ *
+ * 快速层是慢速镜像的包含式写穿缓存：块0为分层头，其后是槽位映射区
+ * （每个槽位一个 int32，记录所缓存的逻辑块号，-1为空），再之后是槽位。
+ * 写入总是先写慢速镜像，块在快速层中时再更新副本，因此快速层随时可以
+ * 丢弃（例如 tmpfs 在重启后清空），丢失的只是热度而不是数据。映射区在
+ * 刷新与关闭时写回；头中的 clean 标志在读写打开后清零、正常关闭后置位，
+ * 打开未正常关闭或与镜像不匹配的快速层时从空层开始。
+ *
+ * 打开时元数据区（超级块、inode 表与位图，最多占一半槽位）被固定在快速层。
+ * 每块一个16位读计数记录访问频率；后台迁移线程定期选出最热的未驻留块，
+ * 放入空槽位或替换热度不到其一半的未固定块，然后把所有计数减半，使热度
+ * 偏向近期访问。只有读取计入热度：写穿模式下写入总要落到慢速镜像。
+ * 块的读取与迁移通过块分段读写锁互斥。更新驻留副本失败的块立即撤下，
+ * 读取改走慢速层，槽位随后交还空槽位表。只读打开时只使用已有的映射，
+ * 不迁移也不写回。
+ */
+class TieredDevice : public BlockDevice {
+ public:
+  /**
+   * @brief 构造函数，接管慢速层（下层完整设备栈）的所有权。
+   * @param slow 已打开的下层块设备。
+   */
+  explicit TieredDevice(std::unique_ptr<BlockDevice> slow);
+  ~TieredDevice() override;
+
+  /**
+   * @brief 为镜像写入分层配置并新建空的快速层文件。
+   * @param image_path 镜像路径。
+   * @param fast_path 快速层文件路径（为空时使用 <image_path>.fast）。
+   * @param fast_mb 快速层大小（MB）。
+   * @return bool 成功返回true。
+   */
+  static bool create(const std::string& image_path, const std::string& fast_path,
+                     int fast_mb);
+
+  /**
+   * @brief 读取镜像的分层配置。
+   * @return bool 镜像启用了分层且配置有效时返回true。
+   */
+  static bool load_config(const std::string& image_path, TierConfig& config);
+
+  /**
+   * @brief 删除镜像的分层配置（create 时调用）。
+   */
+  static void remove_config(const std::string& image_path);
+
+  /**
+   * @brief 打开快速层并载入槽位映射，读写打开时启动后台迁移线程。
+   * @param config 分层配置。
+   * @param read_only 为true时只读取已有的映射。
+   * @return bool 成功返回true。
+   */
+  bool open(const TierConfig& config, bool read_only = false);
+
+  /**
+   * @brief 把块 0..count-1（元数据区）固定在快速层，最多占一半槽位；未驻留的块立即复制。
+   * @param count 要固定的块数。
+   */
+  void pin_metadata(int count);
+
+  /**
+   * @brief 停止迁移线程，执行最后一轮迁移并写回映射区，标记正常关闭。
+   */
+  void close();
+
+  bool read_block(int block_num, char* buffer) override;
+  bool write_block(int block_num, const char* buffer) override;
+  bool read_blocks(int start_block, int count, char* buffer) override;
+  bool write_blocks(int start_block, int count, const char* buffer) override;
+  bool discard_block(int block_num) override;
+  bool flush() override;
+  bool drop_host_cache() override;
+  int get_total_blocks() const override;
+  std::string describe() const override;
+  void collect_stats(std::vector<DeviceStats>& stats) const override;
+
+ private:
+  /**
+   * @struct TierHeader
+   * @brief 快速层块0中的分层头。
+   */
+  struct TierHeader {
+    char magic[8];               ///< 魔数 "DSIMTIER"
+    std::uint32_t version;       ///< 格式版本
+    std::uint32_t reserved;      ///< 对齐保留
+    std::uint64_t set_id;        ///< 分层配置标识
+    std::int32_t slow_blocks;    ///< 慢速层逻辑块数
+    std::int32_t slots;          ///< 槽位数
+    std::int32_t map_blocks;     ///< 映射区块数
+    std::int32_t clean;          ///< 上次是否正常关闭
+  };
+
+  static constexpr int kLockStripes = 64;  ///< 块分段读写锁数量
+
+  bool load_map();
+  bool write_header(bool clean);
+  bool write_map();
+  void count_read(int block_num);
+  bool promote(int block_num, int slot);
+  bool write_fast_copy(int slot, const char* buffer);
+  void release_failed_slot(int block_num, int slot);
+  void migrate_once();
+  void migrator_loop();
+
+  std::unique_ptr<BlockDevice> slow_;      ///< 慢速层（下层完整设备栈）
+  std::unique_ptr<FileBlockDevice> fast_;  ///< 快速层文件
+  TierConfig config_;                      ///< 分层配置
+  int total_blocks_;                       ///< 逻辑块数
+  int slots_;                              ///< 快速层槽位数
+  int map_blocks_;                         ///< 映射区块数
+  int pinned_blocks_;                      ///< 固定在快速层的块数（从块0起）
+  bool read_only_;                         ///< 是否只读打开
+  bool opened_;                            ///< 是否已打开
+  bool cold_start_;                        ///< 本次打开是否丢弃了旧映射
+  bool fail_fast_writes_;                  ///< 模拟快速层写入失败（测试用）
+
+  std::unique_ptr<std::atomic<int>[]> block_slot_;          ///< 逻辑块 → 槽位（-1为未驻留）
+  std::unique_ptr<std::atomic<std::uint16_t>[]> heat_;      ///< 每块读计数
+  std::vector<int> slot_block_;                             ///< 槽位 → 逻辑块（-1为空）
+  std::vector<int> free_slots_;                             ///< 空槽位
+  std::vector<bool> map_dirty_;                             ///< 映射区块是否需要写回
+  std::array<std::shared_mutex, kLockStripes> block_locks_; ///< 块分段读写锁
+  std::mutex migrate_mutex_;  ///< 保护槽位表、空槽位与映射区写回
+
+  // --- 统计 ---
+  std::atomic<std::uint64_t> fast_reads_;   ///< 由快速层服务的读块数
+  std::atomic<std::uint64_t> slow_reads_;   ///< 由慢速层服务的读块数
+  std::atomic<std::uint64_t> promotions_;   ///< 迁入快速层的块数
+  std::atomic<std::uint64_t> evictions_;    ///< 被替换出快速层的块数
+  std::atomic<std::uint64_t> passes_;       ///< 完成的迁移轮数
+  std::atomic<std::uint64_t> fast_write_errors_;  ///< 更新驻留副本失败的次数
+
+  // --- 后台迁移 ---
+  std::thread migrator_thread_;          ///< 迁移线程
+  std::mutex migrator_mutex_;            ///< 迁移线程等待用互斥锁
+  std::condition_variable migrator_cv_;  ///< 迁移线程唤醒条件变量
+  std::atomic<bool> stop_migrator_;      ///< 停止标志
+};
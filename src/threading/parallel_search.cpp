@@ -0,0 +1,454 @@
+// ==============================================================================
+// @file   parallel_search.cpp
+// @brief  镜像内并行查找（find）与内容检索（grep）的实现
+// ==============================================================================
+
+#include "parallel_search.h"
+
+#include <fnmatch.h>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+#include "../utils/error_handler.h"
+#include "../utils/path_utils.h"
+
+namespace {
+
+constexpr std::size_t kScanChunkSize = 256 * 1024;    ///< 单次顺序读取大小
+constexpr std::size_t kMaxLineLength = 1024 * 1024;   ///< 单行最大缓存长度
+constexpr std::size_t kMaxSearchThreads = 8;          ///< 自动选择时的线程上限
+
+/**
+ * @brief 解析 -size 参数，格式为 [+|-]N[c|k|M|G]，默认单位为字节。
+ */
+bool parse_size_spec(const std::string& spec, FindOptions& options) {
+  if (spec.empty()) {
+    return false;
+  }
+
+  std::size_t pos = 0;
+  char compare = '=';
+  if (spec[0] == '+' || spec[0] == '-') {
+    compare = spec[0];
+    pos = 1;
+  }
+
+  std::size_t digits_end = pos;
+  while (digits_end < spec.size() && spec[digits_end] >= '0' &&
+         spec[digits_end] <= '9') {
+    ++digits_end;
+  }
+  if (digits_end == pos || digits_end + 1 < spec.size()) {
+    return false;
+  }
+
+  std::int64_t multiplier = 1;
+  if (digits_end < spec.size()) {
+    switch (spec[digits_end]) {
+      case 'c': multiplier = 1; break;
+      case 'k': multiplier = 1024; break;
+      case 'M': multiplier = 1024 * 1024; break;
+      case 'G': multiplier = 1024LL * 1024 * 1024; break;
+      default: return false;
+    }
+  }
+
+  try {
+    options.size_bytes =
+        std::stoll(spec.substr(pos, digits_end - pos)) * multiplier;
+  } catch (const std::exception&) {
+    return false;
+  }
+  options.size_compare = compare;
+  options.size_filter = true;
+  return true;
+}
+
+}  // namespace
+
+// ==============================================================================
+// 构造与公共接口
+// ==============================================================================
+
+/**
+ * @brief ParallelSearcher 构造函数。
+ * @param fs 文件系统引用。
+ * @param thread_count 工作线程数（0表示自动选择）。
+ */
+ParallelSearcher::ParallelSearcher(FileSystem& fs, std::size_t thread_count)
+    : filesystem_(fs), thread_count_(thread_count) {
+  if (thread_count_ == 0) {
+    std::size_t hardware = std::thread::hardware_concurrency();
+    thread_count_ = std::clamp<std::size_t>(hardware, 2, kMaxSearchThreads);
+  }
+}
+
+/**
+ * @brief 按文件名和大小条件查找路径。
+ */
+bool ParallelSearcher::find(const FindOptions& options,
+                            std::vector<std::string>& results) {
+  std::vector<std::vector<std::string>> partial(thread_count_);
+
+  bool ok = walk(options.root_path, [&](std::size_t worker,
+                                        const WalkItem& item) {
+    if (fnmatch(options.name_pattern.c_str(), item.name.c_str(), 0) != 0) {
+      return;
+    }
+    if (options.size_filter) {
+      std::int64_t size = item.inode.size;
+      if ((options.size_compare == '+' && size <= options.size_bytes) ||
+          (options.size_compare == '-' && size >= options.size_bytes) ||
+          (options.size_compare == '=' && size != options.size_bytes)) {
+        return;
+      }
+    }
+    partial[worker].push_back(item.path);
+  });
+
+  results.clear();
+  for (auto& part : partial) {
+    results.insert(results.end(), part.begin(), part.end());
+  }
+  std::sort(results.begin(), results.end());
+  return ok;
+}
+
+/**
+ * @brief 在目录树内所有普通文件中检索子串。
+ */
+bool ParallelSearcher::grep(const std::string& pattern,
+                            const std::string& root_path,
+                            std::vector<GrepMatch>& matches) {
+  if (pattern.empty()) {
+    ErrorHandler::log_error(ERROR_INVALID_ARGUMENT,
+                            "grep requires a non-empty pattern");
+    return false;
+  }
+
+  std::vector<std::vector<GrepMatch>> partial(thread_count_);
+
+  bool ok = walk(root_path, [&](std::size_t worker, const WalkItem& item) {
+    if (!item.is_directory && item.inode.size > 0) {
+      scan_file(item.path, pattern, partial[worker]);
+    }
+  });
+
+  matches.clear();
+  for (auto& part : partial) {
+    matches.insert(matches.end(), std::make_move_iterator(part.begin()),
+                   std::make_move_iterator(part.end()));
+  }
+  std::sort(matches.begin(), matches.end(),
+            [](const GrepMatch& a, const GrepMatch& b) {
+              if (a.path != b.path) return a.path < b.path;
+              return a.line_number < b.line_number;
+            });
+  return ok;
+}
+
+/**
+ * @brief 在内存块中查找子串。
+ * @details 先用 memchr 定位首字节的候选位置，再用 memcmp 校验其余字节，
+ *          大部分数据由 memchr 的向量化实现跳过。
+ */
+const char* ParallelSearcher::find_substring(const char* haystack,
+                                             std::size_t length,
+                                             const std::string& needle) {
+  const std::size_t needle_length = needle.size();
+  if (needle_length == 0) {
+    return haystack;
+  }
+  if (length < needle_length) {
+    return nullptr;
+  }
+
+  const char first = needle[0];
+  const char* cursor = haystack;
+  const char* last_start = haystack + (length - needle_length);
+
+  while (cursor <= last_start) {
+    const void* hit = memchr(cursor, first, last_start - cursor + 1);
+    if (!hit) {
+      return nullptr;
+    }
+    const char* candidate = static_cast<const char*>(hit);
+    if (memcmp(candidate + 1, needle.data() + 1, needle_length - 1) == 0) {
+      return candidate;
+    }
+    cursor = candidate + 1;
+  }
+  return nullptr;
+}
+
+// ==============================================================================
+// 私有辅助方法
+// ==============================================================================
+
+/**
+ * @brief 以工作窃取方式并行遍历目录树。
+ * @param root_path 起始目录。
+ * @param visit_file 对每个遍历到的条目（包括起始目录）调用的回调，
+ *                   参数为工作线程编号和条目信息。
+ * @return bool 起始目录有效返回true。
+ */
+template <typename Visitor>
+bool ParallelSearcher::walk(const std::string& root_path,
+                            Visitor&& visit_file) {
+  std::string root = PathUtils::normalize_path(root_path);
+  if (root.empty()) {
+    root = "/";
+  }
+
+  WalkItem root_item;
+  if (!filesystem_.stat(root, root_item.inode) ||
+      !(root_item.inode.mode & FILE_TYPE_DIRECTORY)) {
+    ErrorHandler::log_error(ERROR_FILE_NOT_FOUND,
+                            "Directory not found: " + root);
+    return false;
+  }
+  root_item.path = root;
+  root_item.name = root == "/" ? "/" : PathUtils::extract_filename(root);
+  root_item.is_directory = true;
+
+  struct WorkerQueue {
+    std::mutex mutex;
+    std::deque<WalkItem> items;
+  };
+  std::vector<WorkerQueue> queues(thread_count_);
+  std::atomic<std::size_t> pending{1};  // 尚未处理完的条目数
+  std::atomic<std::size_t> queued{1};   // 各队列中待取出的条目数
+  queues[0].items.push_back(std::move(root_item));
+
+  // 空闲线程在此休眠，入队新条目或遍历结束时唤醒
+  std::mutex idle_mutex;
+  std::condition_variable idle_cv;
+  auto wake_idle = [&](bool all) {
+    { std::lock_guard<std::mutex> lock(idle_mutex); }
+    if (all) {
+      idle_cv.notify_all();
+    } else {
+      idle_cv.notify_one();
+    }
+  };
+
+  // 本地队尾出队；本地为空时轮询其他线程，从队首窃取
+  auto take = [&](std::size_t self, WalkItem& out) {
+    {
+      std::lock_guard<std::mutex> lock(queues[self].mutex);
+      if (!queues[self].items.empty()) {
+        out = std::move(queues[self].items.back());
+        queues[self].items.pop_back();
+        queued.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+      }
+    }
+    for (std::size_t step = 1; step < queues.size(); ++step) {
+      WorkerQueue& victim = queues[(self + step) % queues.size()];
+      std::lock_guard<std::mutex> lock(victim.mutex);
+      if (!victim.items.empty()) {
+        out = std::move(victim.items.front());
+        victim.items.pop_front();
+        queued.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+      }
+    }
+    return false;
+  };
+
+  auto expand = [&](std::size_t self, const WalkItem& directory) {
+    std::vector<DirectoryEntry> entries;
+    if (!filesystem_.list_directory(directory.path, entries)) {
+      return;
+    }
+
+    std::vector<WalkItem> children;
+    children.reserve(entries.size());
+    for (const DirectoryEntry& entry : entries) {
+      std::string name = PathUtils::entry_name(entry);
+      if (name.empty() || name == "." || name == "..") {
+        continue;
+      }
+      WalkItem child;
+      child.path = PathUtils::join_path(directory.path, name);
+      if (!filesystem_.stat(child.path, child.inode)) {
+        continue;  // 条目可能已被并发删除
+      }
+      child.name = std::move(name);
+      child.is_directory = (child.inode.mode & FILE_TYPE_DIRECTORY) != 0;
+      children.push_back(std::move(child));
+    }
+
+    if (children.empty()) {
+      return;
+    }
+    pending.fetch_add(children.size(), std::memory_order_relaxed);
+    {
+      std::lock_guard<std::mutex> lock(queues[self].mutex);
+      for (WalkItem& child : children) {
+        queues[self].items.push_back(std::move(child));
+      }
+    }
+    queued.fetch_add(children.size(), std::memory_order_release);
+    wake_idle(children.size() > 1);
+  };
+
+  auto worker = [&](std::size_t self) {
+    WalkItem item;
+    while (true) {
+      if (!take(self, item)) {
+        std::unique_lock<std::mutex> lock(idle_mutex);
+        idle_cv.wait(lock, [&] {
+          return pending.load(std::memory_order_acquire) == 0 ||
+                 queued.load(std::memory_order_acquire) > 0;
+        });
+        if (pending.load(std::memory_order_acquire) == 0) {
+          return;
+        }
+        continue;
+      }
+
+      visit_file(self, item);
+      if (item.is_directory) {
+        expand(self, item);
+      }
+      if (pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        wake_idle(true);
+      }
+    }
+  };
+
+  std::vector<std::thread> threads;
+  threads.reserve(thread_count_);
+  for (std::size_t i = 0; i < thread_count_; ++i) {
+    threads.emplace_back(worker, i);
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  return true;
+}
+
+/**
+ * @brief 以大块顺序读取扫描单个文件，记录包含子串的行。
+ * @details 每次只扫描缓冲区中完整的行，末尾不完整的行留到下一块继续，
+ *          因此跨块边界的匹配不会丢失。
+ */
+void ParallelSearcher::scan_file(const std::string& path,
+                                 const std::string& pattern,
+                                 std::vector<GrepMatch>& matches) {
+  int fd = filesystem_.open_file(path, OPEN_MODE_READ);
+  if (fd == -1) {
+    return;
+  }
+
+  std::vector<char> buffer(kScanChunkSize);
+  std::size_t carry = 0;
+  std::size_t line_number = 1;
+
+  while (true) {
+    if (buffer.size() < carry + kScanChunkSize) {
+      buffer.resize(carry + kScanChunkSize);
+    }
+    int bytes_read = filesystem_.read_file(fd, buffer.data() + carry,
+                                           static_cast<int>(kScanChunkSize));
+    if (bytes_read < 0) {
+      break;
+    }
+
+    const bool eof = bytes_read == 0;
+    const std::size_t valid = carry + static_cast<std::size_t>(bytes_read);
+    char* data = buffer.data();
+
+    std::size_t limit = valid;
+    if (!eof) {
+      const void* last_newline = memrchr(data, '\n', valid);
+      limit = last_newline
+                  ? static_cast<const char*>(last_newline) - data + 1
+                  : 0;
+      if (limit == 0 && valid >= kMaxLineLength) {
+        limit = valid;  // 超长行按块切分，避免无限增长
+      }
+    }
+
+    std::size_t position = 0;
+    std::size_t counted = 0;
+    while (position < limit) {
+      const char* hit =
+          find_substring(data + position, limit - position, pattern);
+      if (!hit) {
+        break;
+      }
+
+      const void* previous_newline = memrchr(data, '\n', hit - data);
+      const char* line_start =
+          previous_newline ? static_cast<const char*>(previous_newline) + 1
+                           : data;
+      const void* next_newline = memchr(hit, '\n', data + limit - hit);
+      const char* line_end = next_newline
+                                 ? static_cast<const char*>(next_newline)
+                                 : data + limit;
+
+      line_number += std::count(static_cast<const char*>(data) + counted,
+                                line_start, '\n');
+      counted = line_start - data;
+      matches.push_back({path, line_number, std::string(line_start, line_end)});
+      position = line_end - data + 1;
+    }
+    line_number += std::count(data + counted, data + limit, '\n');
+
+    if (eof) {
+      break;
+    }
+    memmove(data, data + limit, valid - limit);
+    carry = valid - limit;
+  }
+
+  filesystem_.close_file(fd);
+}
+
+// ==============================================================================
+// 参数解析
+// ==============================================================================
+
+/**
+ * @brief 解析 find 命令参数：<dir> [-name <glob>] [-size [+|-]N[c|k|M|G]]。
+ */
+bool parse_find_arguments(const std::vector<std::string>& args,
+                          FindOptions& options, std::string& error_message) {
+  std::size_t index = 0;
+  if (index < args.size() && !args[index].empty() && args[index][0] != '-') {
+    options.root_path = args[index++];
+  }
+
+  while (index < args.size()) {
+    const std::string& option = args[index];
+    if (index + 1 >= args.size()) {
+      error_message = "Missing value for find option: " + option;
+      return false;
+    }
+    const std::string& value = args[index + 1];
+
+    if (option == "-name") {
+      options.name_pattern = value;
+    } else if (option == "-size") {
+      if (!parse_size_spec(value, options)) {
+        error_message = "Invalid -size value: " + value +
+                        " (expected [+|-]N[c|k|M|G])";
+        return false;
+      }
+    } else {
+      error_message = "Unknown find option: " + option;
+      return false;
+    }
+    index += 2;
+  }
+
+  return true;
+}
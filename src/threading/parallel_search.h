@@ -0,0 +1,121 @@
+// ==============================================================================
+// @file   parallel_search.h
+// @brief  镜像内并行查找（find）与内容检索（grep）的声明
+// ==============================================================================
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "../core/filesystem.h"
+
+// ==============================================================================
+// 查询条件与结果
+// ==============================================================================
+
+/**
+ * @struct FindOptions
+ * @brief find 命令的过滤条件。
+ */
+struct FindOptions {
+  std::string root_path{"/"};    ///< 起始目录
+  std::string name_pattern{"*"};  ///< 文件名通配符（fnmatch语法）
+  bool size_filter{false};        ///< 是否启用大小过滤
+  char size_compare{'='};         ///< 比较方式：'+'大于，'-'小于，'='等于
+  std::int64_t size_bytes{0};     ///< 比较的大小阈值（字节）
+};
+
+/**
+ * @struct GrepMatch
+ * @brief grep 命令的一条匹配结果。
+ */
+struct GrepMatch {
+  std::string path;         ///< 文件路径
+  std::size_t line_number;  ///< 行号（从1开始）
+  std::string line;         ///< 匹配行内容（不含换行符）
+};
+
+// ==============================================================================
+// 并行检索器
+// ==============================================================================
+
+/**
+ * @class ParallelSearcher
+ * @brief 以工作窃取方式并行遍历目录树，并对文件内容做大块顺序扫描。
+ *
+ * 每个工作线程持有自己的双端队列：本地从队尾取任务（深度优先、缓存友好），
+ * 空闲时从其他线程的队首窃取任务（通常是更大的子树）。内容扫描以大块
+ * 顺序读取文件，并用 memchr 首字节过滤 + memcmp 校验的方式查找子串，
+ * memchr 在 glibc 中由 SIMD 实现。
+ */
+class ParallelSearcher {
+ public:
+  /**
+   * @brief 构造函数。
+   * @param fs 文件系统引用。
+   * @param thread_count 工作线程数（0表示按硬件并发度自动选择）。
+   */
+  explicit ParallelSearcher(FileSystem& fs, std::size_t thread_count = 0);
+
+  /**
+   * @brief 按文件名和大小条件查找路径。
+   * @param options 查询条件。
+   * @param[out] results 匹配的路径（已排序）。
+   * @return bool 起始目录有效返回true。
+   */
+  bool find(const FindOptions& options, std::vector<std::string>& results);
+
+  /**
+   * @brief 在目录树内所有普通文件中检索子串。
+   * @param pattern 要查找的子串（按字节精确匹配）。
+   * @param root_path 起始目录。
+   * @param[out] matches 匹配结果（按路径和行号排序）。
+   * @return bool 起始目录有效返回true。
+   */
+  bool grep(const std::string& pattern, const std::string& root_path,
+            std::vector<GrepMatch>& matches);
+
+  /**
+   * @brief 在内存块中查找子串（memchr首字节过滤）。
+   * @param haystack 待查找的数据。
+   * @param length 数据长度。
+   * @param needle 要查找的子串。
+   * @return const char* 首次出现的位置，未找到返回nullptr。
+   */
+  static const char* find_substring(const char* haystack, std::size_t length,
+                                    const std::string& needle);
+
+ private:
+  /**
+   * @struct WalkItem
+   * @brief 遍历任务：一个待展开的目录或一个待处理的文件。
+   */
+  struct WalkItem {
+    std::string path;       ///< 完整路径
+    std::string name;       ///< 基本名称
+    Inode inode;            ///< 对应的inode元数据
+    bool is_directory;      ///< 是否为目录
+  };
+
+  template <typename Visitor>
+  bool walk(const std::string& root_path, Visitor&& visit_file);
+
+  void scan_file(const std::string& path, const std::string& pattern,
+                 std::vector<GrepMatch>& matches);
+
+  FileSystem& filesystem_;    ///< 文件系统引用
+  std::size_t thread_count_;  ///< 工作线程数
+};
+
+/**
+ * @brief 解析 find 命令参数。
+ * @param args 参数列表（不包含关键字"find"）。
+ * @param[out] options 输出的查询条件。
+ * @param[out] error_message 错误信息。
+ * @return bool 成功返回true。
+ */
+bool parse_find_arguments(const std::vector<std::string>& args,
+                          FindOptions& options, std::string& error_message);
@@ -17,6 +17,7 @@
 
 #include "../utils/common.h"
 #include "../utils/error_handler.h"
+#include "../utils/memory_accounting.h"
 #include "../utils/monitoring.h"
 #include "../utils/path_utils.h"
 
@@ -103,33 +104,74 @@ bool StressTester::run(const StressTestConfig& config) {
             << " threads, duration " << normalized_config.duration.count()
             << " seconds" << std::endl;
 
+  bool success = true;
+  switch (normalized_config.cache_mode) {
+    case StressCacheMode::Warm:
+      success = run_phase(normalized_config, "", false);
+      break;
+    case StressCacheMode::Cold:
+      success = run_phase(normalized_config, "cold", true);
+      break;
+    case StressCacheMode::Both:
+      // 冷阶段结束时缓存已被预热，紧接着的热阶段即为稳态
+      success = run_phase(normalized_config, "cold", true);
+      success = run_phase(normalized_config, "warm", false) && success;
+      break;
+  }
+
+  if (normalized_config.cleanup_after) {
+    cleanup_workspace(normalized_config);
+  }
+
+  return success;
+}
+
+/**
+ * @brief 运行一个测量阶段：按需清空缓存，启动工作者与监控线程，输出汇总。
+ * @param config 压力测试配置。
+ * @param label 阶段标签，为空时汇总行不带标签。
+ * @param drop_caches 是否在开始前清空缓存。
+ * @return bool 阶段内没有错误返回true。
+ */
+bool StressTester::run_phase(const StressTestConfig& config,
+                             const std::string& label, bool drop_caches) {
+  if (drop_caches && !filesystem_.drop_caches()) {
+    ErrorHandler::log_error(ERROR_IO_ERROR,
+                            "Failed to drop caches before stress phase");
+    return false;
+  }
+  if (!label.empty()) {
+    std::cout << "[Stress] Phase " << label << " ("
+              << (drop_caches ? "caches dropped" : "caches kept") << ")"
+              << std::endl;
+  }
+
   std::atomic<bool> stop_flag{false};
   std::atomic<std::uint64_t> operation_counter{0};
   std::atomic<std::uint64_t> error_counter{0};
 
   std::vector<std::thread> workers;
-  workers.reserve(normalized_config.thread_count);
+  workers.reserve(config.thread_count);
 
-  for (std::size_t worker_id = 0; worker_id < normalized_config.thread_count;
+  for (std::size_t worker_id = 0; worker_id < config.thread_count;
        ++worker_id) {
-    workers.emplace_back([this, worker_id, &normalized_config, &stop_flag,
+    workers.emplace_back([this, worker_id, &config, &stop_flag,
                           &operation_counter, &error_counter]() {
-      worker_loop(worker_id, normalized_config, stop_flag, operation_counter,
+      worker_loop(worker_id, config, stop_flag, operation_counter,
                   error_counter);
     });
   }
 
   const auto test_start = std::chrono::steady_clock::now();
 
-  std::thread monitor_thread([this, &normalized_config, &stop_flag,
+  std::thread monitor_thread([this, &config, &stop_flag,
                               &operation_counter, &error_counter,
                               test_start]() {
-    monitor_loop(normalized_config, stop_flag, operation_counter,
+    monitor_loop(config, stop_flag, operation_counter,
                  error_counter, test_start);
   });
 
-  while (std::chrono::steady_clock::now() - test_start <
-         normalized_config.duration) {
+  while (std::chrono::steady_clock::now() - test_start < config.duration) {
     std::this_thread::sleep_for(std::chrono::milliseconds(200));
   }
   stop_flag.store(true);
@@ -158,19 +200,18 @@ bool StressTester::run(const StressTestConfig& config) {
           : 0.0;
 
   std::ostringstream final_metrics;
-  final_metrics << std::fixed << std::setprecision(3)
-                << "[Stress] Completed | elapsed_s: " << elapsed_seconds
+  final_metrics << std::fixed << std::setprecision(3) << "[Stress] Completed";
+  if (!label.empty()) {
+    final_metrics << " (" << label << ")";
+  }
+  final_metrics << " | elapsed_s: " << elapsed_seconds
                 << " | ops_total: " << total_operations
                 << " | avg_ops_rate: "
                 << std::setprecision(3) << avg_ops_rate << " ops/s"
                 << " | errors_total: " << total_errors;
   std::cout << final_metrics.str() << std::endl;
 
-  if (normalized_config.cleanup_after) {
-    cleanup_workspace(normalized_config);
-  }
-
-  return error_counter.load() == 0;
+  return total_errors == 0;
 }
 
 /**
@@ -467,6 +508,8 @@ void StressTester::monitor_loop(
 
     const double cpu_usage = Monitoring::get_cpu_usage();
     const std::string memory_info = Monitoring::get_memory_info();
+    const std::string process_memory = Monitoring::get_process_memory();
+    const std::string tracked_memory = MemoryAccounting::summary();
 
     std::ostringstream metrics;
     metrics << "[Stress] Metrics | elapsed_s: "
@@ -482,7 +525,8 @@ void StressTester::monitor_loop(
             << " | cfg_files: " << config.file_count
             << " | write_size_bytes: " << config.write_size
             << " | cpu: " << format_double(cpu_usage, 2) << "% | "
-            << memory_info;
+            << memory_info << " | " << process_memory << " | "
+            << tracked_memory;
 
     std::cout << metrics.str() << std::endl;
 
@@ -591,6 +635,23 @@ bool parse_stress_arguments(const std::vector<std::string>& args,
       }
       ++index;
       config.workspace_path = args[index];
+    } else if (arg == "--cache") {
+      if (index + 1 >= args.size()) {
+        error_message = "--cache requires a value";
+        return false;
+      }
+      ++index;
+      if (args[index] == "warm") {
+        config.cache_mode = StressCacheMode::Warm;
+      } else if (args[index] == "cold") {
+        config.cache_mode = StressCacheMode::Cold;
+      } else if (args[index] == "both") {
+        config.cache_mode = StressCacheMode::Both;
+      } else {
+        error_message = "Invalid value for --cache: " + args[index] +
+                        " (expected warm, cold or both)";
+        return false;
+      }
     } else if (arg == "--buckets") {
       std::uint64_t value = 0;
       if (!require_value(arg, value)) {
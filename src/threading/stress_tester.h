@@ -18,6 +18,16 @@
 // 压力测试配置
 // ==============================================================================
 
+/**
+ * @enum StressCacheMode
+ * @brief 测量阶段开始时的缓存状态。
+ */
+enum class StressCacheMode {
+  Warm,  ///< 保留缓存（默认），测量稳态性能
+  Cold,  ///< 测量前清空内部缓存并丢弃镜像的宿主机页缓存
+  Both,  ///< 先测冷缓存阶段，再测热缓存阶段，分别报告
+};
+
 /**
  * @struct StressTestConfig
  * @brief 压力测试所需的配置参数集合。
@@ -32,6 +42,7 @@ struct StressTestConfig {
   std::string workspace_path{"/stress_suite"};          ///< 工作目录
   bool cleanup_after{false};                              ///< 是否在完成后清理
   std::size_t bucket_count{0};                            ///< 子目录数量（0表示自动）
+  StressCacheMode cache_mode{StressCacheMode::Warm};      ///< 缓存状态
 };
 
 // ==============================================================================
@@ -58,6 +69,16 @@ class StressTester {
   bool run(const StressTestConfig& config);
 
  private:
+  /**
+   * @brief 运行一个测量阶段并输出该阶段的汇总。
+   * @param config 压力测试配置。
+   * @param label 阶段标签（"cold"/"warm"），为空时汇总行不带标签。
+   * @param drop_caches 是否在开始前清空缓存。
+   * @return bool 阶段内没有错误返回true。
+   */
+  bool run_phase(const StressTestConfig& config, const std::string& label,
+                 bool drop_caches);
+
   /**
    * @brief 确保工作目录和文件已准备就绪。
    * @param config 压力测试配置。
@@ -8,6 +8,17 @@
 #include "task_wrapper.h"
 #include <shared_mutex>
 
+#include "../utils/memory_accounting.h"
+
+namespace {
+
+/// 排队中的命令行；在任务执行前一直存活，计入命令子系统的内存统计
+using QueuedCommand =
+    std::basic_string<char, std::char_traits<char>,
+                      TrackedAllocator<char, MemSubsystem::Commands>>;
+
+}  // namespace
+
 /**
  * @brief 构造函数。
  * @param fs 文件系统对象的引用。
@@ -31,14 +42,17 @@ TaskDispatcher::~TaskDispatcher() = default;
 std::future<int> TaskDispatcher::execute_async(const std::string& command_line) {
     DispatchMode mode = resolve_mode(command_line);
 
-    auto task = [this, command_line, mode]() -> int {
+    QueuedCommand queued(command_line.begin(), command_line.end());
+
+    auto task = [this, queued, mode]() -> int {
+        const std::string line(queued.begin(), queued.end());
         if (mode == DispatchMode::Shared) {
             std::shared_lock<std::shared_mutex> lock(dispatcher_mutex_);
-            return TaskWrapper::execute_command_line(filesystem_, command_line);
+            return TaskWrapper::execute_command_line(filesystem_, line);
         }
 
         std::unique_lock<std::shared_mutex> lock(dispatcher_mutex_);
-        return TaskWrapper::execute_command_line(filesystem_, command_line);
+        return TaskWrapper::execute_command_line(filesystem_, line);
     };
 
     return thread_pool_->enqueue(task);
@@ -73,7 +87,11 @@ TaskDispatcher::DispatchMode TaskDispatcher::resolve_mode(const std::string& com
     static const std::unordered_set<std::string> shared_commands = {
         "ls",
         "cat",
-        "info"
+        "info",
+        "stats",
+        "find",
+        "grep",
+        "locate"
     };
 
     std::string command = extract_command_name(command_line);
@@ -2,6 +2,7 @@
 
 #include <atomic>
 #include <condition_variable>
+#include <deque>
 #include <functional>
 #include <future>
 #include <memory>
@@ -10,6 +11,9 @@
 #include <thread>
 #include <vector>
 
+#include "../utils/memory_accounting.h"
+#include "../utils/trace_probes.h"
+
 /**
  * @class ThreadPool
  * @brief 线程池实现，用于管理工作线程。
@@ -63,8 +67,10 @@ class ThreadPool {
   // 工作线程
   std::vector<std::thread> workers;
 
-  // 任务队列
-  std::queue<std::function<void()>> tasks;
+  // 任务队列（队列与任务对象计入任务子系统的内存统计）
+  using Task = std::function<void()>;
+  std::queue<Task, std::deque<Task, TrackedAllocator<Task, MemSubsystem::Tasks>>>
+      tasks;
 
   // 同步原语
   mutable std::mutex queue_mutex;  // mutable 允许在 const 方法中修改
@@ -93,6 +99,7 @@ inline ThreadPool::ThreadPool(size_t num_threads) : stop(false) {
 
           task = std::move(tasks.front());
           tasks.pop();
+          DISKSIM_PROBE1(task__dequeue, tasks.size());
         }
 
         task();
@@ -121,7 +128,9 @@ auto ThreadPool::enqueue(F&& f, Args&&... args)
     -> std::future<typename std::result_of<F(Args...)>::type> {
   using return_type = typename std::result_of<F(Args...)>::type;
 
-  auto task = std::make_shared<std::packaged_task<return_type()>>(
+  using packaged = std::packaged_task<return_type()>;
+  auto task = std::allocate_shared<packaged>(
+      TrackedAllocator<packaged, MemSubsystem::Tasks>(),
       std::bind(std::forward<F>(f), std::forward<Args>(args)...));
 
   std::future<return_type> res = task->get_future();
@@ -134,6 +143,7 @@ auto ThreadPool::enqueue(F&& f, Args&&... args)
     }
 
     tasks.emplace([task]() { (*task)(); });
+    DISKSIM_PROBE1(task__enqueue, tasks.size());
   }
 
   condition.notify_one();
@@ -0,0 +1,239 @@
+// ==============================================================================
+// @file   tree_copier.cpp
+// @brief  镜像内目录树的并行递归复制（cp -r）的实现
+// ==============================================================================
+
+#include "tree_copier.h"
+
+#include <algorithm>
+#include <atomic>
+#include <future>
+#include <sstream>
+#include <thread>
+
+#include "../utils/error_handler.h"
+#include "../utils/path_utils.h"
+#include "thread_pool.h"
+
+namespace {
+
+constexpr std::size_t kDefaultMaxParallelism = 8;  ///< 自动选择时的并行度上限
+
+}  // namespace
+
+// ==============================================================================
+// CopyStats
+// ==============================================================================
+
+std::string CopyStats::summary() const {
+  std::ostringstream oss;
+  oss << "Copied " << directories << " directories, " << files << " files, "
+      << bytes << " bytes";
+  return oss.str();
+}
+
+// ==============================================================================
+// 构造与公共接口
+// ==============================================================================
+
+/**
+ * @brief TreeCopier 构造函数。
+ * @param fs 文件系统引用。
+ * @param parallelism 并发复制的文件数（0表示自动选择）。
+ */
+TreeCopier::TreeCopier(FileSystem& fs, std::size_t parallelism)
+    : filesystem_(fs), parallelism_(parallelism) {
+  if (parallelism_ == 0) {
+    std::size_t hardware = std::thread::hardware_concurrency();
+    parallelism_ = std::clamp<std::size_t>(hardware, 2, kDefaultMaxParallelism);
+  }
+  parallelism_ = std::min(parallelism_, kMaxParallelism);
+}
+
+std::size_t TreeCopier::parallelism() const {
+  return parallelism_;
+}
+
+/**
+ * @brief 递归复制目录。
+ */
+bool TreeCopier::copy(const std::string& source, const std::string& destination,
+                      CopyStats& stats) {
+  std::string src = PathUtils::normalize_path(source);
+  std::string dst = PathUtils::normalize_path(destination);
+
+  Inode inode;
+  if (!filesystem_.stat(src, inode) || !(inode.mode & FILE_TYPE_DIRECTORY)) {
+    ErrorHandler::log_error(ERROR_FILE_NOT_FOUND, "Directory not found: " + src);
+    return false;
+  }
+  if (filesystem_.is_directory(dst)) {
+    dst = PathUtils::join_path(dst, PathUtils::extract_filename(src));
+  }
+  bool inside = src == "/" || dst.compare(0, src.size() + 1, src + "/") == 0;
+  if (dst == src || inside) {
+    ErrorHandler::log_error(ERROR_INVALID_ARGUMENT,
+                            "Cannot copy a directory into itself: " + dst);
+    return false;
+  }
+  if (filesystem_.file_exists(dst)) {
+    ErrorHandler::log_error(ERROR_FILE_ALREADY_EXISTS,
+                            "Destination already exists: " + dst);
+    return false;
+  }
+
+  std::vector<std::string> directories;
+  std::vector<FileItem> files;
+  if (!collect(src, directories, files) ||
+      !create_structure(dst, directories, files)) {
+    return false;
+  }
+  stats.directories += directories.size() + 1;
+
+  // 大文件先排队，避免最后只剩一个长任务拖住整体进度
+  std::sort(files.begin(), files.end(), [](const FileItem& a, const FileItem& b) {
+    return a.size > b.size;
+  });
+
+  std::atomic<std::size_t> copied_bytes{0};
+  std::atomic<bool> failed{false};
+  {
+    ThreadPool pool(parallelism_);
+    std::vector<std::future<void>> pending;
+    pending.reserve(files.size());
+    for (const FileItem& file : files) {
+      if (file.size == 0) {
+        continue;  // 空文件在建立结构时已经创建
+      }
+      pending.push_back(pool.enqueue([&, file] {
+        if (failed.load(std::memory_order_relaxed)) {
+          return;
+        }
+        std::size_t bytes = 0;
+        if (!copy_file(src + file.relative, dst + file.relative, bytes)) {
+          failed.store(true);
+        }
+        copied_bytes.fetch_add(bytes, std::memory_order_relaxed);
+      }));
+    }
+    for (auto& task : pending) {
+      task.get();
+    }
+  }
+
+  stats.files += files.size();
+  stats.bytes += copied_bytes.load();
+  return !failed.load();
+}
+
+// ==============================================================================
+// 私有辅助方法
+// ==============================================================================
+
+/**
+ * @brief 深度优先遍历源目录，收集子目录（父目录在前）与普通文件的相对路径。
+ */
+bool TreeCopier::collect(const std::string& root,
+                         std::vector<std::string>& directories,
+                         std::vector<FileItem>& files) {
+  std::vector<std::string> pending = {""};
+  while (!pending.empty()) {
+    std::string relative = std::move(pending.back());
+    pending.pop_back();
+
+    std::string directory = relative.empty() ? root : root + relative;
+    std::vector<DirectoryEntry> entries;
+    if (!filesystem_.list_directory(directory, entries)) {
+      return false;
+    }
+    for (const DirectoryEntry& entry : entries) {
+      std::string name = PathUtils::entry_name(entry);
+      if (name.empty() || name == "." || name == "..") {
+        continue;
+      }
+      std::string child = relative + "/" + name;
+      Inode inode;
+      if (!filesystem_.stat(root + child, inode)) {
+        return false;
+      }
+      if (inode.mode & FILE_TYPE_DIRECTORY) {
+        directories.push_back(child);
+        pending.push_back(child);
+      } else {
+        files.push_back({child, inode.size, inode.mode & ~FILE_TYPE_REGULAR});
+      }
+    }
+  }
+  return true;
+}
+
+/**
+ * @brief 成批建立目标目录结构与空文件。
+ */
+bool TreeCopier::create_structure(const std::string& root,
+                                  const std::vector<std::string>& directories,
+                                  const std::vector<FileItem>& files) {
+  std::vector<std::string> batch_directories = {root};
+  std::vector<std::pair<std::string, int>> batch_files;
+  auto flush = [&]() {
+    bool ok = filesystem_.create_batch(batch_directories, batch_files);
+    batch_directories.clear();
+    batch_files.clear();
+    return ok;
+  };
+
+  for (const std::string& directory : directories) {
+    batch_directories.push_back(root + directory);
+    if (batch_directories.size() >= kCreateBatch && !flush()) {
+      return false;
+    }
+  }
+  for (const FileItem& file : files) {
+    batch_files.emplace_back(root + file.relative, file.mode);
+    if (batch_directories.size() + batch_files.size() >= kCreateBatch && !flush()) {
+      return false;
+    }
+  }
+  return (batch_directories.empty() && batch_files.empty()) || flush();
+}
+
+/**
+ * @brief 以大块顺序读写复制单个文件的内容（目标文件已存在且为空）。
+ * @details 源文件只读打开，FileSystem::read_file 对只读描述符只加共享锁。
+ */
+bool TreeCopier::copy_file(const std::string& from, const std::string& to,
+                           std::size_t& bytes) {
+  int src_fd = filesystem_.open_file(from, OPEN_MODE_READ);
+  if (src_fd == -1) {
+    return false;
+  }
+  int dst_fd = filesystem_.open_file(to, OPEN_MODE_WRITE);
+  if (dst_fd == -1) {
+    filesystem_.close_file(src_fd);
+    return false;
+  }
+
+  std::vector<char> buffer(kCopyBuffer);
+  bool ok = true;
+  while (true) {
+    int count = filesystem_.read_file(src_fd, buffer.data(),
+                                      static_cast<int>(buffer.size()));
+    if (count <= 0) {
+      ok = count == 0;
+      break;
+    }
+    if (filesystem_.write_file(dst_fd, buffer.data(), count) != count) {
+      ok = false;
+      break;
+    }
+    bytes += static_cast<std::size_t>(count);
+  }
+
+  filesystem_.close_file(dst_fd);
+  filesystem_.close_file(src_fd);
+  if (!ok) {
+    ErrorHandler::log_error(ERROR_IO_ERROR,
+                            "Failed to copy " + from + " to " + to);
+  }
+  return ok;
+}
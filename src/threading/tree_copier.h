@@ -0,0 +1,92 @@
+// ==============================================================================
+// @file   tree_copier.h
+// @brief  镜像内目录树的并行递归复制（cp -r）
+// ==============================================================================
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "../core/filesystem.h"
+
+/**
+ * @struct CopyStats
+ * @brief 一次递归复制的统计。
+ */
+struct CopyStats {
+  std::size_t directories = 0;  ///< 创建的目录数（含目标根目录）
+  std::size_t files = 0;        ///< 复制的文件数
+  std::size_t bytes = 0;        ///< 复制的字节数
+
+  /**
+   * @brief 单行摘要。
+   */
+  std::string summary() const;
+};
+
+/**
+ * @class TreeCopier
+ * @brief 在同一个文件系统内把一棵目录树复制到新位置。
+ *
+ * 分三步完成：
+ *   1. 在源目录下深度优先遍历，记录全部子目录（父目录在前）和普通文件；
+ *   2. 按每批 kCreateBatch 个条目调用 FileSystem::create_batch 建立目录
+ *      结构和空文件（沿用源文件的权限位），整批只加一次独占锁；
+ *   3. 把文件内容的复制任务提交到线程池，按文件大小从大到小排队，
+ *      每个任务用 kCopyBuffer 大小的缓冲区顺序读写。源文件以只读方式
+ *      打开，读取只持共享锁，多个任务的读取可以并发进行。
+ * 并行度即线程池的线程数，由调用方指定（0表示按硬件并发度自动选择）。
+ */
+class TreeCopier {
+ public:
+  static constexpr std::size_t kMaxParallelism = 32;  ///< 允许的最大并行度
+
+  /**
+   * @brief 构造函数。
+   * @param fs 文件系统引用。
+   * @param parallelism 并发复制的文件数（0表示自动选择）。
+   */
+  explicit TreeCopier(FileSystem& fs, std::size_t parallelism = 0);
+
+  /**
+   * @brief 递归复制目录。
+   * @details 目标已是目录时复制到其下的同名子目录，否则目标本身成为副本；
+   *          副本的根目录不得已存在，也不得位于源目录之内。
+   * @param source 源目录。
+   * @param destination 目标路径。
+   * @param[out] stats 复制统计。
+   * @return bool 全部复制成功返回true。
+   */
+  bool copy(const std::string& source, const std::string& destination,
+            CopyStats& stats);
+
+  /** @brief 实际使用的并行度。 */
+  std::size_t parallelism() const;
+
+ private:
+  static constexpr std::size_t kCreateBatch = 256;         ///< 每批创建的条目数
+  static constexpr std::size_t kCopyBuffer = 1024 * 1024;  ///< 单次读写大小
+
+  /**
+   * @struct FileItem
+   * @brief 待复制的文件（相对源目录的路径、大小与权限位）。
+   */
+  struct FileItem {
+    std::string relative;  ///< 相对路径（以'/'开头）
+    int size;              ///< 文件大小（字节）
+    int mode;              ///< 源文件的权限位（不含类型位）
+  };
+
+  bool collect(const std::string& root, std::vector<std::string>& directories,
+               std::vector<FileItem>& files);
+  bool create_structure(const std::string& root,
+                        const std::vector<std::string>& directories,
+                        const std::vector<FileItem>& files);
+  bool copy_file(const std::string& from, const std::string& to,
+                 std::size_t& bytes);
+
+  FileSystem& filesystem_;    ///< 文件系统引用
+  std::size_t parallelism_;  ///< 并发复制的文件数
+};
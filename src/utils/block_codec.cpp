@@ -0,0 +1,81 @@
+// ==============================================================================
+// @file   block_codec.cpp
+// @brief  PackBits 游程压缩的实现
+// ==============================================================================
+
+#include "block_codec.h"
+#include <cstring>
+
+namespace {
+
+const size_t kMaxRun = 128;  ///< 单个控制字节描述的最大长度
+
+/**
+ * @brief 从 pos 开始相同字节的个数（最多 kMaxRun）。
+ */
+size_t run_length(const char* input, size_t length, size_t pos) {
+    size_t run = 1;
+    while (pos + run < length && run < kMaxRun && input[pos + run] == input[pos]) {
+        ++run;
+    }
+    return run;
+}
+
+/**
+ * @brief pos 处是否开始一个至少3字节的重复段（更短的重复按原样字节保存更省）。
+ */
+bool run_starts(const char* input, size_t length, size_t pos) {
+    return pos + 2 < length && input[pos] == input[pos + 1] && input[pos] == input[pos + 2];
+}
+
+}  // namespace
+
+size_t BlockCodec::max_compressed_size(size_t length) {
+    return length + (length + kMaxRun - 1) / kMaxRun;
+}
+
+size_t BlockCodec::compress(const char* input, size_t length, char* output) {
+    size_t in = 0;
+    size_t out = 0;
+    while (in < length) {
+        if (run_starts(input, length, in)) {
+            size_t run = run_length(input, length, in);
+            output[out++] = static_cast<char>(257 - run);
+            output[out++] = input[in];
+            in += run;
+            continue;
+        }
+
+        // 收集原样字节，直到遇到长度至少为3的重复段
+        size_t start = in;
+        while (in < length && in - start < kMaxRun && !run_starts(input, length, in)) {
+            ++in;
+        }
+        size_t count = in - start;
+        output[out++] = static_cast<char>(count - 1);
+        memcpy(output + out, input + start, count);
+        out += count;
+    }
+    return out;
+}
+
+bool BlockCodec::decompress(const char* input, size_t length, char* output, size_t expected) {
+    size_t in = 0;
+    size_t out = 0;
+    while (in < length) {
+        unsigned char control = static_cast<unsigned char>(input[in++]);
+        if (control < 128) {
+            size_t count = static_cast<size_t>(control) + 1;
+            if (in + count > length || out + count > expected) return false;
+            memcpy(output + out, input + in, count);
+            in += count;
+            out += count;
+        } else if (control > 128) {
+            size_t count = 257 - static_cast<size_t>(control);
+            if (in >= length || out + count > expected) return false;
+            memset(output + out, input[in++], count);
+            out += count;
+        }
+    }
+    return out == expected;
+}
@@ -0,0 +1,45 @@
+// ==============================================================================
+// @file   block_codec.h
+// @brief  单个数据块的轻量级游程压缩（PackBits）
+// ==============================================================================
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief 按块压缩与解压的静态工具类。
+ *
+ * 采用 PackBits 游程编码：控制字节 n 在 0..127 时其后跟 n+1 个原样字节，
+ * 在 129..255 时其后的一个字节重复 257-n 次（只对3次以上的重复编码，
+ * 更短的重复并入原样字节）。文件系统镜像中大量存在的零填充（inode表、
+ * 目录块与文件尾部）可以压缩到原来的几十分之一，而不可压缩的数据最多
+ * 膨胀 1/128。不依赖任何外部库。
+ */
+class BlockCodec {
+public:
+    /**
+     * @brief 压缩数据的最大长度（最坏情况）。
+     * @param length 原始长度。
+     */
+    static size_t max_compressed_size(size_t length);
+
+    /**
+     * @brief 压缩一段数据。
+     * @param input 原始数据。
+     * @param length 原始长度。
+     * @param[out] output 输出缓冲区，容量至少为 max_compressed_size(length)。
+     * @return size_t 压缩后的长度。
+     */
+    static size_t compress(const char* input, size_t length, char* output);
+
+    /**
+     * @brief 解压一段数据。
+     * @param input 压缩数据。
+     * @param length 压缩数据长度。
+     * @param[out] output 输出缓冲区。
+     * @param expected 解压后应得到的长度（即 output 的容量）。
+     * @return bool 数据完整且恰好解出 expected 字节时返回true。
+     */
+    static bool decompress(const char* input, size_t length, char* output, size_t expected);
+};
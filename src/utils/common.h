@@ -3,6 +3,8 @@
 #include <vector>
 #include <ctime>
 
+#include "memory_accounting.h"
+
 // ==================== 基本常量定义 ====================
 
 const int BLOCK_SIZE = 4096;  ///< 磁盘块大小（字节）
@@ -35,6 +37,11 @@ struct Inode;
 struct DirectoryEntry;
 struct DiskLayout;
 
+// ==================== 类型别名 ====================
+
+/// 块号列表；分配计入块号列表子系统的内存统计
+using BlockList = std::vector<int, TrackedAllocator<int, MemSubsystem::BlockLists>>;
+
 // ==================== 磁盘布局结构 ====================
 
 /**
@@ -93,8 +100,12 @@ struct Inode {
   int direct_blocks[DIRECT_BLOCKS_COUNT];  ///< 直接块指针数组
   int indirect_block;  ///< 一级间接块指针
   int double_indirect_block;  ///< 二级间接块指针
+  int tail_ref;  ///< 最后一个部分块打包在共享尾块中时为尾部的块内偏移加1，未打包为0
 };
 
+// tail_ref 占用原来的结构体尾部填充（旧镜像中为0，即未打包），inode 大小（以及每块 inode 数）保持不变
+static_assert(sizeof(Inode) == 96, "Inode layout must stay compatible with existing images");
+
 // ==================== 目录项结构 ====================
 
 /**
@@ -118,6 +129,7 @@ struct FileDescriptor {
   int mode;  ///< 打开模式（读/写等）
   int position;  ///< 当前读写位置（字节偏移）
   bool open;  ///< 文件是否处于打开状态
+  bool modified;  ///< 打开后是否写入过数据
 };
 
 // ==================== 命令结构 ====================
@@ -0,0 +1,131 @@
+// ==============================================================================
+// @file   crc32c.cpp
+// @brief  CRC32C 校验和的实现
+// ==============================================================================
+
+#include "crc32c.h"
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <nmmintrin.h>
+#define DISKSIM_HAVE_SSE42_PATH 1
+#endif
+
+namespace {
+
+const uint32_t kPolynomial = 0x82F63B78;  ///< CRC32C 反射多项式
+
+/**
+ * @brief slicing-by-8 查表：table[k][b] 为字节 b 之后再经过 k 个零字节的余数。
+ */
+struct Crc32cTables {
+    uint32_t table[8][256];
+
+    Crc32cTables() {
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t crc = i;
+            for (int bit = 0; bit < 8; ++bit) {
+                crc = (crc >> 1) ^ ((crc & 1) ? kPolynomial : 0);
+            }
+            table[0][i] = crc;
+        }
+        for (uint32_t i = 0; i < 256; ++i) {
+            for (int k = 1; k < 8; ++k) {
+                table[k][i] = (table[k - 1][i] >> 8) ^ table[0][table[k - 1][i] & 0xFF];
+            }
+        }
+    }
+};
+
+const Crc32cTables& tables() {
+    static const Crc32cTables instance;
+    return instance;
+}
+
+bool detect_hardware() {
+#ifdef DISKSIM_HAVE_SSE42_PATH
+    return __builtin_cpu_supports("sse4.2");
+#else
+    return false;
+#endif
+}
+
+}  // namespace
+
+uint32_t Crc32c::compute(const void* data, size_t length, uint32_t crc) {
+    static const bool use_hardware = detect_hardware();
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    return use_hardware ? compute_hardware(bytes, length, crc)
+                        : compute_table(bytes, length, crc);
+}
+
+bool Crc32c::hardware_accelerated() {
+    static const bool use_hardware = detect_hardware();
+    return use_hardware;
+}
+
+const char* Crc32c::implementation() {
+    return hardware_accelerated() ? "sse4.2" : "table";
+}
+
+/**
+ * @brief slicing-by-8 查表实现，每次迭代处理8字节。
+ */
+uint32_t Crc32c::compute_table(const uint8_t* data, size_t length, uint32_t crc) {
+    const auto& t = tables().table;
+    crc = ~crc;
+    while (length >= 8) {
+        uint32_t low;
+        uint32_t high;
+        memcpy(&low, data, 4);
+        memcpy(&high, data + 4, 4);
+        low ^= crc;
+        crc = t[7][low & 0xFF] ^ t[6][(low >> 8) & 0xFF] ^
+              t[5][(low >> 16) & 0xFF] ^ t[4][low >> 24] ^
+              t[3][high & 0xFF] ^ t[2][(high >> 8) & 0xFF] ^
+              t[1][(high >> 16) & 0xFF] ^ t[0][high >> 24];
+        data += 8;
+        length -= 8;
+    }
+    while (length-- > 0) {
+        crc = (crc >> 8) ^ t[0][(crc ^ *data++) & 0xFF];
+    }
+    return ~crc;
+}
+
+#ifdef DISKSIM_HAVE_SSE42_PATH
+/**
+ * @brief SSE4.2 crc32 指令实现（仅在运行时检测到支持时调用）。
+ */
+__attribute__((target("sse4.2")))
+uint32_t Crc32c::compute_hardware(const uint8_t* data, size_t length, uint32_t crc) {
+#if defined(__x86_64__)
+    uint64_t crc64 = ~crc & 0xFFFFFFFFu;
+    while (length >= 8) {
+        uint64_t word;
+        memcpy(&word, data, 8);
+        crc64 = _mm_crc32_u64(crc64, word);
+        data += 8;
+        length -= 8;
+    }
+    uint32_t value = static_cast<uint32_t>(crc64);
+#else
+    uint32_t value = ~crc;
+    while (length >= 4) {
+        uint32_t word;
+        memcpy(&word, data, 4);
+        value = _mm_crc32_u32(value, word);
+        data += 4;
+        length -= 4;
+    }
+#endif
+    while (length-- > 0) {
+        value = _mm_crc32_u8(value, *data++);
+    }
+    return ~value;
+}
+#else
+uint32_t Crc32c::compute_hardware(const uint8_t* data, size_t length, uint32_t crc) {
+    return compute_table(data, length, crc);
+}
+#endif
@@ -0,0 +1,41 @@
+// ==============================================================================
+// @file   crc32c.h
+// @brief  CRC32C（Castagnoli）校验和：SSE4.2 硬件指令与查表实现
+// ==============================================================================
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief 计算 CRC32C 校验和的静态工具类。
+ *
+ * 在支持 SSE4.2 的 x86 处理器上使用 crc32 指令（每次处理8字节，
+ * 单核可达数 GB/s）；其余平台使用 slicing-by-8 查表实现。
+ * 实现在首次调用时按 CPU 能力选择，无需额外的编译选项。
+ */
+class Crc32c {
+public:
+    /**
+     * @brief 计算一段数据的 CRC32C。
+     * @param data 数据指针。
+     * @param length 字节数。
+     * @param crc 之前计算的结果（用于分段累积），首段传0。
+     * @return uint32_t 校验和。
+     */
+    static uint32_t compute(const void* data, size_t length, uint32_t crc = 0);
+
+    /**
+     * @brief 当前是否使用硬件指令。
+     */
+    static bool hardware_accelerated();
+
+    /**
+     * @brief 当前实现的名称（"sse4.2" 或 "table"），用于统计输出。
+     */
+    static const char* implementation();
+
+private:
+    static uint32_t compute_table(const uint8_t* data, size_t length, uint32_t crc);
+    static uint32_t compute_hardware(const uint8_t* data, size_t length, uint32_t crc);
+};
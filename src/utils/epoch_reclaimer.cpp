@@ -0,0 +1,243 @@
+// ==============================================================================
+// @file   epoch_reclaimer.cpp
+// @brief  基于纪元的内存回收的实现
+// ==============================================================================
+
+#include "epoch_reclaimer.h"
+
+#ifdef __linux__
+#include <linux/membarrier.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+/**
+ * @brief 每个线程的读者状态：占用的纪元记录与 Guard 嵌套深度。
+ * @details 线程退出时归还记录，供之后的新线程复用。
+ */
+struct ThreadState {
+    void* record = nullptr;
+    int depth = 0;
+    void (*release)(void*) = nullptr;
+
+    ~ThreadState() {
+        if (record != nullptr && release != nullptr) {
+            release(record);
+        }
+    }
+};
+
+thread_local ThreadState thread_state;
+
+#ifdef __linux__
+int membarrier(int cmd) {
+    return static_cast<int>(syscall(__NR_membarrier, cmd, 0, 0));
+}
+#endif
+
+}  // namespace
+
+// ==============================================================================
+// 构造与实例
+// ==============================================================================
+
+EpochReclaimer::EpochReclaimer()
+    : global_epoch_(1), records_(nullptr), use_membarrier_(false), since_collect_(0) {
+#ifdef __linux__
+    int supported = membarrier(MEMBARRIER_CMD_QUERY);
+    if (supported > 0 && (supported & MEMBARRIER_CMD_PRIVATE_EXPEDITED) &&
+        membarrier(MEMBARRIER_CMD_REGISTER_PRIVATE_EXPEDITED) == 0) {
+        use_membarrier_ = true;
+    }
+#endif
+}
+
+/**
+ * @brief 进程退出时不再有读者，直接释放所有待回收对象。
+ * @details 读者记录有意不释放：仍在运行的线程退出时还会归还它们。
+ */
+EpochReclaimer::~EpochReclaimer() {
+    for (const Retired& item : limbo_) {
+        item.deleter(item.ptr);
+    }
+}
+
+EpochReclaimer& EpochReclaimer::instance() {
+    static EpochReclaimer reclaimer;
+    return reclaimer;
+}
+
+// ==============================================================================
+// 读侧
+// ==============================================================================
+
+EpochReclaimer::Guard::Guard() { EpochReclaimer::instance().enter(); }
+
+EpochReclaimer::Guard::~Guard() { EpochReclaimer::instance().exit(); }
+
+/**
+ * @brief 进入读侧临界区。
+ * @details 只有最外层 Guard 发布纪元：读取全局纪元（acquire，保证之后读到的
+ *          节点不早于该纪元推进前的摘除），写入本线程的记录，再以屏障保证
+ *          记录先于随后的节点读取对写者可见。
+ */
+void EpochReclaimer::enter() {
+    ThreadState& state = thread_state;
+    if (state.depth++ > 0) {
+        return;
+    }
+    if (state.record == nullptr) {
+        state.record = acquire_record();
+        state.release = [](void* record) {
+            release_record(static_cast<ThreadRecord*>(record));
+        };
+    }
+
+    auto* record = static_cast<ThreadRecord*>(state.record);
+    record->epoch.store(global_epoch_.load(std::memory_order_acquire),
+                        std::memory_order_relaxed);
+    if (use_membarrier_) {
+        std::atomic_signal_fence(std::memory_order_seq_cst);
+    } else {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+    }
+}
+
+void EpochReclaimer::exit() {
+    ThreadState& state = thread_state;
+    if (--state.depth > 0) {
+        return;
+    }
+    static_cast<ThreadRecord*>(state.record)->epoch.store(0, std::memory_order_release);
+}
+
+/**
+ * @brief 为当前线程取得一个纪元记录：优先复用已退出线程归还的记录。
+ */
+EpochReclaimer::ThreadRecord* EpochReclaimer::acquire_record() {
+    for (ThreadRecord* record = records_.load(std::memory_order_acquire);
+         record != nullptr; record = record->next) {
+        bool expected = false;
+        if (!record->in_use.load(std::memory_order_relaxed) &&
+            record->in_use.compare_exchange_strong(expected, true,
+                                                   std::memory_order_acq_rel)) {
+            return record;
+        }
+    }
+
+    auto* record = new ThreadRecord();
+    record->in_use.store(true, std::memory_order_relaxed);
+    ThreadRecord* head = records_.load(std::memory_order_relaxed);
+    do {
+        record->next = head;
+    } while (!records_.compare_exchange_weak(head, record, std::memory_order_release,
+                                             std::memory_order_relaxed));
+    return record;
+}
+
+void EpochReclaimer::release_record(ThreadRecord* record) {
+    record->epoch.store(0, std::memory_order_release);
+    record->in_use.store(false, std::memory_order_release);
+}
+
+// ==============================================================================
+// 写侧
+// ==============================================================================
+
+void EpochReclaimer::retire(void* ptr, void (*deleter)(void*)) {
+    std::vector<Retired> expired;
+    {
+        std::lock_guard<std::mutex> lock(retire_mutex_);
+        limbo_.push_back({ptr, deleter, global_epoch_.load(std::memory_order_relaxed)});
+        if (++since_collect_ < kCollectInterval) {
+            return;
+        }
+        since_collect_ = 0;
+        try_advance();
+        take_expired(expired);
+    }
+    // 在锁外调用释放函数，避免析构期间阻塞其他写者
+    for (const Retired& item : expired) {
+        item.deleter(item.ptr);
+    }
+}
+
+void EpochReclaimer::collect() {
+    std::vector<Retired> expired;
+    {
+        std::lock_guard<std::mutex> lock(retire_mutex_);
+        since_collect_ = 0;
+        // 连推两次：刚退休的对象最快在两次推进后即可释放
+        if (try_advance()) {
+            try_advance();
+        }
+        take_expired(expired);
+    }
+    for (const Retired& item : expired) {
+        item.deleter(item.ptr);
+    }
+}
+
+/**
+ * @brief 让所有线程执行一次完整内存屏障，与读者进入时的编译器屏障配对。
+ */
+void EpochReclaimer::heavy_barrier() {
+#ifdef __linux__
+    if (use_membarrier_ && membarrier(MEMBARRIER_CMD_PRIVATE_EXPEDITED) == 0) {
+        return;
+    }
+#endif
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+}
+
+/**
+ * @brief 所有活跃读者都已进入当前纪元时推进全局纪元（调用方持有 retire_mutex_）。
+ */
+bool EpochReclaimer::try_advance() {
+    heavy_barrier();
+    std::uint64_t current = global_epoch_.load(std::memory_order_relaxed);
+    for (ThreadRecord* record = records_.load(std::memory_order_acquire);
+         record != nullptr; record = record->next) {
+        std::uint64_t observed = record->epoch.load(std::memory_order_acquire);
+        if (observed != 0 && observed != current) {
+            return false;
+        }
+    }
+    global_epoch_.store(current + 1, std::memory_order_release);
+    return true;
+}
+
+/**
+ * @brief 取出退休后全局纪元已推进两次的对象（调用方持有 retire_mutex_）。
+ */
+void EpochReclaimer::take_expired(std::vector<Retired>& expired) {
+    std::uint64_t current = global_epoch_.load(std::memory_order_relaxed);
+    std::size_t kept = 0;
+    for (const Retired& item : limbo_) {
+        if (item.epoch + 2 <= current) {
+            expired.push_back(item);
+        } else {
+            limbo_[kept++] = item;
+        }
+    }
+    limbo_.resize(kept);
+}
+
+// ==============================================================================
+// 查询
+// ==============================================================================
+
+std::size_t EpochReclaimer::pending() const {
+    std::lock_guard<std::mutex> lock(retire_mutex_);
+    return limbo_.size();
+}
+
+std::uint64_t EpochReclaimer::epoch() const {
+    return global_epoch_.load(std::memory_order_relaxed);
+}
+
+bool EpochReclaimer::uses_membarrier() const {
+    return use_membarrier_;
+}
@@ -0,0 +1,125 @@
+// ==============================================================================
+// @file   epoch_reclaimer.h
+// @brief  基于纪元的内存回收（EBR）：无锁读者无需加锁，写者延迟释放旧节点
+// ==============================================================================
+
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+/**
+ * @class EpochReclaimer
+ * @brief 进程级的纪元回收器，为无锁读取的缓存提供安全的内存回收。
+ *
+ * 读者在访问共享节点前构造 Guard，进入当前全局纪元；Guard 析构即退出。
+ * 进入时只写本线程独占缓存行上的纪元记录，不对任何共享缓存行执行原子
+ * 读改写，因此读路径可随核数线性扩展。写者把节点从数据结构中摘下后调用
+ * retire，节点带上当时的全局纪元进入待回收队列；当所有活跃读者都已进入
+ * 更新的纪元后，全局纪元推进，落后两个纪元的节点即可释放——此时不可能
+ * 还有读者持有它们。
+ *
+ * 在 Linux 上，回收器注册 membarrier 后读者只需编译器屏障，写者在扫描
+ * 读者记录前用 membarrier 让所有线程执行一次完整内存屏障；不支持时读者
+ * 退回使用 seq_cst 栅栏。
+ */
+class EpochReclaimer {
+public:
+    /**
+     * @class Guard
+     * @brief 读侧临界区（可嵌套），生存期内读到的节点不会被释放。
+     */
+    class Guard {
+    public:
+        Guard();
+        ~Guard();
+        Guard(const Guard&) = delete;
+        Guard& operator=(const Guard&) = delete;
+    };
+
+    /**
+     * @brief 获取进程唯一的回收器实例。
+     */
+    static EpochReclaimer& instance();
+
+    /**
+     * @brief 延迟释放一个已从共享结构中摘下的对象。
+     * @param ptr 对象指针。
+     * @param deleter 宽限期结束后调用的释放函数。
+     */
+    void retire(void* ptr, void (*deleter)(void*));
+
+    /**
+     * @brief 延迟删除一个已从共享结构中摘下的对象。
+     */
+    template <typename T>
+    void retire(T* ptr) {
+        retire(ptr, [](void* p) { delete static_cast<T*>(p); });
+    }
+
+    /**
+     * @brief 尝试推进纪元并释放所有已过宽限期的对象。
+     */
+    void collect();
+
+    /**
+     * @brief 当前等待释放的对象数量。
+     */
+    std::size_t pending() const;
+
+    /**
+     * @brief 当前全局纪元。
+     */
+    std::uint64_t epoch() const;
+
+    /**
+     * @brief 读者是否只用编译器屏障（已启用 membarrier）。
+     */
+    bool uses_membarrier() const;
+
+private:
+    /**
+     * @struct ThreadRecord
+     * @brief 每个读者线程独占一个缓存行的纪元记录（0 表示不在临界区）。
+     */
+    struct alignas(64) ThreadRecord {
+        std::atomic<std::uint64_t> epoch{0};   ///< 进入时观察到的全局纪元
+        std::atomic<bool> in_use{false};       ///< 是否已被某个线程占用
+        ThreadRecord* next{nullptr};           ///< 记录链表（只增不删）
+    };
+
+    /**
+     * @struct Retired
+     * @brief 待回收对象。
+     */
+    struct Retired {
+        void* ptr;                  ///< 对象指针
+        void (*deleter)(void*);     ///< 释放函数
+        std::uint64_t epoch;        ///< 摘下时的全局纪元
+    };
+
+    static constexpr std::size_t kCollectInterval = 64;  ///< 每退休多少个对象尝试回收一次
+
+    EpochReclaimer();
+    ~EpochReclaimer();
+    EpochReclaimer(const EpochReclaimer&) = delete;
+    EpochReclaimer& operator=(const EpochReclaimer&) = delete;
+
+    void enter();
+    void exit();
+    ThreadRecord* acquire_record();
+    static void release_record(ThreadRecord* record);
+    void heavy_barrier();
+    bool try_advance();
+    void take_expired(std::vector<Retired>& expired);
+
+    alignas(64) std::atomic<std::uint64_t> global_epoch_;  ///< 全局纪元（只在推进时写入）
+    alignas(64) std::atomic<ThreadRecord*> records_;       ///< 读者记录链表头
+    bool use_membarrier_;                                  ///< 读者是否只需编译器屏障
+
+    mutable std::mutex retire_mutex_;   ///< 保护待回收队列与纪元推进
+    std::vector<Retired> limbo_;        ///< 待回收队列
+    std::size_t since_collect_;         ///< 上次回收后新退休的对象数
+};
@@ -33,7 +33,8 @@ enum ErrorCode {
     ERROR_UNMOUNT_FAILED = -25,            ///< 卸载失败
     ERROR_FORMAT_FAILED = -26,             ///< 格式化失败
     ERROR_ALREADY_MOUNTED = -27,           ///< 已挂载
-    ERROR_NOT_MOUNTED = -28                ///< 未挂载
+    ERROR_NOT_MOUNTED = -28,               ///< 未挂载
+    ERROR_CHECKSUM_MISMATCH = -29          ///< 块校验和不匹配
 };
 
 /**
@@ -72,6 +73,7 @@ inline const char* get_error_message(ErrorCode error) {
         case ERROR_FORMAT_FAILED: return "Format failed";
         case ERROR_ALREADY_MOUNTED: return "Already mounted";
         case ERROR_NOT_MOUNTED: return "Not mounted";
+        case ERROR_CHECKSUM_MISMATCH: return "Checksum mismatch";
         default: return "Unknown error";
     }
 }
\ No newline at end of file
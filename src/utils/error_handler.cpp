@@ -4,9 +4,15 @@
 // ==============================================================================
 
 #include "error_handler.h"
+#include <atomic>
 #include <iostream>
 #include <sstream>
 
+namespace {
+thread_local ErrorCode first_error = SUCCESS;  ///< 当前线程记录的第一个错误码
+std::atomic<bool> logging_enabled{true};       ///< 是否输出到标准错误流
+}
+
 /**
  * @brief 格式化错误消息。
  * 
@@ -32,7 +38,12 @@ std::string ErrorHandler::format_error_message(ErrorCode code, const std::string
  * @param context 错误的上下文信息。
  */
 void ErrorHandler::log_error(ErrorCode code, const std::string& context) {
-    std::cerr << format_error_message(code, context) << std::endl;
+    if (first_error == SUCCESS) {
+        first_error = code;
+    }
+    if (logging_enabled.load(std::memory_order_relaxed)) {
+        std::cerr << format_error_message(code, context) << std::endl;
+    }
 }
 
 /**
@@ -72,6 +83,7 @@ std::string ErrorHandler::get_error_description(ErrorCode code) {
         case ERROR_FORMAT_FAILED:         return "Format failed";
         case ERROR_ALREADY_MOUNTED:       return "Already mounted";
         case ERROR_NOT_MOUNTED:           return "Not mounted";
+        case ERROR_CHECKSUM_MISMATCH:     return "Checksum mismatch";
         default:                          return "Unknown error";
     }
 }
@@ -109,4 +121,29 @@ bool ErrorHandler::check_and_log(bool result, ErrorCode error_code, const std::s
         log_error(error_code, context);
     }
     return result;
+}
+
+/**
+ * @brief 获取当前线程自上次清除以来记录的第一个错误码。
+ * 
+ * @return ErrorCode 没有记录错误时返回 SUCCESS。
+ */
+ErrorCode ErrorHandler::last_error() {
+    return first_error;
+}
+
+/**
+ * @brief 清除当前线程记录的错误码。
+ */
+void ErrorHandler::clear_last_error() {
+    first_error = SUCCESS;
+}
+
+/**
+ * @brief 开启或关闭错误信息向标准错误流的输出。
+ * 
+ * @param enabled 为false时不再输出到标准错误流。
+ */
+void ErrorHandler::set_logging_enabled(bool enabled) {
+    logging_enabled.store(enabled, std::memory_order_relaxed);
 }
\ No newline at end of file
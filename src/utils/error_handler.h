@@ -61,4 +61,26 @@ public:
      * @return bool 如果操作成功则返回true，否则返回false。
      */
     static bool check_and_log(bool result, ErrorCode error_code, const std::string& context);
+
+    /**
+     * @brief 获取当前线程自上次清除以来记录的第一个错误码。
+     * 
+     * 一次失败的操作往往沿调用链逐层记录错误，第一个错误码最接近根因
+     * （例如先有 Checksum mismatch，再有外层的 I/O error）。
+     * 
+     * @return ErrorCode 没有记录错误时返回 SUCCESS。
+     */
+    static ErrorCode last_error();
+
+    /**
+     * @brief 清除当前线程记录的错误码，在开始一次新操作前调用。
+     */
+    static void clear_last_error();
+
+    /**
+     * @brief 开启或关闭错误信息向标准错误流的输出（错误码仍照常记录）。
+     * 
+     * @param enabled 为false时不再输出到标准错误流。
+     */
+    static void set_logging_enabled(bool enabled);
 };
\ No newline at end of file
@@ -7,6 +7,8 @@
 #include <cstring>
 #include <algorithm>
 
+#include "slow_op_watchdog.h"
+
 /**
  * @brief 从数据块读取数据到缓冲区。
  * @param disk DiskSimulator的引用。
@@ -14,30 +16,47 @@
  * @param offset 偏移量。
  * @param buffer 输出缓冲区。
  * @param size 要读取的大小。
+ * @param tail_offset 最后一块为共享尾块时，文件尾部在该块内的字节偏移。
  * @return bool 读取成功返回true，否则返回false。
  */
 bool FileOperationsUtils::read_data_from_blocks(DiskSimulator& disk, 
-                                               const std::vector<int>& blocks, 
+                                               const BlockList& blocks, 
                                                int offset, 
                                                char* buffer, 
-                                               int size) {
+                                               int size,
+                                               int tail_offset) {
     if (blocks.empty()) {
         return false;
     }
 
+    SlowOpWatchdog::Phase phase(OpPhase::DataIo);
+
     int bytes_read = 0;
     int start_block = offset / BLOCK_SIZE;
     int start_offset = offset % BLOCK_SIZE;
 
     for (int i = start_block;
          i < static_cast<int>(blocks.size()) && bytes_read < size; i++) {
+        // 物理上连续的整块直接读入调用方缓冲区，交给设备合并或并行传输
+        int run = start_offset == 0 ? full_block_run(blocks, i, size - bytes_read) : 0;
+        if (run > 1) {
+            if (!disk.read_blocks(blocks[i], run, buffer + bytes_read)) {
+                return false;
+            }
+            bytes_read += run * BLOCK_SIZE;
+            i += run - 1;
+            continue;
+        }
+
         char block_buffer[BLOCK_SIZE];
         if (!disk.read_block(blocks[i], block_buffer)) {
             return false;
         }
 
-        int copy_size = std::min(BLOCK_SIZE - start_offset, size - bytes_read);
-        memcpy(buffer + bytes_read, block_buffer + start_offset, copy_size);
+        // 共享尾块只是部分块，不会进入上面的整块传输
+        int base = i == static_cast<int>(blocks.size()) - 1 ? tail_offset : 0;
+        int copy_size = std::min(BLOCK_SIZE - base - start_offset, size - bytes_read);
+        memcpy(buffer + bytes_read, block_buffer + base + start_offset, copy_size);
 
         bytes_read += copy_size;
         start_offset = 0;  // 后续块从开头开始复制
@@ -56,7 +75,7 @@ bool FileOperationsUtils::read_data_from_blocks(DiskSimulator& disk,
  * @return bool 写入成功返回true，否则返回false。
  */
 bool FileOperationsUtils::write_data_to_blocks(DiskSimulator& disk, 
-                                              const std::vector<int>& blocks, 
+                                              const BlockList& blocks, 
                                               int offset, 
                                               const char* buffer, 
                                               int size) {
@@ -64,12 +83,25 @@ bool FileOperationsUtils::write_data_to_blocks(DiskSimulator& disk,
         return false;
     }
 
+    SlowOpWatchdog::Phase phase(OpPhase::DataIo);
+
     int bytes_written = 0;
     int start_block = offset / BLOCK_SIZE;
     int start_offset = offset % BLOCK_SIZE;
 
     for (int i = start_block;
          i < static_cast<int>(blocks.size()) && bytes_written < size; i++) {
+        // 物理上连续且被完整覆盖的块无需先读，直接整段写出
+        int run = start_offset == 0 ? full_block_run(blocks, i, size - bytes_written) : 0;
+        if (run > 1) {
+            if (!disk.write_blocks(blocks[i], run, buffer + bytes_written)) {
+                return false;
+            }
+            bytes_written += run * BLOCK_SIZE;
+            i += run - 1;
+            continue;
+        }
+
         char block_buffer[BLOCK_SIZE];
 
         if (start_offset > 0 || size - bytes_written < BLOCK_SIZE) {
@@ -113,4 +145,22 @@ void FileOperationsUtils::initialize_new_inode(Inode& inode, int mode, int link_
     memset(inode.direct_blocks, 0, sizeof(inode.direct_blocks));
     inode.indirect_block = -1;
     inode.double_indirect_block = -1;
-}
\ No newline at end of file
+}
+
+/**
+ * @brief 计算从第 index 个块开始、可整块传输的连续物理块数。
+ * @param blocks 数据块列表。
+ * @param index 起始下标。
+ * @param remaining 剩余待传输的字节数。
+ * @return int 连续且被完整覆盖的块数。
+ */
+int FileOperationsUtils::full_block_run(const BlockList& blocks,
+                                        int index, int remaining) {
+    int run = 0;
+    while (index + run < static_cast<int>(blocks.size()) &&
+           remaining >= (run + 1) * BLOCK_SIZE &&
+           (run == 0 || blocks[index + run] == blocks[index] + run)) {
+        ++run;
+    }
+    return run;
+}
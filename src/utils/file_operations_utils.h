@@ -25,13 +25,15 @@ public:
      * @param offset 偏移量。
      * @param buffer 输出缓冲区。
      * @param size 要读取的大小。
+     * @param tail_offset 最后一块为共享尾块时，文件尾部在该块内的字节偏移（默认0）。
      * @return bool 读取成功返回true，否则返回false。
      */
     static bool read_data_from_blocks(DiskSimulator& disk, 
-                                      const std::vector<int>& blocks, 
+                                      const BlockList& blocks, 
                                       int offset, 
                                       char* buffer, 
-                                      int size);
+                                      int size,
+                                      int tail_offset = 0);
                                       
     /**
      * @brief 将缓冲区数据写入到数据块。
@@ -43,7 +45,7 @@ public:
      * @return bool 写入成功返回true，否则返回false。
      */
     static bool write_data_to_blocks(DiskSimulator& disk, 
-                                     const std::vector<int>& blocks, 
+                                     const BlockList& blocks, 
                                      int offset, 
                                      const char* buffer, 
                                      int size);
@@ -58,4 +60,15 @@ public:
                                            FILE_PERMISSION_READ | 
                                            FILE_PERMISSION_WRITE, 
                                            int link_count = 1);
+
+private:
+    /**
+     * @brief 计算从第 index 个块开始、可整块传输的连续物理块数。
+     * @param blocks 数据块列表。
+     * @param index 起始下标。
+     * @param remaining 剩余待传输的字节数。
+     * @return int 连续且被完整覆盖的块数（至少为0）。
+     */
+    static int full_block_run(const BlockList& blocks, int index,
+                              int remaining);
 };
\ No newline at end of file
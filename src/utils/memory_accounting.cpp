@@ -0,0 +1,107 @@
+// ==============================================================================
+// @file   memory_accounting.cpp
+// @brief  分子系统内存统计的报告实现
+// ==============================================================================
+
+#include "memory_accounting.h"
+
+#include <iomanip>
+#include <sstream>
+
+namespace {
+
+constexpr int kSubsystemCount = static_cast<int>(MemSubsystem::Count);
+
+/**
+ * @brief 把字节数格式化为 B/KB/MB。
+ */
+std::string format_bytes(std::int64_t bytes) {
+    std::ostringstream oss;
+    if (bytes < 1024) {
+        oss << bytes << " B";
+    } else if (bytes < 1024 * 1024) {
+        oss << std::fixed << std::setprecision(1) << bytes / 1024.0 << " KB";
+    } else {
+        oss << std::fixed << std::setprecision(1) << bytes / (1024.0 * 1024.0) << " MB";
+    }
+    return oss.str();
+}
+
+}  // namespace
+
+MemoryAccounting::Counters MemoryAccounting::counters_[static_cast<int>(MemSubsystem::Count)];
+
+bool MemoryAccounting::enabled() {
+#ifndef DISKSIM_NO_MEMORY_ACCOUNTING
+    return true;
+#else
+    return false;
+#endif
+}
+
+MemUsage MemoryAccounting::usage(MemSubsystem subsystem) {
+    const Counters& c = counters_[static_cast<int>(subsystem)];
+    MemUsage usage;
+    usage.live_bytes = c.live_bytes.load(std::memory_order_relaxed);
+    usage.peak_bytes = c.peak_bytes.load(std::memory_order_relaxed);
+    usage.live_allocations = c.live_allocations.load(std::memory_order_relaxed);
+    usage.total_allocations = c.total_allocations.load(std::memory_order_relaxed);
+    return usage;
+}
+
+const char* MemoryAccounting::subsystem_name(MemSubsystem subsystem) {
+    switch (subsystem) {
+        case MemSubsystem::Bitmaps:     return "bitmaps";
+        case MemSubsystem::Directories: return "directories";
+        case MemSubsystem::BlockLists:  return "block lists";
+        case MemSubsystem::Tasks:       return "tasks";
+        case MemSubsystem::Commands:    return "commands";
+        case MemSubsystem::Caches:      return "caches";
+        default:                        return "unknown";
+    }
+}
+
+std::string MemoryAccounting::report() {
+    std::ostringstream oss;
+    oss << "Memory Accounting:" << std::endl;
+    if (!enabled()) {
+        oss << "  disabled at build time (MEMORY_ACCOUNTING=0)" << std::endl;
+        return oss.str();
+    }
+
+    oss << "  " << std::left << std::setw(14) << "Subsystem" << std::right
+        << std::setw(12) << "Live" << std::setw(12) << "Peak"
+        << std::setw(12) << "Live allocs" << std::setw(14) << "Total allocs" << std::endl;
+    std::int64_t total_live = 0;
+    std::int64_t total_peak = 0;
+    for (int i = 0; i < kSubsystemCount; ++i) {
+        MemSubsystem subsystem = static_cast<MemSubsystem>(i);
+        MemUsage u = usage(subsystem);
+        total_live += u.live_bytes;
+        total_peak += u.peak_bytes;
+        oss << "  " << std::left << std::setw(14) << subsystem_name(subsystem) << std::right
+            << std::setw(12) << format_bytes(u.live_bytes)
+            << std::setw(12) << format_bytes(u.peak_bytes)
+            << std::setw(12) << u.live_allocations
+            << std::setw(14) << u.total_allocations << std::endl;
+    }
+    // 各子系统峰值出现的时刻不同，其和只是总峰值的上界
+    oss << "  Tracked total: " << format_bytes(total_live) << " live, "
+        << format_bytes(total_peak) << " sum of peaks" << std::endl;
+    return oss.str();
+}
+
+std::string MemoryAccounting::summary() {
+    if (!enabled()) {
+        return "mem: untracked";
+    }
+    std::ostringstream oss;
+    oss << "mem:";
+    for (int i = 0; i < kSubsystemCount; ++i) {
+        MemSubsystem subsystem = static_cast<MemSubsystem>(i);
+        MemUsage u = usage(subsystem);
+        oss << (i == 0 ? " " : ", ") << subsystem_name(subsystem) << " "
+            << format_bytes(u.live_bytes) << " (peak " << format_bytes(u.peak_bytes) << ")";
+    }
+    return oss.str();
+}
@@ -0,0 +1,166 @@
+// ==============================================================================
+// @file   memory_accounting.h
+// @brief  按子系统统计堆内存：带子系统标签的分配器与计数钩子
+// ==============================================================================
+
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * @enum MemSubsystem
+ * @brief 被单独统计内存的子系统。
+ */
+enum class MemSubsystem : int {
+    Bitmaps = 0,   ///< inode/数据块位图
+    Directories,   ///< 目录快照中的条目数组
+    BlockLists,    ///< 块号列表（块映射、日志结构映射表）
+    Tasks,         ///< 线程池队列与任务对象
+    Commands,      ///< 排队等待执行的命令字符串
+    Caches,        ///< 目录项缓存与 inode 缓存节点
+    Count
+};
+
+/**
+ * @struct MemUsage
+ * @brief 某个子系统的内存使用快照。
+ */
+struct MemUsage {
+    std::int64_t live_bytes = 0;         ///< 当前存活字节数
+    std::int64_t peak_bytes = 0;         ///< 存活字节数的历史峰值
+    std::int64_t live_allocations = 0;   ///< 当前存活的分配次数
+    std::int64_t total_allocations = 0;  ///< 累计分配次数
+};
+
+/**
+ * @class MemoryAccounting
+ * @brief 进程级的分子系统内存计数。
+ *
+ * 各子系统通过 TrackedAllocator（标准容器）或 on_allocate/on_deallocate
+ * （自行 new/delete 的对象）登记分配。每个子系统的计数器独占一个缓存行，
+ * 登记只是几次 relaxed 原子加法，峰值用 CAS 更新。编译时定义
+ * DISKSIM_NO_MEMORY_ACCOUNTING（make MEMORY_ACCOUNTING=0）后钩子为空操作，
+ * 报告中只显示未启用。
+ */
+class MemoryAccounting {
+public:
+    /**
+     * @brief 登记一次分配。
+     */
+    static void on_allocate(MemSubsystem subsystem, std::size_t bytes) {
+#ifndef DISKSIM_NO_MEMORY_ACCOUNTING
+        Counters& c = counters_[static_cast<int>(subsystem)];
+        std::int64_t live = c.live_bytes.fetch_add(static_cast<std::int64_t>(bytes),
+                                                   std::memory_order_relaxed) +
+                            static_cast<std::int64_t>(bytes);
+        c.live_allocations.fetch_add(1, std::memory_order_relaxed);
+        c.total_allocations.fetch_add(1, std::memory_order_relaxed);
+        std::int64_t peak = c.peak_bytes.load(std::memory_order_relaxed);
+        while (live > peak &&
+               !c.peak_bytes.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {
+        }
+#else
+        (void)subsystem;
+        (void)bytes;
+#endif
+    }
+
+    /**
+     * @brief 登记一次释放。
+     */
+    static void on_deallocate(MemSubsystem subsystem, std::size_t bytes) {
+#ifndef DISKSIM_NO_MEMORY_ACCOUNTING
+        Counters& c = counters_[static_cast<int>(subsystem)];
+        c.live_bytes.fetch_sub(static_cast<std::int64_t>(bytes), std::memory_order_relaxed);
+        c.live_allocations.fetch_sub(1, std::memory_order_relaxed);
+#else
+        (void)subsystem;
+        (void)bytes;
+#endif
+    }
+
+    /**
+     * @brief 是否在编译时启用了统计。
+     */
+    static bool enabled();
+
+    /**
+     * @brief 读取子系统的使用快照。
+     */
+    static MemUsage usage(MemSubsystem subsystem);
+
+    /**
+     * @brief 子系统的显示名称。
+     */
+    static const char* subsystem_name(MemSubsystem subsystem);
+
+    /**
+     * @brief 多行报告（用于 stats 命令）。
+     */
+    static std::string report();
+
+    /**
+     * @brief 单行摘要（用于压力测试监控输出）。
+     */
+    static std::string summary();
+
+private:
+    /**
+     * @struct Counters
+     * @brief 一个子系统的计数器，独占缓存行以免子系统之间伪共享。
+     */
+    struct alignas(64) Counters {
+        std::atomic<std::int64_t> live_bytes{0};
+        std::atomic<std::int64_t> peak_bytes{0};
+        std::atomic<std::int64_t> live_allocations{0};
+        std::atomic<std::int64_t> total_allocations{0};
+    };
+
+    static Counters counters_[static_cast<int>(MemSubsystem::Count)];
+};
+
+/**
+ * @class TrackedAllocator
+ * @brief 把分配登记到指定子系统的标准分配器，其余行为与 std::allocator 相同。
+ *
+ * @tparam T 元素类型。
+ * @tparam Subsystem 登记到的子系统。
+ */
+template <typename T, MemSubsystem Subsystem>
+class TrackedAllocator {
+public:
+    using value_type = T;
+
+    template <typename U>
+    struct rebind {
+        using other = TrackedAllocator<U, Subsystem>;
+    };
+
+    TrackedAllocator() noexcept = default;
+
+    template <typename U>
+    TrackedAllocator(const TrackedAllocator<U, Subsystem>&) noexcept {}
+
+    T* allocate(std::size_t n) {
+        T* ptr = static_cast<T*>(::operator new(n * sizeof(T)));
+        MemoryAccounting::on_allocate(Subsystem, n * sizeof(T));
+        return ptr;
+    }
+
+    void deallocate(T* ptr, std::size_t n) noexcept {
+        MemoryAccounting::on_deallocate(Subsystem, n * sizeof(T));
+        ::operator delete(ptr);
+    }
+
+    template <typename U>
+    bool operator==(const TrackedAllocator<U, Subsystem>&) const noexcept {
+        return true;
+    }
+
+    template <typename U>
+    bool operator!=(const TrackedAllocator<U, Subsystem>&) const noexcept {
+        return false;
+    }
+};
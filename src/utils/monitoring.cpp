@@ -104,6 +104,45 @@ std::string Monitoring::get_memory_info() {
     return result.str();
 }
 
+/**
+ * @brief 获取本进程的常驻内存。
+ * @return std::string 包含当前与峰值常驻内存的字符串。
+ */
+std::string Monitoring::get_process_memory() {
+    std::ifstream file("/proc/self/status");
+    if (!file.is_open()) {
+        return "RSS(MB): unavailable";
+    }
+
+    double rss_kb = -1.0;
+    double hwm_kb = -1.0;
+    std::string line;
+    while (std::getline(file, line)) {
+        std::istringstream iss(line);
+        std::string key;
+        double value = 0.0;
+        iss >> key >> value;
+
+        if (key == "VmRSS:") {
+            rss_kb = value;
+        } else if (key == "VmHWM:") {
+            hwm_kb = value;
+        }
+    }
+
+    if (rss_kb < 0.0) {
+        return "RSS(MB): unavailable";
+    }
+
+    std::ostringstream result;
+    result << std::fixed << std::setprecision(3)
+           << "RSS(MB): current=" << rss_kb / 1024.0;
+    if (hwm_kb >= 0.0) {
+        result << ", peak=" << hwm_kb / 1024.0;
+    }
+    return result.str();
+}
+
 /**
  * @brief 获取当前磁盘使用情况。
  * @return std::string 包含磁盘使用信息的字符串。
@@ -33,6 +33,12 @@ public:
      */
     static std::string get_memory_info();
 
+    /**
+     * @brief 获取本进程的常驻内存（/proc/self/status 中的 VmRSS 与 VmHWM）。
+     * @return std::string 包含进程内存信息的字符串。
+     */
+    static std::string get_process_memory();
+
     /**
      * @brief 获取当前磁盘使用情况。
      * @return std::string 包含磁盘使用信息的字符串。
@@ -4,7 +4,10 @@
 // ==============================================================================
 
 #include "path_utils.h"
+
 #include <algorithm>
+#include <cstring>
+
 #include "../utils/common.h"
 
 /**
@@ -13,7 +16,7 @@
  * @param path 要验证的路径字符串。
  * @return ErrorCode 如果路径有效返回SUCCESS，否则返回错误码。
  */
-ErrorCode PathUtils::validate_path(const std::string& path) {
+ErrorCode PathUtils::validate_path(std::string_view path) {
   if (path.empty() || path.length() > MAX_PATH_LENGTH) {
     return ERROR_INVALID_PATH;
   }
@@ -34,18 +37,18 @@ ErrorCode PathUtils::validate_path(const std::string& path) {
  * @param path 完整路径字符串。
  * @return std::string 提取的文件名。如果路径无效或以'/'结尾，则返回空字符串。
  */
-std::string PathUtils::extract_filename(const std::string& path) {
+std::string PathUtils::extract_filename(std::string_view path) {
   if (validate_path(path) != SUCCESS) {
     return "";
   }
   
   size_t last_slash = path.find_last_of('/');
   
-  if (last_slash == std::string::npos) {
-    return path; // 没有找到分隔符，整个路径是文件名
+  if (last_slash == std::string_view::npos) {
+    return std::string(path); // 没有找到分隔符，整个路径是文件名
   }
   
-  return path.substr(last_slash + 1);
+  return std::string(path.substr(last_slash + 1));
 }
 
 /**
@@ -54,14 +57,14 @@ std::string PathUtils::extract_filename(const std::string& path) {
  * @param path 完整路径字符串。
  * @return std::string 目录路径。如果路径无效则返回空字符串。
  */
-std::string PathUtils::extract_directory(const std::string& path) {
+std::string PathUtils::extract_directory(std::string_view path) {
   if (validate_path(path) != SUCCESS) {
     return "";
   }
   
   size_t last_slash = path.find_last_of('/');
   
-  if (last_slash == std::string::npos) {
+  if (last_slash == std::string_view::npos) {
     return "."; // 没有找到分隔符，返回当前目录
   }
   
@@ -69,7 +72,7 @@ std::string PathUtils::extract_directory(const std::string& path) {
     return "/"; // 路径为 "/" 或 "/filename"
   }
   
-  return path.substr(0, last_slash);
+  return std::string(path.substr(0, last_slash));
 }
 
 /**
@@ -78,7 +81,7 @@ std::string PathUtils::extract_directory(const std::string& path) {
  * @param path 要检查的路径字符串。
  * @return bool 如果是绝对路径（以'/'开头）返回true，否则返回false。
  */
-bool PathUtils::is_absolute_path(const std::string& path) {
+bool PathUtils::is_absolute_path(std::string_view path) {
   if (path.empty()) {
       return false;
   }
@@ -96,21 +99,115 @@ bool PathUtils::is_absolute_path(const std::string& path) {
  * @return std::string 规范化后的路径字符串。
  */
 std::string PathUtils::normalize_path(const std::string& path) {
-  if (path.empty()) {
-      return "";
-  }
+  std::string storage;
+  return normalize_path(path, storage);
+}
 
-  std::string normalized = path;
-  std::replace(normalized.begin(), normalized.end(), '\\', '/');
+/**
+ * @brief 规范化路径；常见的已规范路径不做任何复制。
+ * 
+ * @param path 要规范化的路径字符串。
+ * @param storage 需要改写时存放结果的字符串。
+ * @return const std::string& path 本身或 storage。
+ */
+const std::string& PathUtils::normalize_path(const std::string& path, std::string& storage) {
+  if (is_normalized(path)) {
+    return path;
+  }
 
-  // 使用 erase-remove idiom 清理重复的斜杠
-  normalized.erase(std::unique(normalized.begin(), normalized.end(),
-                               [](char a, char b) { return a == '/' && b == '/'; }),
-                   normalized.end());
+  // 单遍改写：替换分隔符的同时跳过重复的'/'
+  storage.clear();
+  storage.reserve(path.size());
+  for (char c : path) {
+    if (c == '\\') {
+      c = '/';
+    }
+    if (c == '/' && !storage.empty() && storage.back() == '/') {
+      continue;
+    }
+    storage.push_back(c);
+  }
 
-  if (normalized.length() > 1 && normalized.back() == '/') {
-    normalized.pop_back();
+  if (storage.length() > 1 && storage.back() == '/') {
+    storage.pop_back();
   }
   
-  return normalized;
+  return storage;
+}
+
+/**
+ * @brief 检查路径是否已经是规范形式。
+ * 
+ * @param path 要检查的路径。
+ * @return bool 规范化不会改变该路径时返回true。
+ */
+bool PathUtils::is_normalized(std::string_view path) {
+  if (path.length() > 1 && path.back() == '/') {
+    return false;
+  }
+  char previous = '\0';
+  for (char c : path) {
+    if (c == '\\' || (c == '/' && previous == '/')) {
+      return false;
+    }
+    previous = c;
+  }
+  return true;
+}
+
+/**
+ * @brief 取出路径中的下一个组件。
+ * 
+ * 相对路径与绝对路径的组件相同（查找总是从根目录开始）。
+ * 
+ * @param path 路径。
+ * @param[in,out] pos 扫描位置，返回时位于该组件之后。
+ * @param[out] component 组件，指向 path 中的字符。
+ * @return bool 取到组件返回true，已到末尾返回false。
+ */
+bool PathUtils::next_component(std::string_view path, size_t& pos,
+                               std::string_view& component) {
+  while (pos < path.size() && path[pos] == '/') {
+    ++pos;
+  }
+  if (pos >= path.size()) {
+    return false;
+  }
+
+  size_t end = path.find('/', pos);
+  if (end == std::string_view::npos) {
+    end = path.size();
+  }
+  component = path.substr(pos, end - pos);
+  pos = end;
+  return true;
+}
+
+/**
+ * @brief 拼接目录路径与条目名称。
+ * 
+ * @param directory 规范化的目录路径（根目录为"/"）。
+ * @param name 条目名称。
+ * @return std::string 条目的完整路径。
+ */
+std::string PathUtils::join_path(std::string_view directory, std::string_view name) {
+  std::string path;
+  path.reserve(directory.size() + name.size() + 1);
+  if (directory != "/") {
+    path.append(directory);
+  }
+  path.push_back('/');
+  path.append(name);
+  return path;
+}
+
+/**
+ * @brief 取出目录项的名称。
+ * 
+ * @param entry 目录项。
+ * @return std::string 条目名称，长度不超过 MAX_FILENAME_LENGTH。
+ */
+std::string PathUtils::entry_name(const DirectoryEntry& entry) {
+  int length = std::min(entry.name_length, MAX_FILENAME_LENGTH);
+  return std::string(entry.name, strnlen(entry.name, length));
 }
@@ -1,12 +1,17 @@
 #pragma once
+#include <cstddef>
 #include <string>
+#include <string_view>
 #include "../utils/error_codes.h"
 
+struct DirectoryEntry;
+
 /**
  * @class PathUtils
  * @brief 提供路径操作的静态工具方法。
  *
- * 用于处理文件系统路径的验证、解析和规范化。
+ * 用于处理文件系统路径的验证、解析和规范化。参数使用 std::string_view，
+ * 逐个组件遍历路径时只移动位置而不复制字符串。
  */
 class PathUtils {
  public:
@@ -15,28 +20,28 @@ class PathUtils {
    * @param path 要验证的路径字符串。
    * @return ErrorCode 如果路径有效返回SUCCESS，否则返回错误码。
    */
-  static ErrorCode validate_path(const std::string& path);
+  static ErrorCode validate_path(std::string_view path);
 
   /**
    * @brief 从完整路径中提取文件名。
    * @param path 完整路径字符串。
    * @return std::string 提取的文件名。如果路径无效则返回空字符串。
    */
-  static std::string extract_filename(const std::string& path);
+  static std::string extract_filename(std::string_view path);
 
   /**
    * @brief 从完整路径中提取目录路径。
    * @param path 完整路径字符串。
    * @return std::string 目录路径。如果路径无效则返回空字符串。
    */
-  static std::string extract_directory(const std::string& path);
+  static std::string extract_directory(std::string_view path);
 
   /**
    * @brief 检查路径是否为绝对路径。
    * @param path 要检查的路径字符串。
    * @return bool 如果是绝对路径返回true，否则返回false。
    */
-  static bool is_absolute_path(const std::string& path);
+  static bool is_absolute_path(std::string_view path);
 
   /**
    * @brief 规范化路径，统一使用'/'作为分隔符。
@@ -44,4 +49,42 @@ class PathUtils {
    * @return std::string 规范化后的路径字符串。
    */
   static std::string normalize_path(const std::string& path);
+
+  /**
+   * @brief 规范化路径；已经规范的路径直接返回原字符串，不复制。
+   * @param path 要规范化的路径字符串。
+   * @param storage 需要改写时存放结果的字符串。
+   * @return const std::string& path 本身或 storage。
+   */
+  static const std::string& normalize_path(const std::string& path, std::string& storage);
+
+  /**
+   * @brief 检查路径是否已经是规范形式（无'\\'、无连续'/'、无末尾'/'）。
+   */
+  static bool is_normalized(std::string_view path);
+
+  /**
+   * @brief 取出路径中的下一个组件，跳过前导与连续的'/'。
+   * @param path 路径。
+   * @param[in,out] pos 扫描位置（从0开始），返回时位于该组件之后。
+   * @param[out] component 组件，指向 path 中的字符。
+   * @return bool 取到组件返回true，已到末尾返回false。
+   */
+  static bool next_component(std::string_view path, size_t& pos,
+                             std::string_view& component);
+
+  /**
+   * @brief 拼接目录路径与条目名称。
+   * @param directory 规范化的目录路径。
+   * @param name 条目名称。
+   * @return std::string 条目的完整路径。
+   */
+  static std::string join_path(std::string_view directory, std::string_view name);
+
+  /**
+   * @brief 取出目录项的名称（名称字段不一定以'\0'结尾）。
+   * @param entry 目录项。
+   * @return std::string 条目名称。
+   */
+  static std::string entry_name(const DirectoryEntry& entry);
 };
\ No newline at end of file
@@ -0,0 +1,221 @@
+// ==============================================================================
+// @file   slow_op_watchdog.cpp
+// @brief  慢操作看门狗的实现
+// ==============================================================================
+
+#include "slow_op_watchdog.h"
+
+#include <array>
+#include <atomic>
+#include <cstdlib>
+#include <deque>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+
+#include "trace_probes.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr std::size_t kPhaseCount = static_cast<std::size_t>(OpPhase::Count);
+constexpr std::size_t kMaxReports = 16;  ///< 保留的最近报告数
+
+/**
+ * @brief 当前线程正在计时的操作。
+ */
+struct OpContext {
+    int depth = 0;                          ///< Operation 嵌套深度
+    bool timing = false;                    ///< 最外层操作是否在计时
+    const char* name = nullptr;             ///< 操作名
+    const std::string* target = nullptr;    ///< 操作路径（可为空）
+    int fd = -1;                            ///< 文件描述符（无路径时使用）
+    Clock::time_point start;                ///< 操作开始时间
+    Clock::time_point segment_start;        ///< 当前阶段本段的开始时间
+    OpPhase current = OpPhase::Other;       ///< 当前阶段
+    std::array<std::int64_t, kPhaseCount> ns{};  ///< 各阶段累计纳秒
+};
+
+thread_local OpContext context;
+
+std::int64_t initial_threshold_ns() {
+    const char* value = std::getenv("DISKSIM_SLOW_OP_MS");
+    if (value == nullptr) {
+        return 0;
+    }
+    double ms = std::atof(value);
+    return ms > 0 ? static_cast<std::int64_t>(ms * 1e6) : 0;
+}
+
+std::atomic<std::int64_t> threshold_ns{initial_threshold_ns()};
+
+std::mutex reports_mutex;
+std::deque<std::string> reports;
+
+/**
+ * @brief 把从本段开始到 now 的时间计入当前阶段。
+ */
+inline void charge(OpContext& ctx, Clock::time_point now) {
+    ctx.ns[static_cast<std::size_t>(ctx.current)] +=
+        std::chrono::duration_cast<std::chrono::nanoseconds>(now - ctx.segment_start).count();
+    ctx.segment_start = now;
+}
+
+}  // namespace
+
+// ==============================================================================
+// Operation
+// ==============================================================================
+
+SlowOpWatchdog::Operation::Operation(const char* name, const std::string& target) {
+    begin(name, &target, -1);
+}
+
+SlowOpWatchdog::Operation::Operation(const char* name, int fd) {
+    begin(name, nullptr, fd);
+}
+
+SlowOpWatchdog::Operation::Operation(const char* name) {
+    begin(name, nullptr, -1);
+}
+
+void SlowOpWatchdog::Operation::begin(const char* name, const std::string* target, int fd) {
+    OpContext& ctx = context;
+    name_ = name;
+    outermost_ = ctx.depth++ == 0;
+    if (!outermost_) {
+        return;
+    }
+    DISKSIM_PROBE3(op__entry, name, target != nullptr ? target->c_str() : nullptr, fd);
+    if (threshold_ns.load(std::memory_order_relaxed) <= 0) {
+        return;
+    }
+
+    ctx.timing = true;
+    ctx.name = name;
+    ctx.target = target;
+    ctx.fd = fd;
+    ctx.current = OpPhase::Other;
+    ctx.ns.fill(0);
+    ctx.start = Clock::now();
+    ctx.segment_start = ctx.start;
+}
+
+/**
+ * @brief 结束最外层操作；只有超过阈值时才格式化并输出报告。
+ */
+SlowOpWatchdog::Operation::~Operation() {
+    OpContext& ctx = context;
+    --ctx.depth;
+    if (!outermost_) {
+        return;
+    }
+    DISKSIM_PROBE1(op__return, name_);
+    if (!ctx.timing) {
+        return;
+    }
+    ctx.timing = false;
+
+    Clock::time_point now = Clock::now();
+    charge(ctx, now);
+    std::int64_t total = std::chrono::duration_cast<std::chrono::nanoseconds>(now - ctx.start).count();
+    std::int64_t threshold = threshold_ns.load(std::memory_order_relaxed);
+    if (threshold <= 0 || total < threshold) {
+        return;
+    }
+
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(3);
+    oss << "Slow operation: " << ctx.name;
+    if (ctx.target != nullptr) {
+        oss << " " << *ctx.target;
+    } else if (ctx.fd >= 0) {
+        oss << " fd=" << ctx.fd;
+    }
+    oss << " took " << total / 1e6 << " ms (";
+    bool first = true;
+    for (std::size_t i = 0; i < kPhaseCount; ++i) {
+        // 只列出占比不可忽略的阶段
+        if (ctx.ns[i] < 100000 && ctx.ns[i] * 100 < total) {
+            continue;
+        }
+        oss << (first ? "" : ", ") << phase_name(static_cast<OpPhase>(i)) << " "
+            << ctx.ns[i] / 1e6 << " ms";
+        first = false;
+    }
+    oss << ")";
+    report(oss.str());
+}
+
+// ==============================================================================
+// Phase
+// ==============================================================================
+
+SlowOpWatchdog::Phase::Phase(OpPhase phase) : active_(false), previous_(OpPhase::Other) {
+    OpContext& ctx = context;
+    if (!ctx.timing) {
+        return;
+    }
+    active_ = true;
+    charge(ctx, Clock::now());
+    previous_ = ctx.current;
+    ctx.current = phase;
+}
+
+SlowOpWatchdog::Phase::~Phase() {
+    if (!active_) {
+        return;
+    }
+    OpContext& ctx = context;
+    // 操作可能已在阶段结束前完成（例如锁对象随返回值移出阶段范围之外）
+    if (!ctx.timing) {
+        return;
+    }
+    charge(ctx, Clock::now());
+    ctx.current = previous_;
+}
+
+// ==============================================================================
+// 配置与报告
+// ==============================================================================
+
+void SlowOpWatchdog::set_threshold_ms(double ms) {
+    threshold_ns.store(ms > 0 ? static_cast<std::int64_t>(ms * 1e6) : 0, std::memory_order_relaxed);
+}
+
+double SlowOpWatchdog::threshold_ms() {
+    return threshold_ns.load(std::memory_order_relaxed) / 1e6;
+}
+
+std::vector<std::string> SlowOpWatchdog::recent_reports() {
+    std::lock_guard<std::mutex> lock(reports_mutex);
+    return std::vector<std::string>(reports.begin(), reports.end());
+}
+
+const char* SlowOpWatchdog::phase_name(OpPhase phase) {
+    switch (phase) {
+        case OpPhase::LockWait:       return "lock wait";
+        case OpPhase::PathResolution: return "path resolution";
+        case OpPhase::InodeIo:        return "inode I/O";
+        case OpPhase::BlockMap:       return "block map";
+        case OpPhase::DataIo:         return "data I/O";
+        case OpPhase::BitmapSave:     return "bitmap save";
+        case OpPhase::Flush:          return "flush";
+        case OpPhase::Cleaning:       return "segment cleaning";
+        case OpPhase::Other:          return "other";
+        default:                      return "unknown";
+    }
+}
+
+void SlowOpWatchdog::report(const std::string& line) {
+    {
+        std::lock_guard<std::mutex> lock(reports_mutex);
+        reports.push_back(line);
+        if (reports.size() > kMaxReports) {
+            reports.pop_front();
+        }
+    }
+    std::cerr << line << std::endl;
+}
@@ -0,0 +1,119 @@
+// ==============================================================================
+// @file   slow_op_watchdog.h
+// @brief  慢操作看门狗：按阶段累计每次文件系统操作的耗时，超过阈值时输出分解
+// ==============================================================================
+
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @enum OpPhase
+ * @brief 一次文件系统操作中被单独计时的阶段。
+ */
+enum class OpPhase : int {
+    LockWait = 0,     ///< 等待文件系统读写锁
+    PathResolution,   ///< 路径解析（逐级查找目录项）
+    InodeIo,          ///< inode 表读写
+    BlockMap,         ///< 块映射（直接/间接块指针）的读取与更新
+    DataIo,           ///< 文件与目录数据块读写
+    BitmapSave,       ///< 位图写回
+    Flush,            ///< 检查点、校验和区与日志的写回
+    Cleaning,         ///< 日志结构设备的同步段清理
+    Other,            ///< 未归入以上阶段的时间
+    Count
+};
+
+/**
+ * @class SlowOpWatchdog
+ * @brief 记录超过阈值的文件系统操作及其各阶段耗时。
+ *
+ * FileSystem 的公共操作在入口构造 Operation，各模块在可能耗时的位置构造
+ * Phase。计时状态保存在线程局部变量中，阶段按栈嵌套，时间只计入最内层
+ * 阶段，因此各阶段之和等于操作总耗时。每个阶段只需两次单调时钟读取，
+ * 不加锁；只有超过阈值的操作才格式化报告、写入标准错误流并保存到最近
+ * 报告列表。阈值为0时不计时，Phase 只剩一次分支判断。
+ *
+ * 阈值在启动时取自环境变量 DISKSIM_SLOW_OP_MS（毫秒，默认关闭），运行中
+ * 可通过 `slowlog <ms>` 命令或 set_threshold_ms 修改。
+ *
+ * 最外层 Operation 同时触发 USDT 探针 disksim:op__entry / op__return
+ * （见 trace_probes.h），与阈值无关。
+ */
+class SlowOpWatchdog {
+public:
+    /**
+     * @class Operation
+     * @brief 一次文件系统操作的计时范围；嵌套时只有最外层生效。
+     */
+    class Operation {
+    public:
+        /**
+         * @brief 以路径标识的操作。
+         * @param name 操作名（静态字符串）。
+         * @param target 操作的路径，须在本对象生存期内有效。
+         */
+        Operation(const char* name, const std::string& target);
+
+        /**
+         * @brief 以文件描述符标识的操作。
+         */
+        Operation(const char* name, int fd);
+
+        /**
+         * @brief 不针对具体对象的操作（挂载、格式化等）。
+         */
+        explicit Operation(const char* name);
+
+        ~Operation();
+        Operation(const Operation&) = delete;
+        Operation& operator=(const Operation&) = delete;
+
+    private:
+        void begin(const char* name, const std::string* target, int fd);
+        const char* name_;  ///< 操作名
+        bool outermost_;    ///< 是否为最外层操作
+    };
+
+    /**
+     * @class Phase
+     * @brief 阶段计时范围；不在计时中的操作内时不做任何事。
+     */
+    class Phase {
+    public:
+        explicit Phase(OpPhase phase);
+        ~Phase();
+        Phase(const Phase&) = delete;
+        Phase& operator=(const Phase&) = delete;
+
+    private:
+        bool active_;       ///< 是否在计时
+        OpPhase previous_;  ///< 进入前的阶段
+    };
+
+    /**
+     * @brief 设置慢操作阈值。
+     * @param ms 毫秒数，小于等于0时关闭看门狗。
+     */
+    static void set_threshold_ms(double ms);
+
+    /**
+     * @brief 当前阈值（毫秒），0表示关闭。
+     */
+    static double threshold_ms();
+
+    /**
+     * @brief 最近的慢操作报告（从旧到新，最多保留16条）。
+     */
+    static std::vector<std::string> recent_reports();
+
+    /**
+     * @brief 阶段的显示名称。
+     */
+    static const char* phase_name(OpPhase phase);
+
+private:
+    static void report(const std::string& line);
+};
@@ -0,0 +1,59 @@
+// ==============================================================================
+// @file   trace_probes.h
+// @brief  USDT 静态探针：供 bpftrace / perf / SystemTap 按需挂载
+// ==============================================================================
+
+#pragma once
+
+/**
+ * 探针以 sys/sdt.h 的 DTRACE_PROBEn 实现，提供者名为 disksim。未挂载时每个
+ * 探针只是一条 nop 指令，参数在寄存器或栈上就地给出，不产生函数调用；
+ * 探针位置与参数描述记录在可执行文件的 .note.stapsdt 段中，调试器或 eBPF
+ * 工具挂载时才把 nop 替换为断点。
+ *
+ * 构建环境缺少 sys/sdt.h（systemtap-sdt-dev / systemtap-sdt-devel）或定义了
+ * DISKSIM_NO_USDT（make USDT=0）时，探针宏展开为空，参数不会被求值。
+ *
+ * 探针一览（参数依次为 arg0、arg1 …）：
+ *   op__entry(name, path, fd)       FileSystem 公共操作入口（只在最外层触发）
+ *   op__return(name)                FileSystem 公共操作返回
+ *   block__read(block, count)       DiskSimulator 块读取
+ *   block__write(block, count)      DiskSimulator 块写入
+ *   lock__contended(exclusive)      文件系统读写锁未能立即取得
+ *   lock__acquired(exclusive)       文件系统读写锁已取得
+ *   dentry__hit(parent, name, len)  目录项缓存命中（name 不以 NUL 结尾，按 len 读取）
+ *   dentry__miss(parent, name, len) 目录项缓存未命中
+ *   inode__hit(inode)               inode 缓存命中
+ *   inode__miss(inode)              inode 缓存未命中
+ *   dirsnap__hit(inode)             目录快照命中
+ *   dirsnap__miss(inode)            目录快照未命中，从磁盘加载
+ *   task__enqueue(queue_size)       ThreadPool 任务入队（入队后的队列长度）
+ *   task__dequeue(queue_size)       ThreadPool 任务出队（出队后的队列长度）
+ */
+
+#if !defined(DISKSIM_NO_USDT) && defined(__has_include)
+#if __has_include(<sys/sdt.h>)
+#include <sys/sdt.h>
+#define DISKSIM_USDT_ENABLED 1
+#endif
+#endif
+
+#ifdef DISKSIM_USDT_ENABLED
+#define DISKSIM_PROBE0(name) DTRACE_PROBE(disksim, name)
+#define DISKSIM_PROBE1(name, a1) DTRACE_PROBE1(disksim, name, a1)
+#define DISKSIM_PROBE2(name, a1, a2) DTRACE_PROBE2(disksim, name, a1, a2)
+#define DISKSIM_PROBE3(name, a1, a2, a3) DTRACE_PROBE3(disksim, name, a1, a2, a3)
+#else
+#define DISKSIM_PROBE0(name) \
+    do {                     \
+    } while (0)
+#define DISKSIM_PROBE1(name, a1) \
+    do {                         \
+    } while (0)
+#define DISKSIM_PROBE2(name, a1, a2) \
+    do {                             \
+    } while (0)
+#define DISKSIM_PROBE3(name, a1, a2, a3) \
+    do {                                 \
+    } while (0)
+#endif
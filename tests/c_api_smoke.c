@@ -0,0 +1,105 @@
+/* ==============================================================================
+ * @file   c_api_smoke.c
+ * @brief  libdisksim.so C 接口冒烟测试：由 test_functionality.sh 编译并运行
+ * ==============================================================================
+ *
+ * 用法：c_api_smoke <已格式化的镜像>
+ * 每个检查输出一行 "ok <名称>" 或 "FAIL <名称>: <原因>"，全部通过时退出码为0。
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "api/disksim.h"
+
+static int failures = 0;
+
+static void check(int condition, const char* name, const char* detail) {
+  if (condition) {
+    printf("ok %s\n", name);
+  } else {
+    printf("FAIL %s: %s\n", name, detail);
+    failures++;
+  }
+}
+
+int main(int argc, char** argv) {
+  if (argc != 2) {
+    fprintf(stderr, "usage: %s <image>\n", argv[0]);
+    return 2;
+  }
+  disksim_set_logging(0);
+
+  disksim_fs* fs = NULL;
+  int rc = disksim_mount(argv[1], 0, &fs);
+  check(rc == DISKSIM_OK && fs != NULL, "mount", disksim_strerror(rc));
+  if (fs == NULL) {
+    return 1;
+  }
+  check(disksim_api_version() == DISKSIM_API_VERSION, "api_version", "mismatch");
+
+  rc = disksim_mkdir(fs, "/capi");
+  check(rc == DISKSIM_OK, "mkdir", disksim_strerror(rc));
+  rc = disksim_mkdir(fs, "/capi");
+  check(rc == DISKSIM_E_EXISTS, "mkdir_exists", disksim_strerror(rc));
+
+  const char payload[] = "written through the C API";
+  int fd = disksim_open(fs, "/capi/data.txt", DISKSIM_O_WRITE | DISKSIM_O_CREATE);
+  check(fd >= 0, "open_create", disksim_strerror(fd));
+  rc = disksim_write(fs, fd, payload, sizeof(payload) - 1);
+  check(rc == (int)(sizeof(payload) - 1), "write", disksim_strerror(rc));
+  rc = disksim_close(fs, fd);
+  check(rc == DISKSIM_OK, "close", disksim_strerror(rc));
+
+  char buffer[64] = {0};
+  fd = disksim_open(fs, "/capi/data.txt", DISKSIM_O_READ);
+  check(fd >= 0, "open_read", disksim_strerror(fd));
+  rc = disksim_seek(fs, fd, 16);
+  check(rc == DISKSIM_OK, "seek", disksim_strerror(rc));
+  rc = disksim_read(fs, fd, buffer, sizeof(buffer));
+  check(rc == (int)(sizeof(payload) - 1 - 16) && strcmp(buffer, "the C API") == 0,
+        "read", buffer);
+  disksim_close(fs, fd);
+
+  disksim_stat_t st;
+  rc = disksim_stat(fs, "/capi/data.txt", &st);
+  check(rc == DISKSIM_OK && st.size == sizeof(payload) - 1 &&
+            (st.mode & DISKSIM_S_IFREG) != 0,
+        "stat_file", disksim_strerror(rc));
+  /* data.txt 的尾部在关闭时已打包进共享尾块，类型位仍须恰好是普通文件 */
+  check(rc == DISKSIM_OK && (st.mode & 0xF000) == DISKSIM_S_IFREG,
+        "stat_tail_packed_mode", "internal tail-packed flag leaked into mode");
+  rc = disksim_stat(fs, "/capi", &st);
+  check(rc == DISKSIM_OK && (st.mode & DISKSIM_S_IFDIR) != 0, "stat_dir",
+        disksim_strerror(rc));
+  rc = disksim_stat(fs, "/capi/missing.txt", &st);
+  check(rc == DISKSIM_E_NOT_FOUND, "stat_missing", disksim_strerror(rc));
+
+  /* 先查询条目总数，再按需提供缓冲区 */
+  size_t total = 0;
+  rc = disksim_readdir(fs, "/capi", NULL, 0, &total);
+  check(rc == 0 && total >= 1, "readdir_count", disksim_strerror(rc));
+  disksim_dirent_t entries[8];
+  rc = disksim_readdir(fs, "/capi", entries, 8, &total);
+  int found = 0;
+  for (int i = 0; i < rc; ++i) {
+    if (strcmp(entries[i].name, "data.txt") == 0) {
+      found = 1;
+    }
+  }
+  check(rc == (int)total && found, "readdir", "data.txt not listed");
+
+  rc = disksim_unmount(fs);
+  check(rc == DISKSIM_OK, "unmount", disksim_strerror(rc));
+
+  /* 只读句柄可以读取，但拒绝写入 */
+  rc = disksim_mount(argv[1], DISKSIM_MOUNT_READ_ONLY, &fs);
+  check(rc == DISKSIM_OK, "mount_read_only", disksim_strerror(rc));
+  if (rc == DISKSIM_OK) {
+    rc = disksim_mkdir(fs, "/capi/ro");
+    check(rc == DISKSIM_E_PERMISSION, "read_only_mkdir", disksim_strerror(rc));
+    disksim_unmount(fs);
+  }
+
+  return failures == 0 ? 0 : 1;
+}
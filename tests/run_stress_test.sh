@@ -12,10 +12,11 @@ set -euo pipefail
 : "${WRITE_SIZE:?missing WRITE_SIZE}"
 : "${MONITOR:?missing MONITOR}"
 : "${WORKSPACE:?missing WORKSPACE}"
+CACHE="${CACHE:-warm}"        # warm / cold / both
 
 echo "Preparing stress disk (${DISK_SIZE}MB)"
-rm -f "${DISK}"
-trap 'rm -f "${DISK}"' EXIT
+rm -f "${DISK}" "${DISK}.warm"
+trap 'rm -f "${DISK}" "${DISK}.warm"' EXIT
 
 "${BIN}" "${DISK}" create "${DISK_SIZE}"
 "${BIN}" "${DISK}" format
@@ -40,6 +41,7 @@ stdbuf -oL "${BIN}" "${DISK}" stress \
   --write-size "${WRITE_SIZE}" \
   --monitor "${MONITOR}" \
   --workspace "${WORKSPACE}" \
+  --cache "${CACHE}" \
   --cleanup 2>&1 \
   | tee "${log_file}" \
   | stdbuf -oL grep -E --line-buffered '\[Stress\] (Starting|Metrics|Test finished)'
@@ -4,6 +4,17 @@ set -o pipefail
 
 EXECUTABLE="./disk_sim"
 DISK_FILE="test_functionality.img"
+LOG_DISK_FILE="test_functionality_log.img"
+MOUNT_DISK_FILE="test_functionality_mnt.img"
+SHARD_DISK_FILE="test_functionality_shards.img"
+STRIPE_DISK_FILE="test_functionality_stripe.img"
+MIRROR_DISK_FILE="test_functionality_mirror.img"
+CHECKSUM_DISK_FILE="test_functionality_crc.img"
+API_DISK_FILE="test_functionality_api.img"
+ARCHIVE_FILE="test_functionality.dsia"
+IMPORT_DISK_FILE="test_functionality_import.img"
+TIER_DISK_FILE="test_functionality_tier.img"
+API_SMOKE_BIN="./tests/c_api_smoke"
 
 TOTAL_TESTS=0
 FAILED_TESTS=0
@@ -121,7 +132,7 @@ ensure_build() {
 
 prepare_environment() {
   print_heading "Environment Setup"
-  rm -f "$DISK_FILE"
+  rm -f "$DISK_FILE" "$DISK_FILE.nameidx" "$DISK_FILE.mounts" "$DISK_FILE.warm"
   run_expect_success "Create 10MB disk" "Disk created successfully" $EXECUTABLE "$DISK_FILE" create 10
   run_expect_success "Format disk" "Disk formatted successfully" $EXECUTABLE "$DISK_FILE" format
 }
@@ -129,7 +140,15 @@ prepare_environment() {
 cleanup_environment() {
   print_heading "Environment Cleanup"
   make clean >/dev/null 2>&1
-  rm -f "$DISK_FILE"
+  rm -f "$DISK_FILE" "$DISK_FILE.nameidx" "$DISK_FILE.mounts" "$LOG_DISK_FILE" "$MOUNT_DISK_FILE"
+  rm -f ./*.img.warm
+  rm -f "$SHARD_DISK_FILE" "$SHARD_DISK_FILE".shard*
+  rm -f "$STRIPE_DISK_FILE" "$STRIPE_DISK_FILE".stripe*
+  rm -f "$MIRROR_DISK_FILE" "$MIRROR_DISK_FILE".mirror*
+  rm -f "$CHECKSUM_DISK_FILE"
+  rm -f "$API_DISK_FILE" "$API_SMOKE_BIN"
+  rm -f "$ARCHIVE_FILE" "$IMPORT_DISK_FILE" "$IMPORT_DISK_FILE".stripe*
+  rm -f "$TIER_DISK_FILE" "$TIER_DISK_FILE".tier "$TIER_DISK_FILE".fast
   echo "Cleanup complete."
 }
 
@@ -150,6 +169,450 @@ test_basic_operations() {
   run_expect_success "List /docs/logs" "./" $EXECUTABLE "$DISK_FILE" ls /docs/logs
 }
 
+test_search() {
+  print_heading "Find and Grep"
+  run_expect_success "Find by name" "/docs/readme.txt" $EXECUTABLE "$DISK_FILE" find / -name '*.txt'
+  run_expect_success "Find by size" "/docs/readme.txt" $EXECUTABLE "$DISK_FILE" find /docs -size +10c
+  run_expect_success "Grep content" "/docs/readme.txt:1:Disk simulator functional test" $EXECUTABLE "$DISK_FILE" grep functional /docs
+  run_expect_failure "Find missing directory" "Directory not found" $EXECUTABLE "$DISK_FILE" find /ghost -name '*'
+}
+
+test_name_index() {
+  print_heading "Name Index"
+  run_expect_failure "Locate without index" "Name index is not enabled" $EXECUTABLE "$DISK_FILE" locate readme.txt
+  run_expect_success "Build name index" "Name index built" $EXECUTABLE "$DISK_FILE" locate --build
+  run_expect_success "Locate indexed file" "/docs/readme.txt" $EXECUTABLE "$DISK_FILE" locate readme.txt
+  run_expect_success "Create file after build" "File created" $EXECUTABLE "$DISK_FILE" touch /docs/logs/trace.log
+  run_expect_success "Index tracks new file" "/docs/logs/trace.log" $EXECUTABLE "$DISK_FILE" locate trace.log
+  run_expect_success "Remove indexed file" "Removed" $EXECUTABLE "$DISK_FILE" rm /docs/logs/trace.log
+  run_expect_failure "Index drops removed file" "No entries named" $EXECUTABLE "$DISK_FILE" locate trace.log
+}
+
+test_log_structured() {
+  print_heading "Log-Structured Device"
+  rm -f "$LOG_DISK_FILE"
+  run_expect_success "Create log-structured disk" "log-structured" $EXECUTABLE "$LOG_DISK_FILE" create 64 --log-structured --segment-blocks 32
+  run_expect_success "Format log-structured disk" "Disk formatted successfully" $EXECUTABLE "$LOG_DISK_FILE" format
+  run_expect_success "Write on log-structured disk" "Written to file" $EXECUTABLE "$LOG_DISK_FILE" echo 'appended to the log' \> /log.txt
+  run_expect_success "Read back after remount" "appended to the log" $EXECUTABLE "$LOG_DISK_FILE" cat /log.txt
+  run_expect_success "Stats report log mode" "Mode: log-structured" $EXECUTABLE "$LOG_DISK_FILE" stats
+
+  # 写满若干个段：每次封存段的检查点只应重写变化的映射块，而不是整张映射表
+  local big batch="" i output checkpoints blocks map_blocks
+  big=$(head -c 5000 /dev/zero | tr '\0' l)
+  for i in $(seq 1 40); do
+    batch+="echo $big > /seg$i\n"
+  done
+  output=$(printf "%b" "${batch}stats\nexit\n" | $EXECUTABLE "$LOG_DISK_FILE" run 2>&1)
+  map_blocks=$(sed -n 's/.*map \([0-9]*\) blocks.*/\1/p' <<< "$output" | head -1)
+  blocks=$(sed -n 's/.* \([0-9]*\) checkpoint blocks in \([0-9]*\) checkpoints.*/\1/p' <<< "$output" | head -1)
+  checkpoints=$(sed -n 's/.* checkpoint blocks in \([0-9]*\) checkpoints.*/\1/p' <<< "$output" | head -1)
+  ((TOTAL_TESTS++))
+  if [ -n "$blocks" ] && [ "${checkpoints:-0}" -ge 4 ] && [ "${map_blocks:-0}" -gt 4 ] &&
+     [ "$blocks" -le $((checkpoints * 3)) ]; then
+    print_result 0 "Checkpoints write only dirty map blocks" "" "$blocks blocks in $checkpoints checkpoints (map $map_blocks blocks)"
+  else
+    print_result 1 "Checkpoints write only dirty map blocks" "$output" "$blocks blocks in $checkpoints checkpoints (map $map_blocks blocks)"
+  fi
+  run_expect_success "Segments read back after remount" "$big" $EXECUTABLE "$LOG_DISK_FILE" cat /seg40
+  run_expect_success "Stats report plain mode" "Mode: plain" $EXECUTABLE "$DISK_FILE" stats
+  run_expect_failure "Reject unknown create option" "Unknown create option" $EXECUTABLE "$LOG_DISK_FILE" create 10 --bogus
+}
+
+test_mount_table() {
+  print_heading "Mount Table"
+  rm -f "$MOUNT_DISK_FILE"
+  run_expect_success "Create image to mount" "Disk created successfully" $EXECUTABLE "$MOUNT_DISK_FILE" create 5
+  run_expect_success "Format image to mount" "Disk formatted successfully" $EXECUTABLE "$MOUNT_DISK_FILE" format
+  run_expect_success "Create mount point" "Directory created" $EXECUTABLE "$DISK_FILE" mkdir /mnt
+  run_expect_success "Mount image on /mnt" "Mounted" $EXECUTABLE "$DISK_FILE" mount "$MOUNT_DISK_FILE" /mnt
+  run_expect_success "List mounts" "on /mnt" $EXECUTABLE "$DISK_FILE" mount
+  run_expect_success "Write through mount" "Written to file" $EXECUTABLE "$DISK_FILE" echo 'stored on second image' \> /mnt/note.txt
+  run_expect_success "Read through mount" "stored on second image" $EXECUTABLE "$DISK_FILE" cat /mnt/note.txt
+  run_expect_success "Copy across mounts" "File copied" $EXECUTABLE "$DISK_FILE" copy /mnt/note.txt /docs/note.txt
+  run_expect_success "Mounted image holds file" "stored on second image" $EXECUTABLE "$MOUNT_DISK_FILE" cat /note.txt
+  run_expect_failure "Reject overlapping mount" "overlaps" $EXECUTABLE "$DISK_FILE" mount "$LOG_DISK_FILE" /mnt
+  run_expect_success "Unmount /mnt" "Unmounted" $EXECUTABLE "$DISK_FILE" umount /mnt
+  run_expect_failure "File gone after unmount" "File not found" $EXECUTABLE "$DISK_FILE" cat /mnt/note.txt
+  run_expect_success "Remove mount point" "Removed" $EXECUTABLE "$DISK_FILE" rm /mnt
+  run_expect_success "Remove copied note" "Removed" $EXECUTABLE "$DISK_FILE" rm /docs/note.txt
+}
+
+test_sharded_namespace() {
+  print_heading "Sharded Namespace"
+  rm -f "$SHARD_DISK_FILE" "$SHARD_DISK_FILE".shard*
+  run_expect_success "Create 3-way shard set" "3 shards" $EXECUTABLE "$SHARD_DISK_FILE" create 5 --shards 3
+  run_expect_success "Format shard set" "Disk formatted successfully" $EXECUTABLE "$SHARD_DISK_FILE" format
+  local dir
+  for dir in alpha beta gamma delta; do
+    $EXECUTABLE "$SHARD_DISK_FILE" mkdir /$dir >/dev/null 2>&1
+    $EXECUTABLE "$SHARD_DISK_FILE" echo "in-$dir" \> /$dir/file.txt >/dev/null 2>&1
+  done
+  run_expect_success "Merged root listing" "delta" $EXECUTABLE "$SHARD_DISK_FILE" ls /
+  run_expect_success "Read file on its shard" "in-gamma" $EXECUTABLE "$SHARD_DISK_FILE" cat /gamma/file.txt
+  run_expect_success "Find across shards" "/alpha/file.txt" $EXECUTABLE "$SHARD_DISK_FILE" find / -name 'file.txt'
+
+  local holders=0
+  local shard
+  for shard in "$SHARD_DISK_FILE".shard*; do
+    if $EXECUTABLE "$shard" cat /beta/file.txt 2>/dev/null | grep -q "in-beta"; then
+      holders=$((holders + 1))
+    fi
+  done
+  ((TOTAL_TESTS++))
+  if [ "$holders" -eq 1 ]; then
+    print_result 0 "File stored on exactly one shard" "" "Shards holding /beta/file.txt: $holders"
+  else
+    print_result 1 "File stored on exactly one shard" "" "Shards holding /beta/file.txt: $holders (expected 1)"
+  fi
+
+  run_expect_failure "Remove non-empty sharded dir" "Directory not empty" $EXECUTABLE "$SHARD_DISK_FILE" rm /beta
+  run_expect_success "Remove sharded file" "Removed" $EXECUTABLE "$SHARD_DISK_FILE" rm /beta/file.txt
+  run_expect_success "Remove empty sharded dir" "Removed" $EXECUTABLE "$SHARD_DISK_FILE" rm /beta
+
+  local replicas=0
+  for shard in "$SHARD_DISK_FILE".shard*; do
+    if $EXECUTABLE "$shard" ls /beta >/dev/null 2>&1; then
+      replicas=$((replicas + 1))
+    fi
+  done
+  ((TOTAL_TESTS++))
+  if [ "$replicas" -eq 0 ]; then
+    print_result 0 "Removed dir gone from every shard" "" "Shards still holding /beta: $replicas"
+  else
+    print_result 1 "Removed dir gone from every shard" "" "Shards still holding /beta: $replicas (expected 0)"
+  fi
+
+  run_expect_success "Create nested sharded dir" "Directory created" $EXECUTABLE "$SHARD_DISK_FILE" mkdir /gamma/sub
+  run_expect_success "Listing shows files" "file.txt" $EXECUTABLE "$SHARD_DISK_FILE" ls /gamma
+  run_expect_success "Listing shows subdirs" "sub" $EXECUTABLE "$SHARD_DISK_FILE" ls /gamma
+  run_expect_success "Remove nested sharded dir" "Removed" $EXECUTABLE "$SHARD_DISK_FILE" rm /gamma/sub
+}
+
+test_striped_device() {
+  print_heading "Striped Device"
+  rm -f "$STRIPE_DISK_FILE" "$STRIPE_DISK_FILE".stripe*
+  run_expect_success "Create 3-way striped disk" "striped x3" $EXECUTABLE "$STRIPE_DISK_FILE" create 6 --stripe 3 --stripe-unit 4
+  run_expect_success "Format striped disk" "Disk formatted successfully" $EXECUTABLE "$STRIPE_DISK_FILE" format
+
+  local payload
+  payload=$(head -c 30000 /dev/zero | tr '\0' 's')
+  local output
+  output=$($EXECUTABLE "$STRIPE_DISK_FILE" echo "$payload" \> /wide.txt 2>&1)
+  ((TOTAL_TESTS++))
+  if [[ "$output" == *"Written to file"* ]]; then
+    print_result 0 "Write multi-stripe file" "" "Command: $EXECUTABLE $STRIPE_DISK_FILE echo <30000 bytes> > /wide.txt"
+  else
+    print_result 1 "Write multi-stripe file" "$output" "Expected substring: Written to file"
+  fi
+  run_expect_success "Copy multi-stripe file" "File copied" $EXECUTABLE "$STRIPE_DISK_FILE" copy /wide.txt /wide2.txt
+
+  output=$($EXECUTABLE "$STRIPE_DISK_FILE" cat /wide2.txt 2>&1)
+  ((TOTAL_TESTS++))
+  if [ "$output" = "$payload" ]; then
+    print_result 0 "Read back striped copy" "" "30000 bytes across 3 members"
+  else
+    print_result 1 "Read back striped copy" "${output:0:200}" "Content mismatch"
+  fi
+
+  run_expect_success "Stats report striped mode" "Mode: striped (3 members, unit 4 blocks)" $EXECUTABLE "$STRIPE_DISK_FILE" stats
+  run_expect_failure "Reject single-member stripe" "Invalid stripe width" $EXECUTABLE "$STRIPE_DISK_FILE" create 6 --stripe 1
+  mv "$STRIPE_DISK_FILE.stripe2" "$STRIPE_DISK_FILE.stripe2.bak"
+  run_expect_failure "Refuse to open incomplete stripe set" "stripe2" $EXECUTABLE "$STRIPE_DISK_FILE" ls /
+  mv "$STRIPE_DISK_FILE.stripe2.bak" "$STRIPE_DISK_FILE.stripe2"
+}
+
+test_mirrored_device() {
+  print_heading "Mirrored Device"
+  rm -f "$MIRROR_DISK_FILE" "$MIRROR_DISK_FILE".mirror*
+  run_expect_success "Create 2-way mirrored disk" "mirrored x2" $EXECUTABLE "$MIRROR_DISK_FILE" create 6 --mirror 2
+  run_expect_success "Format mirrored disk" "Disk formatted successfully" $EXECUTABLE "$MIRROR_DISK_FILE" format
+  run_expect_success "Write on mirrored disk" "Written to file" $EXECUTABLE "$MIRROR_DISK_FILE" echo 'on both members' \> /both.txt
+  run_expect_success "Stats report mirror in sync" "2 in sync" $EXECUTABLE "$MIRROR_DISK_FILE" stats
+
+  mv "$MIRROR_DISK_FILE.mirror1" "$MIRROR_DISK_FILE.mirror1.bak"
+  run_expect_success "Write with member offline" "Written to file" $EXECUTABLE "$MIRROR_DISK_FILE" echo 'written while degraded' \> /degraded.txt
+  run_expect_success "Stats report offline member" "Offline members: 1" $EXECUTABLE "$MIRROR_DISK_FILE" stats
+  mv "$MIRROR_DISK_FILE.mirror1.bak" "$MIRROR_DISK_FILE.mirror1"
+
+  run_expect_success "Resync on member return" "on both members" $EXECUTABLE "$MIRROR_DISK_FILE" cat /both.txt
+  run_expect_success "Member back in sync" "2 in sync" $EXECUTABLE "$MIRROR_DISK_FILE" stats
+  ((TOTAL_TESTS++))
+  if cmp -s -i 4096 "$MIRROR_DISK_FILE" "$MIRROR_DISK_FILE.mirror1"; then
+    print_result 0 "Members identical after resync" "" "Data and change map match"
+  else
+    print_result 1 "Members identical after resync" "$(cmp -i 4096 "$MIRROR_DISK_FILE" "$MIRROR_DISK_FILE.mirror1" 2>&1)" "Member contents differ"
+  fi
+  run_expect_success "Read degraded write after resync" "written while degraded" $EXECUTABLE "$MIRROR_DISK_FILE" cat /degraded.txt
+
+  # 模拟崩溃：可写打开期间被强制终止，并让成员1的一个数据块与成员0不一致
+  (echo "echo 'before crash' > /crash.txt"; sleep 5) | $EXECUTABLE "$MIRROR_DISK_FILE" run >/dev/null 2>&1 &
+  local pid=$!
+  sleep 1
+  kill -9 "$pid" 2>/dev/null
+  wait "$pid" 2>/dev/null
+  printf 'torn' | dd of="$MIRROR_DISK_FILE.mirror1" bs=1 seek=$((4096 * 300)) conv=notrunc 2>/dev/null
+  run_expect_success "Detect unclean shutdown" "not shut down cleanly" $EXECUTABLE "$MIRROR_DISK_FILE" stats
+  # 每次关闭都会中断重同步并保存进度，后续打开从中断处继续
+  local attempt
+  for attempt in $(seq 1 20); do
+    $EXECUTABLE "$MIRROR_DISK_FILE" stats 2>&1 | grep -q "2 in sync" && break
+  done
+  run_expect_success "Interrupted resync resumes to completion" "2 in sync" $EXECUTABLE "$MIRROR_DISK_FILE" stats
+  ((TOTAL_TESTS++))
+  if cmp -s -i 4096 "$MIRROR_DISK_FILE" "$MIRROR_DISK_FILE.mirror1"; then
+    print_result 0 "Members identical after crash resync" "" "Diverged block repaired from member 0"
+  else
+    print_result 1 "Members identical after crash resync" "$(cmp -i 4096 "$MIRROR_DISK_FILE" "$MIRROR_DISK_FILE.mirror1" 2>&1)" "Member contents differ"
+  fi
+  run_expect_success "Read write made before crash" "before crash" $EXECUTABLE "$MIRROR_DISK_FILE" cat /crash.txt
+  run_expect_failure "Reject stripe plus mirror" "cannot be combined" $EXECUTABLE "$MIRROR_DISK_FILE" create 6 --mirror 2 --stripe 2
+}
+
+test_read_only_mount() {
+  print_heading "Read-only Mount"
+  local before after
+  before=$(md5sum < "$DISK_FILE")
+  run_expect_success "Read-only cat" "Disk simulator functional test" $EXECUTABLE "$DISK_FILE" --read-only cat /docs/readme.txt
+  after=$(md5sum < "$DISK_FILE")
+  ((TOTAL_TESTS++))
+  if [ "$before" == "$after" ]; then
+    print_result 0 "Image untouched by read-only reads" "" "No access-time or metadata writes"
+  else
+    print_result 1 "Image untouched by read-only reads" "" "Image checksum changed"
+  fi
+
+  # 后台只读 shell 持有共享锁期间，另一个只读进程应能立即挂载
+  (printf 'cat /docs/readme.txt\n'; sleep 2; printf 'exit\n') | $EXECUTABLE "$DISK_FILE" --read-only run >/dev/null 2>&1 &
+  local reader=$!
+  sleep 0.5
+  run_expect_success "Concurrent read-only reader" "readme.txt" timeout 5 $EXECUTABLE "$DISK_FILE" --read-only ls /docs
+  wait "$reader"
+
+  run_expect_failure "Reject write on read-only mount" "mounted read-only" $EXECUTABLE "$DISK_FILE" --read-only touch /docs/ro.txt
+  run_expect_failure "Reject format with --read-only" "cannot be used with --read-only" $EXECUTABLE "$DISK_FILE" --read-only format
+}
+
+test_checksums() {
+  print_heading "Block Checksums"
+  rm -f "$CHECKSUM_DISK_FILE"
+  run_expect_success "Create checksummed disk" "checksummed" $EXECUTABLE "$CHECKSUM_DISK_FILE" create 6 --checksums
+  run_expect_success "Format checksummed disk" "Disk formatted successfully" $EXECUTABLE "$CHECKSUM_DISK_FILE" format
+  run_expect_success "Write on checksummed disk" "Written to file" $EXECUTABLE "$CHECKSUM_DISK_FILE" echo 'checksum payload marker' \> /crc.txt
+  run_expect_success "Stats report checksum layer" "verify strict" $EXECUTABLE "$CHECKSUM_DISK_FILE" stats
+  run_expect_success "Scrub clean image" "0 corrupted" $EXECUTABLE "$CHECKSUM_DISK_FILE" scrub
+
+  # 在镜像文件中直接改写文件数据的一个字节，模拟静默损坏
+  local offset
+  offset=$(grep -obUa 'checksum payload marker' "$CHECKSUM_DISK_FILE" | head -1 | cut -d: -f1)
+  printf 'X' | dd of="$CHECKSUM_DISK_FILE" bs=1 seek="$offset" conv=notrunc 2>/dev/null
+  run_expect_failure "Scrub detects corruption" "1 corrupted" $EXECUTABLE "$CHECKSUM_DISK_FILE" scrub
+  run_expect_failure "Strict read rejects corrupt block" "Checksum mismatch" $EXECUTABLE "$CHECKSUM_DISK_FILE" cat /crc.txt
+  run_expect_success "Switch verify policy to warn" "Verify policy set to warn" $EXECUTABLE "$CHECKSUM_DISK_FILE" scrub --verify warn
+  run_expect_success "Warn read returns data" "hecksum payload marker" $EXECUTABLE "$CHECKSUM_DISK_FILE" cat /crc.txt
+
+  rm -f "$CHECKSUM_DISK_FILE"
+  run_expect_success "Create log-structured checksummed disk" "log-structured, checksummed" $EXECUTABLE "$CHECKSUM_DISK_FILE" create 6 --log-structured --checksums
+  run_expect_success "Format log-structured checksummed disk" "Disk formatted successfully" $EXECUTABLE "$CHECKSUM_DISK_FILE" format
+  run_expect_success "Write on log-structured checksummed disk" "Written to file" $EXECUTABLE "$CHECKSUM_DISK_FILE" echo 'logged and summed' \> /lfs.txt
+  run_expect_success "Read on log-structured checksummed disk" "logged and summed" $EXECUTABLE "$CHECKSUM_DISK_FILE" cat /lfs.txt
+  run_expect_success "Scrub log-structured checksummed disk" "0 corrupted" $EXECUTABLE "$CHECKSUM_DISK_FILE" scrub
+  run_expect_failure "Reject scrub without checksums" "created without --checksums" $EXECUTABLE "$DISK_FILE" scrub
+  run_expect_failure "Reject --verify without --checksums" "--verify requires --checksums" $EXECUTABLE "$CHECKSUM_DISK_FILE" create 6 --verify warn
+}
+
+test_c_api() {
+  print_heading "Shared Library C API"
+  local output
+  output=$(make -j4 lib 2>&1 && cc -std=c99 -Wall -Wextra -I./src tests/c_api_smoke.c \
+    -L. -ldisksim -Wl,-rpath,"$PWD" -o "$API_SMOKE_BIN" 2>&1)
+  local status=$?
+  ((TOTAL_TESTS++))
+  if [ $status -ne 0 ] || [ ! -x "$API_SMOKE_BIN" ]; then
+    print_result 1 "Build libdisksim.so and C client" "$output" "Library or client failed to build"
+    return
+  fi
+  print_result 0 "Build libdisksim.so and C client" "" "Linked against libdisksim.so"
+
+  rm -f "$API_DISK_FILE"
+  $EXECUTABLE "$API_DISK_FILE" create 6 >/dev/null 2>&1 && $EXECUTABLE "$API_DISK_FILE" format >/dev/null 2>&1
+  output=$("$API_SMOKE_BIN" "$API_DISK_FILE" 2>&1)
+  status=$?
+  ((TOTAL_TESTS++))
+  if [ $status -eq 0 ] && ! grep -q "^FAIL" <<< "$output"; then
+    print_result 0 "C API smoke test" "" "$(grep -c '^ok' <<< "$output") checks passed"
+  else
+    print_result 1 "C API smoke test" "$output" "$(grep '^FAIL' <<< "$output" | head -1)"
+  fi
+  run_expect_success "CLI reads file written via C API" "written through the C API" $EXECUTABLE "$API_DISK_FILE" cat /capi/data.txt
+  run_expect_success "C API stat covered a tail-packed file" "Packed Tails: 1 files" $EXECUTABLE "$API_DISK_FILE" info
+}
+
+test_slow_op_watchdog() {
+  print_heading "Slow Operation Watchdog"
+  run_expect_success "Slowlog is off by default" "Slow operation watchdog: off" $EXECUTABLE $DISK_FILE slowlog
+  run_expect_success "Env threshold reports slow write" "Slow operation: write_file" env DISKSIM_SLOW_OP_MS=0.001 $EXECUTABLE $DISK_FILE echo 'watchdog payload' \> /slow.txt
+  run_expect_success "Slow report includes phase breakdown" "data I/O" env DISKSIM_SLOW_OP_MS=0.001 $EXECUTABLE $DISK_FILE cat /slow.txt
+  run_cli_batch "Slowlog command sets threshold" "Slow operation: create_directory /slowdir" "slowlog 0.001\nmkdir /slowdir\nslowlog off\nexit\n"
+  run_cli_batch "Slowlog lists recent reports" "Slow operation: list_directory /slowdir" "slowlog 0.001\nls /slowdir\nslowlog off\nslowlog\nexit\n"
+  run_expect_failure "Reject invalid slowlog threshold" "Invalid threshold" $EXECUTABLE $DISK_FILE slowlog fast
+  $EXECUTABLE $DISK_FILE rm /slow.txt >/dev/null 2>&1
+  $EXECUTABLE $DISK_FILE rm /slowdir >/dev/null 2>&1
+}
+
+test_memory_accounting() {
+  print_heading "Memory Accounting"
+  run_expect_success "Stats report memory accounting" "Memory Accounting:" $EXECUTABLE $DISK_FILE stats
+  run_expect_success "Stats report bitmap memory" "bitmaps" $EXECUTABLE $DISK_FILE stats
+  run_cli_batch "Stats track directory snapshots" "directories" "ls /\nstats\nexit\n"
+  run_expect_success "Stats report process RSS" "Process RSS(MB): current=" $EXECUTABLE $DISK_FILE stats
+}
+
+test_cache_modes() {
+  print_heading "Cold and Warm Cache Modes"
+  run_expect_success "Stress reports cold phase" "Completed (cold)" $EXECUTABLE $DISK_FILE stress --duration 1 --files 4 --threads 2 --monitor 1 --workspace /cache_modes --cache both --cleanup
+  run_expect_success "Stress reports warm phase" "Completed (warm)" $EXECUTABLE $DISK_FILE stress --duration 1 --files 4 --threads 2 --monitor 1 --workspace /cache_modes --cache both --cleanup
+  run_expect_failure "Stress rejects unknown cache mode" "expected warm, cold or both" $EXECUTABLE $DISK_FILE stress --cache hot
+  run_expect_success "Stats report access hint" "Access hint:" $EXECUTABLE $DISK_FILE stats
+}
+
+test_warm_set() {
+  print_heading "Persisted Warm Set"
+  run_expect_success "Populate caches" "readme.txt" $EXECUTABLE $DISK_FILE ls /docs
+  run_expect_success "Warm set written at unmount" "$DISK_FILE.warm" ls "$DISK_FILE.warm"
+  run_expect_success "Warm set loaded at mount" "Warm set: $DISK_FILE.warm | loaded" $EXECUTABLE $DISK_FILE stats
+  run_expect_success "Warm set can be disabled" "disabled" env DISKSIM_WARM_SET=0 $EXECUTABLE $DISK_FILE stats
+}
+
+test_defrag() {
+  print_heading "Online Defragmentation"
+  # 交替扩展两个文件，使两者的数据块相互穿插（关闭尾部打包以固定块布局）
+  local small big interleave
+  small=$(head -c 3000 /dev/zero | tr '\0' s)
+  big=$(head -c 9000 /dev/zero | tr '\0' b)
+  interleave="mkdir /frag\necho $small > /frag/a\necho $small > /frag/b\necho $big > /frag/a\necho $big > /frag/b\nexit\n"
+  DISKSIM_TAIL_PACKING=0 run_cli_batch "Create interleaved files" "disk-sim>" "$interleave"
+  run_expect_success "Defrag moves fragmented files" "2 defragmented, 0 skipped" $EXECUTABLE $DISK_FILE defrag /frag
+  run_expect_success "Contents survive defrag" "$big" $EXECUTABLE $DISK_FILE cat /frag/a
+  run_expect_success "Second pass finds nothing" "0 fragmented" $EXECUTABLE $DISK_FILE defrag /frag
+  run_cli_batch "Background defrag starts and stops" "Defrag: idle" "defrag --background\ndefrag --stop\ndefrag --status\nexit\n"
+  run_expect_failure "Defrag refused on read-only mount" "read-only" $EXECUTABLE $DISK_FILE --read-only defrag
+  run_expect_success "Remove defrag files" "Removed" $EXECUTABLE $DISK_FILE rm /frag/a
+  run_expect_success "Remove defrag files" "Removed" $EXECUTABLE $DISK_FILE rm /frag/b
+  run_expect_success "Remove defrag directory" "Removed" $EXECUTABLE $DISK_FILE rm /frag
+}
+
+test_tail_packing() {
+  print_heading "Tail Packing"
+  local grown
+  grown=$(head -c 5000 /dev/zero | tr '\0' g)
+  run_cli_batch "Create small files" "disk-sim>" "mkdir /tails\necho tail-one > /tails/one\necho tail-two > /tails/two\necho tail-three > /tails/three\nexit\n"
+  run_expect_success "Info reports packed tails" "Packed Tails:" $EXECUTABLE $DISK_FILE info
+  run_expect_success "Packed tail reads back" "tail-two" $EXECUTABLE $DISK_FILE cat /tails/two
+  run_cli_batch "Grow packed file" "Written to file" "echo $grown > /tails/one\nexit\n"
+  run_expect_success "Grown file reads back" "$grown" $EXECUTABLE $DISK_FILE cat /tails/one
+  run_expect_success "Neighbour tail intact after unpack" "tail-three" $EXECUTABLE $DISK_FILE cat /tails/three
+  # 只改写前面私有块的写入不搬动尾部：关闭打包后改写文件开头，打包的尾部仍然保留
+  local head_only packed_before
+  head_only=$(head -c 4200 /dev/zero | tr '\0' h)
+  run_cli_batch "Create two-block file" "Written to file" "echo $head_only > /tails/two-block\nexit\n"
+  packed_before=$($EXECUTABLE $DISK_FILE info | grep "Packed Tails")
+  DISKSIM_TAIL_PACKING=0 run_cli_batch "Overwrite head of packed file" "Written to file" "echo HEAD > /tails/two-block\nexit\n"
+  run_expect_success "Head write leaves tail packed" "$packed_before" $EXECUTABLE $DISK_FILE info
+  run_expect_success "Head write reads back" "HEADhhhh" $EXECUTABLE $DISK_FILE cat /tails/two-block
+  run_expect_success "Remove packed files" "Removed" $EXECUTABLE $DISK_FILE rm /tails/two-block
+  run_expect_success "Defrag keeps shared tails" "0 skipped" $EXECUTABLE $DISK_FILE defrag /tails
+  run_expect_success "Remove packed files" "Removed" $EXECUTABLE $DISK_FILE rm /tails/one
+  run_expect_success "Remove packed files" "Removed" $EXECUTABLE $DISK_FILE rm /tails/two
+  run_expect_success "Remove packed files" "Removed" $EXECUTABLE $DISK_FILE rm /tails/three
+  run_expect_success "Remove tails directory" "Removed" $EXECUTABLE $DISK_FILE rm /tails
+}
+
+test_copy_tree() {
+  print_heading "Recursive Copy"
+  local setup="mkdir /tree\nmkdir /tree/sub\necho top-file > /tree/top\necho nested-file > /tree/sub/nested\n"
+  local cleanup="" i
+  # 20个条目超出一个目录块，检验目录扩展后的块指针被持久化
+  for i in $(seq 1 20); do
+    setup+="touch /tree/sub/f$i\n"
+    cleanup+="rm /tree/sub/f$i\nrm /tree_copy/sub/f$i\n"
+  done
+  run_cli_batch "Create source tree" "disk-sim>" "${setup}exit\n"
+  run_expect_success "Large directory survives remount" "f20" $EXECUTABLE $DISK_FILE ls /tree/sub
+  run_expect_success "Copy tree in parallel" "Copied 2 directories, 22 files" $EXECUTABLE $DISK_FILE cp -r /tree /tree_copy --jobs 2
+  run_expect_success "Copied file contents" "nested-file" $EXECUTABLE $DISK_FILE cat /tree_copy/sub/nested
+  run_expect_success "Copied large directory" "f20" $EXECUTABLE $DISK_FILE ls /tree_copy/sub
+  run_expect_failure "Copy tree into itself rejected" "into itself" $EXECUTABLE $DISK_FILE cp -r /tree /tree/sub
+  run_expect_failure "Copy tree rejects bad jobs" "Invalid --jobs" $EXECUTABLE $DISK_FILE cp -r /tree /other --jobs 0
+  cleanup+="rm /tree/top\nrm /tree/sub/nested\nrm /tree/sub\nrm /tree\n"
+  cleanup+="rm /tree_copy/top\nrm /tree_copy/sub/nested\nrm /tree_copy/sub\nrm /tree_copy\n"
+  run_cli_batch "Remove copied trees" "Removed: /tree_copy" "${cleanup}exit\n"
+}
+
+test_image_archive() {
+  print_heading "Image Archive"
+  rm -f "$ARCHIVE_FILE" "$IMPORT_DISK_FILE" "$IMPORT_DISK_FILE".stripe*
+  run_cli_batch "Populate image for export" "disk-sim>" "mkdir /archived\necho kept-in-archive > /archived/note\nexit\n"
+  run_expect_success "Export allocated blocks" "Exported" $EXECUTABLE "$DISK_FILE" export-image "$ARCHIVE_FILE"
+  run_expect_success "Import archive" "Imported" $EXECUTABLE "$IMPORT_DISK_FILE" import-image "$ARCHIVE_FILE"
+  run_expect_success "Imported file contents" "kept-in-archive" $EXECUTABLE "$IMPORT_DISK_FILE" cat /archived/note
+  run_expect_success "Export compressed archive" "compressed" $EXECUTABLE "$DISK_FILE" export-image "$ARCHIVE_FILE" --compress
+  run_expect_success "Import into striped image" "Imported" $EXECUTABLE "$IMPORT_DISK_FILE" import-image "$ARCHIVE_FILE" --stripe 2
+  run_expect_success "Striped import contents" "kept-in-archive" $EXECUTABLE "$IMPORT_DISK_FILE" cat /archived/note
+  ((TOTAL_TESTS++))
+  local piped
+  piped=$($EXECUTABLE "$DISK_FILE" export-image - --compress 2>/dev/null | $EXECUTABLE "$IMPORT_DISK_FILE" import-image - 2>&1)
+  if echo "$piped" | grep -q "Imported"; then
+    print_result 0 "Stream archive through a pipe" "" "export-image - | import-image -"
+  else
+    print_result 1 "Stream archive through a pipe" "$piped" "Pipe import failed"
+  fi
+  run_expect_failure "Reject block-count changing import" "block count" $EXECUTABLE "$IMPORT_DISK_FILE" import-image "$ARCHIVE_FILE" --checksums
+  head -c 100 "$ARCHIVE_FILE" > "$ARCHIVE_FILE.part"
+  run_expect_failure "Reject truncated archive" "truncated or corrupt" $EXECUTABLE "$IMPORT_DISK_FILE" import-image "$ARCHIVE_FILE.part"
+  rm -f "$ARCHIVE_FILE" "$ARCHIVE_FILE.part" "$IMPORT_DISK_FILE" "$IMPORT_DISK_FILE".stripe*
+  run_cli_batch "Remove archived files" "Removed: /archived" "rm /archived/note\nrm /archived\nexit\n"
+}
+
+test_heatmap() {
+  print_heading "Block Heat Map"
+  run_expect_success "Heat map off by default" "Block Heat Map: off" $EXECUTABLE $DISK_FILE heatmap
+  local batch="heatmap on\nmkdir /heat\ntouch /heat/a\ntouch /heat/b\nls /heat\nheatmap\nexit\n"
+  run_cli_batch "Heat map tracks inode table" "Inode table block 0 (block 1)" "$batch"
+  run_cli_batch "Heat map reports access pattern" "% random" "heatmap on\ncat /heat/a\nheatmap\nexit\n"
+  DISKSIM_HEATMAP=1 run_expect_success "Heat map enabled from environment" "Tracking: on" $EXECUTABLE $DISK_FILE heatmap
+  run_cli_batch "Heat map reset clears counters" "(none)" "heatmap on\nls /heat\nheatmap reset\nheatmap\nexit\n"
+  run_expect_failure "Heat map rejects unknown action" "Usage: heatmap" $EXECUTABLE $DISK_FILE heatmap bogus
+  run_cli_batch "Remove heat map files" "Removed: /heat" "rm /heat/a\nrm /heat/b\nrm /heat\nexit\n"
+}
+
+test_tiered_device() {
+  print_heading "Tiered Device"
+  rm -f "$TIER_DISK_FILE" "$TIER_DISK_FILE".tier "$TIER_DISK_FILE".fast
+  run_expect_success "Create tiered disk" "tiered (2MB fast)" $EXECUTABLE "$TIER_DISK_FILE" create 16 --tiered 2
+  run_expect_success "Format tiered disk" "formatted" $EXECUTABLE "$TIER_DISK_FILE" format
+  run_expect_success "Metadata pinned in fast tier" "13 pinned" $EXECUTABLE "$TIER_DISK_FILE" stats
+  printf "mkdir /tier\necho hot-block > /tier/f\nexit\n" | $EXECUTABLE "$TIER_DISK_FILE" run >/dev/null 2>&1
+  run_expect_success "Read through fast tier" "hot-block" $EXECUTABLE "$TIER_DISK_FILE" cat /tier/f
+  run_expect_success "Slot map survives reopen" "Promotions: 0" $EXECUTABLE "$TIER_DISK_FILE" stats
+  rm -f "$TIER_DISK_FILE".fast
+  run_expect_success "Lost fast tier starts cold" "cold start" $EXECUTABLE "$TIER_DISK_FILE" stats
+  run_expect_success "Data intact after losing fast tier" "hot-block" $EXECUTABLE "$TIER_DISK_FILE" cat /tier/f
+  # 快速层写入失败时撤下驻留副本，同一会话内的读取改走慢速层而不是读到旧副本
+  local tier_output
+  tier_output=$(printf "echo rewritten > /tier/f\ncat /tier/f\nstats\nexit\n" |
+    DISKSIM_TIER_FAIL_WRITES=1 $EXECUTABLE "$TIER_DISK_FILE" run 2>&1)
+  ((TOTAL_TESTS++))
+  if echo "$tier_output" | grep -q "rewritten$" && echo "$tier_output" | grep -q "fast tier write errors"; then
+    print_result 0 "Failed fast tier write drops stale copy" "" "Read served from slow tier"
+  else
+    print_result 1 "Failed fast tier write drops stale copy" "$tier_output" "Stale fast tier copy returned"
+  fi
+  run_expect_success "Dropped slots repinned on reopen" "rewritten" $EXECUTABLE "$TIER_DISK_FILE" cat /tier/f
+  run_expect_failure "Reject fast tier as large as disk" "smaller than the disk" $EXECUTABLE "$TIER_DISK_FILE" create 4 --tiered 4
+  rm -f "$TIER_DISK_FILE" "$TIER_DISK_FILE".tier "$TIER_DISK_FILE".fast
+}
+
 test_copy_and_removal() {
   print_heading "Copy and Removal"
   run_expect_success "Copy readme" "File copied" $EXECUTABLE "$DISK_FILE" copy /docs/readme.txt /docs/manual.txt
@@ -164,6 +627,15 @@ test_cli_mode() {
   print_heading "CLI Run Mode"
   local batch="help\nmkdir /cli-suite\nls /\nrm /cli-suite\nexit\n"
   run_cli_batch "Execute batch" "cli-suite" "$batch"
+  # 同一进程内先列举再修改，后续列举必须看到写者发布的新目录版本
+  local listing="mkdir /cli-snap\nls /cli-snap\ntouch /cli-snap/new.txt\nls /cli-snap\nrm /cli-snap/new.txt\nrm /cli-snap\nexit\n"
+  run_cli_batch "Listing sees published directory version" $'../\tnew.txt' "$listing"
+  # 目录项与inode缓存：删除后复用同一inode号时不能命中旧条目
+  local reuse="mkdir /cache-a\nmkdir /cache-a/b\ntouch /cache-a/b/f\nrm /cache-a/b/f\nrm /cache-a/b\ntouch /cache-a/b\necho reused-inode > /cache-a/b\ncat /cache-a/b\ncat /cache-a/b/f\nrm /cache-a/b\nrm /cache-a\nexit\n"
+  run_cli_batch "Cached lookups follow inode reuse" "Not a directory" "$reuse"
+  # 重复、末尾的'/'与相对路径按组件解析，结果与规范路径相同
+  local unnormalized="mkdir /px\nmkdir px/sub\ntouch //px///sub//f.txt\necho deep-path > /px/sub/f.txt\ncat px/sub/f.txt/\nrm //px/sub/f.txt\nrm /px/sub/\nrm px\nexit\n"
+  run_cli_batch "Unnormalized paths resolve by component" "deep-path" "$unnormalized"
 }
 
 test_info_command() {
@@ -197,6 +669,26 @@ main() {
 
   test_root_listing
   test_basic_operations
+  test_search
+  test_name_index
+  test_log_structured
+  test_mount_table
+  test_sharded_namespace
+  test_striped_device
+  test_mirrored_device
+  test_read_only_mount
+  test_checksums
+  test_c_api
+  test_slow_op_watchdog
+  test_memory_accounting
+  test_cache_modes
+  test_warm_set
+  test_defrag
+  test_tail_packing
+  test_copy_tree
+  test_image_archive
+  test_heatmap
+  test_tiered_device
   test_copy_and_removal
   test_cli_mode
   test_info_command
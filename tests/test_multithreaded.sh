@@ -141,7 +141,7 @@ ensure_build() {
 
 prepare_environment() {
   print_heading "Environment Setup"
-  rm -f "$DISK_FILE"
+  rm -f "$DISK_FILE" "$DISK_FILE.warm"
   run_expect_success "Create 10MB disk" "Disk created successfully" $EXECUTABLE "$DISK_FILE" create 10
   run_expect_success "Format disk" "Disk formatted successfully" $EXECUTABLE "$DISK_FILE" format
   run_expect_success "Create dispatcher workspace" "Directory created" $EXECUTABLE "$DISK_FILE" mkdir /mt
@@ -150,7 +150,7 @@ prepare_environment() {
 cleanup_environment() {
   print_heading "Environment Cleanup"
   make clean >/dev/null 2>&1
-  rm -f "$DISK_FILE"
+  rm -f "$DISK_FILE" "$DISK_FILE.warm"
   echo "Cleanup complete."
 }
 
@@ -178,6 +178,11 @@ test_parallel_activity() {
   run_expect_success "Dispatcher batch workload" "batch.txt" $EXECUTABLE "$DISK_FILE" multithreaded "touch /mt/job1.txt; touch /mt/job2.txt; echo 'batch payload' > /mt/batch.txt"
   assert_contains "Batch artifacts created" /mt job1.txt job2.txt batch.txt
 
+  run_expect_success "Listings interleaved with writers" "parallel-done" bash -c "$EXECUTABLE $DISK_FILE multithreaded 'ls /mt; touch /mt/snap1.txt; ls /mt; touch /mt/snap2.txt; ls /' >/dev/null && echo parallel-done"
+  assert_contains "Writers not lost behind listings" /mt snap1.txt snap2.txt
+  run_expect_success "Remove snap1" "Removed" $EXECUTABLE "$DISK_FILE" multithreaded rm /mt/snap1.txt
+  run_expect_success "Remove snap2" "Removed" $EXECUTABLE "$DISK_FILE" multithreaded rm /mt/snap2.txt
+
   run_expect_success "Remove batch file" "Removed" $EXECUTABLE "$DISK_FILE" multithreaded rm /mt/batch.txt
   run_expect_success "Remove job1" "Removed" $EXECUTABLE "$DISK_FILE" multithreaded rm /mt/job1.txt
   run_expect_success "Remove job2" "Removed" $EXECUTABLE "$DISK_FILE" multithreaded rm /mt/job2.txt
@@ -158,7 +158,7 @@ ensure_build() {
 
 prepare_environment() {
   print_heading "Environment Setup"
-  rm -f "$DISK_FILE"
+  rm -f "$DISK_FILE" "$DISK_FILE.warm"
   run_expect_success "Create 20MB disk" "Disk created successfully" $EXECUTABLE "$DISK_FILE" create 20
   run_expect_success "Format disk" "Disk formatted successfully" $EXECUTABLE "$DISK_FILE" format
   run_expect_success "Create test workspace" "Directory created" $EXECUTABLE "$DISK_FILE" mkdir /ts
@@ -167,7 +167,7 @@ prepare_environment() {
 cleanup_environment() {
   print_heading "Environment Cleanup"
   make clean >/dev/null 2>&1
-  rm -f "$DISK_FILE"
+  rm -f "$DISK_FILE" "$DISK_FILE.warm"
   echo "Cleanup complete."
 }
 